@@ -0,0 +1,127 @@
+/**
+ * Benchmark: BULK_GRADE throughput.
+ *
+ * Grades a class worth of submissions of one test with gradeBatch(),
+ * once per thread count, and checks every run produces the same scores
+ * and per-question counts as the single-threaded one. Submissions are
+ * already parsed, as the handler hands them to the test service.
+ *
+ * Build: make bench
+ * Run:   ./bench/bulk_grade_bench [submissions] [questions]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "include/core/test.h"
+#include "src/service/answer_key.h"
+
+using namespace english_learning;
+
+namespace {
+
+core::Test makeTest(int questions) {
+    core::Test test("test_bench", "mixed", "intermediate", "grammar", "Bench");
+    for (int i = 0; i < questions; i++) {
+        std::string id = "q" + std::to_string(i + 1);
+        switch (i % 3) {
+        case 0:
+            test.addQuestion(core::TestQuestion(id, "multiple_choice", "Pick one", "b"));
+            break;
+        case 1:
+            test.addQuestion(core::TestQuestion(id, "fill_blank", "She ___ to school.", "Goes"));
+            break;
+        default:
+            test.addQuestion(core::TestQuestion(id, "sentence_order", "Order the words",
+                                                "I have never been to London."));
+            break;
+        }
+    }
+    return test;
+}
+
+// Varied submissions: some wrong, some skipped, answers in any order
+std::vector<service::SubmissionAnswers> makeSubmissions(int count, int questions) {
+    std::vector<service::SubmissionAnswers> submissions(count);
+    for (int s = 0; s < count; s++) {
+        service::SubmissionAnswers& submission = submissions[s];
+        submission.submissionId = "sub_" + std::to_string(s);
+        for (int k = 0; k < questions; k++) {
+            int i = (k + s) % questions;
+            if ((i + s) % 7 == 0) continue;
+            bool wrong = (i * 31 + s) % 5 == 0;
+            const char* answer = i % 3 == 0 ? (wrong ? "a" : "b")
+                               : i % 3 == 1 ? (wrong ? "went" : "  goes ")
+                                            : (wrong ? "london i have never been to"
+                                                     : "i have  never been to london");
+            submission.answers.emplace_back("q" + std::to_string(i + 1), answer);
+        }
+    }
+    return submissions;
+}
+
+bool sameResult(const service::BulkGradeResult& a, const service::BulkGradeResult& b) {
+    if (a.scores.size() != b.scores.size() || a.questions.size() != b.questions.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.scores.size(); i++) {
+        if (a.scores[i].submissionId != b.scores[i].submissionId ||
+            a.scores[i].score != b.scores[i].score) {
+            return false;
+        }
+    }
+    for (size_t i = 0; i < a.questions.size(); i++) {
+        if (a.questions[i].correct != b.questions[i].correct ||
+            a.questions[i].wrong != b.questions[i].wrong ||
+            a.questions[i].unanswered != b.questions[i].unanswered) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int count = argc > 1 ? std::stoi(argv[1]) : 100000;
+    int questions = argc > 2 ? std::stoi(argv[2]) : 20;
+    std::cout << "Submissions: " << count << ", questions: " << questions << std::endl;
+
+    core::Test test = makeTest(questions);
+    service::AnswerKey key(test);
+    std::vector<service::SubmissionAnswers> submissions = makeSubmissions(count, questions);
+
+    service::BulkGradeResult reference = service::gradeBatch(key, submissions, 1);
+    std::cout << "  average " << reference.averagePercentage << "%" << std::endl;
+
+    unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+    std::vector<unsigned> threadCounts = {1, 2, 4};
+    if (cores > 4) threadCounts.push_back(cores);
+
+    double single = 0;
+    for (unsigned threads : threadCounts) {
+        const int runs = 5;
+        double best = 0;
+        service::BulkGradeResult result;
+        for (int run = 0; run < runs; run++) {
+            auto start = std::chrono::steady_clock::now();
+            result = service::gradeBatch(key, submissions, threads);
+            double ms = std::chrono::duration<double, std::milli>(
+                            std::chrono::steady_clock::now() - start).count();
+            if (run == 0 || ms < best) best = ms;
+        }
+        if (!sameResult(result, reference)) {
+            std::cerr << "Result mismatch with " << threads << " threads" << std::endl;
+            return 1;
+        }
+        if (threads == 1) single = best;
+        std::cout << "  " << threads << " thread(s), " << result.shards << " shard(s): " << best
+                  << " ms (" << static_cast<long>(count / best * 1000.0)
+                  << " submissions/s), speedup " << single / best << "x" << std::endl;
+    }
+    return 0;
+}
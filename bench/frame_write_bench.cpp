@@ -0,0 +1,140 @@
+/**
+ * Benchmark: framed writes over a loopback TCP connection.
+ *
+ * Compares the old two-send() framing against a single sendmsg() per frame
+ * and against FrameQueue flushing several queued frames per call. Reports
+ * wall time and the number of write syscalls issued by the sender.
+ *
+ * Build: make bench
+ * Run:   ./bench/frame_write_bench [frames] [payloadBytes]
+ */
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "src/network/frame_queue.h"
+
+using english_learning::network::FrameQueue;
+
+namespace {
+
+struct Result {
+    double millis;
+    uint64_t syscalls;
+};
+
+/** Connected loopback TCP pair (Nagle left on, like the legacy server). */
+bool makePair(int& sender, int& receiver) {
+    int listener = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = 0;
+    if (bind(listener, (struct sockaddr*)&addr, sizeof(addr)) < 0) return false;
+    socklen_t len = sizeof(addr);
+    getsockname(listener, (struct sockaddr*)&addr, &len);
+    listen(listener, 1);
+
+    sender = socket(AF_INET, SOCK_STREAM, 0);
+    if (connect(sender, (struct sockaddr*)&addr, sizeof(addr)) < 0) return false;
+    receiver = accept(listener, nullptr, nullptr);
+    close(listener);
+    return receiver >= 0;
+}
+
+/** Read frames request/response style: the reader waits for each frame. */
+void drainFrames(int fd, int frames) {
+    std::string body;
+    for (int i = 0; i < frames; i++) {
+        uint32_t len;
+        if (recv(fd, &len, sizeof(len), MSG_WAITALL) <= 0) return;
+        body.resize(ntohl(len));
+        if (recv(fd, &body[0], body.size(), MSG_WAITALL) <= 0) return;
+    }
+}
+
+template <typename WriteFn>
+Result run(int frames, WriteFn write) {
+    int sender, receiver;
+    if (!makePair(sender, receiver)) {
+        std::cerr << "[ERROR] Cannot create loopback pair" << std::endl;
+        return {0, 0};
+    }
+
+    std::thread reader(drainFrames, receiver, frames);
+    auto start = std::chrono::steady_clock::now();
+    uint64_t syscalls = write(sender);
+    reader.join();
+    auto end = std::chrono::steady_clock::now();
+
+    close(sender);
+    close(receiver);
+    return {std::chrono::duration<double, std::milli>(end - start).count(), syscalls};
+}
+
+void report(const char* name, int frames, const Result& r) {
+    std::cout << "  " << name << ": " << r.millis << " ms, " << r.syscalls
+              << " syscalls (" << static_cast<double>(r.syscalls) / frames
+              << " per frame)" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int frames = argc > 1 ? std::stoi(argv[1]) : 20000;
+    size_t payloadSize = argc > 2 ? std::stoul(argv[2]) : 300;
+    std::string payload(payloadSize, 'x');
+
+    std::cout << "Frames: " << frames << " x " << payloadSize << " bytes" << std::endl;
+
+    // Legacy: htonl prefix and body in two send() calls
+    Result twoSends = run(frames, [&](int fd) {
+        uint64_t calls = 0;
+        for (int i = 0; i < frames; i++) {
+            uint32_t len = htonl(payload.size());
+            send(fd, &len, sizeof(len), 0);
+            send(fd, payload.data(), payload.size(), 0);
+            calls += 2;
+        }
+        return calls;
+    });
+    report("send() x2 per frame   ", frames, twoSends);
+
+    // One gathered sendmsg() per frame
+    Result single = run(frames, [&](int fd) {
+        uint64_t calls = 0;
+        for (int i = 0; i < frames; i++) {
+            FrameQueue::writeFrame(fd, payload);
+            calls++;
+        }
+        return calls;
+    });
+    report("sendmsg() per frame   ", frames, single);
+
+    // Bursts of frames (response + pushes) flushed together
+    const int burst = 8;
+    Result queued = run(frames, [&](int fd) {
+        FrameQueue queue;
+        for (int i = 0; i < frames; i++) {
+            queue.push(payload);
+            if ((i + 1) % burst == 0 || i + 1 == frames) {
+                while (queue.flush(fd) == FrameQueue::FlushResult::WouldBlock) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        return queue.syscalls();
+    });
+    report("FrameQueue burst of 8 ", frames, queued);
+
+    return 0;
+}
@@ -0,0 +1,169 @@
+/**
+ * Benchmark: tolerant grading.
+ *
+ * Times the bit-parallel edit distance and word LCS of fuzzy_match.h
+ * against the textbook dynamic programs they replace, then grades whole
+ * tests whose questions all have tolerance on and whose answers all miss
+ * the exact match, so every answer takes the fuzzy path.
+ *
+ * Build: make bench
+ * Run:   ./bench/fuzzy_match_bench [iterations]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "include/core/test.h"
+#include "src/service/answer_key.h"
+#include "src/service/fuzzy_match.h"
+
+using namespace english_learning;
+
+namespace {
+
+// Prevents the compiler from discarding the results
+long long sink = 0;
+
+int dpEditDistance(std::string_view a, std::string_view b) {
+    std::vector<int> row(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); j++) row[j] = static_cast<int>(j);
+    for (size_t i = 1; i <= a.size(); i++) {
+        int diagonal = row[0];
+        row[0] = static_cast<int>(i);
+        for (size_t j = 1; j <= b.size(); j++) {
+            int above = row[j];
+            row[j] = std::min({row[j] + 1, row[j - 1] + 1, diagonal + (a[i - 1] != b[j - 1])});
+            diagonal = above;
+        }
+    }
+    return row[b.size()];
+}
+
+int dpLcs(const std::vector<std::string>& a, const std::vector<std::string>& b) {
+    std::vector<int> row(b.size() + 1, 0);
+    for (size_t i = 1; i <= a.size(); i++) {
+        int diagonal = 0;
+        for (size_t j = 1; j <= b.size(); j++) {
+            int above = row[j];
+            row[j] = a[i - 1] == b[j - 1] ? diagonal + 1 : std::max(row[j], row[j - 1]);
+            diagonal = above;
+        }
+    }
+    return row[b.size()];
+}
+
+template <typename Fn>
+double timeIt(int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) sink += fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+std::string makeText(size_t length, unsigned seed) {
+    std::string text;
+    for (size_t i = 0; i < length; i++) {
+        seed = seed * 1103515245 + 12345;
+        text += static_cast<char>('a' + (seed >> 16) % 26);
+    }
+    return text;
+}
+
+// The words of the sentence with every other pair swapped
+std::vector<std::string> shuffled(const std::vector<std::string>& words) {
+    std::vector<std::string> result = words;
+    for (size_t i = 0; i + 1 < result.size(); i += 4) std::swap(result[i], result[i + 1]);
+    return result;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 200000;
+    std::cout << "Iterations: " << iterations << std::endl;
+
+    uint64_t charMasks[256] = {};
+    std::cout << "Edit distance (bound 2, two typos):" << std::endl;
+    for (size_t length : {8, 24, 64}) {
+        std::string correct = makeText(length, static_cast<unsigned>(length));
+        std::string typed = correct;
+        typed[length / 3] = '#';
+        typed.erase(length / 2, 1);
+
+        if (service::boundedEditDistance(correct, typed, 2, charMasks) !=
+            dpEditDistance(correct, typed)) {
+            std::cerr << "Distance mismatch at " << length << " chars" << std::endl;
+            return 1;
+        }
+        double dp = timeIt(iterations, [&] { return dpEditDistance(correct, typed); });
+        double bits = timeIt(iterations, [&] {
+            return service::boundedEditDistance(correct, typed, 2, charMasks);
+        });
+        std::cout << "  " << length << " chars: dp " << dp << " ns, bit-parallel " << bits
+                  << " ns, speedup " << dp / bits << "x" << std::endl;
+    }
+
+    std::cout << "Word LCS (pairs swapped):" << std::endl;
+    for (size_t length : {8, 24, 64}) {
+        std::vector<std::string> correct;
+        for (size_t i = 0; i < length; i++) correct.push_back(makeText(3 + i % 5, 7 * i + 1));
+        std::vector<std::string> typed = shuffled(correct);
+
+        // Masks as AnswerKey builds them, looked up per submitted word
+        std::vector<uint64_t> masks(typed.size());
+        for (size_t j = 0; j < typed.size(); j++) {
+            for (size_t i = 0; i < correct.size(); i++) {
+                if (typed[j] == correct[i]) masks[j] |= uint64_t(1) << i;
+            }
+        }
+        if (service::longestCommonSubsequence(correct.size(), masks.data(), masks.size()) !=
+            dpLcs(correct, typed)) {
+            std::cerr << "LCS mismatch at " << length << " words" << std::endl;
+            return 1;
+        }
+        double dp = timeIt(iterations, [&] { return dpLcs(correct, typed); });
+        double bits = timeIt(iterations, [&] {
+            return service::longestCommonSubsequence(correct.size(), masks.data(), masks.size());
+        });
+        std::cout << "  " << length << " words: dp " << dp << " ns, bit-parallel " << bits
+                  << " ns, speedup " << dp / bits << "x" << std::endl;
+    }
+
+    std::cout << "Whole test, tolerance on, no answer exact:" << std::endl;
+    for (int questions : {10, 20, 50}) {
+        core::Test strict("test_bench", "mixed", "intermediate", "grammar", "Bench");
+        std::vector<std::string> answers;
+        for (int i = 0; i < questions; i++) {
+            std::string id = "q" + std::to_string(i + 1);
+            if (i % 2 == 0) {
+                strict.addQuestion(core::TestQuestion(id, "fill_blank", "___", "would have passed"));
+                answers.push_back("would have pased");
+            } else {
+                strict.addQuestion(core::TestQuestion(id, "sentence_order", "Order the words",
+                                                      "I was cooking when the phone rang"));
+                answers.push_back("I was cooking the phone rang when");
+            }
+        }
+        core::Test tolerant = strict;
+        for (auto& q : tolerant.questions) {
+            q.maxTypos = 2;
+            q.partialCredit = true;
+        }
+
+        service::AnswerKey strictKey(strict);
+        service::AnswerKey tolerantKey(tolerant);
+        int n = std::max(1, iterations * 10 / questions);
+        double exact = timeIt(n, [&] { return strictKey.grade(answers).earnedPoints; });
+        double fuzzy = timeIt(n, [&] { return tolerantKey.grade(answers).earnedPoints; });
+        std::cout << "  " << questions << " questions: exact only " << exact / 1000.0
+                  << " us, tolerant " << fuzzy / 1000.0 << " us ("
+                  << tolerantKey.grade(answers).earnedPoints << "/" << tolerantKey.totalPoints()
+                  << " points)" << std::endl;
+    }
+
+    return sink == 0 ? 1 : 0;
+}
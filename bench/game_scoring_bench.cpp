@@ -0,0 +1,139 @@
+/**
+ * Benchmark: SUBMIT_GAME_RESULT scoring throughput.
+ *
+ * Compares the legacy scorer (every submitted match compared against
+ * the game's pairs one by one until it is found) against a compiled
+ * MatchKey (pairs hashed to positions once per game version, one lookup
+ * per match, repeated matches counted once). Each iteration scores one
+ * submission from an already parsed request, which is the work the
+ * handler does after JsonDocument.
+ *
+ * Build: make bench
+ * Run:   ./bench/game_scoring_bench [iterations]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <string_view>
+
+#include "include/core/game.h"
+#include "include/protocol/json_document.h"
+#include "src/service/match_key.h"
+
+using namespace english_learning;
+using english_learning::protocol::JsonDocument;
+using english_learning::protocol::JsonValue;
+
+namespace {
+
+// Prevents the compiler from discarding the scores
+long long sink = 0;
+
+core::Game makeGame(int pairs) {
+    core::Game game("game_bench", "word_match", "Bench", "", "intermediate", 300, 100);
+    for (int i = 0; i < pairs; i++) {
+        game.pairs.emplace_back("word" + std::to_string(i), "meaning" + std::to_string(i));
+    }
+    return game;
+}
+
+// Every pair matched, one in five wrongly; repeats appends the first
+// matches again, as a client retrying part of a round would
+std::string makeSubmission(int pairs, int repeats) {
+    std::string json = R"({"messageType":"SUBMIT_GAME_RESULT_REQUEST","messageId":"msg_9",)"
+                       R"("sessionToken":"tok_1","payload":{"gameSessionId":"gs_1",)"
+                       R"("gameId":"game_bench","matches":[)";
+    for (int i = 0; i < pairs + repeats; i++) {
+        int pair = i % pairs;
+        if (i > 0) json += ",";
+        std::string right = pair % 5 == 4 ? "meaning" + std::to_string(pair + 1)
+                                          : "meaning" + std::to_string(pair);
+        json += R"({"left":"word)" + std::to_string(pair) + R"(","right":")" + right + R"("})";
+    }
+    json += "]}}";
+    return json;
+}
+
+// SUBMIT_GAME_RESULT scoring as it was before match keys
+int legacyScore(const core::Game& game, JsonValue payload) {
+    int correctMatches = 0;
+    for (JsonValue match : payload["matches"]) {
+        std::string_view left = match["left"].raw();
+        std::string_view right = match["right"].raw();
+        for (const auto& pair : game.pairs) {
+            if (pair.first == left && pair.second == right) {
+                correctMatches++;
+                break;
+            }
+        }
+    }
+    return correctMatches;
+}
+
+// What handleSubmitGameResult does now
+int compiledScore(const service::MatchKey& key, JsonValue payload) {
+    service::MatchTally tally(key);
+    for (JsonValue match : payload["matches"]) {
+        tally.add(match[key.leftField()].raw(), match[key.rightField()].raw());
+    }
+    return tally.correct();
+}
+
+template <typename Fn>
+double timeIt(int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) sink += fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 200000;
+    std::cout << "Iterations: " << iterations << " (per submission)" << std::endl;
+
+    for (int pairs : {10, 100, 1000}) {
+        core::Game game = makeGame(pairs);
+        std::string json = makeSubmission(pairs, 0);
+        JsonDocument doc(json);
+        JsonValue payload = doc["payload"];
+
+        auto compileStart = std::chrono::steady_clock::now();
+        service::MatchKey key(game);
+        double compileUs = std::chrono::duration<double, std::micro>(
+                               std::chrono::steady_clock::now() - compileStart).count();
+
+        if (legacyScore(game, payload) != compiledScore(key, payload)) {
+            std::cerr << "Score mismatch at " << pairs << " pairs" << std::endl;
+            return 1;
+        }
+
+        int n = std::max(1, iterations * 10 / pairs);
+        double legacy = timeIt(n, [&] { return legacyScore(game, payload); });
+        double compiled = timeIt(n, [&] { return compiledScore(key, payload); });
+        std::cout << "  " << pairs << " pairs: legacy " << legacy / 1000.0 << " us ("
+                  << static_cast<long>(1e9 / legacy) << "/s), compiled " << compiled / 1000.0
+                  << " us (" << static_cast<long>(1e9 / compiled) << "/s), speedup "
+                  << legacy / compiled << "x, key built in " << compileUs << " us"
+                  << std::endl;
+    }
+
+    // A submission repeating its matches must not score above 100%
+    core::Game game = makeGame(100);
+    service::MatchKey key(game);
+    std::string json = makeSubmission(100, 300);
+    JsonDocument doc(json);
+    int legacy = legacyScore(game, doc["payload"]);
+    int compiled = compiledScore(key, doc["payload"]);
+    std::cout << "  100 pairs, 300 repeated matches: legacy counts " << legacy
+              << " correct, compiled " << compiled << std::endl;
+    if (compiled > 100) {
+        std::cerr << "Repeated matches counted twice" << std::endl;
+        return 1;
+    }
+
+    return sink == 0 ? 1 : 0;
+}
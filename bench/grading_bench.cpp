@@ -0,0 +1,188 @@
+/**
+ * Benchmark: SUBMIT_TEST grading throughput.
+ *
+ * Compares the legacy grader (answers collected into a std::map, then
+ * both the submitted and the correct answer lowercased, stripped and
+ * re-normalized for every question of every submission) against a
+ * compiled AnswerKey (correct answers normalized once, question IDs
+ * hashed to positions). Each iteration grades one submission from an
+ * already parsed request, which is the work the handler does after
+ * JsonDocument.
+ *
+ * Build: make bench
+ * Run:   ./bench/grading_bench [iterations]
+ */
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "include/core/test.h"
+#include "include/protocol/json_document.h"
+#include "src/service/answer_key.h"
+
+using namespace english_learning;
+using english_learning::protocol::JsonDocument;
+using english_learning::protocol::JsonValue;
+
+namespace {
+
+// Prevents the compiler from discarding the scores
+long long sink = 0;
+
+core::Test makeTest(int questions) {
+    core::Test test("test_bench", "mixed", "intermediate", "grammar", "Bench");
+    for (int i = 0; i < questions; i++) {
+        std::string id = "q" + std::to_string(i + 1);
+        switch (i % 3) {
+        case 0:
+            test.addQuestion(core::TestQuestion(id, "multiple_choice", "Pick one", "b"));
+            break;
+        case 1:
+            test.addQuestion(core::TestQuestion(id, "fill_blank", "She ___ to school.", "Goes"));
+            break;
+        default:
+            test.addQuestion(core::TestQuestion(id, "sentence_order", "Order the words",
+                                                "I have never been to London."));
+            break;
+        }
+    }
+    return test;
+}
+
+// Submitted answers: mostly right, with the case and spacing users type
+std::string makeSubmission(int questions) {
+    std::string json = R"({"messageType":"SUBMIT_TEST_REQUEST","messageId":"msg_7",)"
+                       R"("sessionToken":"tok_1","payload":{"testId":"test_bench","answers":[)";
+    for (int i = 0; i < questions; i++) {
+        if (i > 0) json += ",";
+        const char* answer = i % 3 == 0 ? (i % 4 == 0 ? "a" : "b")
+                           : i % 3 == 1 ? "  goes "
+                                        : "i have  never been to london";
+        json += R"({"questionId":"q)" + std::to_string(i + 1) + R"(","answer":")" + answer +
+                R"("})";
+    }
+    json += "]}}";
+    return json;
+}
+
+// SUBMIT_TEST grading as it was before answer keys
+int legacyGrade(const core::Test& test, JsonValue payload) {
+    std::map<std::string_view, std::string_view> answers;
+    for (JsonValue entry : payload["answers"]) {
+        answers.emplace(entry["questionId"].raw(), entry["answer"].raw());
+    }
+
+    int earnedPoints = 0;
+    for (const auto& q : test.questions) {
+        std::string userAnswer;
+        auto answerIt = answers.find(q.questionId);
+        if (answerIt != answers.end()) userAnswer = std::string(answerIt->second);
+
+        bool isCorrect = false;
+        if (q.type == "multiple_choice") {
+            isCorrect = userAnswer == q.correctAnswer;
+        } else if (q.type == "sentence_order") {
+            std::string lowerUser = userAnswer;
+            std::string lowerCorrect = q.correctAnswer;
+            std::transform(lowerUser.begin(), lowerUser.end(), lowerUser.begin(), ::tolower);
+            std::transform(lowerCorrect.begin(), lowerCorrect.end(), lowerCorrect.begin(),
+                           ::tolower);
+            auto punct = [](char c) { return !std::isalnum(c) && c != ' '; };
+            lowerUser.erase(std::remove_if(lowerUser.begin(), lowerUser.end(), punct),
+                            lowerUser.end());
+            lowerCorrect.erase(std::remove_if(lowerCorrect.begin(), lowerCorrect.end(), punct),
+                               lowerCorrect.end());
+            lowerUser.erase(0, lowerUser.find_first_not_of(" \t"));
+            lowerUser.erase(lowerUser.find_last_not_of(" \t") + 1);
+            lowerCorrect.erase(0, lowerCorrect.find_first_not_of(" \t"));
+            lowerCorrect.erase(lowerCorrect.find_last_not_of(" \t") + 1);
+            std::string normalizedUser, normalizedCorrect;
+            for (char c : lowerUser) {
+                if (c != ' ' || normalizedUser.empty() || normalizedUser.back() != ' ') {
+                    normalizedUser += c;
+                }
+            }
+            for (char c : lowerCorrect) {
+                if (c != ' ' || normalizedCorrect.empty() || normalizedCorrect.back() != ' ') {
+                    normalizedCorrect += c;
+                }
+            }
+            isCorrect = normalizedUser == normalizedCorrect;
+        } else {
+            std::string lowerUser = userAnswer;
+            std::string lowerCorrect = q.correctAnswer;
+            std::transform(lowerUser.begin(), lowerUser.end(), lowerUser.begin(), ::tolower);
+            std::transform(lowerCorrect.begin(), lowerCorrect.end(), lowerCorrect.begin(),
+                           ::tolower);
+            lowerUser.erase(0, lowerUser.find_first_not_of(" \t"));
+            lowerUser.erase(lowerUser.find_last_not_of(" \t") + 1);
+            lowerCorrect.erase(0, lowerCorrect.find_first_not_of(" \t"));
+            lowerCorrect.erase(lowerCorrect.find_last_not_of(" \t") + 1);
+            isCorrect = lowerUser == lowerCorrect;
+        }
+        if (isCorrect) earnedPoints += q.points;
+    }
+    return earnedPoints;
+}
+
+// What handleSubmitTest does now
+int compiledGrade(const service::AnswerKey& key, JsonValue payload) {
+    std::vector<std::string> answers(key.size());
+    std::vector<bool> answered(key.size(), false);
+    for (JsonValue entry : payload["answers"]) {
+        size_t position = key.position(entry["questionId"].raw());
+        if (position == service::AnswerKey::npos || answered[position]) continue;
+        answered[position] = true;
+        answers[position] = entry["answer"].unescaped();
+    }
+    return key.grade(answers).earnedPoints;
+}
+
+template <typename Fn>
+double timeIt(int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) sink += fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 200000;
+    std::cout << "Iterations: " << iterations << " (per submission)" << std::endl;
+
+    for (int questions : {10, 50, 200}) {
+        core::Test test = makeTest(questions);
+        std::string json = makeSubmission(questions);
+        JsonDocument doc(json);
+        JsonValue payload = doc["payload"];
+
+        auto compileStart = std::chrono::steady_clock::now();
+        service::AnswerKey key(test);
+        double compileUs = std::chrono::duration<double, std::micro>(
+                               std::chrono::steady_clock::now() - compileStart).count();
+
+        if (legacyGrade(test, payload) != compiledGrade(key, payload)) {
+            std::cerr << "Score mismatch at " << questions << " questions" << std::endl;
+            return 1;
+        }
+
+        int n = std::max(1, iterations * 10 / questions);
+        double legacy = timeIt(n, [&] { return legacyGrade(test, payload); });
+        double compiled = timeIt(n, [&] { return compiledGrade(key, payload); });
+        std::cout << "  " << questions << " questions: legacy " << legacy / 1000.0
+                  << " us (" << static_cast<long>(1e9 / legacy) << "/s), compiled "
+                  << compiled / 1000.0 << " us (" << static_cast<long>(1e9 / compiled)
+                  << "/s), speedup " << legacy / compiled << "x, key built in " << compileUs
+                  << " us" << std::endl;
+    }
+
+    return sink == 0 ? 1 : 0;
+}
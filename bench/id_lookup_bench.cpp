@@ -0,0 +1,107 @@
+/**
+ * Benchmark: user and session lookups by ID.
+ *
+ * Compares the std::map<std::string, User*> the server used to keep by
+ * userId against a HandleIndex over interned IDs, looked up both by the
+ * string (one hash probe into the interner) and by a handle already in
+ * hand (an array access, as releaseClient does with Session::userHandle).
+ * Session tokens are compared the same way, std::map against the
+ * std::unordered_map that replaced it.
+ *
+ * Build: make bench
+ * Run:   ./bench/id_lookup_bench [lookups]
+ */
+
+#include <chrono>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "include/core/session.h"
+#include "include/core/user.h"
+#include "include/protocol/utils.h"
+#include "src/repository/memory/id_interner.h"
+
+using namespace english_learning;
+using english_learning::repository::memory::HandleIndex;
+using english_learning::repository::memory::IdInterner;
+
+namespace {
+
+// Prevents the compiler from discarding the lookups
+long long sink = 0;
+
+template <typename Fn>
+double timeIt(int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) sink += fn(i);
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+void report(const char* what, double legacy, double interned, double byHandle) {
+    std::cout << "    " << what << ": map " << legacy << " ns, interned " << interned << " ns ("
+              << legacy / interned << "x)";
+    if (byHandle > 0) std::cout << ", by handle " << byHandle << " ns (" << legacy / byHandle
+                                << "x)";
+    std::cout << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int lookups = argc > 1 ? std::stoi(argv[1]) : 2000000;
+    std::cout << "Lookups: " << lookups << std::endl;
+
+    for (int count : {1000, 10000, 100000}) {
+        std::vector<core::User> users(count);
+        std::vector<core::Session> sessions(count);
+        for (int i = 0; i < count; i++) {
+            users[i].userId = "user_" + std::to_string(10000 + i);
+            users[i].fullname = "User " + std::to_string(i);
+            sessions[i] = core::Session(protocol::utils::generateSessionToken(), users[i].userId, 0);
+        }
+
+        std::map<std::string, core::User*> legacyUsers;
+        IdInterner ids;
+        HandleIndex<core::User> userById(ids);
+        std::map<std::string, core::Session> legacySessions;
+        std::unordered_map<std::string, core::Session> hashedSessions;
+        for (int i = 0; i < count; i++) {
+            legacyUsers[users[i].userId] = &users[i];
+            sessions[i].userHandle = userById.put(users[i].userId, &users[i]);
+            legacySessions[sessions[i].sessionToken] = sessions[i];
+            hashedSessions[sessions[i].sessionToken] = sessions[i];
+        }
+
+        // Random order, so the map's comparisons are not all cache hits
+        std::vector<int> order(lookups);
+        std::mt19937 rng(42);
+        for (int& i : order) i = static_cast<int>(rng() % count);
+
+        std::cout << "  " << count << " users" << std::endl;
+        double legacy = timeIt(lookups, [&](int i) {
+            return legacyUsers.find(users[order[i]].userId)->second->fullname.size();
+        });
+        double interned = timeIt(lookups, [&](int i) {
+            return userById.find(users[order[i]].userId)->fullname.size();
+        });
+        double byHandle = timeIt(lookups, [&](int i) {
+            return userById.find(sessions[order[i]].userHandle)->fullname.size();
+        });
+        report("userById", legacy, interned, byHandle);
+
+        legacy = timeIt(lookups, [&](int i) {
+            return legacySessions.find(sessions[order[i]].sessionToken)->second.userId.size();
+        });
+        interned = timeIt(lookups, [&](int i) {
+            return hashedSessions.find(sessions[order[i]].sessionToken)->second.userId.size();
+        });
+        report("sessions", legacy, interned, 0);
+    }
+
+    return sink == 0 ? 1 : 0;
+}
@@ -0,0 +1,129 @@
+/**
+ * Benchmark: field extraction from protocol messages.
+ *
+ * Compares the legacy getJsonValue()/getJsonObject()/getJsonArray() access
+ * pattern used by the handlers against a JsonDocument tokenized once per
+ * message. Each iteration extracts the same fields a real handler reads.
+ *
+ * Build: make bench
+ * Run:   ./bench/json_document_bench [iterations]
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "include/protocol/json_document.h"
+#include "include/protocol/json_parser.h"
+
+using namespace english_learning::protocol;
+
+namespace {
+
+// Prevents the compiler from discarding the extracted values
+size_t sink = 0;
+
+const std::string LOGIN =
+    R"({"messageType":"LOGIN_REQUEST","messageId":"msg_42","timestamp":1735000000000,)"
+    R"("payload":{"email":"student@example.com","password":"secret123"}})";
+
+const std::string SEND_MESSAGE =
+    R"({"messageType":"SEND_MESSAGE_REQUEST","messageId":"msg_43","timestamp":1735000000000,)"
+    R"("sessionToken":"tok_8f3a9c2e1b7d4f60","payload":{"recipientId":"user_17",)"
+    R"("messageContent":"Hi! Did you finish the \"present perfect\" lesson yet?"}})";
+
+std::string makeSubmitGame(int pairs) {
+    std::string json =
+        R"({"messageType":"SUBMIT_GAME_RESULT_REQUEST","messageId":"msg_44",)"
+        R"("timestamp":1735000000000,"sessionToken":"tok_8f3a9c2e1b7d4f60",)"
+        R"("payload":{"gameSessionId":"gs_91","gameId":"game_3","matches":[)";
+    for (int i = 0; i < pairs; i++) {
+        if (i > 0) json += ",";
+        json += R"({"left":"word)" + std::to_string(i) + R"(","right":"meaning )" +
+                std::to_string(i) + R"("})";
+    }
+    json += "]}}";
+    return json;
+}
+
+size_t legacyScalar(const std::string& json, const std::vector<std::string>& fields) {
+    std::string payload = getJsonObject(json, "payload");
+    size_t total = getJsonValue(json, "messageType").size() +
+                   getJsonValue(json, "messageId").size() +
+                   getJsonValue(json, "sessionToken").size();
+    for (const auto& field : fields) total += getJsonValue(payload, field).size();
+    return total;
+}
+
+size_t documentScalar(const std::string& json, const std::vector<std::string>& fields) {
+    JsonDocument doc(json);
+    JsonValue payload = doc["payload"];
+    size_t total = doc["messageType"].raw().size() + doc["messageId"].raw().size() +
+                   doc["sessionToken"].raw().size();
+    for (const auto& field : fields) total += payload[field].raw().size();
+    return total;
+}
+
+size_t legacyMatches(const std::string& json) {
+    std::string payload = getJsonObject(json, "payload");
+    size_t total = getJsonValue(json, "messageType").size() +
+                   getJsonValue(payload, "gameSessionId").size();
+    for (const auto& match : parseJsonArray(getJsonArray(payload, "matches"))) {
+        total += getJsonValue(match, "left").size() + getJsonValue(match, "right").size();
+    }
+    return total;
+}
+
+size_t documentMatches(const std::string& json) {
+    JsonDocument doc(json);
+    JsonValue payload = doc["payload"];
+    size_t total = doc["messageType"].raw().size() + payload["gameSessionId"].raw().size();
+    for (JsonValue match : payload["matches"]) {
+        total += match["left"].raw().size() + match["right"].raw().size();
+    }
+    return total;
+}
+
+template <typename Fn>
+double timeIt(int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) sink += fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+void compare(const char* name, size_t bytes, double legacy, double document) {
+    std::cout << "  " << name << " (" << bytes << " bytes): legacy " << legacy
+              << " ns, document " << document << " ns, speedup "
+              << legacy / document << "x" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 200000;
+    std::cout << "Iterations: " << iterations << " (ns per message)" << std::endl;
+
+    std::vector<std::string> loginFields = {"email", "password"};
+    compare("LOGIN_REQUEST          ", LOGIN.size(),
+            timeIt(iterations, [&] { return legacyScalar(LOGIN, loginFields); }),
+            timeIt(iterations, [&] { return documentScalar(LOGIN, loginFields); }));
+
+    std::vector<std::string> chatFields = {"recipientId", "messageContent"};
+    compare("SEND_MESSAGE_REQUEST   ", SEND_MESSAGE.size(),
+            timeIt(iterations, [&] { return legacyScalar(SEND_MESSAGE, chatFields); }),
+            timeIt(iterations, [&] { return documentScalar(SEND_MESSAGE, chatFields); }));
+
+    for (int pairs : {8, 64}) {
+        std::string game = makeSubmitGame(pairs);
+        int n = iterations / pairs * 4;
+        std::string label = "SUBMIT_GAME_RESULT x" + std::to_string(pairs) +
+                            (pairs < 10 ? "  " : " ");
+        compare(label.c_str(), game.size(),
+                timeIt(n, [&] { return legacyMatches(game); }),
+                timeIt(n, [&] { return documentMatches(game); }));
+    }
+
+    return sink == 0 ? 1 : 0;
+}
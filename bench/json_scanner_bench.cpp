@@ -0,0 +1,154 @@
+/**
+ * Benchmark: structural scanning of large protocol messages.
+ *
+ * Builds three realistic corpora (a SUBMIT_TEST_REQUEST with many answers,
+ * a SUBMIT_EXERCISE_REQUEST carrying a long escaped essay and an
+ * ADD_GAME_REQUEST with a long pair list) and reports, for each JsonScanner
+ * kernel the CPU supports, the scan throughput. It then times the parser
+ * operations that sit on top of the scanner. Every kernel's output is
+ * checked against the scalar kernel before timing.
+ *
+ * Build: make bench
+ * Run:   ./bench/json_scanner_bench [iterations]
+ */
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "include/protocol/json_document.h"
+#include "include/protocol/json_parser.h"
+#include "include/protocol/json_scanner.h"
+
+using namespace english_learning::protocol;
+
+namespace {
+
+size_t sink = 0;
+
+const char* HEADER =
+    R"("messageId":"msg_1024","timestamp":1735000000000,"sessionToken":"tok_8f3a9c2e1b7d4f60",)";
+
+std::string makeSubmitTest(int answers) {
+    std::string json = std::string(R"({"messageType":"SUBMIT_TEST_REQUEST",)") + HEADER +
+                       R"("payload":{"testId":"test_001","timeSpent":600,"answers":[)";
+    for (int i = 0; i < answers; i++) {
+        if (i > 0) json += ",";
+        json += R"({"questionId":"q_)" + std::to_string(i) + R"(","answer":")" +
+                (i % 3 == 0 ? "b" : "I have {been} [studying] for two years") + R"("})";
+    }
+    return json + "]}}";
+}
+
+std::string makeEssay(size_t words) {
+    static const char* vocabulary[] = {"the", "student", "\\\"practised\\\"", "every",
+                                       "morning,", "reading", "{aloud}", "and", "writing",
+                                       "notes:", "[daily]", "journal\\n"};
+    std::string json = std::string(R"({"messageType":"SUBMIT_EXERCISE_REQUEST",)") + HEADER +
+                       R"("payload":{"exerciseId":"ex_7","exerciseType":"essay","content":")";
+    for (size_t i = 0; i < words; i++) {
+        json += vocabulary[i % (sizeof(vocabulary) / sizeof(vocabulary[0]))];
+        json += ' ';
+    }
+    return json + R"("}})";
+}
+
+std::string makeAddGame(int pairs) {
+    std::string json = std::string(R"({"messageType":"ADD_GAME_REQUEST",)") + HEADER +
+                       R"("payload":{"gameType":"sentence_match","title":"Idioms",)"
+                       R"("level":"intermediate","topic":"daily","pairs":[)";
+    for (int i = 0; i < pairs; i++) {
+        if (i > 0) json += ",";
+        json += R"({"left":"Break a leg #)" + std::to_string(i) +
+                R"x(","right":"Good luck (said before a show)"})x";
+    }
+    return json + "]}}";
+}
+
+std::vector<size_t> scanAll(const std::string& json, JsonScanner::Kernel kernel) {
+    std::vector<size_t> positions;
+    JsonScanner scanner(json, kernel);
+    for (size_t pos = scanner.next(); pos != JsonScanner::npos; pos = scanner.next()) {
+        positions.push_back(pos);
+    }
+    return positions;
+}
+
+template <typename Fn>
+double nanosPerCall(int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) sink += fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 20000;
+
+    struct Corpus {
+        const char* name;
+        std::string json;
+        const char* arrayKey;
+    };
+    std::vector<Corpus> corpora = {
+        {"SUBMIT_TEST x200 answers ", makeSubmitTest(200), "answers"},
+        {"SUBMIT_EXERCISE 3k words ", makeEssay(3000), nullptr},
+        {"ADD_GAME x300 pairs      ", makeAddGame(300), "pairs"},
+    };
+
+    std::vector<JsonScanner::Kernel> kernels;
+    for (auto kernel : {JsonScanner::Kernel::Scalar, JsonScanner::Kernel::Sse2,
+                        JsonScanner::Kernel::Avx2}) {
+        if (JsonScanner::supported(kernel)) kernels.push_back(kernel);
+    }
+
+    std::cout << "Active kernel: " << JsonScanner::kernelName(JsonScanner::activeKernel())
+              << ", iterations: " << iterations << std::endl;
+
+    int status = 0;
+    for (const auto& corpus : corpora) {
+        const std::string& json = corpus.json;
+        std::cout << corpus.name << " (" << json.size() << " bytes)" << std::endl;
+
+        auto reference = scanAll(json, JsonScanner::Kernel::Scalar);
+        for (auto kernel : kernels) {
+            if (scanAll(json, kernel) != reference) {
+                std::cout << "  [MISMATCH] " << JsonScanner::kernelName(kernel) << std::endl;
+                status = 1;
+            }
+            double ns = nanosPerCall(iterations, [&] {
+                JsonScanner scanner(json, kernel);
+                size_t count = 0;
+                while (scanner.next() != JsonScanner::npos) count++;
+                return count;
+            });
+            std::cout << "  scan " << JsonScanner::kernelName(kernel) << ": " << ns
+                      << " ns (" << json.size() / ns << " GB/s)" << std::endl;
+        }
+
+        double document = nanosPerCall(iterations, [&] {
+            JsonDocument doc(json);
+            return doc.tokenCount();
+        });
+        std::cout << "  JsonDocument build: " << document << " ns" << std::endl;
+
+        if (corpus.arrayKey) {
+            double elements = nanosPerCall(iterations, [&] {
+                std::string payload = getJsonObject(json, "payload");
+                return parseJsonArray(getJsonArray(payload, corpus.arrayKey)).size();
+            });
+            std::cout << "  getJsonObject + getJsonArray + parseJsonArray: " << elements
+                      << " ns" << std::endl;
+        } else {
+            double content = nanosPerCall(iterations, [&] {
+                return getJsonValue(json, "content").size();
+            });
+            std::cout << "  getJsonValue(content): " << content << " ns" << std::endl;
+        }
+    }
+
+    return sink == 0 ? 1 : status;
+}
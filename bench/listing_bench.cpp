@@ -0,0 +1,181 @@
+/**
+ * Benchmark: GET_GAME_LIST and GET_TEST catalog filtering.
+ *
+ * Compares the legacy handlers (a walk over the catalog comparing the
+ * gameType/level strings of every Game, then each match serialized into
+ * a stringstream; for GET_TEST a walk until the first test of the level)
+ * against GameIndex and TestIndex (enum-coded rows packed in an array,
+ * listing objects serialized once, the first test of each level resolved
+ * when the index is built). Each iteration is the work the handler does
+ * after session validation.
+ *
+ * Build: make bench
+ * Run:   ./bench/listing_bench [iterations]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "include/core/game.h"
+#include "include/core/test.h"
+#include "include/protocol/json_parser.h"
+#include "include/protocol/json_writer.h"
+#include "src/repository/memory/content_index.h"
+
+using namespace english_learning;
+using english_learning::protocol::JsonWriter;
+using english_learning::repository::memory::Catalog;
+using english_learning::repository::memory::GameIndex;
+using english_learning::repository::memory::TestIndex;
+
+namespace {
+
+// Prevents the compiler from discarding the listings
+long long sink = 0;
+
+const char* const GAME_TYPES[] = {"word_match", "sentence_match", "picture_match"};
+const char* const LEVELS[] = {"beginner", "intermediate", "advanced"};
+
+std::string padded(const char* prefix, int i) {
+    std::string digits = std::to_string(i);
+    return prefix + std::string(6 - digits.size(), '0') + digits;
+}
+
+Catalog<core::Game>::Map makeGames(int count) {
+    Catalog<core::Game>::Map games;
+    for (int i = 0; i < count; i++) {
+        core::Game game(padded("game_", i), GAME_TYPES[i % 3], "Game " + std::to_string(i),
+                        "Match the words with their meanings before the time runs out",
+                        LEVELS[(i / 3) % 3], 120, 100);
+        game.topic = "vocabulary";
+        for (int p = 0; p < 8; p++) {
+            game.pairs.emplace_back("word" + std::to_string(p), "meaning" + std::to_string(p));
+        }
+        games.emplace(game.gameId, std::move(game));
+    }
+    return games;
+}
+
+Catalog<core::Test>::Map makeTests(int count) {
+    Catalog<core::Test>::Map tests;
+    for (int i = 0; i < count; i++) {
+        // Advanced tests only at the end, so the legacy walk goes far
+        const char* level = i < count - 1 ? LEVELS[i % 2] : "advanced";
+        core::Test test(padded("test_", i), "mixed", level, "grammar", "Test");
+        tests.emplace(test.testId, std::move(test));
+    }
+    return tests;
+}
+
+// GET_GAME_LIST filtering and serialization as they were before the index
+size_t legacyGameList(const Catalog<core::Game>::Map& games, const std::string& gameType,
+                      const std::string& level) {
+    std::stringstream gamesJson;
+    gamesJson << "[";
+    bool first = true;
+    for (const auto& pair : games) {
+        const core::Game& game = pair.second;
+        bool typeMatch = gameType.empty() || gameType == "all" || game.gameType == gameType;
+        bool levelMatch = level.empty() || game.level == level;
+        if (typeMatch && levelMatch) {
+            if (!first) gamesJson << ",";
+            first = false;
+            gamesJson << R"({"gameId":")" << game.gameId << R"(","gameType":")"
+                      << game.gameType << R"(","title":")" << protocol::escapeJson(game.title)
+                      << R"(","description":")" << protocol::escapeJson(game.description)
+                      << R"(","level":")" << game.level << R"(","topic":")" << game.topic
+                      << R"(","timeLimit":)" << game.timeLimit << R"(,"maxScore":)"
+                      << game.maxScore << "}";
+        }
+    }
+    gamesJson << "]";
+    return gamesJson.str().size();
+}
+
+// What handleGetGameList does now
+size_t indexedGameList(const GameIndex& index, const std::string& gameType,
+                       const std::string& level) {
+    std::string out;
+    JsonWriter writer(out);
+    writer.beginArray();
+    index.writeListing(writer, gameType, level);
+    writer.endArray();
+    return out.size();
+}
+
+const core::Test* legacyFirstTest(const Catalog<core::Test>::Map& tests,
+                                  const std::string& level) {
+    for (const auto& pair : tests) {
+        if (pair.second.level == level) return &pair.second;
+    }
+    return tests.empty() ? nullptr : &tests.begin()->second;
+}
+
+template <typename Fn>
+double timeIt(int iterations, Fn fn) {
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) sink += fn();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+}
+
+void report(const std::string& what, double legacy, double indexed) {
+    std::cout << "    " << what << ": legacy " << legacy / 1000.0 << " us, indexed "
+              << indexed / 1000.0 << " us, speedup " << legacy / indexed << "x" << std::endl;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? std::stoi(argv[1]) : 200000;
+    std::cout << "Iterations: " << iterations << " (per 100 catalog items)" << std::endl;
+
+    for (int count : {100, 1000, 10000}) {
+        auto games = makeGames(count);
+        auto tests = makeTests(count);
+        GameIndex gameIndex(games);
+        TestIndex testIndex(tests);
+        int n = std::max(1, iterations * 100 / count / 10);
+
+        std::cout << "  " << count << " games / tests" << std::endl;
+        struct Filter {
+            const char* name;
+            std::string gameType;
+            std::string level;
+        };
+        for (const Filter& filter : {Filter{"all games", "", ""},
+                                     Filter{"one type", "sentence_match", ""},
+                                     Filter{"type + level", "picture_match", "advanced"}}) {
+            if (legacyGameList(games, filter.gameType, filter.level) !=
+                indexedGameList(gameIndex, filter.gameType, filter.level)) {
+                std::cerr << "Listing mismatch for " << filter.name << std::endl;
+                return 1;
+            }
+            double legacy = timeIt(n, [&] {
+                return legacyGameList(games, filter.gameType, filter.level);
+            });
+            double indexed = timeIt(n, [&] {
+                return indexedGameList(gameIndex, filter.gameType, filter.level);
+            });
+            report(std::string("GET_GAME_LIST ") + filter.name, legacy, indexed);
+        }
+
+        std::string level = "advanced";
+        if (legacyFirstTest(tests, level) != testIndex.firstOfLevel(level)) {
+            std::cerr << "GET_TEST picked a different test" << std::endl;
+            return 1;
+        }
+        double legacy = timeIt(n * 10, [&] {
+            return legacyFirstTest(tests, level)->testId.size();
+        });
+        double indexed = timeIt(n * 10, [&] {
+            return testIndex.firstOfLevel(level)->testId.size();
+        });
+        report("GET_TEST last level", legacy, indexed);
+    }
+
+    return sink == 0 ? 1 : 0;
+}
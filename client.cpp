@@ -18,6 +18,8 @@
 #include <chrono>
 #include <condition_variable>
 #include <cstring>
+#include <deque>
+#include <future>
 #include <iostream>
 #include <map>
 #include <mutex>
@@ -42,6 +44,7 @@
 #define DEFAULT_SERVER "127.0.0.1"
 #define DEFAULT_PORT 8888
 #define BUFFER_SIZE 65536
+#define MAX_EXPIRED_REQUESTS 64 // messageId hết giờ còn nhớ để bỏ response muộn
 
 // ============================================================================
 // PROTOCOL LAYER (Refactored to include/protocol/)
@@ -79,6 +82,17 @@ std::queue<std::string> responseQueue;
 std::mutex responseQueueMutex;
 std::condition_variable responseCondition;
 
+// Các request gửi qua sendRequest() đang chờ response, khóa theo messageId.
+// Response có messageId khớp được trả thẳng cho future tương ứng thay vì đi
+// qua responseQueue, nên nhiều request có thể cùng chờ (pipelining).
+std::map<std::string, std::promise<std::string>> pendingRequests;
+// Request đã hết thời gian chờ (cũ nhất ở đầu, tối đa MAX_EXPIRED_REQUESTS):
+// response đến muộn của chúng bị bỏ, không lọt vào responseQueue
+std::deque<std::string> expiredRequests;
+// Receive thread đã dừng: không còn ai trả response, sendRequest() thất bại
+bool receiverStopped = false;
+std::mutex pendingRequestsMutex;
+
 // [FIX] Biến để lưu thông tin tin nhắn mới
 std::atomic<bool> hasNewNotification(false);
 std::string pendingChatUserId = "";
@@ -101,6 +115,10 @@ std::atomic<bool> canShowNotification(true);
 
 // [FIX] Lưu ID người đang chat để hiển thị tin nhắn trực tiếp thay vì popup
 std::string currentChatPartnerId = "";
+
+// Hook cho giao diện khác (GUI) nhận push notification, gọi trên receive
+// thread sau handlePushNotification. nullptr = chỉ xử lý kiểu console.
+void (*pushNotificationHook)(const std::string &message) = nullptr;
 std::string currentChatPartnerName = "";
 std::mutex chatPartnerMutex;
 
@@ -110,7 +128,7 @@ std::mutex chatPartnerMutex;
 // NOTE: getCurrentTimestamp() is now provided by include/protocol/utils.h
 
 std::string generateMessageId() {
-  static int counter = 0;
+  static std::atomic<int> counter(0);
   return "msg_" + std::to_string(++counter);
 }
 
@@ -379,7 +397,24 @@ void handlePushNotification(const std::string &message) {
 // Phân loại message: response (đưa vào queue) hoặc push notification (hiển thị)
 // ============================================================================
 
+// Hủy các request đang chờ (mất kết nối): future nhận chuỗi rỗng
+void cancelPendingRequests() {
+  std::lock_guard<std::mutex> lock(pendingRequestsMutex);
+  receiverStopped = true;
+  for (auto &entry : pendingRequests) {
+    entry.second.set_value("");
+  }
+  pendingRequests.clear();
+}
+
+void receiveLoop();
+
 void receiveThreadFunc() {
+  receiveLoop();
+  cancelPendingRequests();
+}
+
+void receiveLoop() {
   while (running && clientSocket >= 0) {
     // Sử dụng poll để kiểm tra có dữ liệu không (non-blocking check)
     struct pollfd pfd;
@@ -444,7 +479,27 @@ void receiveThreadFunc() {
           messageType == "VOICE_CALL_ENDED") {
         // [FIX] Đây là push notification, xử lý ngay
         handlePushNotification(buffer);
+        if (pushNotificationHook)
+          pushNotificationHook(buffer);
       } else {
+        // Response của sendRequest(): trả cho future theo messageId
+        std::string messageId = getJsonValue(buffer, "messageId");
+        {
+          std::lock_guard<std::mutex> lock(pendingRequestsMutex);
+          auto it = pendingRequests.find(messageId);
+          if (!messageId.empty() && it != pendingRequests.end()) {
+            it->second.set_value(buffer);
+            pendingRequests.erase(it);
+            continue;
+          }
+          auto expired = std::find(expiredRequests.begin(),
+                                   expiredRequests.end(), messageId);
+          if (!messageId.empty() && expired != expiredRequests.end()) {
+            expiredRequests.erase(expired);
+            continue;
+          }
+        }
+
         // [FIX] Đây là response cho request, đưa vào queue
         {
           std::lock_guard<std::mutex> lock(responseQueueMutex);
@@ -510,12 +565,73 @@ std::string waitForResponse(int timeoutMs = 10000) {
   return response;
 }
 
-// [FIX] Gửi request và chờ response (sử dụng queue thay vì blocking recv)
-std::string sendAndReceive(const std::string &request) {
+// Gửi request không chờ: trả về future sẽ nhận response có cùng messageId.
+// Request phải có trường "messageId"; có thể gọi nhiều lần liên tiếp rồi mới
+// chờ các future (pipelining).
+std::future<std::string> sendRequest(const std::string &request) {
+  std::string messageId = getJsonValue(request, "messageId");
+  std::promise<std::string> promise;
+  std::future<std::string> future = promise.get_future();
+
+  if (messageId.empty()) {
+    promise.set_value("");
+    return future;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(pendingRequestsMutex);
+    if (receiverStopped) {
+      promise.set_value("");
+      return future;
+    }
+    pendingRequests[messageId] = std::move(promise);
+  }
+
   if (!sendMessage(request)) {
-    return "";
+    std::lock_guard<std::mutex> lock(pendingRequestsMutex);
+    auto it = pendingRequests.find(messageId);
+    if (it != pendingRequests.end()) {
+      it->second.set_value("");
+      pendingRequests.erase(it);
+    }
+  }
+  return future;
+}
+
+// Chờ future của sendRequest() cho request messageId; trả về chuỗi rỗng nếu
+// hết thời gian. Khi đó request bị gỡ khỏi pendingRequests, và response đến
+// muộn của nó bị bỏ chứ không lẫn sang request sau.
+std::string awaitResponse(const std::string &messageId,
+                          std::future<std::string> &future, int timeoutMs) {
+  if (future.wait_for(std::chrono::milliseconds(timeoutMs)) ==
+      std::future_status::ready) {
+    return future.get();
+  }
+
+  std::lock_guard<std::mutex> lock(pendingRequestsMutex);
+  // Response có thể vừa đến giữa lúc hết giờ và lúc lấy lock
+  if (future.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+    return future.get();
+  }
+  if (pendingRequests.erase(messageId) > 0) {
+    expiredRequests.push_back(messageId);
+    if (expiredRequests.size() > MAX_EXPIRED_REQUESTS) {
+      expiredRequests.pop_front();
+    }
+  }
+  return "";
+}
+
+// Gửi request và chờ response của chính nó (khớp theo messageId)
+std::string sendAndReceive(const std::string &request) {
+  if (getJsonValue(request, "messageId").empty()) {
+    if (!sendMessage(request)) {
+      return "";
+    }
+    return waitForResponse();
   }
-  return waitForResponse();
+  std::future<std::string> future = sendRequest(request);
+  return awaitResponse(getJsonValue(request, "messageId"), future, 10000);
 }
 
 // ============================================================================
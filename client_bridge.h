@@ -2,6 +2,7 @@
 #define CLIENT_BRIDGE_H
 
 #include <atomic>
+#include <future>
 #include <iostream>
 #include <string>
 
@@ -19,10 +20,19 @@ extern int activeCallUdpPort;        // UDP port của người nhận (khi mìn
 extern std::atomic<bool> inCallMode; // Trạng thái đang gọi
 extern std::string activeCallId;     // ID cuộc gọi đang diễn ra
 
+// Gọi trên receive thread với mỗi push notification (RECEIVE_MESSAGE,
+// VOICE_CALL_*...). Không được chạm vào widget GTK trực tiếp: chuyển sang
+// main loop bằng g_idle_add.
+extern void (*pushNotificationHook)(const std::string &message);
+
 // --- CÁC HÀM DÙNG CHUNG (Shared Functions) ---
 bool connectToServer(const char *ip, int port);
 bool sendMessage(const std::string &message);
 std::string waitForResponse(int timeoutMs = 3000);
+std::string generateMessageId();
+std::future<std::string> sendRequest(const std::string &request); // pipelining
+std::string awaitResponse(const std::string &messageId,
+                          std::future<std::string> &future, int timeoutMs);
 void receiveThreadFunc();
 std::string getJsonValue(const std::string &json, const std::string &key);
 
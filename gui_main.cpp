@@ -1,14 +1,18 @@
 #include "client_bridge.h"
+#include "include/protocol/json_document.h"
+#include "include/protocol/json_parser.h"
 #include "src/audio/audio_streamer.h" // Include AudioStreamer
 #include <algorithm>
 #include <cstring>
 #include <gtk/gtk.h>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <regex>
 #include <sstream>
 #include <string>
 #include <thread>
+#include <unordered_set>
 #include <vector>
 
 // Forward declaration for chat conversation handler (after including gtk)
@@ -77,9 +81,16 @@ struct ConversationState {
   GtkWidget *box_msgs;
   std::string recipientId;
   std::string recipientLabel;
-  int messageCount;
+  std::string lastMessageId; // Cursor "after" cho lần đồng bộ delta kế tiếp
+  std::unordered_set<std::string> shownIds; // Tin đã vẽ (push, resync, tự gửi)
   guint timeout_id;
 };
+
+// Số tin tải khi mở hội thoại và tối đa mỗi lần đồng bộ delta
+#define CHAT_PAGE_SIZE 50
+// Tin mới đến qua push RECEIVE_MESSAGE; resync theo cursor chỉ để bù tin bị
+// lỡ (mất kết nối, push gửi thất bại) nên chạy thưa
+#define CHAT_RESYNC_SECONDS 30
 static ConversationState *g_conv_state = nullptr;
 
 // Khai báo tên hàm
@@ -87,6 +98,26 @@ void show_main_menu();
 void show_test_dialog();
 void show_game_dialog();
 
+// Dữ liệu tải trước ngay sau khi đăng nhập (lessons, games, contacts được gửi
+// cùng lúc qua sendRequest). Mỗi mục chỉ dùng một lần và hết hạn sau
+// PREFETCH_TTL_MS; các lần mở dialog sau sẽ tải lại như bình thường.
+struct PrefetchedData {
+  std::string lessons;
+  std::string games;
+  std::string contacts;
+  gint64 fetchedAt = 0;
+};
+static PrefetchedData g_prefetch;
+static const gint64 PREFETCH_TTL_MS = 30000;
+
+static std::string take_prefetched(std::string &slot) {
+  std::string response;
+  response.swap(slot);
+  if (g_get_monotonic_time() / 1000 - g_prefetch.fetchedAt > PREFETCH_TTL_MS)
+    return "";
+  return response;
+}
+
 // Escape JSON for small payloads
 static std::string escape_json(const std::string &s) {
   std::string out;
@@ -1566,52 +1597,55 @@ void show_lessons_dialog() {
       sessionToken + "\", \"payload\":{\"level\":\"" + currentLevel +
       "\", \"topic\":\"\", \"page\":1}}";
 
-  if (sendMessage(jsonRequest)) {
-    std::string response = waitForResponse(4000);
+  std::string response = take_prefetched(g_prefetch.lessons);
+  if (response.empty()) {
+    if (!sendMessage(jsonRequest))
+      return;
+    response = waitForResponse(4000);
+  }
 
-    GtkWidget *dialog = gtk_dialog_new_with_buttons(
-        "Chọn bài học", GTK_WINDOW(window), GTK_DIALOG_MODAL, "Đóng",
-        GTK_RESPONSE_CLOSE, NULL);
-    gtk_window_set_default_size(GTK_WINDOW(dialog), 450, 500);
+  GtkWidget *dialog = gtk_dialog_new_with_buttons(
+      "Chọn bài học", GTK_WINDOW(window), GTK_DIALOG_MODAL, "Đóng",
+      GTK_RESPONSE_CLOSE, NULL);
+  gtk_window_set_default_size(GTK_WINDOW(dialog), 450, 500);
 
-    GtkWidget *content_area = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
-    GtkWidget *lbl =
-        gtk_label_new(("Danh sách bài học (" + currentLevel + ")").c_str());
-    gtk_box_pack_start(GTK_BOX(content_area), lbl, FALSE, FALSE, 10);
-
-    GtkWidget *scrolled = gtk_scrolled_window_new(NULL, NULL);
-    gtk_box_pack_start(GTK_BOX(content_area), scrolled, TRUE, TRUE, 0);
-    GtkWidget *vbox_list = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
-    gtk_container_add(GTK_CONTAINER(scrolled), vbox_list);
-
-    try {
-      std::regex re_lesson("\"lessonId\"\\s*:\\s*\"([^\"]+)\"[^}]*\"title\"\\s*"
-                           ":\\s*\"([^\"]+)\"");
-      auto words_begin =
-          std::sregex_iterator(response.begin(), response.end(), re_lesson);
-      auto words_end = std::sregex_iterator();
-      int count = 0;
-      for (std::sregex_iterator i = words_begin; i != words_end; ++i) {
-        std::smatch match = *i;
-        GtkWidget *btn = gtk_button_new_with_label(match.str(2).c_str());
-        g_signal_connect(btn, "clicked", G_CALLBACK(on_lesson_btn_clicked),
-                         strdup(match.str(1).c_str()));
-        gtk_box_pack_start(GTK_BOX(vbox_list), btn, FALSE, FALSE, 0);
-        count++;
-      }
-      if (count == 0)
-        gtk_box_pack_start(GTK_BOX(vbox_list),
-                           gtk_label_new("Chưa có bài học nào."), FALSE, FALSE,
-                           20);
-    } catch (...) {
-      gtk_box_pack_start(GTK_BOX(vbox_list), gtk_label_new("Lỗi đọc dữ liệu."),
-                         FALSE, FALSE, 20);
-    }
+  GtkWidget *content_area = gtk_dialog_get_content_area(GTK_DIALOG(dialog));
+  GtkWidget *lbl =
+      gtk_label_new(("Danh sách bài học (" + currentLevel + ")").c_str());
+  gtk_box_pack_start(GTK_BOX(content_area), lbl, FALSE, FALSE, 10);
 
-    gtk_widget_show_all(dialog);
-    gtk_dialog_run(GTK_DIALOG(dialog));
-    gtk_widget_destroy(dialog);
+  GtkWidget *scrolled = gtk_scrolled_window_new(NULL, NULL);
+  gtk_box_pack_start(GTK_BOX(content_area), scrolled, TRUE, TRUE, 0);
+  GtkWidget *vbox_list = gtk_box_new(GTK_ORIENTATION_VERTICAL, 5);
+  gtk_container_add(GTK_CONTAINER(scrolled), vbox_list);
+
+  try {
+    std::regex re_lesson("\"lessonId\"\\s*:\\s*\"([^\"]+)\"[^}]*\"title\"\\s*"
+                         ":\\s*\"([^\"]+)\"");
+    auto words_begin =
+        std::sregex_iterator(response.begin(), response.end(), re_lesson);
+    auto words_end = std::sregex_iterator();
+    int count = 0;
+    for (std::sregex_iterator i = words_begin; i != words_end; ++i) {
+      std::smatch match = *i;
+      GtkWidget *btn = gtk_button_new_with_label(match.str(2).c_str());
+      g_signal_connect(btn, "clicked", G_CALLBACK(on_lesson_btn_clicked),
+                       strdup(match.str(1).c_str()));
+      gtk_box_pack_start(GTK_BOX(vbox_list), btn, FALSE, FALSE, 0);
+      count++;
+    }
+    if (count == 0)
+      gtk_box_pack_start(GTK_BOX(vbox_list),
+                         gtk_label_new("Chưa có bài học nào."), FALSE, FALSE,
+                         20);
+  } catch (...) {
+    gtk_box_pack_start(GTK_BOX(vbox_list), gtk_label_new("Lỗi đọc dữ liệu."),
+                       FALSE, FALSE, 20);
   }
+
+  gtk_widget_show_all(dialog);
+  gtk_dialog_run(GTK_DIALOG(dialog));
+  gtk_widget_destroy(dialog);
 }
 
 // =========================================================
@@ -1660,26 +1694,29 @@ void show_chat_dialog() {
       "{\"messageType\":\"GET_CONTACT_LIST_REQUEST\", \"sessionToken\":\"" +
       sessionToken + "\", \"payload\":{}}";
 
-  GtkWidget *loading =
-      gtk_message_dialog_new(NULL, GTK_DIALOG_MODAL, GTK_MESSAGE_INFO,
-                             GTK_BUTTONS_NONE, "Loading contacts...");
-  gtk_widget_show_now(loading);
-  while (gtk_events_pending())
-    gtk_main_iteration();
+  std::string response = take_prefetched(g_prefetch.contacts);
+  if (response.empty()) {
+    GtkWidget *loading =
+        gtk_message_dialog_new(NULL, GTK_DIALOG_MODAL, GTK_MESSAGE_INFO,
+                               GTK_BUTTONS_NONE, "Loading contacts...");
+    gtk_widget_show_now(loading);
+    while (gtk_events_pending())
+      gtk_main_iteration();
 
-  if (!sendMessage(jsonRequest)) {
+    if (!sendMessage(jsonRequest)) {
+      gtk_widget_destroy(loading);
+      GtkWidget *error =
+          gtk_message_dialog_new(NULL, GTK_DIALOG_MODAL, GTK_MESSAGE_ERROR,
+                                 GTK_BUTTONS_OK, "Failed to load contacts");
+      gtk_dialog_run(GTK_DIALOG(error));
+      gtk_widget_destroy(error);
+      return;
+    }
+
+    response = waitForResponse(3000);
     gtk_widget_destroy(loading);
-    GtkWidget *error =
-        gtk_message_dialog_new(NULL, GTK_DIALOG_MODAL, GTK_MESSAGE_ERROR,
-                               GTK_BUTTONS_OK, "Failed to load contacts");
-    gtk_dialog_run(GTK_DIALOG(error));
-    gtk_widget_destroy(error);
-    return;
   }
 
-  std::string response = waitForResponse(3000);
-  gtk_widget_destroy(loading);
-
   // Parse contacts list
   std::vector<std::pair<std::string, std::string>> contacts; // (userId, name)
   size_t pos = 0;
@@ -1767,86 +1804,130 @@ struct ConversationContext {
   std::string recipientLabel;
 };
 
-// Auto-refresh function: fetches new messages and updates UI
-static gboolean refresh_conversation_messages(gpointer data) {
-  if (!g_conv_state || !g_conv_state->dialog)
-    return FALSE; // Stop if window closed
+// Một tin trong trang GET_CHAT_HISTORY_RESPONSE
+struct ChatEntry {
+  std::string messageId;
+  std::string senderId;
+  std::string content;
+};
 
-  // Fetch chat history again
+// Gửi GET_CHAT_HISTORY_REQUEST một trang (tối đa CHAT_PAGE_SIZE tin, sau
+// cursor afterId nếu có) và đọc kết quả. Trả false nếu không có phản hồi
+// hoặc server báo lỗi (ví dụ cursor không còn hợp lệ).
+static bool fetch_chat_page(const std::string &recipientId,
+                            const std::string &afterId, int timeoutMs,
+                            std::vector<ChatEntry> &out, bool &hasMore) {
   std::string req =
       std::string("{\"messageType\":\"GET_CHAT_HISTORY_REQUEST\", "
                   "\"sessionToken\":\"") +
-      sessionToken + "\", \"payload\":{\"recipientId\":\"" +
-      g_conv_state->recipientId + "\"}}";
+      sessionToken + "\", \"payload\":{\"recipientId\":\"" + recipientId +
+      "\", \"limit\":" + std::to_string(CHAT_PAGE_SIZE);
+  if (!afterId.empty())
+    req += ", \"after\":\"" + afterId + "\"";
+  req += "}}";
   if (!sendMessage(req))
-    return TRUE; // Keep trying
+    return false;
 
-  std::string resp = waitForResponse(1000);
+  std::string resp = waitForResponse(timeoutMs);
+  english_learning::protocol::JsonDocument doc(resp);
+  auto payload = doc["payload"];
+  if (!doc.valid() || payload["status"].str() != "success")
+    return false;
 
-  // Count messages
-  int newCount = 0;
-  size_t pos = 0;
-  while ((pos = resp.find("\"senderId\"", pos)) != std::string::npos) {
-    newCount++;
-    pos += 10;
+  auto data = payload["data"];
+  hasMore = data["hasMore"].asBool(false);
+  for (auto msg : data["messages"]) {
+    ChatEntry entry;
+    entry.messageId = msg["messageId"].unescaped();
+    entry.senderId = msg["senderId"].unescaped();
+    // Nội dung được escape hai lần trên đường truyền
+    entry.content = english_learning::protocol::unescapeJson(
+        msg["content"].unescaped());
+    out.push_back(std::move(entry));
   }
+  return true;
+}
 
-  // If new messages, show notification and refresh
-  if (newCount > g_conv_state->messageCount) {
-    g_print("[CHAT] New messages! %d -> %d\n", g_conv_state->messageCount,
-            newCount);
-    g_conv_state->messageCount = newCount;
+// Nối một tin vào cuối hội thoại đang mở nếu chưa hiển thị
+static void append_conversation_message(const ChatEntry &m) {
+  if (!g_conv_state->shownIds.insert(m.messageId).second)
+    return; // Đã hiển thị (tin mình vừa gửi, hoặc đã nhận qua push)
+  bool isMine = (m.senderId != g_conv_state->recipientId);
+  add_chat_bubble(g_conv_state->box_msgs, m.content, isMine,
+                  isMine ? "You" : g_conv_state->recipientLabel);
+}
 
-    // Show notification
-    GtkWidget *notif = gtk_message_dialog_new(
-        NULL, GTK_DIALOG_MODAL, GTK_MESSAGE_INFO, GTK_BUTTONS_OK,
-        "📬 New message from %s!", g_conv_state->recipientLabel.c_str());
-    gtk_dialog_run(GTK_DIALOG(notif));
-    gtk_widget_destroy(notif);
-
-    // Clear and rebuild message list
-    gtk_container_foreach(GTK_CONTAINER(g_conv_state->box_msgs),
-                          (GtkCallback)gtk_widget_destroy, NULL);
-
-    // Re-parse and display all messages
-    std::vector<std::pair<std::string, std::string>> msgs;
-    pos = 0;
-    while ((pos = resp.find("\"senderId\"", pos)) != std::string::npos) {
-      size_t sStart = resp.find('"', pos + 10);
-      size_t sEnd = resp.find('"', sStart + 1);
-      std::string sid = resp.substr(sStart + 1, sEnd - sStart - 1);
-      size_t cPos = resp.find("\"content\"", pos);
-      if (cPos == std::string::npos)
-        break;
-      size_t cStart = resp.find('"', cPos + 9);
-      size_t cEnd = resp.find('"', cStart + 1);
-      std::string cont = resp.substr(cStart + 1, cEnd - cStart - 1);
-      size_t np = 0;
-      while ((np = cont.find("\\n", np)) != std::string::npos) {
-        cont.replace(np, 2, "\n");
-        np++;
-      }
-      msgs.emplace_back(sid, cont);
-      pos = cEnd + 1;
-    }
+static void scroll_conversation_to_bottom() {
+  GtkAdjustment *adj = gtk_scrolled_window_get_vadjustment(
+      GTK_SCROLLED_WINDOW(gtk_widget_get_parent(g_conv_state->box_msgs)));
+  gtk_adjustment_set_value(adj, gtk_adjustment_get_upper(adj));
+}
 
-    // Rebuild UI with all messages
-    for (auto &m : msgs) {
-      bool isMine = (m.first != g_conv_state->recipientId);
-      add_chat_bubble(g_conv_state->box_msgs, m.second, isMine,
-                      isMine ? "You" : g_conv_state->recipientLabel);
-    }
-    gtk_widget_show_all(g_conv_state->box_msgs);
+// Resync dự phòng: tải các tin sau cursor lastMessageId, nối những tin push
+// chưa mang tới. Không dựng lại cả hội thoại.
+static gboolean refresh_conversation_messages(gpointer data) {
+  if (!g_conv_state || !g_conv_state->dialog)
+    return FALSE; // Stop if window closed
 
-    // Scroll to bottom
-    GtkAdjustment *adj = gtk_scrolled_window_get_vadjustment(
-        GTK_SCROLLED_WINDOW(gtk_widget_get_parent(g_conv_state->box_msgs)));
-    gtk_adjustment_set_value(adj, gtk_adjustment_get_upper(adj));
+  std::vector<ChatEntry> msgs;
+  bool hasMore = false;
+  if (!fetch_chat_page(g_conv_state->recipientId, g_conv_state->lastMessageId,
+                       1000, msgs, hasMore)) {
+    // Cursor có thể đã mất (tin bị xóa): lần sau tải lại trang mới nhất,
+    // shownIds giữ cho các tin đã vẽ không bị lặp
+    g_conv_state->lastMessageId.clear();
+    return TRUE; // Keep trying
+  }
+
+  size_t before = g_conv_state->shownIds.size();
+  for (auto &m : msgs) {
+    g_conv_state->lastMessageId = m.messageId;
+    append_conversation_message(m);
+  }
+  if (g_conv_state->shownIds.size() != before) {
+    g_print("[CHAT] Resync recovered %zu message(s)\n",
+            g_conv_state->shownIds.size() - before);
+    scroll_conversation_to_bottom();
   }
 
+  // Còn tin chưa tải: đồng bộ tiếp ngay thay vì chờ chu kỳ sau
+  if (hasMore)
+    return refresh_conversation_messages(data);
   return TRUE; // Keep the timer running
 }
 
+// Chạy trên main loop (g_idle_add từ on_push_notification): nối tin
+// RECEIVE_MESSAGE vào hội thoại đang mở với người gửi
+static gboolean deliver_pushed_message(gpointer data) {
+  std::unique_ptr<std::string> message(static_cast<std::string *>(data));
+  if (!g_conv_state || !g_conv_state->dialog)
+    return G_SOURCE_REMOVE;
+
+  english_learning::protocol::JsonDocument doc(*message);
+  auto payload = doc["payload"];
+  ChatEntry entry;
+  entry.senderId = payload["senderId"].unescaped();
+  if (!doc.valid() || entry.senderId != g_conv_state->recipientId)
+    return G_SOURCE_REMOVE; // Tin của hội thoại khác
+
+  entry.messageId = payload["messageId"].unescaped();
+  // Nội dung được escape hai lần trên đường truyền
+  entry.content = english_learning::protocol::unescapeJson(
+      payload["messageContent"].unescaped());
+  append_conversation_message(entry);
+  scroll_conversation_to_bottom();
+  return G_SOURCE_REMOVE;
+}
+
+// pushNotificationHook: chạy trên receive thread nên chỉ chuyển tin sang
+// main loop, mọi thao tác với widget nằm trong deliver_pushed_message
+static void on_push_notification(const std::string &message) {
+  if (english_learning::protocol::getJsonValue(message, "messageType") !=
+      "RECEIVE_MESSAGE")
+    return;
+  g_idle_add(deliver_pushed_message, new std::string(message));
+}
+
 // Helper to add a chat bubble (reused for history and new messages)
 static void add_chat_bubble(GtkWidget *box, const std::string &content,
                             bool isMine, const std::string &senderLabel) {
@@ -1895,7 +1976,15 @@ static void on_conversation_send_clicked(GtkWidget *widget, gpointer data) {
   if (sendMessage(json)) {
     // Assume success for UI responsiveness or wait?
     // Let's do a quick wait to ensure it went through.
-    waitForResponse(500);
+    std::string resp = waitForResponse(500);
+
+    // Ghi nhận messageId để lần đồng bộ delta không vẽ lại tin này
+    english_learning::protocol::JsonDocument doc(resp);
+    if (g_conv_state && doc.valid() &&
+        doc["messageType"].str() == "SEND_MESSAGE_RESPONSE") {
+      g_conv_state->shownIds.insert(
+          doc["payload"]["data"]["messageId"].unescaped());
+    }
 
     // Append to UI
     add_chat_bubble(ctx->box_msgs, msg, true, "You");
@@ -1926,36 +2015,11 @@ static void on_open_conversation_clicked(GtkWidget * /*widget*/,
   if (selText)
     g_free(selText);
 
-  // Request chat history
-  std::string req = std::string("{\"messageType\":\"GET_CHAT_HISTORY_"
-                                "REQUEST\", \"sessionToken\":\"") +
-                    sessionToken + "\", \"payload\":{\"recipientId\":\"" +
-                    recipientId + "\"}}";
-  if (!sendMessage(req))
+  // Chỉ tải trang mới nhất; các tin sau đó được đồng bộ theo delta
+  std::vector<ChatEntry> msgs;
+  bool hasMore = false;
+  if (!fetch_chat_page(recipientId, "", 2000, msgs, hasMore))
     return;
-  std::string resp = waitForResponse(2000);
-
-  // Parse messages (senderId, content)
-  std::vector<std::pair<std::string, std::string>> msgs;
-  size_t p = 0;
-  while ((p = resp.find("\"senderId\"", p)) != std::string::npos) {
-    size_t sStart = resp.find('"', p + 10);
-    size_t sEnd = resp.find('"', sStart + 1);
-    std::string sid = resp.substr(sStart + 1, sEnd - sStart - 1);
-    size_t cPos = resp.find("\"content\"", p);
-    if (cPos == std::string::npos)
-      break;
-    size_t cStart = resp.find('"', cPos + 9);
-    size_t cEnd = resp.find('"', cStart + 1);
-    std::string cont = resp.substr(cStart + 1, cEnd - cStart - 1);
-    size_t np = 0;
-    while ((np = cont.find("\\n", np)) != std::string::npos) {
-      cont.replace(np, 2, "\n");
-      np++;
-    }
-    msgs.emplace_back(sid, cont);
-    p = cEnd + 1;
-  }
 
   // Build conversation window
   GtkWidget *conv = gtk_dialog_new_with_buttons(
@@ -1979,8 +2043,8 @@ static void on_open_conversation_clicked(GtkWidget * /*widget*/,
   gtk_container_add(GTK_CONTAINER(scroll), box_msgs);
 
   for (auto &m : msgs) {
-    bool isMine = (m.first != recipientId);
-    add_chat_bubble(box_msgs, m.second, isMine,
+    bool isMine = (m.senderId != recipientId);
+    add_chat_bubble(box_msgs, m.content, isMine,
                     isMine ? "You" : recipientLabel);
   }
 
@@ -2020,10 +2084,13 @@ static void on_open_conversation_clicked(GtkWidget * /*widget*/,
   g_conv_state->box_msgs = box_msgs;
   g_conv_state->recipientId = recipientId;
   g_conv_state->recipientLabel = recipientLabel;
-  g_conv_state->messageCount = (int)msgs.size();
-  // Start auto-refresh every 3 seconds (3000 ms)
-  g_conv_state->timeout_id =
-      g_timeout_add(3000, refresh_conversation_messages, NULL);
+  for (auto &m : msgs)
+    g_conv_state->shownIds.insert(m.messageId);
+  if (!msgs.empty())
+    g_conv_state->lastMessageId = msgs.back().messageId;
+  // Tin mới đến qua push; resync thưa theo cursor để bù tin bị lỡ
+  g_conv_state->timeout_id = g_timeout_add_seconds(
+      CHAT_RESYNC_SECONDS, refresh_conversation_messages, NULL);
 
   gtk_widget_show_all(conv);
   gtk_dialog_run(GTK_DIALOG(conv));
@@ -2104,9 +2171,12 @@ void show_game_dialog() {
       "{\"messageType\":\"GET_GAME_LIST_REQUEST\", \"sessionToken\":\"" +
       sessionToken + "\", \"payload\":{\"gameType\":\"all\",\"level\":\"" +
       currentLevel + "\"}}";
-  if (!sendMessage(listReq))
-    return;
-  std::string listResp = waitForResponse(3000);
+  std::string listResp = take_prefetched(g_prefetch.games);
+  if (listResp.empty()) {
+    if (!sendMessage(listReq))
+      return;
+    listResp = waitForResponse(3000);
+  }
   auto games = parse_game_list(listResp);
 
   if (games.empty()) {
@@ -2214,6 +2284,7 @@ static void on_level_item_clicked(GtkWidget *widget, gpointer data) {
     std::string response = waitForResponse(3000);
     if (response.find("success") != std::string::npos) {
       currentLevel = level;
+      g_prefetch = PrefetchedData(); // lessons/games theo level cũ
       GtkWidget *msg = gtk_message_dialog_new(
           NULL, GTK_DIALOG_MODAL, GTK_MESSAGE_INFO, GTK_BUTTONS_OK,
           "Đã chuyển sang cấp độ: %s", level);
@@ -2800,6 +2871,36 @@ static gboolean check_voice_call_status(gpointer data) {
   return TRUE; // Keep polling
 }
 
+// Gửi 3 request cùng lúc rồi mới chờ, thay vì gửi-chờ lần lượt từng cái
+static void prefetch_dashboard_data() {
+  std::string lessonsId = generateMessageId();
+  std::string gamesId = generateMessageId();
+  std::string contactsId = generateMessageId();
+  std::string lessonsReq =
+      "{\"messageType\":\"GET_LESSONS_REQUEST\", \"messageId\":\"" +
+      lessonsId + "\", \"sessionToken\":\"" + sessionToken +
+      "\", \"payload\":{\"level\":\"" + currentLevel +
+      "\", \"topic\":\"\", \"page\":1}}";
+  std::string gamesReq =
+      "{\"messageType\":\"GET_GAME_LIST_REQUEST\", \"messageId\":\"" +
+      gamesId + "\", \"sessionToken\":\"" + sessionToken +
+      "\", \"payload\":{\"gameType\":\"all\",\"level\":\"" + currentLevel +
+      "\"}}";
+  std::string contactsReq =
+      "{\"messageType\":\"GET_CONTACT_LIST_REQUEST\", \"messageId\":\"" +
+      contactsId + "\", \"sessionToken\":\"" + sessionToken +
+      "\", \"payload\":{}}";
+
+  std::future<std::string> lessons = sendRequest(lessonsReq);
+  std::future<std::string> games = sendRequest(gamesReq);
+  std::future<std::string> contacts = sendRequest(contactsReq);
+
+  g_prefetch.lessons = awaitResponse(lessonsId, lessons, 4000);
+  g_prefetch.games = awaitResponse(gamesId, games, 3000);
+  g_prefetch.contacts = awaitResponse(contactsId, contacts, 3000);
+  g_prefetch.fetchedAt = g_get_monotonic_time() / 1000;
+}
+
 void show_main_menu() {
   if (vbox_login != NULL) {
     gtk_widget_destroy(vbox_login);
@@ -2854,6 +2955,7 @@ static void on_login_clicked(GtkWidget *widget, gpointer data) {
       if (std::regex_search(response, match, re_level) && match.size() > 1)
         currentLevel = match.str(1);
 
+      prefetch_dashboard_data();
       show_main_menu();
     } else {
       gtk_label_set_text(GTK_LABEL(lbl_status), "Sai mật khẩu!");
@@ -2866,6 +2968,7 @@ static void on_login_clicked(GtkWidget *widget, gpointer data) {
 int main(int argc, char *argv[]) {
   if (!connectToServer("127.0.0.1", 8888))
     return 1;
+  pushNotificationHook = on_push_notification;
   std::thread recvThread(receiveThreadFunc);
   recvThread.detach();
 
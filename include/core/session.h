@@ -14,6 +14,7 @@ namespace core {
 struct Session {
     std::string sessionToken;
     std::string userId;
+    IdHandle userHandle = NO_ID_HANDLE;  // Interned userId, set by the server's session store
     Timestamp expiresAt;
 
     Session() : expiresAt(0) {}
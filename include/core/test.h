@@ -11,6 +11,7 @@ namespace core {
 /**
  * TestQuestion entity representing a single question in a test.
  * Supports multiple question types: multiple choice, fill-in-the-blank, sentence ordering.
+ * Answers are graded by service::AnswerKey.
  */
 struct TestQuestion {
     std::string questionId;
@@ -20,6 +21,8 @@ struct TestQuestion {
     std::string correctAnswer;
     std::vector<std::string> words;  // For sentence_order type
     int points;
+    int maxTypos = 0;            // fill_blank: character edits still graded as correct
+    bool partialCredit = false;  // sentence_order: points for the words in the right order
 
     TestQuestion() : points(10) {}
 
@@ -27,24 +30,6 @@ struct TestQuestion {
                  const std::string& correct, int pts = 10)
         : questionId(id), type(t), question(q), correctAnswer(correct), points(pts) {}
 
-    // Check if answer is correct
-    bool checkAnswer(const std::string& answer) const {
-        if (type == "multiple_choice") {
-            return answer == correctAnswer;
-        } else if (type == "fill_blank") {
-            // Case-insensitive comparison for fill blank
-            std::string lowerAnswer = answer;
-            std::string lowerCorrect = correctAnswer;
-            for (char& c : lowerAnswer) c = std::tolower(c);
-            for (char& c : lowerCorrect) c = std::tolower(c);
-            return lowerAnswer == lowerCorrect;
-        } else if (type == "sentence_order") {
-            // For sentence order, compare the full sentence
-            return answer == correctAnswer;
-        }
-        return false;
-    }
-
     // Check if this is a multiple choice question
     bool isMultipleChoice() const {
         return type == "multiple_choice";
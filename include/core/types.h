@@ -84,6 +84,15 @@ inline Level stringToLevel(const std::string& str) {
     return Level::Beginner;
 }
 
+// Strict counterpart of stringToLevel(): false for anything but a level name
+inline bool parseLevel(const std::string& str, Level& level) {
+    if (str == "beginner") level = Level::Beginner;
+    else if (str == "intermediate") level = Level::Intermediate;
+    else if (str == "advanced") level = Level::Advanced;
+    else return false;
+    return true;
+}
+
 inline std::string roleToString(UserRole role) {
     switch (role) {
         case UserRole::Student: return "student";
@@ -120,6 +129,18 @@ inline Topic stringToTopic(const std::string& str) {
     return Topic::Grammar;
 }
 
+// Strict counterpart of stringToTopic(): false for anything but a topic name
+inline bool parseTopic(const std::string& str, Topic& topic) {
+    if (str == "grammar") topic = Topic::Grammar;
+    else if (str == "vocabulary") topic = Topic::Vocabulary;
+    else if (str == "listening") topic = Topic::Listening;
+    else if (str == "speaking") topic = Topic::Speaking;
+    else if (str == "reading") topic = Topic::Reading;
+    else if (str == "writing") topic = Topic::Writing;
+    else return false;
+    return true;
+}
+
 inline std::string questionTypeToString(QuestionType type) {
     switch (type) {
         case QuestionType::MultipleChoice: return "multiple_choice";
@@ -135,6 +156,15 @@ inline QuestionType stringToQuestionType(const std::string& str) {
     return QuestionType::MultipleChoice;
 }
 
+// Strict counterpart of stringToQuestionType()
+inline bool parseQuestionType(const std::string& str, QuestionType& type) {
+    if (str == "multiple_choice") type = QuestionType::MultipleChoice;
+    else if (str == "fill_blank") type = QuestionType::FillBlank;
+    else if (str == "sentence_order") type = QuestionType::SentenceOrder;
+    else return false;
+    return true;
+}
+
 inline std::string exerciseTypeToString(ExerciseType type) {
     switch (type) {
         case ExerciseType::SentenceRewrite: return "sentence_rewrite";
@@ -165,6 +195,15 @@ inline GameType stringToGameType(const std::string& str) {
     return GameType::WordMatch;
 }
 
+// Strict counterpart of stringToGameType()
+inline bool parseGameType(const std::string& str, GameType& type) {
+    if (str == "word_match") type = GameType::WordMatch;
+    else if (str == "sentence_match") type = GameType::SentenceMatch;
+    else if (str == "picture_match") type = GameType::PictureMatch;
+    else return false;
+    return true;
+}
+
 inline std::string submissionStatusToString(SubmissionStatus status) {
     switch (status) {
         case SubmissionStatus::Pending: return "pending";
@@ -202,6 +241,10 @@ inline VoiceCallStatus stringToVoiceCallStatus(const std::string& str) {
 // Timestamp type alias
 using Timestamp = int64_t;
 
+// Dense 32-bit handle standing for a string ID inside the server
+using IdHandle = uint32_t;
+constexpr IdHandle NO_ID_HANDLE = UINT32_MAX;
+
 } // namespace core
 } // namespace english_learning
 
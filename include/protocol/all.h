@@ -7,7 +7,11 @@
  */
 
 #include "message_types.h"
+#include "message_dispatch.h"
+#include "json_scanner.h"
 #include "json_parser.h"
+#include "json_document.h"
+#include "json_writer.h"
 #include "json_builder.h"
 #include "utils.h"
 
@@ -1,10 +1,10 @@
 #ifndef ENGLISH_LEARNING_PROTOCOL_JSON_BUILDER_H
 #define ENGLISH_LEARNING_PROTOCOL_JSON_BUILDER_H
 
-#include <string>
 #include <sstream>
+#include <string>
 #include <vector>
-#include "json_parser.h"
+#include "json_writer.h"
 
 namespace english_learning {
 namespace protocol {
@@ -12,107 +12,114 @@ namespace protocol {
 /**
  * Fluent JSON builder for constructing JSON responses.
  * Provides a type-safe way to build JSON without manual string concatenation.
+ * For hot paths, prefer JsonWriter, which appends into a reusable buffer.
  */
 class JsonBuilder {
 public:
-    JsonBuilder() : first_(true), hasContent_(false) {
-        ss_ << "{";
-    }
+    JsonBuilder() : json_("{"), first_(true), hasContent_(false) {}
 
     // Add a string field
     JsonBuilder& addString(const std::string& key, const std::string& value) {
-        addComma();
-        ss_ << "\"" << key << "\":\"" << JsonParser::escape(value) << "\"";
+        addKey(key);
+        json_ += '"';
+        JsonWriter::appendEscaped(json_, value);
+        json_ += '"';
         return *this;
     }
 
     // Add an integer field
     JsonBuilder& addInt(const std::string& key, int value) {
-        addComma();
-        ss_ << "\"" << key << "\":" << value;
+        addKey(key);
+        JsonWriter::appendInt(json_, value);
         return *this;
     }
 
     // Add a long long field
     JsonBuilder& addLong(const std::string& key, long long value) {
-        addComma();
-        ss_ << "\"" << key << "\":" << value;
+        addKey(key);
+        JsonWriter::appendInt(json_, value);
         return *this;
     }
 
     // Add a double field
     JsonBuilder& addDouble(const std::string& key, double value) {
-        addComma();
-        ss_ << "\"" << key << "\":" << value;
+        addKey(key);
+        std::ostringstream number;
+        number << value;
+        json_ += number.str();
         return *this;
     }
 
     // Add a boolean field
     JsonBuilder& addBool(const std::string& key, bool value) {
-        addComma();
-        ss_ << "\"" << key << "\":" << (value ? "true" : "false");
+        addKey(key);
+        json_ += value ? "true" : "false";
         return *this;
     }
 
     // Add a raw JSON value (object or array) - no escaping
     JsonBuilder& addRaw(const std::string& key, const std::string& rawJson) {
-        addComma();
-        ss_ << "\"" << key << "\":" << rawJson;
+        addKey(key);
+        json_ += rawJson;
         return *this;
     }
 
     // Add a null field
     JsonBuilder& addNull(const std::string& key) {
-        addComma();
-        ss_ << "\"" << key << "\":null";
+        addKey(key);
+        json_ += "null";
         return *this;
     }
 
     // Add a nested object using another builder
     JsonBuilder& addObject(const std::string& key, const JsonBuilder& nested) {
-        addComma();
-        ss_ << "\"" << key << "\":" << nested.build();
+        addKey(key);
+        json_ += nested.json_;
+        json_ += '}';
         return *this;
     }
 
     // Add a string array
     JsonBuilder& addStringArray(const std::string& key, const std::vector<std::string>& values) {
-        addComma();
-        ss_ << "\"" << key << "\":[";
+        addKey(key);
+        json_ += '[';
         bool firstItem = true;
         for (const auto& v : values) {
-            if (!firstItem) ss_ << ",";
-            ss_ << "\"" << JsonParser::escape(v) << "\"";
+            if (!firstItem) json_ += ',';
+            json_ += '"';
+            JsonWriter::appendEscaped(json_, v);
+            json_ += '"';
             firstItem = false;
         }
-        ss_ << "]";
+        json_ += ']';
         return *this;
     }
 
     // Build the final JSON string
     std::string build() const {
-        return ss_.str() + "}";
+        return json_ + "}";
     }
 
     // Reset the builder for reuse
     void reset() {
-        ss_.str("");
-        ss_.clear();
-        ss_ << "{";
+        json_.assign(1, '{');
         first_ = true;
         hasContent_ = false;
     }
 
 private:
-    void addComma() {
+    void addKey(const std::string& key) {
         if (!first_) {
-            ss_ << ",";
+            json_ += ',';
         }
         first_ = false;
         hasContent_ = true;
+        json_ += '"';
+        json_ += key;
+        json_ += "\":";
     }
 
-    std::stringstream ss_;
+    std::string json_;
     bool first_;
     bool hasContent_;
 };
@@ -188,37 +195,37 @@ public:
  */
 class JsonArrayBuilder {
 public:
-    JsonArrayBuilder() : first_(true) {
-        ss_ << "[";
-    }
+    JsonArrayBuilder() : json_("["), first_(true) {}
 
     // Add a raw JSON element (object or value)
     JsonArrayBuilder& addRaw(const std::string& rawJson) {
-        if (!first_) ss_ << ",";
-        ss_ << rawJson;
+        if (!first_) json_ += ',';
+        json_ += rawJson;
         first_ = false;
         return *this;
     }
 
     // Add a string element
     JsonArrayBuilder& addString(const std::string& value) {
-        if (!first_) ss_ << ",";
-        ss_ << "\"" << JsonParser::escape(value) << "\"";
+        if (!first_) json_ += ',';
+        json_ += '"';
+        JsonWriter::appendEscaped(json_, value);
+        json_ += '"';
         first_ = false;
         return *this;
     }
 
     // Add an object from a builder
     JsonArrayBuilder& addObject(const JsonBuilder& obj) {
-        if (!first_) ss_ << ",";
-        ss_ << obj.build();
+        if (!first_) json_ += ',';
+        json_ += obj.build();
         first_ = false;
         return *this;
     }
 
     // Build the final array string
     std::string build() const {
-        return ss_.str() + "]";
+        return json_ + "]";
     }
 
     // Check if array is empty
@@ -228,14 +235,12 @@ public:
 
     // Reset the builder
     void reset() {
-        ss_.str("");
-        ss_.clear();
-        ss_ << "[";
+        json_.assign(1, '[');
         first_ = true;
     }
 
 private:
-    std::stringstream ss_;
+    std::string json_;
     bool first_;
 };
 
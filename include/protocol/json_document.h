@@ -0,0 +1,162 @@
+#ifndef ENGLISH_LEARNING_PROTOCOL_JSON_DOCUMENT_H
+#define ENGLISH_LEARNING_PROTOCOL_JSON_DOCUMENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace english_learning {
+namespace protocol {
+
+class JsonDocument;
+class JsonScanner;
+
+/**
+ * Kind of a JSON token.
+ */
+enum class JsonType : uint8_t {
+    Missing,   ///< Lookup did not match anything
+    Null,
+    Bool,
+    Number,
+    String,
+    Object,
+    Array,
+    Key        ///< Object member name (internal; never returned by lookups)
+};
+
+/**
+ * Lightweight handle to one value inside a JsonDocument.
+ *
+ * Lookups never allocate: raw() returns a view into the original message.
+ * For strings the view excludes the quotes and keeps escape sequences as
+ * they appear on the wire, matching what getJsonValue() returns.
+ * Looking up a missing key yields a Missing value whose raw() is empty,
+ * so chains like doc["payload"]["level"].str() are always safe.
+ */
+class JsonValue {
+public:
+    JsonValue() = default;
+
+    JsonType type() const;
+    bool exists() const { return doc_ != nullptr; }
+    bool isString() const { return type() == JsonType::String; }
+    bool isObject() const { return type() == JsonType::Object; }
+    bool isArray() const { return type() == JsonType::Array; }
+
+    /** Raw text: string contents without quotes, or the token/container text. */
+    std::string_view raw() const;
+
+    /** raw() as an owned string (same result as getJsonValue for scalars). */
+    std::string str() const { return std::string(raw()); }
+
+    /** String contents with escape sequences decoded. */
+    std::string unescaped() const;
+
+    /** Integer value, or defaultValue if missing or not a number. */
+    int asInt(int defaultValue = 0) const;
+
+    bool asBool(bool defaultValue = false) const;
+
+    /** Object member by key (direct children only). */
+    JsonValue operator[](std::string_view key) const;
+
+    /** Array element by position. */
+    JsonValue at(size_t index) const;
+
+    /** Number of array elements or object members. */
+    size_t size() const;
+
+    /** Iterates the elements of an array (empty for anything else). */
+    class Iterator {
+    public:
+        Iterator(const JsonDocument* doc, uint32_t index, uint32_t remaining)
+            : doc_(doc), index_(index), remaining_(remaining) {}
+        JsonValue operator*() const { return JsonValue(doc_, index_); }
+        Iterator& operator++();
+        bool operator!=(const Iterator& other) const { return remaining_ != other.remaining_; }
+
+    private:
+        const JsonDocument* doc_;
+        uint32_t index_;
+        uint32_t remaining_;
+    };
+
+    Iterator begin() const;
+    Iterator end() const { return Iterator(doc_, 0, 0); }
+
+private:
+    friend class JsonDocument;
+    JsonValue(const JsonDocument* doc, uint32_t index) : doc_(doc), index_(index) {}
+
+    const JsonDocument* doc_ = nullptr;
+    uint32_t index_ = 0;
+};
+
+/**
+ * A protocol message tokenized once into a flat offset table.
+ *
+ * The constructor walks the structural positions reported by JsonScanner
+ * a single time and records, for every value, its type, byte range and
+ * the index just past its subtree, so nested lookups skip whole objects
+ * without rescanning them. The
+ * document keeps a view of the text; the caller must keep the text alive
+ * for as long as the document and any JsonValue taken from it.
+ *
+ * Malformed input is tolerated the way the old parser tolerated it:
+ * tokenizing stops at the first error, containers still open at that
+ * point are closed, and everything read before the error stays
+ * reachable. valid() reports whether the whole text parsed.
+ */
+class JsonDocument {
+public:
+    explicit JsonDocument(std::string_view json);
+
+    JsonDocument(const JsonDocument&) = delete;
+    JsonDocument& operator=(const JsonDocument&) = delete;
+
+    bool valid() const { return valid_; }
+    std::string_view text() const { return json_; }
+
+    JsonValue root() const;
+
+    /** Member of the root object. */
+    JsonValue operator[](std::string_view key) const { return root()[key]; }
+
+    /**
+     * First member named key anywhere in the document, in text order.
+     * Mirrors getJsonValue's search for callers that do not know the path.
+     */
+    JsonValue find(std::string_view key) const;
+
+    /** Number of tokens recorded (for diagnostics and benchmarks). */
+    size_t tokenCount() const { return tokens_.size(); }
+
+private:
+    friend class JsonValue;
+
+    struct Token {
+        JsonType type;
+        uint32_t start;   ///< First byte (strings and keys: after the quote)
+        uint32_t length;  ///< Byte length (strings and keys: without quotes)
+        uint32_t next;    ///< Index of the first token after this subtree
+        uint32_t count;   ///< Array elements / object members
+    };
+
+    bool parseValue(JsonScanner& scanner, size_t& pos, int depth);
+    bool parseString(JsonScanner& scanner, size_t& pos, JsonType type);
+    bool parseContainer(JsonScanner& scanner, size_t& pos, int depth, bool isObject);
+    void skipWhitespace(size_t& pos) const;
+    bool onlyWhitespace(size_t from, size_t to) const;
+
+    std::string_view json_;
+    std::vector<Token> tokens_;
+    bool valid_ = false;
+};
+
+} // namespace protocol
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_PROTOCOL_JSON_DOCUMENT_H
@@ -0,0 +1,79 @@
+#ifndef ENGLISH_LEARNING_PROTOCOL_JSON_SCANNER_H
+#define ENGLISH_LEARNING_PROTOCOL_JSON_SCANNER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace english_learning {
+namespace protocol {
+
+/**
+ * Structural character scanner shared by JsonParser and JsonDocument.
+ *
+ * The text is classified 64 bytes at a time into bitmasks of quotes,
+ * backslashes and structural characters ({ } [ ] : ,). Escaped quotes are
+ * removed, a prefix XOR over the remaining quotes marks the bytes that lie
+ * inside strings, and next() then walks the surviving bits with
+ * count-trailing-zeros. Callers only ever look at structural characters
+ * outside strings plus the opening and closing quote of each string, so
+ * braces or brackets inside string values no longer confuse them.
+ *
+ * Blocks are classified lazily, so a lookup that finds its key early does
+ * not pay for the rest of the message. The classification kernel (AVX2,
+ * SSE2 or scalar) is chosen once at startup from the CPU's capabilities.
+ */
+class JsonScanner {
+public:
+    enum class Kernel {
+        Scalar,
+        Sse2,   ///< 4 x 16 bytes per block
+        Avx2    ///< 2 x 32 bytes per block
+    };
+
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    explicit JsonScanner(std::string_view json) : JsonScanner(json, activeKernel()) {}
+    JsonScanner(std::string_view json, Kernel kernel);
+
+    /** Position of the next structural character or quote, or npos at the end. */
+    size_t next() {
+        while (pending_ == 0) {
+            if (blockStart_ >= json_.size()) return npos;
+            scanBlock();
+        }
+        size_t pos = pendingBase_ + static_cast<size_t>(__builtin_ctzll(pending_));
+        pending_ &= pending_ - 1;
+        return pos;
+    }
+
+    /** Same as next() without consuming the position. */
+    size_t peek() {
+        while (pending_ == 0) {
+            if (blockStart_ >= json_.size()) return npos;
+            scanBlock();
+        }
+        return pendingBase_ + static_cast<size_t>(__builtin_ctzll(pending_));
+    }
+
+    /** Best kernel supported by this CPU. */
+    static Kernel activeKernel();
+    static bool supported(Kernel kernel);
+    static const char* kernelName(Kernel kernel);
+
+private:
+    void scanBlock();
+
+    std::string_view json_;
+    Kernel kernel_;
+    size_t blockStart_ = 0;     ///< First byte of the next block to classify
+    size_t pendingBase_ = 0;    ///< First byte of the block pending_ refers to
+    uint64_t pending_ = 0;      ///< Unreported positions of the current block
+    uint64_t inString_ = 0;     ///< All ones if the previous block ended inside a string
+    bool escapeCarry_ = false;  ///< Previous block ended with an unfinished escape
+};
+
+} // namespace protocol
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_PROTOCOL_JSON_SCANNER_H
@@ -0,0 +1,115 @@
+#ifndef ENGLISH_LEARNING_PROTOCOL_JSON_WRITER_H
+#define ENGLISH_LEARNING_PROTOCOL_JSON_WRITER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace english_learning {
+namespace protocol {
+
+/**
+ * Streaming JSON writer that appends into a caller-provided std::string.
+ *
+ * The writer tracks comma placement itself, escapes strings by copying
+ * runs of safe bytes in bulk, and formats integers with std::to_chars, so
+ * building a response costs no allocation beyond growing the target
+ * buffer. Paired with acquireBuffer()/releaseBuffer(), the buffer's
+ * capacity is reused from one response to the next on the same thread:
+ *
+ *     std::string out = JsonWriter::acquireBuffer();
+ *     JsonWriter(out).beginObject().field("status", "success").endObject();
+ *     sendFrame(socket, out);             // written straight from out
+ *     JsonWriter::releaseBuffer(std::move(out));
+ *
+ * Nesting deeper than MAX_DEPTH levels is not supported; going deeper, or
+ * closing more containers than were opened, fails an assertion.
+ */
+class JsonWriter {
+public:
+    /** Deepest container nesting: one hasItem_ bit per level, plus the top. */
+    static constexpr unsigned MAX_DEPTH = 63;
+
+    explicit JsonWriter(std::string& out) : out_(out) {}
+
+    JsonWriter& beginObject();
+    JsonWriter& endObject();
+    JsonWriter& beginArray();
+    JsonWriter& endArray();
+
+    /** Member name; the next value written belongs to it. */
+    JsonWriter& key(std::string_view name);
+
+    /** String value, escaped on the way in. */
+    JsonWriter& string(std::string_view value);
+
+    /**
+     * String whose contents are already JSON-escaped, such as a value
+     * taken from an incoming message with JsonValue::raw().
+     */
+    JsonWriter& escapedString(std::string_view value);
+
+    JsonWriter& integer(long long value);
+    JsonWriter& boolean(bool value);
+    JsonWriter& null();
+
+    /** Pre-serialized JSON value, copied verbatim. */
+    JsonWriter& raw(std::string_view json);
+
+    // key() followed by the matching value
+    JsonWriter& field(std::string_view name, std::string_view value) {
+        return key(name).string(value);
+    }
+    JsonWriter& fieldEscaped(std::string_view name, std::string_view value) {
+        return key(name).escapedString(value);
+    }
+    JsonWriter& fieldInt(std::string_view name, long long value) {
+        return key(name).integer(value);
+    }
+    JsonWriter& fieldBool(std::string_view name, bool value) {
+        return key(name).boolean(value);
+    }
+    JsonWriter& fieldRaw(std::string_view name, std::string_view json) {
+        return key(name).raw(json);
+    }
+
+    /** Append value to out with JSON string escaping (no quotes). */
+    static void appendEscaped(std::string& out, std::string_view value);
+
+    /** Append the decimal form of value to out. */
+    static void appendInt(std::string& out, long long value);
+
+    /**
+     * Take this thread's cached output buffer: empty, but with the capacity
+     * of the largest buffer released on this thread so far.
+     */
+    static std::string acquireBuffer();
+
+    /**
+     * Give a buffer back for reuse once its contents have been sent.
+     * Buffers above a size cap are freed instead of cached.
+     */
+    static void releaseBuffer(std::string&& buffer);
+
+private:
+    /** Comma before a value or key unless it is first in its container. */
+    void separate() {
+        if (afterKey_) {
+            afterKey_ = false;
+            return;
+        }
+        uint64_t bit = 1ULL << depth_;
+        if (hasItem_ & bit) out_ += ',';
+        hasItem_ |= bit;
+    }
+
+    std::string& out_;
+    uint64_t hasItem_ = 0;  ///< Bit per nesting level: container already has an item
+    unsigned depth_ = 0;
+    bool afterKey_ = false;
+};
+
+} // namespace protocol
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_PROTOCOL_JSON_WRITER_H
@@ -0,0 +1,132 @@
+#ifndef ENGLISH_LEARNING_PROTOCOL_MESSAGE_DISPATCH_H
+#define ENGLISH_LEARNING_PROTOCOL_MESSAGE_DISPATCH_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace english_learning {
+namespace protocol {
+
+/** Most payload fields a route can declare as required. */
+constexpr size_t MAX_REQUIRED_FIELDS = 4;
+
+/**
+ * One request type: its handler plus the metadata the dispatcher checks
+ * before calling it.
+ */
+template <typename Handler>
+struct MessageRoute {
+    std::string_view type;           ///< e.g. MessageType::LOGIN_REQUEST
+    std::string_view responseType;   ///< Type used for errors raised by the dispatcher
+    bool authRequired;               ///< Request must carry a sessionToken
+    Handler handler;
+    std::array<std::string_view, MAX_REQUIRED_FIELDS> requiredFields;  ///< Unused slots are ""
+};
+
+/**
+ * Immutable messageType -> route table built entirely at compile time.
+ *
+ * The constructor searches for a seed under which the FNV-1a hash of every
+ * type, re-mixed with the seed, lands in its own slot of a power-of-two
+ * table, so find() costs one hash over the type string, one mask and a
+ * single string comparison, whatever the number of routes. Declare it constexpr so a table with no perfect seed
+ * fails to compile instead of failing at runtime:
+ *
+ *     constexpr MessageDispatchTable<Handler, 2> ROUTES({{
+ *         {MessageType::LOGIN_REQUEST, MessageType::LOGIN_RESPONSE, false,
+ *          handleLogin, {"email", "password"}},
+ *         {MessageType::GET_LESSONS_REQUEST, MessageType::GET_LESSONS_RESPONSE,
+ *          true, handleGetLessons, {}},
+ *     }});
+ */
+template <typename Handler, size_t N>
+class MessageDispatchTable {
+public:
+    using Route = MessageRoute<Handler>;
+
+    constexpr explicit MessageDispatchTable(const std::array<Route, N>& routes)
+        : routes_(routes), seed_(findSeed(routes)) {
+        for (size_t i = 0; i < N; i++) {
+            slots_[slotOf(seed_, routes_[i].type)] = static_cast<uint8_t>(i + 1);
+        }
+    }
+
+    /** Route for a messageType, or nullptr if the type is unknown. */
+    constexpr const Route* find(std::string_view type) const {
+        uint8_t index = slots_[slotOf(seed_, type)];
+        if (index == 0) return nullptr;
+        const Route& route = routes_[index - 1];
+        return route.type == type ? &route : nullptr;
+    }
+
+    constexpr size_t size() const { return N; }
+    constexpr const Route* begin() const { return routes_.data(); }
+    constexpr const Route* end() const { return routes_.data() + N; }
+
+private:
+    static_assert(N > 0 && N < 255, "slot indices are stored in a uint8_t");
+
+    /**
+     * Smallest power of two holding the routes at a load factor <= 1/4,
+     * sparse enough that a perfect seed turns up after a few dozen tries.
+     */
+    static constexpr size_t tableSize() {
+        size_t size = 1;
+        while (size < 4 * N) size <<= 1;
+        return size;
+    }
+
+    static constexpr uint32_t hash(std::string_view text) {
+        uint32_t h = 2166136261u;
+        for (char c : text) {
+            h ^= static_cast<uint8_t>(c);
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+    /** Re-mix a string hash with the seed (murmur3 finalizer). */
+    static constexpr size_t slotOf(uint32_t seed, uint32_t h) {
+        h ^= seed;
+        h ^= h >> 16;
+        h *= 0x85ebca6bu;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35u;
+        h ^= h >> 16;
+        return h & (tableSize() - 1);
+    }
+
+    static constexpr size_t slotOf(uint32_t seed, std::string_view text) {
+        return slotOf(seed, hash(text));
+    }
+
+    static constexpr uint32_t findSeed(const std::array<Route, N>& routes) {
+        // Hash each type once; trying a seed then only re-mixes N integers
+        std::array<uint32_t, N> hashes{};
+        for (size_t i = 0; i < N; i++) hashes[i] = hash(routes[i].type);
+
+        for (uint32_t seed = 0; seed < 1000000; seed++) {
+            std::array<bool, tableSize()> used{};
+            bool collision = false;
+            for (size_t i = 0; i < N && !collision; i++) {
+                size_t slot = slotOf(seed, hashes[i]);
+                collision = used[slot];
+                used[slot] = true;
+            }
+            if (!collision) return seed;
+        }
+        // Not a constant expression: reaching here fails constexpr evaluation
+        throw "no collision-free seed for this route set";
+    }
+
+    std::array<Route, N> routes_;
+    uint32_t seed_;
+    std::array<uint8_t, tableSize()> slots_{};
+};
+
+} // namespace protocol
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_PROTOCOL_MESSAGE_DISPATCH_H
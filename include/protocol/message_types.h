@@ -31,6 +31,8 @@ constexpr const char* GET_TEST_REQUEST = "GET_TEST_REQUEST";
 constexpr const char* GET_TEST_RESPONSE = "GET_TEST_RESPONSE";
 constexpr const char* SUBMIT_TEST_REQUEST = "SUBMIT_TEST_REQUEST";
 constexpr const char* SUBMIT_TEST_RESPONSE = "SUBMIT_TEST_RESPONSE";
+constexpr const char* BULK_GRADE_REQUEST = "BULK_GRADE_REQUEST";
+constexpr const char* BULK_GRADE_RESPONSE = "BULK_GRADE_RESPONSE";
 
 // Exercises
 constexpr const char* GET_EXERCISE_REQUEST = "GET_EXERCISE_REQUEST";
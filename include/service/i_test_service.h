@@ -1,7 +1,9 @@
 #ifndef ENGLISH_LEARNING_SERVICE_I_TEST_SERVICE_H
 #define ENGLISH_LEARNING_SERVICE_I_TEST_SERVICE_H
 
+#include <cstdint>
 #include <string>
+#include <utility>
 #include <vector>
 #include "service_result.h"
 #include "include/core/test.h"
@@ -29,6 +31,46 @@ struct TestSubmissionResult {
     std::vector<bool> questionResults;
 };
 
+/**
+ * One submission to grade in bulk: answers keyed by questionId.
+ */
+struct SubmissionAnswers {
+    std::string submissionId;
+    std::vector<std::pair<std::string, std::string>> answers;
+};
+
+/**
+ * Score of one submission in a bulk grading run.
+ */
+struct SubmissionScore {
+    std::string submissionId;
+    int score = 0;
+    int percentage = 0;
+    int correctCount = 0;
+};
+
+/**
+ * How one question fared across a bulk grading run.
+ */
+struct QuestionStats {
+    std::string questionId;
+    uint32_t correct = 0;
+    uint32_t wrong = 0;       ///< Answered incorrectly
+    uint32_t unanswered = 0;  ///< No answer given (and not correct)
+};
+
+/**
+ * DTO for bulk grading result.
+ */
+struct BulkGradeResult {
+    std::string testId;
+    int totalPoints = 0;
+    double averagePercentage = 0.0;
+    unsigned shards = 0;                   ///< Threads the batch was split across
+    std::vector<SubmissionScore> scores;   ///< Same order as the submissions
+    std::vector<QuestionStats> questions;  ///< Test order
+};
+
 /**
  * Interface for test management services.
  */
@@ -80,6 +122,21 @@ public:
         const std::string& testId,
         const std::vector<std::string>& answers) = 0;
 
+    /**
+     * Grade many submissions of a test at once (teacher/admin only), e.g.
+     * a whole class, or past submissions after the answer key was fixed.
+     * @param userId The user requesting the grading
+     * @param testId The test the submissions belong to
+     * @param submissions Submissions to grade
+     * @param threads Worker threads (0 = one per core)
+     * @return Per-submission scores and per-question statistics
+     */
+    virtual ServiceResult<BulkGradeResult> gradeSubmissions(
+        const std::string& userId,
+        const std::string& testId,
+        const std::vector<SubmissionAnswers>& submissions,
+        unsigned threads = 0) = 0;
+
     /**
      * Update an existing test (teacher/admin only).
      * @param userId The user updating the test
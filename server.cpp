@@ -3,20 +3,25 @@
  * ENGLISH LEARNING APP - SERVER (Enhanced Version)
  * ============================================================================
  * Server xử lý các request từ client theo giao thức đã thiết kế
- * Sử dụng POSIX socket, multithreading để xử lý nhiều client đồng thời
+ * Sử dụng POSIX socket + epoll reactor (mặc định) hoặc thread-per-connection
  *
  * Compile: g++ -std=c++17 -pthread -o server server.cpp
- * Run: ./server [port]
+ * Run: ./server [port] [--io=epoll|threads]
  * ============================================================================
  */
 
 #include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <charconv>
 #include <chrono>
 #include <cstring>
 #include <ctime>
+#include <deque>
 #include <fstream>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <random>
 #include <sstream>
@@ -27,8 +32,12 @@
 
 // POSIX socket headers
 #include <arpa/inet.h>
+#include <linux/sockios.h>
 #include <netinet/in.h>
+#include <poll.h>
 #include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/ioctl.h>
 #include <sys/socket.h>
 #include <unistd.h>
 
@@ -38,6 +47,13 @@
 #define DEFAULT_PORT 8888
 #define BUFFER_SIZE 65536
 #define MAX_CLIENTS 100
+#define MAX_CHAT_PAGE 200 // Số tin tối đa mỗi trang GET_CHAT_HISTORY
+#define MAX_LOGGED_TEST_SUBMISSIONS 10000 // Bài SUBMIT_TEST lưu mỗi đề
+#define MAX_BULK_GRADE_RESULTS 200 // Điểm từng bài tối đa trong BULK_GRADE
+#define VOICE_CALL_RING_TIMEOUT_MS 30000 // Đổ chuông quá lâu thì thành missed
+#define MAX_VOICE_CALL_HISTORY 10000 // Cuộc gọi đã kết thúc giữ lại để tra cứu
+#define GAME_SESSION_GRACE_MS 60000 // Nộp muộn tối đa sau timeLimit của game
+#define MAX_GAME_SESSION_HISTORY 50000 // Kết quả game (bản gọn) giữ lại
 
 // ============================================================================
 // CORE DOMAIN MODELS (Refactored to include/core/)
@@ -68,8 +84,27 @@ using GameSession = english_learning::core::GameSession;
 #include "src/repository/bridge/bridge_repositories_ext.h"
 #include "src/service/all.h"
 
+// ============================================================================
+// NETWORK LAYER (epoll reactor)
+// ============================================================================
+#include "src/network/event_loop.h"
+#include "src/network/frame_queue.h"
+#include "src/network/notification_dispatcher.h"
+#include "src/network/worker_pool.h"
+
+// ============================================================================
+// LOGGING (async, batched)
+// ============================================================================
+#include "src/logging/async_logger.h"
+
+using english_learning::logging::LogLevel;
+
 // Using declarations for protocol utilities
 using english_learning::protocol::escapeJson;
+using english_learning::protocol::JsonDocument;
+using english_learning::protocol::JsonType;
+using english_learning::protocol::JsonValue;
+using english_learning::protocol::JsonWriter;
 using english_learning::protocol::getJsonArray;
 using english_learning::protocol::getJsonObject;
 using english_learning::protocol::getJsonValue;
@@ -83,32 +118,54 @@ namespace MessageType = english_learning::protocol::MessageType;
 // BIẾN TOÀN CỤC VÀ MUTEX
 // ============================================================================
 std::map<std::string, User> users; // email -> User (changed for easier lookup)
-std::map<std::string, User *> userById;              // userId -> User*
-std::map<std::string, Session> sessions;             // sessionToken -> Session
-std::map<std::string, Lesson> lessons;               // lessonId -> Lesson
-std::map<std::string, Test> tests;                   // testId -> Test
+english_learning::repository::memory::IdInterner userHandles; // userId <-> handle
+english_learning::repository::memory::HandleIndex<User>
+    userById(userHandles); // handle -> User*, tra theo userId qua userHandles
+std::unordered_map<std::string, Session> sessions;   // sessionToken -> Session
+// Danh mục chỉ-đọc-nhiều: handler đọc snapshot, admin xuất bản phiên bản mới
+using english_learning::repository::memory::Catalog;
+Catalog<Lesson> lessons;                             // lessonId -> Lesson
+english_learning::repository::memory::LessonIndexCache
+    lessonIndex(lessons); // (level, topic) -> JSON dựng sẵn cho danh sách bài học
+Catalog<Test> tests;                                 // testId -> Test
+english_learning::repository::memory::CatalogView<
+    Test, english_learning::service::AnswerKeyBook>
+    answerKeys(tests); // Đáp án đã chuẩn hóa, dựng lại khi tests thay đổi
+english_learning::repository::memory::TestIndexCache
+    testIndex(tests); // Level mã hóa enum, test đầu tiên theo level
+std::map<std::string, std::deque<english_learning::service::SubmissionAnswers>>
+    testSubmissions; // testId -> các bài SUBMIT_TEST gần nhất (cho BULK_GRADE)
 std::map<std::string, Exercise> exercises;           // exerciseId -> Exercise
-std::vector<ExerciseSubmission> exerciseSubmissions; // Danh sách bài nộp
-std::map<std::string, Game> games;                   // gameId -> Game
-std::map<std::string, GameSession> gameSessions;     // sessionId -> GameSession
-std::vector<ChatMessage> chatMessages;               // Danh sách tin nhắn
+english_learning::repository::memory::SubmissionStore
+    exerciseSubmissions; // Bài nộp, index theo id/user/bài tập + hàng chờ chấm
+Catalog<Game> games;                                 // gameId -> Game
+english_learning::repository::memory::CatalogView<
+    Game, english_learning::service::MatchKeyBook>
+    matchKeys(games); // Cặp đúng đã hash, dựng lại khi games thay đổi
+english_learning::repository::memory::GameIndexCache
+    gameIndex(games); // (gameType, level) mã hóa enum + JSON dựng sẵn
+using GameSessionCompletion =
+    english_learning::repository::memory::GameSessionStore::Completion;
+english_learning::repository::memory::GameSessionStore
+    gameSessions(GAME_SESSION_GRACE_MS,
+                 MAX_GAME_SESSION_HISTORY); // Game đang chơi (TTL) + lịch sử điểm
+english_learning::repository::memory::ChatStore chatStore; // Tin nhắn theo hội thoại
 std::map<int, std::string> clientSessions;           // socket -> sessionToken
 
 // Voice Call type alias
 using VoiceCallSession = english_learning::core::VoiceCallSession;
-std::map<std::string, VoiceCallSession>
-    voiceCalls; // callId -> VoiceCallSession
+using CallChange = english_learning::repository::memory::CallRegistry::Change;
+english_learning::repository::memory::CallRegistry
+    voiceCalls(VOICE_CALL_RING_TIMEOUT_MS,
+               MAX_VOICE_CALL_HISTORY); // Slot bận theo user + lịch sử
 
 std::mutex usersMutex;
 std::mutex sessionsMutex;
-std::mutex chatMutex;
-std::mutex logMutex;
-std::mutex exercisesMutex;
-std::mutex gamesMutex;
-std::mutex voiceCallMutex;
+std::mutex exercisesMutex; // exercises (bài nộp có lock riêng trong store)
+std::mutex testSubmissionsMutex;
 
 int serverSocket = -1;
-bool running = true;
+std::atomic<bool> running{true}; // Tắt bởi signalHandler
 
 // ============================================================================
 // SERVICE LAYER INTEGRATION
@@ -121,6 +178,47 @@ namespace service = english_learning::service;
 
 std::unique_ptr<service::ServiceContainer> serviceContainer;
 
+// Các reactor shard và worker pool (chỉ dùng ở chế độ --io=epoll). Mỗi shard
+// có listening socket SO_REUSEPORT và bảng connection riêng; session/user
+// vẫn là state chung ở trên.
+std::vector<std::unique_ptr<english_learning::network::EventLoop>> eventLoops;
+std::unique_ptr<english_learning::network::WorkerPool> workerPool;
+
+// Logger bất đồng bộ thay cho việc mở/ghi/đóng server.log mỗi message
+std::unique_ptr<english_learning::logging::AsyncLogger> serverLog;
+
+// Push tới user khác (RECEIVE_MESSAGE, EXERCISE_FEEDBACK_NOTIFICATION,
+// VOICE_CALL_*) đi qua dispatcher: handler chỉ xếp hàng, không bao giờ gọi
+// send() trên socket của người khác khi đang giữ lock
+std::unique_ptr<english_learning::network::NotificationDispatcher>
+    notifications;
+
+// Thread-per-connection: writer của một connection. Response của chính
+// connection và push của dispatcher đều ghi qua frames dưới cùng một lock,
+// nên frame không bao giờ xen nhau. Push chỉ ghi non-blocking; phần socket
+// chưa nhận được nằm lại trong frames và thread của connection ghi nốt khi
+// socket ghi được (wakeFd đánh thức nó khỏi poll()).
+struct ConnectionWriter {
+  std::mutex mutex;
+  english_learning::network::FrameQueue frames; // Khóa bằng mutex
+  int wakeFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+  ~ConnectionWriter() {
+    if (wakeFd >= 0) {
+      close(wakeFd);
+    }
+  }
+};
+std::mutex connectionWritersMutex;
+std::unordered_map<int, std::shared_ptr<ConnectionWriter>>
+    connectionWriters; // socket -> writer (chỉ ở --io=threads)
+
+std::shared_ptr<ConnectionWriter> findConnectionWriter(int socket) {
+  std::lock_guard<std::mutex> lock(connectionWritersMutex);
+  auto it = connectionWriters.find(socket);
+  return it == connectionWriters.end() ? nullptr : it->second;
+}
+
 // ============================================================================
 // HÀM TIỆN ÍCH
 // ============================================================================
@@ -130,30 +228,147 @@ bool isTeacher(const std::string &userId);
 // NOTE: getCurrentTimestamp(), generateId(), generateSessionToken()
 // are now provided by include/protocol/utils.h
 
-// Ghi log
-void logMessage(const std::string &direction, const std::string &clientInfo,
-                const std::string &message) {
-  std::lock_guard<std::mutex> lock(logMutex);
+// Ghi log RECV/SEND: chỉ copy record vào ring của serverLog, thread nền
+// ghi file theo lô
+void logMessage(std::string_view direction, std::string_view clientInfo,
+                std::string_view message) {
+  if (serverLog) {
+    serverLog->log(LogLevel::Info, direction, clientInfo, message);
+  }
+}
+
+// Gửi một frame (4 byte độ dài + JSON) tới socket, ghi thẳng từ buffer của
+// caller. Ở chế độ reactor, phần socket chưa nhận hết được xếp vào hàng đợi
+// của connection và không bao giờ block; ở chế độ thread-per-connection thì
+// frame đi qua writer của connection (prefix và body chung một sendmsg())
+// và thread gọi chờ tới khi socket nhận hết.
+bool sendFrame(int socket, std::string_view payload) {
+  if (!eventLoops.empty()) {
+    // Mỗi fd chỉ thuộc về đúng một shard
+    for (auto &loop : eventLoops) {
+      if (loop->owns(socket)) {
+        return loop->send(socket, payload);
+      }
+    }
+    return false;
+  }
+
+  // Thread của connection ghi response của mình, được phép chờ socket
+  std::shared_ptr<ConnectionWriter> writer = findConnectionWriter(socket);
+  if (!writer) {
+    return false;
+  }
+  using FlushResult = english_learning::network::FrameQueue::FlushResult;
+  std::unique_lock<std::mutex> lock(writer->mutex);
+  FlushResult result = writer->frames.send(socket, payload);
+  while (result == FlushResult::WouldBlock) {
+    // Không giữ lock khi chờ, để push vẫn xếp hàng được
+    lock.unlock();
+    struct pollfd writable = {socket, POLLOUT, 0};
+    if (poll(&writable, 1, -1) < 0 && errno != EINTR) {
+      return false;
+    }
+    lock.lock();
+    result = writer->frames.flush(socket);
+  }
+  return result == FlushResult::Done;
+}
+
+// Số byte đã giao cho connection nhưng chưa ra tới mạng. Reactor: hàng đợi
+// FrameQueue của connection. Thread-per-connection: frame còn trong writer
+// của connection cộng phần nằm trong send buffer của socket (SIOCOUTQ).
+size_t outboundBacklog(int socket) {
+  if (!eventLoops.empty()) {
+    for (auto &loop : eventLoops) {
+      if (loop->owns(socket)) {
+        return loop->pendingBytes(socket);
+      }
+    }
+    return 0;
+  }
 
-  auto now = std::chrono::system_clock::now();
-  auto time = std::chrono::system_clock::to_time_t(now);
-  std::string timeStr = std::ctime(&time);
-  timeStr.pop_back();
+  size_t queued = 0;
+  if (std::shared_ptr<ConnectionWriter> writer = findConnectionWriter(socket)) {
+    std::lock_guard<std::mutex> lock(writer->mutex);
+    queued = writer->frames.pendingBytes();
+  }
+  int unsent = 0;
+  if (ioctl(socket, SIOCOUTQ, &unsent) < 0) {
+    return queued;
+  }
+  return queued + static_cast<size_t>(unsent);
+}
 
-  std::cout << "[" << timeStr << "] " << direction << " " << clientInfo << ": ";
+// Đóng connection của client nhận push quá chậm (--push-policy=disconnect)
+void disconnectClient(int socket) {
+  for (auto &loop : eventLoops) {
+    if (loop->owns(socket)) {
+      loop->disconnect(socket);
+      return;
+    }
+  }
+  // Thread-per-connection: recv() của thread đó trả 0 và tự dọn dẹp
+  shutdown(socket, SHUT_RDWR);
+}
 
-  if (message.length() > 200) {
-    std::cout << message.substr(0, 200) << "..." << std::endl;
-  } else {
-    std::cout << message << std::endl;
+// Giao push cho writer của connection mà không bao giờ block. Ở chế độ
+// thread-per-connection, phần socket chưa nhận được để lại cho thread của
+// connection ghi tiếp.
+bool queueFrame(int socket, std::string_view payload) {
+  if (!eventLoops.empty()) {
+    return sendFrame(socket, payload);
+  }
+
+  std::shared_ptr<ConnectionWriter> writer = findConnectionWriter(socket);
+  if (!writer) {
+    return false;
+  }
+  using FlushResult = english_learning::network::FrameQueue::FlushResult;
+  std::lock_guard<std::mutex> lock(writer->mutex);
+  FlushResult result = writer->frames.send(socket, payload);
+  if (result == FlushResult::WouldBlock) {
+    uint64_t one = 1;
+    ssize_t ignored = write(writer->wakeFd, &one, sizeof(one));
+    (void)ignored;
   }
+  return result != FlushResult::Error;
+}
 
-  std::ofstream logFile("server.log", std::ios::app);
-  if (logFile.is_open()) {
-    logFile << "[" << timeStr << "] " << direction << " " << clientInfo << ": "
-            << message << std::endl;
-    logFile.close();
+// Thread của dispatcher gửi push tới socket của người nhận
+bool deliverNotification(int socket, std::string_view payload) {
+  if (!queueFrame(socket, payload)) {
+    return false;
   }
+  logMessage("SEND", "Client:" + std::to_string(socket), payload);
+  return true;
+}
+
+// Mở một response chuẩn và payload của nó:
+// {"messageType":...,"messageId":...,"timestamp":...,"payload":{"status":...
+// Caller ghi tiếp các field của payload rồi gọi endResponse().
+void beginResponse(JsonWriter &writer, std::string_view messageType,
+                   std::string_view messageId, std::string_view status) {
+  writer.beginObject()
+      .field("messageType", messageType)
+      .fieldEscaped("messageId", messageId)
+      .fieldInt("timestamp", getCurrentTimestamp())
+      .key("payload")
+      .beginObject()
+      .field("status", status);
+}
+
+void endResponse(JsonWriter &writer) { writer.endObject().endObject(); }
+
+// Response lỗi {"status":"error","message":...}, ghi vào buffer của thread
+std::string errorResponse(std::string_view messageType,
+                          std::string_view messageId,
+                          std::string_view message) {
+  std::string out = JsonWriter::acquireBuffer();
+  JsonWriter writer(out);
+  beginResponse(writer, messageType, messageId, "error");
+  writer.field("message", message);
+  endResponse(writer);
+  return out;
 }
 
 // NOTE: escapeJson(), getJsonValue(), getJsonObject(), getJsonArray(),
@@ -178,7 +393,7 @@ void initSampleData() {
   teacher1.online = false;
   teacher1.clientSocket = -1;
   users[teacher1.email] = teacher1;
-  userById[teacher1.userId] = &users[teacher1.email];
+  userById.put(teacher1.userId, &users[teacher1.email]);
 
   // Teacher 2
   User teacher2;
@@ -192,7 +407,7 @@ void initSampleData() {
   teacher2.online = false;
   teacher2.clientSocket = -1;
   users[teacher2.email] = teacher2;
-  userById[teacher2.userId] = &users[teacher2.email];
+  userById.put(teacher2.userId, &users[teacher2.email]);
 
   // Student 1
   User student1;
@@ -206,7 +421,7 @@ void initSampleData() {
   student1.online = false;
   student1.clientSocket = -1;
   users[student1.email] = student1;
-  userById[student1.userId] = &users[student1.email];
+  userById.put(student1.userId, &users[student1.email]);
 
   // Student 2
   User student2;
@@ -220,7 +435,7 @@ void initSampleData() {
   student2.online = false;
   student2.clientSocket = -1;
   users[student2.email] = student2;
-  userById[student2.userId] = &users[student2.email];
+  userById.put(student2.userId, &users[student2.email]);
 
   // Student 3
   User student3;
@@ -234,7 +449,7 @@ void initSampleData() {
   student3.online = false;
   student3.clientSocket = -1;
   users[student3.email] = student3;
-  userById[student3.userId] = &users[student3.email];
+  userById.put(student3.userId, &users[student3.email]);
 
   // Admin user
   User admin;
@@ -248,7 +463,12 @@ void initSampleData() {
   admin.online = false;
   admin.clientSocket = -1;
   users[admin.email] = admin;
-  userById[admin.userId] = &users[admin.email];
+  userById.put(admin.userId, &users[admin.email]);
+
+  // Danh mục được dựng cục bộ rồi xuất bản một lần ở cuối hàm
+  Catalog<Lesson>::Map lessonItems;
+  Catalog<Test>::Map testItems;
+  Catalog<Game>::Map gameItems;
 
   // ========== TẠO BÀI HỌC - BEGINNER ==========
 
@@ -333,7 +553,7 @@ V She works in a bank.
 X Do she speak English?
 V Does she speak English?
 )";
-  lessons[lesson1.lessonId] = lesson1;
+  lessonItems[lesson1.lessonId] = lesson1;
 
   // Lesson 2: Common Daily Vocabulary
   Lesson lesson2;
@@ -428,7 +648,7 @@ V Does she speak English?
 - Uncle - Chú/Bác/Cậu
 - Aunt - Cô/Dì/Thím
 )";
-  lessons[lesson2.lessonId] = lesson2;
+  lessonItems[lesson2.lessonId] = lesson2;
 
   // Lesson 3: Basic Listening Skills
   Lesson lesson3;
@@ -505,7 +725,7 @@ B: Yes, I do. It's very nice!
 - Repeat what you hear
 - Don't translate word by word
 )";
-  lessons[lesson3.lessonId] = lesson3;
+  lessonItems[lesson3.lessonId] = lesson3;
 
   // ========== TẠO BÀI HỌC - INTERMEDIATE ==========
 
@@ -607,7 +827,7 @@ V She didn't go to the party.
 X When I was walking home, I was seeing a cat.
 V When I was walking home, I saw a cat.
 )";
-  lessons[lesson4.lessonId] = lesson4;
+  lessonItems[lesson4.lessonId] = lesson4;
 
   // Lesson 5: Business Vocabulary
   Lesson lesson5;
@@ -709,7 +929,7 @@ Leaving a message:
 - schedule - lên lịch
 - confirm - xác nhận
 )";
-  lessons[lesson5.lessonId] = lesson5;
+  lessonItems[lesson5.lessonId] = lesson5;
 
   // ========== TẠO BÀI HỌC - ADVANCED ==========
 
@@ -807,7 +1027,7 @@ V If I had money, I would buy it.
 X If I would have known, I would have helped.
 V If I had known, I would have helped.
 )";
-  lessons[lesson6.lessonId] = lesson6;
+  lessonItems[lesson6.lessonId] = lesson6;
 
   // Lesson 7: IELTS Speaking
   Lesson lesson7;
@@ -904,7 +1124,7 @@ Instead of "big" -> enormous, massive, substantial
 Instead of "small" -> tiny, minute, negligible
 Instead of "important" -> crucial, vital, significant
 )";
-  lessons[lesson7.lessonId] = lesson7;
+  lessonItems[lesson7.lessonId] = lesson7;
 
   // ========== TẠO BÀI TEST ==========
 
@@ -995,7 +1215,7 @@ Instead of "important" -> crucial, vital, significant
   q9.points = 15;
   test1.questions.push_back(q9);
 
-  tests[test1.testId] = test1;
+  testItems[test1.testId] = test1;
 
   // Test 2: Intermediate Grammar
   Test test2;
@@ -1046,6 +1266,7 @@ Instead of "important" -> crucial, vital, significant
   q2_5.question = "What ____ you ____ (do) at 8pm yesterday?";
   q2_5.correctAnswer = "were doing";
   q2_5.points = 10;
+  q2_5.maxTypos = 1; // Chấp nhận sai 1 ký tự
   test2.questions.push_back(q2_5);
 
   TestQuestion q2_6;
@@ -1055,9 +1276,10 @@ Instead of "important" -> crucial, vital, significant
   q2_6.words = {"was", "I", "when", "cooking", "rang", "the", "phone"};
   q2_6.correctAnswer = "I was cooking when the phone rang";
   q2_6.points = 15;
+  q2_6.partialCredit = true; // Có điểm cho các từ đúng thứ tự
   test2.questions.push_back(q2_6);
 
-  tests[test2.testId] = test2;
+  testItems[test2.testId] = test2;
 
   // Test 3: Advanced Grammar - Conditionals
   Test test3;
@@ -1091,6 +1313,7 @@ Instead of "important" -> crucial, vital, significant
   q3_3.question = "If I had studied harder, I ____ (pass) the exam.";
   q3_3.correctAnswer = "would have passed";
   q3_3.points = 15;
+  q3_3.maxTypos = 2;
   test3.questions.push_back(q3_3);
 
   TestQuestion q3_4;
@@ -1110,7 +1333,7 @@ Instead of "important" -> crucial, vital, significant
   q3_5.points = 15;
   test3.questions.push_back(q3_5);
 
-  tests[test3.testId] = test3;
+  testItems[test3.testId] = test3;
 
   // ========== TẠO BÀI TẬP ==========
 
@@ -1204,7 +1427,7 @@ Instead of "important" -> crucial, vital, significant
                  {"Water", "Nước"}};
   game1.timeLimit = 120;
   game1.maxScore = 100;
-  games[game1.gameId] = game1;
+  gameItems[game1.gameId] = game1;
 
   // Game 2: Word Matching - Intermediate
   Game game2;
@@ -1220,7 +1443,7 @@ Instead of "important" -> crucial, vital, significant
                  {"Contract", "Hợp đồng"},  {"Budget", "Ngân sách"}};
   game2.timeLimit = 150;
   game2.maxScore = 100;
-  games[game2.gameId] = game2;
+  gameItems[game2.gameId] = game2;
 
   // Game 3: Sentence Matching
   Game game3;
@@ -1238,7 +1461,7 @@ Instead of "important" -> crucial, vital, significant
                          {"Do you like coffee?", "Yes, I do."}};
   game3.timeLimit = 180;
   game3.maxScore = 100;
-  games[game3.gameId] = game3;
+  gameItems[game3.gameId] = game3;
 
   // Game 4: Picture Matching (Fruits - beginner level)
   // Image format: "placeholder:color:emoji" for GUI to render colored
@@ -1258,7 +1481,7 @@ Instead of "important" -> crucial, vital, significant
                         {"Strawberry", "placeholder:#E74C3C:🍓"}};
   game4.timeLimit = 120;
   game4.maxScore = 100;
-  games[game4.gameId] = game4;
+  gameItems[game4.gameId] = game4;
 
   // Game 5: Picture Matching (Animals - intermediate level)
   Game game5;
@@ -1276,7 +1499,11 @@ Instead of "important" -> crucial, vital, significant
                         {"Lion", "placeholder:#DAA520:🦁"}};
   game5.timeLimit = 100;
   game5.maxScore = 100;
-  games[game5.gameId] = game5;
+  gameItems[game5.gameId] = game5;
+
+  lessons.publish(std::move(lessonItems));
+  tests.publish(std::move(testItems));
+  games.publish(std::move(gameItems));
 
   std::cout << "[INFO] Sample data initialized: " << users.size() << " users, "
             << lessons.size() << " lessons, " << tests.size() << " tests, "
@@ -1289,13 +1516,13 @@ Instead of "important" -> crucial, vital, significant
 // ============================================================================
 
 // Xử lý REGISTER_REQUEST
-std::string handleRegister(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string fullname = getJsonValue(payload, "fullname");
-  std::string email = getJsonValue(payload, "email");
-  std::string password = getJsonValue(payload, "password");
-  std::string confirmPassword = getJsonValue(payload, "confirmPassword");
+std::string handleRegister(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string fullname = payload["fullname"].str();
+  std::string email = payload["email"].str();
+  std::string password = payload["password"].str();
+  std::string confirmPassword = payload["confirmPassword"].str();
 
   if (password != confirmPassword) {
     return R"({"messageType":"REGISTER_RESPONSE","messageId":")" + messageId +
@@ -1323,7 +1550,7 @@ std::string handleRegister(const std::string &json) {
     newUser.clientSocket = -1;
 
     users[email] = newUser;
-    userById[newUser.userId] = &users[email];
+    userById.put(newUser.userId, &users[email]);
 
     return R"({"messageType":"REGISTER_RESPONSE","messageId":")" + messageId +
            R"(","timestamp":)" + std::to_string(getCurrentTimestamp()) +
@@ -1337,17 +1564,8 @@ std::string handleRegister(const std::string &json) {
 // Gửi thông báo tin nhắn chưa đọc khi user login
 void sendUnreadMessagesNotification(int clientSocket,
                                     const std::string &userId) {
-  std::vector<ChatMessage> unreadMessages;
-
-  {
-    std::lock_guard<std::mutex> lock(chatMutex);
-    for (auto &msg : chatMessages) {
-      if (msg.recipientId == userId && !msg.read) {
-        unreadMessages.push_back(msg);
-      }
-    }
-  }
-
+  // Chỉ quét các hội thoại còn tin chưa đọc, từ tin chưa đọc đầu tiên
+  std::vector<ChatMessage> unreadMessages = chatStore.findUnreadFor(userId);
   if (unreadMessages.empty())
     return;
 
@@ -1356,23 +1574,24 @@ void sendUnreadMessagesNotification(int clientSocket,
   messagesJson << "[";
   bool first = true;
 
-  std::lock_guard<std::mutex> userLock(usersMutex);
-  for (const auto &msg : unreadMessages) {
-    std::string senderName = "Unknown";
-    auto senderIt = userById.find(msg.senderId);
-    if (senderIt != userById.end()) {
-      senderName = senderIt->second->fullname;
-    }
+  {
+    std::lock_guard<std::mutex> userLock(usersMutex);
+    for (const auto &msg : unreadMessages) {
+      std::string senderName = "Unknown";
+      if (User *sender = userById.find(msg.senderId)) {
+        senderName = sender->fullname;
+      }
 
-    if (!first)
-      messagesJson << ",";
-    first = false;
+      if (!first)
+        messagesJson << ",";
+      first = false;
 
-    messagesJson << R"({"messageId":")" << msg.messageId << R"(","senderId":")"
-                 << msg.senderId << R"(","senderName":")"
-                 << escapeJson(senderName) << R"(","content":")"
-                 << escapeJson(msg.content) << R"(","timestamp":)"
-                 << msg.timestamp << "}";
+      messagesJson << R"({"messageId":")" << msg.messageId
+                   << R"(","senderId":")" << msg.senderId
+                   << R"(","senderName":")" << escapeJson(senderName)
+                   << R"(","content":")" << escapeJson(msg.content)
+                   << R"(","timestamp":)" << msg.timestamp << "}";
+    }
   }
   messagesJson << "]";
 
@@ -1383,20 +1602,18 @@ void sendUnreadMessagesNotification(int clientSocket,
       std::to_string(unreadMessages.size()) + R"(,"messages":)" +
       messagesJson.str() + R"(}})";
 
-  uint32_t len = htonl(notification.length());
-  send(clientSocket, &len, sizeof(len), 0);
-  send(clientSocket, notification.c_str(), notification.length(), 0);
+  sendFrame(clientSocket, notification);
 
   logMessage("SEND", "Client:" + std::to_string(clientSocket),
              "UNREAD_MESSAGES_NOTIFICATION");
 }
 
 // Xử lý LOGIN_REQUEST
-std::string handleLogin(const std::string &json, int clientSocket) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string email = getJsonValue(payload, "email");
-  std::string password = getJsonValue(payload, "password");
+std::string handleLogin(const JsonDocument &request, int clientSocket) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string email = payload["email"].str();
+  std::string password = payload["password"].str();
 
   std::string userId;
   std::string response;
@@ -1420,6 +1637,7 @@ std::string handleLogin(const std::string &json, int clientSocket) {
     Session session;
     session.sessionToken = sessionToken;
     session.userId = user.userId;
+    session.userHandle = userById.handle(user.userId);
     session.expiresAt = getCurrentTimestamp() + 3600000;
 
     {
@@ -1439,14 +1657,16 @@ std::string handleLogin(const std::string &json, int clientSocket) {
   }
 
   // Gửi response trước
-  uint32_t respLen = htonl(response.length());
-  send(clientSocket, &respLen, sizeof(respLen), 0);
-  send(clientSocket, response.c_str(), response.length(), 0);
+  sendFrame(clientSocket, response);
   logMessage("SEND", "Client:" + std::to_string(clientSocket), response);
 
   // Sau đó gửi thông báo tin nhắn chưa đọc (nếu có)
   sendUnreadMessagesNotification(clientSocket, userId);
 
+  // Từ giờ nhận push trên connection này; push đã spool lúc offline được
+  // gửi ngay sau đó
+  notifications->attach(userId, clientSocket);
+
   // Trả về chuỗi rỗng để báo hiệu đã xử lý response
   return "";
 }
@@ -1463,11 +1683,11 @@ std::string handleLogin(const std::string &json, int clientSocket) {
 // - Easier to unit test (service can be mocked)
 // - Thread safety handled by bridge repositories
 // ============================================================================
-std::string handleLoginV2(const std::string &json, int clientSocket) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string email = getJsonValue(payload, "email");
-  std::string password = getJsonValue(payload, "password");
+std::string handleLoginV2(const JsonDocument &request, int clientSocket) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string email = payload["email"].str();
+  std::string password = payload["password"].str();
 
   // Use the service layer for authentication
   auto result = serviceContainer->auth().login(email, password, clientSocket);
@@ -1493,14 +1713,13 @@ std::string handleLoginV2(const std::string &json, int clientSocket) {
   }
 
   // Send response
-  uint32_t respLen = htonl(response.length());
-  send(clientSocket, &respLen, sizeof(respLen), 0);
-  send(clientSocket, response.c_str(), response.length(), 0);
+  sendFrame(clientSocket, response);
   logMessage("SEND", "Client:" + std::to_string(clientSocket), response);
 
   // Send unread messages notification if login successful
   if (result.isSuccess()) {
     sendUnreadMessagesNotification(clientSocket, result.getData().userId);
+    notifications->attach(result.getData().userId, clientSocket);
   }
 
   return ""; // Response already sent
@@ -1520,82 +1739,64 @@ std::string validateSession(const std::string &sessionToken) {
 }
 
 // Xử lý GET_LESSONS_REQUEST
-std::string handleGetLessons(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string level = getJsonValue(payload, "level");
-  std::string topic = getJsonValue(payload, "topic");
+std::string handleGetLessons(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string level = payload["level"].str();
+  std::string topic = payload["topic"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
-    return R"({"messageType":"GET_LESSONS_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
-  }
-
-  std::stringstream lessonsJson;
-  lessonsJson << "[";
-  bool first = true;
-  int count = 0;
-
-  for (const auto &pair : lessons) {
-    const Lesson &lesson = pair.second;
-
-    // Lọc theo topic nếu có
-    if (!topic.empty() && lesson.topic != topic)
-      continue;
-    // Lọc theo level nếu có
-    if (!level.empty() && lesson.level != level)
-      continue;
-
-    if (!first)
-      lessonsJson << ",";
-    first = false;
-
-    lessonsJson << R"({"lessonId":")" << lesson.lessonId << R"(","title":")"
-                << escapeJson(lesson.title) << R"(","description":")"
-                << escapeJson(lesson.description) << R"(","topic":")"
-                << lesson.topic << R"(","level":")" << lesson.level
-                << R"(","duration":)" << lesson.duration
-                << R"(,"completionStatus":false,"progress":0})";
-    count++;
-  }
-  lessonsJson << "]";
-
-  return R"({"messageType":"GET_LESSONS_RESPONSE","messageId":")" + messageId +
-         R"(","timestamp":)" + std::to_string(getCurrentTimestamp()) +
-         R"(,"payload":{"status":"success","message":"Retrieved lessons successfully","data":{"lessons":)" +
-         lessonsJson.str() +
-         R"(,"pagination":{"currentPage":1,"totalPages":1,"totalLessons":)" +
-         std::to_string(count) + R"(}}}})";
+    return errorResponse("GET_LESSONS_RESPONSE", messageId,
+                         "Invalid or expired session");
+  }
+
+  std::string out = JsonWriter::acquireBuffer();
+  JsonWriter writer(out);
+  beginResponse(writer, "GET_LESSONS_RESPONSE", messageId, "success");
+  writer.field("message", "Retrieved lessons successfully")
+      .key("data")
+      .beginObject()
+      .key("lessons")
+      .beginArray();
+
+  // Lọc theo level/topic qua index; mỗi bài học đã được serialize sẵn
+  size_t count = lessonIndex.current()->writeListing(writer, level, topic);
+
+  writer.endArray()
+      .key("pagination")
+      .beginObject()
+      .fieldInt("currentPage", 1)
+      .fieldInt("totalPages", 1)
+      .fieldInt("totalLessons", count)
+      .endObject()
+      .endObject();
+  endResponse(writer);
+  return out;
 }
 
 // Xử lý GET_LESSON_DETAIL_REQUEST
-std::string handleGetLessonDetail(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string lessonId = getJsonValue(payload, "lessonId");
+std::string handleGetLessonDetail(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string lessonId = payload["lessonId"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
-    return R"({"messageType":"GET_LESSON_DETAIL_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
+    return errorResponse("GET_LESSON_DETAIL_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
-  auto it = lessons.find(lessonId);
-  if (it == lessons.end()) {
-    return R"({"messageType":"GET_LESSON_DETAIL_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Lesson not found"}})";
+  auto catalog = lessons.snapshot();
+  const Lesson *found = catalog->find(lessonId);
+  if (!found) {
+    return errorResponse("GET_LESSON_DETAIL_RESPONSE", messageId,
+                         "Lesson not found");
   }
 
-  const Lesson &lesson = it->second;
+  const Lesson &lesson = *found;
 
   return R"({"messageType":"GET_LESSON_DETAIL_RESPONSE","messageId":")" +
          messageId + R"(","timestamp":)" +
@@ -1612,11 +1813,11 @@ std::string handleGetLessonDetail(const std::string &json) {
 }
 
 // Xử lý GET_TEST_REQUEST
-std::string handleGetTest(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string level = getJsonValue(payload, "level");
+std::string handleGetTest(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string level = payload["level"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
@@ -1625,18 +1826,11 @@ std::string handleGetTest(const std::string &json) {
            R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
   }
 
-  // Tìm test phù hợp với level
-  const Test *selectedTest = nullptr;
-  for (const auto &pair : tests) {
-    if (pair.second.level == level) {
-      selectedTest = &pair.second;
-      break;
-    }
-  }
-
-  // Nếu không tìm thấy, lấy test đầu tiên
-  if (!selectedTest && !tests.empty()) {
-    selectedTest = &tests.begin()->second;
+  // Test đầu tiên của level (tra sẵn trong index); không có thì test đầu tiên
+  auto index = testIndex.current();
+  const Test *selectedTest = index->firstOfLevel(level);
+  if (!selectedTest) {
+    selectedTest = index->first();
   }
 
   if (!selectedTest) {
@@ -1695,185 +1889,197 @@ std::string handleGetTest(const std::string &json) {
 }
 
 // Xử lý SUBMIT_TEST_REQUEST
-std::string handleSubmitTest(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string testId = getJsonValue(payload, "testId");
+std::string handleSubmitTest(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string testId = payload["testId"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
-    return R"({"messageType":"SUBMIT_TEST_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
+    return errorResponse("SUBMIT_TEST_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
-  auto it = tests.find(testId);
-  if (it == tests.end()) {
-    return R"({"messageType":"SUBMIT_TEST_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Test not found"}})";
-  }
-
-  const Test &test = it->second;
-  std::string answersArray = getJsonArray(json, "answers");
-
-  int totalPoints = 0;
-  int earnedPoints = 0;
-  int correctCount = 0;
-  int wrongCount = 0;
-
-  std::stringstream detailedResults;
-  detailedResults << "[";
-
-  for (size_t i = 0; i < test.questions.size(); i++) {
-    const TestQuestion &q = test.questions[i];
-    totalPoints += q.points;
-
-    // Tìm câu trả lời của user cho câu hỏi này
-    std::string userAnswer = "";
-    size_t qPos = answersArray.find(q.questionId);
-    if (qPos != std::string::npos) {
-      size_t answerPos = answersArray.find("\"answer\"", qPos);
-      if (answerPos != std::string::npos) {
-        size_t colonPos = answersArray.find(':', answerPos);
-        size_t valueStart = answersArray.find('"', colonPos);
-        size_t valueEnd = answersArray.find('"', valueStart + 1);
-        if (valueStart != std::string::npos && valueEnd != std::string::npos) {
-          userAnswer =
-              answersArray.substr(valueStart + 1, valueEnd - valueStart - 1);
-        }
-      }
-    }
-
-    bool isCorrect = false;
-    if (q.type == "multiple_choice") {
-      isCorrect = (userAnswer == q.correctAnswer);
-    } else if (q.type == "sentence_order") {
-      // sentence_order: userAnswer is comma-separated word indices or sentence
-      // For simplicity, compare the sentence directly (normalized)
-      std::string lowerUser = userAnswer;
-      std::string lowerCorrect = q.correctAnswer;
-      std::transform(lowerUser.begin(), lowerUser.end(), lowerUser.begin(),
-                     ::tolower);
-      std::transform(lowerCorrect.begin(), lowerCorrect.end(),
-                     lowerCorrect.begin(), ::tolower);
-      // Remove extra spaces and punctuation for comparison
-      lowerUser.erase(
-          std::remove_if(lowerUser.begin(), lowerUser.end(),
-                         [](char c) { return !std::isalnum(c) && c != ' '; }),
-          lowerUser.end());
-      lowerCorrect.erase(
-          std::remove_if(lowerCorrect.begin(), lowerCorrect.end(),
-                         [](char c) { return !std::isalnum(c) && c != ' '; }),
-          lowerCorrect.end());
-      // Trim
-      lowerUser.erase(0, lowerUser.find_first_not_of(" \t"));
-      lowerUser.erase(lowerUser.find_last_not_of(" \t") + 1);
-      lowerCorrect.erase(0, lowerCorrect.find_first_not_of(" \t"));
-      lowerCorrect.erase(lowerCorrect.find_last_not_of(" \t") + 1);
-      // Normalize multiple spaces
-      std::string normalizedUser, normalizedCorrect;
-      for (size_t i = 0; i < lowerUser.length(); i++) {
-        if (lowerUser[i] == ' ' &&
-            (normalizedUser.empty() || normalizedUser.back() != ' ')) {
-          normalizedUser += ' ';
-        } else if (lowerUser[i] != ' ') {
-          normalizedUser += lowerUser[i];
-        }
-      }
-      for (size_t i = 0; i < lowerCorrect.length(); i++) {
-        if (lowerCorrect[i] == ' ' &&
-            (normalizedCorrect.empty() || normalizedCorrect.back() != ' ')) {
-          normalizedCorrect += ' ';
-        } else if (lowerCorrect[i] != ' ') {
-          normalizedCorrect += lowerCorrect[i];
-        }
-      }
-      isCorrect = (normalizedUser == normalizedCorrect);
-    } else {
-      // fill_blank: so sánh không phân biệt hoa thường và khoảng trắng thừa
-      std::string lowerUser = userAnswer;
-      std::string lowerCorrect = q.correctAnswer;
-      std::transform(lowerUser.begin(), lowerUser.end(), lowerUser.begin(),
-                     ::tolower);
-      std::transform(lowerCorrect.begin(), lowerCorrect.end(),
-                     lowerCorrect.begin(), ::tolower);
-      // Trim
-      lowerUser.erase(0, lowerUser.find_first_not_of(" \t"));
-      lowerUser.erase(lowerUser.find_last_not_of(" \t") + 1);
-      lowerCorrect.erase(0, lowerCorrect.find_first_not_of(" \t"));
-      lowerCorrect.erase(lowerCorrect.find_last_not_of(" \t") + 1);
-      isCorrect = (lowerUser == lowerCorrect);
-    }
-
-    if (isCorrect) {
-      earnedPoints += q.points;
-      correctCount++;
-    } else {
-      wrongCount++;
-    }
-
-    if (i > 0)
-      detailedResults << ",";
-    detailedResults << R"({"questionId":")" << q.questionId << R"(","correct":)"
-                    << (isCorrect ? "true" : "false") << R"(,"userAnswer":")"
-                    << escapeJson(userAnswer) << R"(","correctAnswer":")"
-                    << escapeJson(q.correctAnswer) << R"(","points":)"
-                    << q.points << R"(,"earnedPoints":)"
-                    << (isCorrect ? q.points : 0) << "}";
+  auto keys = answerKeys.current();
+  const english_learning::service::AnswerKey *key = keys->find(testId);
+  if (!key) {
+    return errorResponse("SUBMIT_TEST_RESPONSE", messageId, "Test not found");
   }
-  detailedResults << "]";
+
+  // Đọc payload.answers một lần, xếp theo vị trí câu hỏi trong đề
+  std::vector<std::string> answers(key->size());
+  std::vector<bool> answered(key->size(), false);
+  for (JsonValue entry : payload["answers"]) {
+    size_t position = key->position(entry["questionId"].raw());
+    if (position == english_learning::service::AnswerKey::npos ||
+        answered[position])
+      continue;
+    answered[position] = true;
+    answers[position] = entry["answer"].unescaped();
+  }
+
+  english_learning::service::AnswerKey::Result graded = key->grade(answers);
+  int totalPoints = graded.totalPoints;
+  int earnedPoints = graded.earnedPoints;
+
+  std::string detailedResults;
+  JsonWriter details(detailedResults);
+  details.beginArray();
+  for (size_t i = 0; i < key->size(); i++) {
+    bool isCorrect = graded.correct[i] != 0;
+    details.beginObject()
+        .field("questionId", key->questionId(i))
+        .fieldBool("correct", isCorrect)
+        .field("userAnswer", answers[i])
+        .field("correctAnswer", key->correctAnswer(i))
+        .fieldInt("points", key->points(i))
+        .fieldInt("earnedPoints", graded.earned[i])
+        .endObject();
+  }
+  details.endArray();
 
   int percentage = (totalPoints > 0) ? (earnedPoints * 100 / totalPoints) : 0;
   bool passed = (percentage >= 60);
-  std::string grade;
-  if (percentage >= 90)
-    grade = "A";
-  else if (percentage >= 80)
-    grade = "B";
-  else if (percentage >= 70)
-    grade = "C";
-  else if (percentage >= 60)
-    grade = "D";
-  else
-    grade = "F";
+  std::string grade = english_learning::service::letterGrade(percentage);
+  std::string submissionId = generateId("sub");
+
+  // Lưu lại để BULK_GRADE chấm lại cả lớp (giới hạn mỗi đề)
+  english_learning::service::SubmissionAnswers logged;
+  logged.submissionId = submissionId;
+  for (size_t i = 0; i < key->size(); i++) {
+    if (answered[i])
+      logged.answers.emplace_back(key->questionId(i), answers[i]);
+  }
+  {
+    std::lock_guard<std::mutex> lock(testSubmissionsMutex);
+    auto &history = testSubmissions[testId];
+    if (history.size() >= MAX_LOGGED_TEST_SUBMISSIONS)
+      history.pop_front();
+    history.push_back(std::move(logged));
+  }
 
   return R"({"messageType":"SUBMIT_TEST_RESPONSE","messageId":")" + messageId +
          R"(","timestamp":)" + std::to_string(getCurrentTimestamp()) +
          R"(,"payload":{"status":"success","data":{"testId":")" + testId +
-         R"(","submissionId":")" + generateId("sub") + R"(","score":)" +
+         R"(","submissionId":")" + submissionId + R"(","score":)" +
          std::to_string(earnedPoints) + R"(,"percentage":)" +
          std::to_string(percentage) + R"(,"totalPoints":)" +
          std::to_string(totalPoints) + R"(,"earnedPoints":)" +
          std::to_string(earnedPoints) + R"(,"totalQuestions":)" +
-         std::to_string(test.questions.size()) + R"(,"correctAnswers":)" +
-         std::to_string(correctCount) + R"(,"wrongAnswers":)" +
-         std::to_string(wrongCount) + R"(,"passed":)" +
+         std::to_string(key->size()) + R"(,"correctAnswers":)" +
+         std::to_string(graded.correctCount) + R"(,"wrongAnswers":)" +
+         std::to_string(graded.wrongCount) + R"(,"passed":)" +
          (passed ? "true" : "false") + R"(,"grade":")" + grade +
-         R"(","detailedResults":)" + detailedResults.str() + R"(}}})";
+         R"(","detailedResults":)" + detailedResults + R"(}}})";
+}
+
+// Xử lý BULK_GRADE_REQUEST (teacher/admin): chấm nhiều bài của một đề song
+// song. payload.submissions gửi kèm bài cần chấm; nếu không có thì chấm lại
+// các bài SUBMIT_TEST đã lưu của đề đó.
+std::string handleBulkGrade(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string testId = payload["testId"].str();
+
+  std::string userId = validateSession(sessionToken);
+  if (userId.empty()) {
+    return errorResponse("BULK_GRADE_RESPONSE", messageId,
+                         "Invalid or expired session");
+  }
+
+  std::vector<english_learning::service::SubmissionAnswers> submissions;
+  JsonValue inlineSubmissions = payload["submissions"];
+  if (inlineSubmissions.isArray()) {
+    submissions.reserve(inlineSubmissions.size());
+    for (JsonValue entry : inlineSubmissions) {
+      english_learning::service::SubmissionAnswers submission;
+      submission.submissionId = entry["submissionId"].unescaped();
+      for (JsonValue answer : entry["answers"]) {
+        submission.answers.emplace_back(answer["questionId"].unescaped(),
+                                        answer["answer"].unescaped());
+      }
+      submissions.push_back(std::move(submission));
+    }
+  } else {
+    std::lock_guard<std::mutex> lock(testSubmissionsMutex);
+    auto it = testSubmissions.find(testId);
+    if (it != testSubmissions.end())
+      submissions.assign(it->second.begin(), it->second.end());
+  }
+
+  auto result =
+      serviceContainer->tests().gradeSubmissions(userId, testId, submissions);
+  if (!result.isSuccess()) {
+    return errorResponse("BULK_GRADE_RESPONSE", messageId,
+                         result.getMessage());
+  }
+  const english_learning::service::BulkGradeResult &graded = result.getData();
+
+  // Một frame tối đa BUFFER_SIZE byte: chỉ trả điểm từng bài cho
+  // MAX_BULK_GRADE_RESULTS bài đầu, thống kê thì tính trên tất cả
+  size_t listed = std::min(graded.scores.size(),
+                           static_cast<size_t>(MAX_BULK_GRADE_RESULTS));
+
+  std::string out = JsonWriter::acquireBuffer();
+  JsonWriter writer(out);
+  beginResponse(writer, "BULK_GRADE_RESPONSE", messageId, "success");
+  writer.key("data")
+      .beginObject()
+      .field("testId", graded.testId)
+      .fieldInt("totalSubmissions",
+                static_cast<long long>(graded.scores.size()))
+      .fieldInt("totalPoints", graded.totalPoints)
+      .fieldInt("averagePercentage",
+                static_cast<long long>(graded.averagePercentage + 0.5))
+      .fieldInt("shards", graded.shards)
+      .key("results")
+      .beginArray();
+  for (size_t i = 0; i < listed; i++) {
+    const auto &score = graded.scores[i];
+    writer.beginObject()
+        .field("submissionId", score.submissionId)
+        .fieldInt("score", score.score)
+        .fieldInt("percentage", score.percentage)
+        .fieldInt("correctAnswers", score.correctCount)
+        .field("grade", english_learning::service::letterGrade(score.percentage))
+        .endObject();
+  }
+  writer.endArray()
+      .fieldBool("resultsTruncated", listed < graded.scores.size())
+      .key("questions")
+      .beginArray();
+  for (const auto &stats : graded.questions) {
+    writer.beginObject()
+        .field("questionId", stats.questionId)
+        .fieldInt("correct", stats.correct)
+        .fieldInt("wrong", stats.wrong)
+        .fieldInt("unanswered", stats.unanswered)
+        .endObject();
+  }
+  writer.endArray().endObject();
+  endResponse(writer);
+  return out;
 }
 
 // Xử lý GET_CONTACT_LIST_REQUEST
-std::string handleGetContactList(const std::string &json) {
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
+std::string handleGetContactList(const JsonDocument &request) {
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
 
   std::string currentUserId = validateSession(sessionToken);
   if (currentUserId.empty()) {
-    return R"({"messageType":"GET_CONTACT_LIST_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
+    return errorResponse("GET_CONTACT_LIST_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
-  std::stringstream contactsJson;
-  contactsJson << "[";
-  bool first = true;
-  int onlineCount = 0;
+  std::string out = JsonWriter::acquireBuffer();
+  JsonWriter writer(out);
+  beginResponse(writer, "GET_CONTACT_LIST_RESPONSE", messageId, "success");
+  writer.key("data").beginObject().key("contacts").beginArray();
 
+  int onlineCount = 0;
   {
     std::lock_guard<std::mutex> lock(usersMutex);
     for (const auto &pair : users) {
@@ -1881,65 +2087,54 @@ std::string handleGetContactList(const std::string &json) {
       if (user.userId == currentUserId)
         continue;
 
-      if (!first)
-        contactsJson << ",";
-      first = false;
-
-      contactsJson << R"({"userId":")" << user.userId << R"(","fullName":")"
-                   << escapeJson(user.fullname) << R"(","role":")" << user.role
-                   << R"(","status":")" << (user.online ? "online" : "offline")
-                   << R"(","level":")" << user.level << R"("})";
+      writer.beginObject()
+          .field("userId", user.userId)
+          .field("fullName", user.fullname)
+          .field("role", user.role)
+          .field("status", user.online ? "online" : "offline")
+          .field("level", user.level)
+          .endObject();
 
       if (user.online)
         onlineCount++;
     }
   }
-  contactsJson << "]";
 
-  return R"({"messageType":"GET_CONTACT_LIST_RESPONSE","messageId":")" +
-         messageId + R"(","timestamp":)" +
-         std::to_string(getCurrentTimestamp()) +
-         R"(,"payload":{"status":"success","data":{"contacts":)" +
-         contactsJson.str() + R"(,"onlineCount":)" +
-         std::to_string(onlineCount) + R"(,"totalContacts":)" +
-         std::to_string(users.size() - 1) + R"(}}})";
+  writer.endArray()
+      .fieldInt("onlineCount", onlineCount)
+      .fieldInt("totalContacts", static_cast<long long>(users.size()) - 1)
+      .endObject();
+  endResponse(writer);
+  return out;
 }
 
 // Xử lý SEND_MESSAGE_REQUEST
-std::string handleSendMessage(const std::string &json, int senderSocket) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string recipientId = getJsonValue(payload, "recipientId");
-  std::string messageContent = getJsonValue(payload, "messageContent");
+std::string handleSendMessage(const JsonDocument &request, int senderSocket) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string recipientId = payload["recipientId"].str();
+  std::string messageContent = payload["messageContent"].str();
 
   std::string senderId = validateSession(sessionToken);
   if (senderId.empty()) {
-    return R"({"messageType":"SEND_MESSAGE_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
+    return errorResponse("SEND_MESSAGE_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
   User *recipient = nullptr;
   std::string senderName;
   {
     std::lock_guard<std::mutex> lock(usersMutex);
-    auto it = userById.find(recipientId);
-    if (it != userById.end()) {
-      recipient = it->second;
-    }
-    auto senderIt = userById.find(senderId);
-    if (senderIt != userById.end()) {
-      senderName = senderIt->second->fullname;
+    recipient = userById.find(recipientId);
+    if (User *sender = userById.find(senderId)) {
+      senderName = sender->fullname;
     }
   }
 
   if (!recipient) {
-    return R"({"messageType":"SEND_MESSAGE_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Recipient not found"}})";
+    return errorResponse("SEND_MESSAGE_RESPONSE", messageId,
+                         "Recipient not found");
   }
 
   ChatMessage msg;
@@ -1950,133 +2145,154 @@ std::string handleSendMessage(const std::string &json, int senderSocket) {
   msg.timestamp = getCurrentTimestamp();
   msg.read = false;
 
-  {
-    std::lock_guard<std::mutex> lock(chatMutex);
-    chatMessages.push_back(msg);
-  }
-
-  bool delivered = false;
-  if (recipient->online && recipient->clientSocket > 0) {
-    std::string notification =
-        R"({"messageType":"RECEIVE_MESSAGE","messageId":")" + msg.messageId +
-        R"(","timestamp":)" + std::to_string(msg.timestamp) +
-        R"(,"payload":{"messageId":")" + msg.messageId + R"(","senderId":")" +
-        senderId + R"(","senderName":")" + escapeJson(senderName) +
-        R"(","messageContent":")" + escapeJson(messageContent) +
-        R"(","sentAt":)" + std::to_string(msg.timestamp) + R"(}})";
-
-    uint32_t len = htonl(notification.length());
-    if (send(recipient->clientSocket, &len, sizeof(len), 0) > 0) {
-      if (send(recipient->clientSocket, notification.c_str(),
-               notification.length(), 0) > 0) {
-        delivered = true;
-        logMessage("SEND", "Client:" + std::to_string(recipient->clientSocket),
-                   notification);
-      }
-    }
-  }
-
-  return R"({"messageType":"SEND_MESSAGE_RESPONSE","messageId":")" + messageId +
-         R"(","timestamp":)" + std::to_string(getCurrentTimestamp()) +
-         R"(,"payload":{"status":"success","data":{"messageId":")" +
-         msg.messageId + R"(","recipientId":")" + recipientId +
-         R"(","messageContent":")" + escapeJson(messageContent) +
-         R"(","sentAt":)" + std::to_string(msg.timestamp) + R"(,"delivered":)" +
-         (delivered ? "true" : "false") + R"(}}})";
+  chatStore.add(msg);
+
+  // Push và response dùng chung một buffer của thread. Push không cần
+  // spool: tin đã nằm trong chatStore và được báo qua
+  // UNREAD_MESSAGES_NOTIFICATION ở lần login sau.
+  std::string out = JsonWriter::acquireBuffer();
+  JsonWriter notification(out);
+  notification.beginObject()
+      .field("messageType", "RECEIVE_MESSAGE")
+      .field("messageId", msg.messageId)
+      .fieldInt("timestamp", msg.timestamp)
+      .key("payload")
+      .beginObject()
+      .field("messageId", msg.messageId)
+      .field("senderId", senderId)
+      .field("senderName", senderName)
+      .field("messageContent", messageContent)
+      .fieldInt("sentAt", msg.timestamp)
+      .endObject()
+      .endObject();
+  bool delivered =
+      notifications->notify(recipientId, out) ==
+      english_learning::network::NotificationDispatcher::Result::Queued;
+  out.clear();
+
+  JsonWriter writer(out);
+  beginResponse(writer, "SEND_MESSAGE_RESPONSE", messageId, "success");
+  writer.key("data")
+      .beginObject()
+      .field("messageId", msg.messageId)
+      .fieldEscaped("recipientId", recipientId)
+      .field("messageContent", messageContent)
+      .fieldInt("sentAt", msg.timestamp)
+      .fieldBool("delivered", delivered)
+      .endObject();
+  endResponse(writer);
+  return out;
 }
 
 // Xử lý MARK_MESSAGES_READ_REQUEST - đánh dấu tin nhắn đã đọc
-std::string handleMarkMessagesRead(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string senderId = getJsonValue(payload, "senderId");
+std::string handleMarkMessagesRead(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string senderId = payload["senderId"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
-    return R"({"messageType":"MARK_MESSAGES_READ_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
+    return errorResponse("MARK_MESSAGES_READ_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
-  int markedCount = 0;
-  {
-    std::lock_guard<std::mutex> lock(chatMutex);
-    for (auto &msg : chatMessages) {
-      if (msg.recipientId == userId && msg.senderId == senderId && !msg.read) {
-        msg.read = true;
-        markedCount++;
-      }
-    }
-  }
+  size_t markedCount = chatStore.markConversationAsRead(userId, senderId);
 
-  return R"({"messageType":"MARK_MESSAGES_READ_RESPONSE","messageId":")" +
-         messageId + R"(","timestamp":)" +
-         std::to_string(getCurrentTimestamp()) +
-         R"(,"payload":{"status":"success","data":{"markedCount":)" +
-         std::to_string(markedCount) + R"(}}})";
+  std::string out = JsonWriter::acquireBuffer();
+  JsonWriter writer(out);
+  beginResponse(writer, "MARK_MESSAGES_READ_RESPONSE", messageId, "success");
+  writer.key("data").beginObject().fieldInt("markedCount", markedCount).endObject();
+  endResponse(writer);
+  return out;
+}
+
+// Đọc cursor phân trang: chuỗi là messageId, số là timestamp (ms)
+bool readChatCursor(const JsonValue &value, std::string &messageId,
+                    english_learning::core::Timestamp &time) {
+  if (!value.exists() || value.type() == JsonType::Null) {
+    return true;
+  }
+  if (value.isString()) {
+    messageId = value.str();
+    return true;
+  }
+  // Cả chuỗi phải là số nguyên không âm: "1.5", "-3", "12abc" bị từ chối
+  std::string_view text = value.raw();
+  auto result = std::from_chars(text.data(), text.data() + text.size(), time);
+  return result.ec == std::errc() && result.ptr == text.data() + text.size() &&
+         time >= 0;
 }
 
 // Xử lý GET_CHAT_HISTORY_REQUEST
-std::string handleGetChatHistory(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string recipientId = getJsonValue(payload, "recipientId");
+// Payload tùy chọn: "limit" (số tin mỗi trang), "before"/"after" (messageId
+// hoặc timestamp). Không có limit và cursor thì trả cả hội thoại như cũ.
+// Không có "after": trang gồm các tin mới nhất trước "before". Có "after":
+// các tin cũ nhất sau cursor (đồng bộ delta). "hasMore" cho biết còn tin
+// ngoài trang theo hướng đó.
+std::string handleGetChatHistory(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string recipientId = payload["recipientId"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
-    return R"({"messageType":"GET_CHAT_HISTORY_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
-  }
-
-  std::stringstream messagesJson;
-  messagesJson << "[";
-  bool first = true;
-
-  {
-    std::lock_guard<std::mutex> lock(chatMutex);
-    for (const auto &msg : chatMessages) {
-      if ((msg.senderId == userId && msg.recipientId == recipientId) ||
-          (msg.senderId == recipientId && msg.recipientId == userId)) {
-        if (!first)
-          messagesJson << ",";
-        first = false;
-
-        messagesJson << R"({"messageId":")" << msg.messageId
-                     << R"(","senderId":")" << msg.senderId
-                     << R"(","content":")" << escapeJson(msg.content)
-                     << R"(","timestamp":)" << msg.timestamp << "}";
-      }
-    }
-  }
-  messagesJson << "]";
-
-  return R"({"messageType":"GET_CHAT_HISTORY_RESPONSE","messageId":")" +
-         messageId + R"(","timestamp":)" +
-         std::to_string(getCurrentTimestamp()) +
-         R"(,"payload":{"status":"success","data":{"messages":)" +
-         messagesJson.str() + R"(}}})";
+    return errorResponse("GET_CHAT_HISTORY_RESPONSE", messageId,
+                         "Invalid or expired session");
+  }
+
+  english_learning::repository::memory::ChatHistoryQuery query;
+  if (!readChatCursor(payload["before"], query.beforeId, query.beforeTime) ||
+      !readChatCursor(payload["after"], query.afterId, query.afterTime)) {
+    return errorResponse("GET_CHAT_HISTORY_RESPONSE", messageId,
+                         "Invalid cursor");
+  }
+  int limit = payload["limit"].asInt(0);
+  query.limit = static_cast<size_t>(std::clamp(limit, 0, MAX_CHAT_PAGE));
+
+  std::string out = JsonWriter::acquireBuffer();
+  JsonWriter writer(out);
+  beginResponse(writer, "GET_CHAT_HISTORY_RESPONSE", messageId, "success");
+  writer.key("data").beginObject().key("messages").beginArray();
+
+  // Chỉ duyệt phần trang được chọn của hội thoại, ghi thẳng ra JSON
+  auto page = chatStore.forEachInConversationPage(
+      userId, recipientId, query, [&writer](const ChatMessage &msg) {
+        writer.beginObject()
+            .field("messageId", msg.messageId)
+            .field("senderId", msg.senderId)
+            .field("content", msg.content)
+            .fieldInt("timestamp", msg.timestamp)
+            .endObject();
+      });
+
+  if (!page.valid) {
+    // Cursor trỏ tới tin không thuộc hội thoại: client nên tải lại trang mới
+    // nhất
+    JsonWriter::releaseBuffer(std::move(out));
+    return errorResponse("GET_CHAT_HISTORY_RESPONSE", messageId,
+                         "Invalid cursor");
+  }
+
+  writer.endArray().fieldBool("hasMore", page.hasMore).endObject();
+  endResponse(writer);
+  return out;
 }
 
 // Xử lý GET_EXERCISE_REQUEST
-std::string handleGetExercise(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string exerciseType = getJsonValue(payload, "exerciseType");
-  std::string level = getJsonValue(payload, "level");
-  std::string topic = getJsonValue(payload, "topic");
+std::string handleGetExercise(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string exerciseType = payload["exerciseType"].str();
+  std::string level = payload["level"].str();
+  std::string topic = payload["topic"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
-    return R"({"messageType":"GET_EXERCISE_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
+    return errorResponse("GET_EXERCISE_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
   // Tìm exercise phù hợp
@@ -2098,10 +2314,8 @@ std::string handleGetExercise(const std::string &json) {
   }
 
   if (!selectedExercise) {
-    return R"({"messageType":"GET_EXERCISE_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"No exercises available"}})";
+    return errorResponse("GET_EXERCISE_RESPONSE", messageId,
+                         "No exercises available");
   }
 
   const Exercise &ex = *selectedExercise;
@@ -2145,29 +2359,53 @@ std::string handleGetExercise(const std::string &json) {
   return responseJson.str();
 }
 
+// Họ tên của từng userId trong danh sách, chỉ khóa usersMutex một lần; id
+// rỗng hoặc không tồn tại cho ra fallback
+std::vector<std::string> fullNamesOf(const std::vector<std::string> &userIds,
+                                     const std::string &fallback) {
+  std::vector<std::string> names;
+  names.reserve(userIds.size());
+  std::lock_guard<std::mutex> lock(usersMutex);
+  for (const auto &id : userIds) {
+    User *user = userById.find(id);
+    names.push_back(user ? user->fullname : fallback);
+  }
+  return names;
+}
+
+// Tên bài tập của từng exerciseId, khóa exercisesMutex một lần
+std::vector<std::string> exerciseTitlesOf(
+    const std::vector<ExerciseSubmission> &submissions) {
+  std::vector<std::string> titles;
+  titles.reserve(submissions.size());
+  std::lock_guard<std::mutex> lock(exercisesMutex);
+  for (const auto &submission : submissions) {
+    auto it = exercises.find(submission.exerciseId);
+    titles.push_back(it != exercises.end() ? it->second.title
+                                           : "Unknown Exercise");
+  }
+  return titles;
+}
+
 // Xử lý SUBMIT_EXERCISE_REQUEST
-std::string handleSubmitExercise(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string exerciseId = getJsonValue(payload, "exerciseId");
-  std::string exerciseType = getJsonValue(payload, "exerciseType");
-  std::string content = getJsonValue(payload, "content");
+std::string handleSubmitExercise(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string exerciseId = payload["exerciseId"].str();
+  std::string exerciseType = payload["exerciseType"].str();
+  std::string content = payload["content"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
-    return R"({"messageType":"SUBMIT_EXERCISE_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
+    return errorResponse("SUBMIT_EXERCISE_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
   auto it = exercises.find(exerciseId);
   if (it == exercises.end()) {
-    return R"({"messageType":"SUBMIT_EXERCISE_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Exercise not found"}})";
+    return errorResponse("SUBMIT_EXERCISE_RESPONSE", messageId,
+                         "Exercise not found");
   }
 
   ExerciseSubmission submission;
@@ -2183,10 +2421,7 @@ std::string handleSubmitExercise(const std::string &json) {
   submission.teacherScore = 0;
   submission.reviewedAt = 0;
 
-  {
-    std::lock_guard<std::mutex> lock(exercisesMutex);
-    exerciseSubmissions.push_back(submission);
-  }
+  exerciseSubmissions.add(submission);
 
   return R"({"messageType":"SUBMIT_EXERCISE_RESPONSE","messageId":")" +
          messageId + R"(","timestamp":)" +
@@ -2197,51 +2432,39 @@ std::string handleSubmitExercise(const std::string &json) {
 }
 
 // Xử lý GET_PENDING_SUBMISSIONS_REQUEST (Teacher only)
-std::string handleGetPendingSubmissions(const std::string &json) {
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
+std::string handleGetPendingSubmissions(const JsonDocument &request) {
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty() || !isTeacher(userId)) {
-    return R"({"messageType":"GET_PENDING_SUBMISSIONS_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Unauthorized: Teacher access required"}})";
+    return errorResponse("GET_PENDING_SUBMISSIONS_RESPONSE", messageId,
+                         "Unauthorized: Teacher access required");
   }
 
+  // Hàng chờ chấm, cũ nhất trước
+  std::vector<ExerciseSubmission> pending = exerciseSubmissions.findPending();
+  std::vector<std::string> studentIds;
+  studentIds.reserve(pending.size());
+  for (const auto &submission : pending)
+    studentIds.push_back(submission.userId);
+  std::vector<std::string> studentNames = fullNamesOf(studentIds, "Unknown");
+
   std::stringstream submissionsJson;
   submissionsJson << "[";
-  bool first = true;
   int count = 0;
-
-  {
-    std::lock_guard<std::mutex> lock(exercisesMutex);
-    for (const auto &submission : exerciseSubmissions) {
-      if (submission.status == "pending") {
-        if (!first)
-          submissionsJson << ",";
-        first = false;
-
-        std::string studentName = "Unknown";
-        {
-          std::lock_guard<std::mutex> userLock(usersMutex);
-          auto it = userById.find(submission.userId);
-          if (it != userById.end()) {
-            studentName = it->second->fullname;
-          }
-        }
-
-        submissionsJson << R"({"submissionId":")" << submission.submissionId
-                        << R"(","exerciseId":")" << submission.exerciseId
-                        << R"(","userId":")" << submission.userId
-                        << R"(","studentName":")" << escapeJson(studentName)
-                        << R"(","exerciseType":")" << submission.exerciseType
-                        << R"(","content":")" << escapeJson(submission.content)
-                        << R"(","submittedAt":)" << submission.submittedAt
-                        << "}";
-        count++;
-      }
-    }
+  for (size_t i = 0; i < pending.size(); i++) {
+    const ExerciseSubmission &submission = pending[i];
+    if (i > 0)
+      submissionsJson << ",";
+    submissionsJson << R"({"submissionId":")" << submission.submissionId
+                    << R"(","exerciseId":")" << submission.exerciseId
+                    << R"(","userId":")" << submission.userId
+                    << R"(","studentName":")" << escapeJson(studentNames[i])
+                    << R"(","exerciseType":")" << submission.exerciseType
+                    << R"(","content":")" << escapeJson(submission.content)
+                    << R"(","submittedAt":)" << submission.submittedAt << "}";
+    count++;
   }
   submissionsJson << "]";
 
@@ -2290,8 +2513,8 @@ std::string handleReviewExercise(const std::string& json) {
                 // Send notification to student if online
                 {
                     std::lock_guard<std::mutex> userLock(usersMutex);
-                    auto it = userById.find(submission.userId);
-                    if (it != userById.end() && it->second->online && it->second->clientSocket > 0) {
+                    User *student = userById.find(submission.userId);
+                    if (student && student->online && student->clientSocket > 0) {
                         std::string notification = R"({"messageType":"EXERCISE_FEEDBACK_NOTIFICATION","messageId":")" +
                                                    generateId("notif") +
                                                    R"(","timestamp":)" + std::to_string(getCurrentTimestamp()) +
@@ -2301,8 +2524,8 @@ std::string handleReviewExercise(const std::string& json) {
                                                    R"(","score":)" + std::to_string(score) + R"(}})";
 
                         uint32_t len = htonl(notification.length());
-                        send(it->second->clientSocket, &len, sizeof(len), 0);
-                        send(it->second->clientSocket, notification.c_str(), notification.length(), 0);
+                        send(student->clientSocket, &len, sizeof(len), 0);
+                        send(student->clientSocket, notification.c_str(), notification.length(), 0);
                         logMessage("SEND", "Client:" + std::to_string(it->second->clientSocket), "EXERCISE_FEEDBACK_NOTIFICATION");
                     }
                 }
@@ -2348,9 +2571,8 @@ std::string handleGetFeedback(const std::string& json) {
                 std::string teacherName = "Unknown";
                 {
                     std::lock_guard<std::mutex> userLock(usersMutex);
-                    auto it = userById.find(submission.teacherId);
-                    if (it != userById.end()) {
-                        teacherName = it->second->fullname;
+                    if (User *teacher = userById.find(submission.teacherId)) {
+                        teacherName = teacher->fullname;
                     }
                 }
 
@@ -2373,62 +2595,41 @@ std::string handleGetFeedback(const std::string& json) {
 #endif
 
 // Xử lý GET_GAME_LIST_REQUEST
-std::string handleGetGameList(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string gameType = getJsonValue(payload, "gameType");
-  std::string level = getJsonValue(payload, "level");
+std::string handleGetGameList(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string gameType = payload["gameType"].str();
+  std::string level = payload["level"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
-    return R"({"messageType":"GET_GAME_LIST_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
+    return errorResponse("GET_GAME_LIST_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
-  std::stringstream gamesJson;
-  gamesJson << "[";
-  bool first = true;
-  int count = 0;
-
-  for (const auto &pair : games) {
-    const Game &game = pair.second;
-    bool typeMatch =
-        gameType.empty() || gameType == "all" || game.gameType == gameType;
-    bool levelMatch = level.empty() || game.level == level;
+  if (gameType == "all")
+    gameType.clear();
 
-    if (typeMatch && levelMatch) {
-      if (!first)
-        gamesJson << ",";
-      first = false;
+  std::string out = JsonWriter::acquireBuffer();
+  JsonWriter writer(out);
+  beginResponse(writer, "GET_GAME_LIST_RESPONSE", messageId, "success");
+  writer.key("data").beginObject().key("games").beginArray();
 
-      gamesJson << R"({"gameId":")" << game.gameId << R"(","gameType":")"
-                << game.gameType << R"(","title":")" << escapeJson(game.title)
-                << R"(","description":")" << escapeJson(game.description)
-                << R"(","level":")" << game.level << R"(","topic":")"
-                << game.topic << R"(","timeLimit":)" << game.timeLimit
-                << R"(,"maxScore":)" << game.maxScore << "}";
-      count++;
-    }
-  }
-  gamesJson << "]";
+  // Lọc trên mã enum của index; mỗi game đã được serialize sẵn
+  size_t count = gameIndex.current()->writeListing(writer, gameType, level);
 
-  return R"({"messageType":"GET_GAME_LIST_RESPONSE","messageId":")" +
-         messageId + R"(","timestamp":)" +
-         std::to_string(getCurrentTimestamp()) +
-         R"(,"payload":{"status":"success","data":{"games":)" +
-         gamesJson.str() + R"(,"totalGames":)" + std::to_string(count) +
-         R"(}}})";
+  writer.endArray().fieldInt("totalGames", count).endObject();
+  endResponse(writer);
+  return out;
 }
 
 // Xử lý START_GAME_REQUEST
-std::string handleStartGame(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string gameId = getJsonValue(payload, "gameId");
+std::string handleStartGame(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string gameId = payload["gameId"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
@@ -2437,14 +2638,15 @@ std::string handleStartGame(const std::string &json) {
            R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
   }
 
-  auto it = games.find(gameId);
-  if (it == games.end()) {
+  auto catalog = games.snapshot();
+  const Game *found = catalog->find(gameId);
+  if (!found) {
     return R"({"messageType":"START_GAME_RESPONSE","messageId":")" + messageId +
            R"(","timestamp":)" + std::to_string(getCurrentTimestamp()) +
            R"(,"payload":{"status":"error","message":"Game not found"}})";
   }
 
-  const Game &game = it->second;
+  const Game &game = *found;
   std::string sessionId = generateId("gs");
 
   GameSession session;
@@ -2457,16 +2659,14 @@ std::string handleStartGame(const std::string &json) {
   session.maxScore = game.maxScore;
   session.completed = false;
 
-  {
-    std::lock_guard<std::mutex> lock(gamesMutex);
-    gameSessions[sessionId] = session;
-  }
+  // Hết timeLimit (+ GAME_SESSION_GRACE_MS) chưa nộp thì bị dọn
+  gameSessions.add(session, game.timeLimit);
 
   std::stringstream gameDataJson;
   gameDataJson << R"({"gameSessionId":")" << sessionId << R"(","gameId":")"
                << game.gameId << R"(","gameType":")" << game.gameType
                << R"(","title":")" << escapeJson(game.title)
-               << R"(","timeLimit":)" << game.timeLimit << R"(","maxScore":)"
+               << R"(","timeLimit":)" << game.timeLimit << R"(,"maxScore":)"
                << game.maxScore;
 
   if (game.gameType == "word_match") {
@@ -2510,91 +2710,57 @@ std::string handleStartGame(const std::string &json) {
 }
 
 // Xử lý SUBMIT_GAME_RESULT_REQUEST
-std::string handleSubmitGameResult(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string gameSessionId = getJsonValue(payload, "gameSessionId");
-  std::string gameId = getJsonValue(payload, "gameId");
-  std::string matchesArray = getJsonArray(payload, "matches");
+std::string handleSubmitGameResult(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string gameSessionId = payload["gameSessionId"].str();
+  std::string gameId = payload["gameId"].str();
+  JsonValue matches = payload["matches"];
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
-    return R"({"messageType":"SUBMIT_GAME_RESULT_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
+    return errorResponse("SUBMIT_GAME_RESULT_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
-  auto sessionIt = gameSessions.find(gameSessionId);
-  if (sessionIt == gameSessions.end()) {
-    return R"({"messageType":"SUBMIT_GAME_RESULT_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Game session not found"}})";
+  if (!gameSessions.findById(gameSessionId)) {
+    return errorResponse("SUBMIT_GAME_RESULT_RESPONSE", messageId,
+                         "Game session not found");
   }
 
-  auto gameIt = games.find(gameId);
-  if (gameIt == games.end()) {
-    return R"({"messageType":"SUBMIT_GAME_RESULT_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Game not found"}})";
+  auto keys = matchKeys.current();
+  const english_learning::service::MatchKey *key = keys->find(gameId);
+  if (!key) {
+    return errorResponse("SUBMIT_GAME_RESULT_RESPONSE", messageId,
+                         "Game not found");
   }
 
-  const Game &game = gameIt->second;
-  GameSession &session = sessionIt->second;
+  // Mỗi match là một lookup hash; cặp nộp lặp lại chỉ tính một lần
+  english_learning::service::MatchTally tally(*key);
+  for (JsonValue match : matches) {
+    tally.add(match[key->leftField()].raw(), match[key->rightField()].raw());
+  }
+  int correctMatches = tally.correct();
+  int totalPairs = static_cast<int>(key->size());
+  int score = tally.score();
 
-  // Parse matches and calculate score
-  int correctMatches = 0;
-  int totalPairs = 0;
-
-  if (game.gameType == "word_match") {
-    totalPairs = game.pairs.size();
-    std::vector<std::string> matches = parseJsonArray(matchesArray);
-    for (const std::string &match : matches) {
-      std::string left = getJsonValue(match, "left");
-      std::string right = getJsonValue(match, "right");
-      for (const auto &pair : game.pairs) {
-        if (pair.first == left && pair.second == right) {
-          correctMatches++;
-          break;
-        }
-      }
-    }
-  } else if (game.gameType == "sentence_match") {
-    totalPairs = game.sentencePairs.size();
-    std::vector<std::string> matches = parseJsonArray(matchesArray);
-    for (const std::string &match : matches) {
-      std::string left = getJsonValue(match, "left");
-      std::string right = getJsonValue(match, "right");
-      for (const auto &pair : game.sentencePairs) {
-        if (pair.first == left && pair.second == right) {
-          correctMatches++;
-          break;
-        }
-      }
-    }
-  } else if (game.gameType == "picture_match") {
-    totalPairs = game.picturePairs.size();
-    std::vector<std::string> matches = parseJsonArray(matchesArray);
-    for (const std::string &match : matches) {
-      std::string word = getJsonValue(match, "word");
-      std::string imageUrl = getJsonValue(match, "imageUrl");
-      for (const auto &pair : game.picturePairs) {
-        if (pair.first == word && pair.second == imageUrl) {
-          correctMatches++;
-          break;
-        }
-      }
-    }
-  }
-
-  int score =
-      (totalPairs > 0) ? (correctMatches * game.maxScore / totalPairs) : 0;
-  session.score = score;
-  session.endTime = getCurrentTimestamp();
-  session.completed = true;
+  // Session hoàn thành chuyển sang lịch sử (bản gọn), chỉ nộp được một lần
+  GameSession session;
+  auto completion = gameSessions.complete(gameSessionId, score,
+                                          getCurrentTimestamp(), &session);
+  if (completion == GameSessionCompletion::AlreadyCompleted) {
+    return errorResponse("SUBMIT_GAME_RESULT_RESPONSE", messageId,
+                         "Game session already completed");
+  }
+  if (completion == GameSessionCompletion::Expired) {
+    return errorResponse("SUBMIT_GAME_RESULT_RESPONSE", messageId,
+                         "Game session expired");
+  }
+  if (completion != GameSessionCompletion::Done) {
+    return errorResponse("SUBMIT_GAME_RESULT_RESPONSE", messageId,
+                         "Game session not found");
+  }
 
   int percentage = (totalPairs > 0) ? (correctMatches * 100 / totalPairs) : 0;
   std::string grade;
@@ -2615,7 +2781,7 @@ std::string handleSubmitGameResult(const std::string &json) {
          R"(,"payload":{"status":"success","data":{"gameSessionId":")" +
          gameSessionId + R"(","gameId":")" + gameId + R"(","score":)" +
          std::to_string(score) + R"(,"maxScore":)" +
-         std::to_string(game.maxScore) + R"(,"correctMatches":)" +
+         std::to_string(key->maxScore()) + R"(,"correctMatches":)" +
          std::to_string(correctMatches) + R"(,"totalPairs":)" +
          std::to_string(totalPairs) + R"(,"percentage":)" +
          std::to_string(percentage) + R"(,"grade":")" + grade +
@@ -2627,28 +2793,22 @@ std::string handleSubmitGameResult(const std::string &json) {
 // Helper function to check if user is admin
 bool isAdmin(const std::string &userId) {
   std::lock_guard<std::mutex> lock(usersMutex);
-  auto it = userById.find(userId);
-  if (it != userById.end()) {
-    return it->second->role == "admin";
-  }
-  return false;
+  User *user = userById.find(userId);
+  return user && user->role == "admin";
 }
 
 // Helper function to check if user is teacher
 bool isTeacher(const std::string &userId) {
   std::lock_guard<std::mutex> lock(usersMutex);
-  auto it = userById.find(userId);
-  if (it != userById.end()) {
-    return it->second->role == "teacher";
-  }
-  return false;
+  User *user = userById.find(userId);
+  return user && user->role == "teacher";
 }
 
 // Xử lý ADD_GAME_REQUEST (Admin only)
-std::string handleAddGame(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
+std::string handleAddGame(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty() || !isAdmin(userId)) {
@@ -2657,13 +2817,13 @@ std::string handleAddGame(const std::string &json) {
            R"(,"payload":{"status":"error","message":"Unauthorized: Admin access required"}})";
   }
 
-  std::string gameType = getJsonValue(payload, "gameType");
-  std::string title = getJsonValue(payload, "title");
-  std::string description = getJsonValue(payload, "description");
-  std::string level = getJsonValue(payload, "level");
-  std::string topic = getJsonValue(payload, "topic");
-  std::string timeLimitStr = getJsonValue(payload, "timeLimit");
-  std::string maxScoreStr = getJsonValue(payload, "maxScore");
+  std::string gameType = payload["gameType"].str();
+  std::string title = payload["title"].str();
+  std::string description = payload["description"].str();
+  std::string level = payload["level"].str();
+  std::string topic = payload["topic"].str();
+  std::string timeLimitStr = payload["timeLimit"].str();
+  std::string maxScoreStr = payload["maxScore"].str();
 
   Game newGame;
   newGame.gameId = generateId("game");
@@ -2677,35 +2837,29 @@ std::string handleAddGame(const std::string &json) {
 
   // Parse pairs based on game type
   if (gameType == "word_match") {
-    std::string pairsArray = getJsonArray(payload, "pairs");
-    std::vector<std::string> pairs = parseJsonArray(pairsArray);
-    for (const std::string &pair : pairs) {
-      std::string left = getJsonValue(pair, "left");
-      std::string right = getJsonValue(pair, "right");
+    for (JsonValue pair : payload["pairs"]) {
+      std::string left = pair["left"].str();
+      std::string right = pair["right"].str();
       newGame.pairs.push_back({left, right});
     }
   } else if (gameType == "sentence_match") {
-    std::string pairsArray = getJsonArray(payload, "pairs");
-    std::vector<std::string> pairs = parseJsonArray(pairsArray);
-    for (const std::string &pair : pairs) {
-      std::string left = getJsonValue(pair, "left");
-      std::string right = getJsonValue(pair, "right");
+    for (JsonValue pair : payload["pairs"]) {
+      std::string left = pair["left"].str();
+      std::string right = pair["right"].str();
       newGame.sentencePairs.push_back({left, right});
     }
   } else if (gameType == "picture_match") {
-    std::string pairsArray = getJsonArray(payload, "pairs");
-    std::vector<std::string> pairs = parseJsonArray(pairsArray);
-    for (const std::string &pair : pairs) {
-      std::string word = getJsonValue(pair, "word");
-      std::string imageUrl = getJsonValue(pair, "imageUrl");
+    for (JsonValue pair : payload["pairs"]) {
+      std::string word = pair["word"].str();
+      std::string imageUrl = pair["imageUrl"].str();
       newGame.picturePairs.push_back({word, imageUrl});
     }
   }
 
-  {
-    std::lock_guard<std::mutex> lock(gamesMutex);
-    games[newGame.gameId] = newGame;
-  }
+  games.update([&](auto &items) {
+    items[newGame.gameId] = newGame;
+    return true;
+  });
 
   return R"({"messageType":"ADD_GAME_RESPONSE","messageId":")" + messageId +
          R"(","timestamp":)" + std::to_string(getCurrentTimestamp()) +
@@ -2714,37 +2868,34 @@ std::string handleAddGame(const std::string &json) {
 }
 
 // Xử lý UPDATE_GAME_REQUEST (Admin only)
-std::string handleUpdateGame(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string gameId = getJsonValue(payload, "gameId");
+std::string handleUpdateGame(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string gameId = payload["gameId"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty() || !isAdmin(userId)) {
-    return R"({"messageType":"UPDATE_GAME_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Unauthorized: Admin access required"}})";
+    return errorResponse("UPDATE_GAME_RESPONSE", messageId,
+                         "Unauthorized: Admin access required");
   }
 
-  {
-    std::lock_guard<std::mutex> lock(gamesMutex);
-    auto it = games.find(gameId);
-    if (it == games.end()) {
-      return R"({"messageType":"UPDATE_GAME_RESPONSE","messageId":")" +
-             messageId + R"(","timestamp":)" +
-             std::to_string(getCurrentTimestamp()) +
-             R"(,"payload":{"status":"error","message":"Game not found"}})";
-    }
+  std::string title = payload["title"].str();
+  std::string description = payload["description"].str();
+  bool updated = games.update([&](auto &items) {
+    auto it = items.find(gameId);
+    if (it == items.end())
+      return false;
 
     Game &game = it->second;
-    std::string title = getJsonValue(payload, "title");
-    std::string description = getJsonValue(payload, "description");
     if (!title.empty())
       game.title = title;
     if (!description.empty())
       game.description = description;
+    return true;
+  });
+  if (!updated) {
+    return errorResponse("UPDATE_GAME_RESPONSE", messageId, "Game not found");
   }
 
   return R"({"messageType":"UPDATE_GAME_RESPONSE","messageId":")" + messageId +
@@ -2753,30 +2904,22 @@ std::string handleUpdateGame(const std::string &json) {
 }
 
 // Xử lý DELETE_GAME_REQUEST (Admin only)
-std::string handleDeleteGame(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string gameId = getJsonValue(payload, "gameId");
+std::string handleDeleteGame(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string gameId = payload["gameId"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty() || !isAdmin(userId)) {
-    return R"({"messageType":"DELETE_GAME_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Unauthorized: Admin access required"}})";
+    return errorResponse("DELETE_GAME_RESPONSE", messageId,
+                         "Unauthorized: Admin access required");
   }
 
-  {
-    std::lock_guard<std::mutex> lock(gamesMutex);
-    auto it = games.find(gameId);
-    if (it == games.end()) {
-      return R"({"messageType":"DELETE_GAME_RESPONSE","messageId":")" +
-             messageId + R"(","timestamp":)" +
-             std::to_string(getCurrentTimestamp()) +
-             R"(,"payload":{"status":"error","message":"Game not found"}})";
-    }
-    games.erase(it);
+  bool deleted =
+      games.update([&](auto &items) { return items.erase(gameId) > 0; });
+  if (!deleted) {
+    return errorResponse("DELETE_GAME_RESPONSE", messageId, "Game not found");
   }
 
   return R"({"messageType":"DELETE_GAME_RESPONSE","messageId":")" + messageId +
@@ -2785,71 +2928,67 @@ std::string handleDeleteGame(const std::string &json) {
 }
 
 // Xử lý GET_ADMIN_GAMES_REQUEST (Admin only)
-std::string handleGetAdminGames(const std::string &json) {
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
+std::string handleGetAdminGames(const JsonDocument &request) {
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty() || !isAdmin(userId)) {
-    return R"({"messageType":"GET_ADMIN_GAMES_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Unauthorized: Admin access required"}})";
+    return errorResponse("GET_ADMIN_GAMES_RESPONSE", messageId,
+                         "Unauthorized: Admin access required");
   }
 
   std::stringstream gamesJson;
   gamesJson << "[";
   bool first = true;
 
-  {
-    std::lock_guard<std::mutex> lock(gamesMutex);
-    for (const auto &pair : games) {
-      const Game &game = pair.second;
-      if (!first)
-        gamesJson << ",";
-      first = false;
+  auto catalog = games.snapshot();
+  for (const auto &pair : catalog->items) {
+    const Game &game = pair.second;
+    if (!first)
+      gamesJson << ",";
+    first = false;
 
-      gamesJson << R"({"gameId":")" << game.gameId << R"(","gameType":")"
-                << game.gameType << R"(","title":")" << escapeJson(game.title)
-                << R"(","description":")" << escapeJson(game.description)
-                << R"(","level":")" << game.level << R"(","topic":")"
-                << game.topic << R"(","timeLimit":)" << game.timeLimit
-                << R"(,"maxScore":)" << game.maxScore;
-
-      if (game.gameType == "word_match") {
-        gamesJson << R"(,"pairs":[)";
-        for (size_t i = 0; i < game.pairs.size(); i++) {
-          if (i > 0)
-            gamesJson << ",";
-          gamesJson << R"({"left":")" << escapeJson(game.pairs[i].first)
-                    << R"(","right":")" << escapeJson(game.pairs[i].second)
-                    << R"("})";
-        }
-        gamesJson << "]";
-      } else if (game.gameType == "sentence_match") {
-        gamesJson << R"(,"pairs":[)";
-        for (size_t i = 0; i < game.sentencePairs.size(); i++) {
-          if (i > 0)
-            gamesJson << ",";
-          gamesJson << R"({"left":")" << escapeJson(game.sentencePairs[i].first)
-                    << R"(","right":")"
-                    << escapeJson(game.sentencePairs[i].second) << R"("})";
-        }
-        gamesJson << "]";
-      } else if (game.gameType == "picture_match") {
-        gamesJson << R"(,"pairs":[)";
-        for (size_t i = 0; i < game.picturePairs.size(); i++) {
-          if (i > 0)
-            gamesJson << ",";
-          gamesJson << R"({"word":")" << escapeJson(game.picturePairs[i].first)
-                    << R"(","imageUrl":")"
-                    << escapeJson(game.picturePairs[i].second) << R"("})";
-        }
-        gamesJson << "]";
-      }
+    gamesJson << R"({"gameId":")" << game.gameId << R"(","gameType":")"
+              << game.gameType << R"(","title":")" << escapeJson(game.title)
+              << R"(","description":")" << escapeJson(game.description)
+              << R"(","level":")" << game.level << R"(","topic":")"
+              << game.topic << R"(","timeLimit":)" << game.timeLimit
+              << R"(,"maxScore":)" << game.maxScore;
 
-      gamesJson << "}";
+    if (game.gameType == "word_match") {
+      gamesJson << R"(,"pairs":[)";
+      for (size_t i = 0; i < game.pairs.size(); i++) {
+        if (i > 0)
+          gamesJson << ",";
+        gamesJson << R"({"left":")" << escapeJson(game.pairs[i].first)
+                  << R"(","right":")" << escapeJson(game.pairs[i].second)
+                  << R"("})";
+      }
+      gamesJson << "]";
+    } else if (game.gameType == "sentence_match") {
+      gamesJson << R"(,"pairs":[)";
+      for (size_t i = 0; i < game.sentencePairs.size(); i++) {
+        if (i > 0)
+          gamesJson << ",";
+        gamesJson << R"({"left":")" << escapeJson(game.sentencePairs[i].first)
+                  << R"(","right":")"
+                  << escapeJson(game.sentencePairs[i].second) << R"("})";
+      }
+      gamesJson << "]";
+    } else if (game.gameType == "picture_match") {
+      gamesJson << R"(,"pairs":[)";
+      for (size_t i = 0; i < game.picturePairs.size(); i++) {
+        if (i > 0)
+          gamesJson << ",";
+        gamesJson << R"({"word":")" << escapeJson(game.picturePairs[i].first)
+                  << R"(","imageUrl":")"
+                  << escapeJson(game.picturePairs[i].second) << R"("})";
+      }
+      gamesJson << "]";
     }
+
+    gamesJson << "}";
   }
   gamesJson << "]";
 
@@ -2861,71 +3000,45 @@ std::string handleGetAdminGames(const std::string &json) {
 }
 
 // Xử lý REVIEW_EXERCISE_REQUEST (Teacher only)
-std::string handleReviewExercise(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string submissionId = getJsonValue(payload, "submissionId");
-  std::string feedback = getJsonValue(payload, "feedback");
-  std::string scoreStr = getJsonValue(payload, "score");
+std::string handleReviewExercise(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string submissionId = payload["submissionId"].str();
+  std::string feedback = payload["feedback"].str();
+  std::string scoreStr = payload["score"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty() || !isTeacher(userId)) {
-    return R"({"messageType":"REVIEW_EXERCISE_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Unauthorized: Teacher access required"}})";
+    return errorResponse("REVIEW_EXERCISE_RESPONSE", messageId,
+                         "Unauthorized: Teacher access required");
   }
 
   int score = scoreStr.empty() ? 0 : std::stoi(scoreStr);
   if (score < 0 || score > 100) {
-    return R"({"messageType":"REVIEW_EXERCISE_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Score must be between 0 and 100"}})";
+    return errorResponse("REVIEW_EXERCISE_RESPONSE", messageId,
+                         "Score must be between 0 and 100");
   }
 
-  {
-    std::lock_guard<std::mutex> lock(exercisesMutex);
-    for (auto &submission : exerciseSubmissions) {
-      if (submission.submissionId == submissionId) {
-        submission.status = "reviewed";
-        submission.teacherId = userId;
-        submission.teacherFeedback = feedback;
-        submission.teacherScore = score;
-        submission.reviewedAt = getCurrentTimestamp();
-
-        // Send notification to student if online
-        {
-          std::lock_guard<std::mutex> userLock(usersMutex);
-          auto it = userById.find(submission.userId);
-          if (it != userById.end() && it->second->online &&
-              it->second->clientSocket > 0) {
-            std::string notification =
-                R"({"messageType":"EXERCISE_FEEDBACK_NOTIFICATION","messageId":")" +
-                generateId("notif") + R"(","timestamp":)" +
-                std::to_string(getCurrentTimestamp()) +
-                R"(,"payload":{"submissionId":")" + submissionId +
-                R"(","exerciseId":")" + submission.exerciseId +
-                R"(","feedback":")" + escapeJson(feedback) + R"(","score":)" +
-                std::to_string(score) + R"(}})";
-
-            uint32_t len = htonl(notification.length());
-            send(it->second->clientSocket, &len, sizeof(len), 0);
-            send(it->second->clientSocket, notification.c_str(),
-                 notification.length(), 0);
-            logMessage("SEND",
-                       "Client:" + std::to_string(it->second->clientSocket),
-                       "EXERCISE_FEEDBACK_NOTIFICATION");
-          }
-        }
+  ExerciseSubmission submission;
+  if (exerciseSubmissions.review(submissionId, userId, feedback, score,
+                                 getCurrentTimestamp(), &submission)) {
+    // Báo cho học viên; nếu đang offline thì spool tới lần login sau
+    std::string notification =
+        R"({"messageType":"EXERCISE_FEEDBACK_NOTIFICATION","messageId":")" +
+        generateId("notif") + R"(","timestamp":)" +
+        std::to_string(getCurrentTimestamp()) +
+        R"(,"payload":{"submissionId":")" + submissionId +
+        R"(","exerciseId":")" + submission.exerciseId +
+        R"(","feedback":")" + escapeJson(feedback) + R"(","score":)" +
+        std::to_string(score) + R"(}})";
+    notifications->notify(submission.userId, std::move(notification),
+                          "feedback:" + submissionId, true);
 
-        return R"({"messageType":"REVIEW_EXERCISE_RESPONSE","messageId":")" +
-               messageId + R"(","timestamp":)" +
-               std::to_string(getCurrentTimestamp()) +
-               R"(,"payload":{"status":"success","message":"Exercise reviewed successfully"}}})";
-      }
-    }
+    return R"({"messageType":"REVIEW_EXERCISE_RESPONSE","messageId":")" +
+           messageId + R"(","timestamp":)" +
+           std::to_string(getCurrentTimestamp()) +
+           R"(,"payload":{"status":"success","message":"Exercise reviewed successfully"}}})";
   }
 
   return R"({"messageType":"REVIEW_EXERCISE_RESPONSE","messageId":")" +
@@ -2935,54 +3048,42 @@ std::string handleReviewExercise(const std::string &json) {
 }
 
 // Xử lý GET_FEEDBACK_REQUEST (Student)
-std::string handleGetFeedback(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string submissionId = getJsonValue(payload, "submissionId");
+std::string handleGetFeedback(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string submissionId = payload["submissionId"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
-    return R"({"messageType":"GET_FEEDBACK_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
+    return errorResponse("GET_FEEDBACK_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
-  {
-    std::lock_guard<std::mutex> lock(exercisesMutex);
-    for (const auto &submission : exerciseSubmissions) {
-      if (submission.submissionId == submissionId &&
-          submission.userId == userId) {
-        if (submission.status == "pending") {
-          return R"({"messageType":"GET_FEEDBACK_RESPONSE","messageId":")" +
-                 messageId + R"(","timestamp":)" +
-                 std::to_string(getCurrentTimestamp()) +
-                 R"(,"payload":{"status":"success","data":{"status":"pending","message":"Your submission is still being reviewed"}}})";
-        }
+  auto found = exerciseSubmissions.findById(submissionId);
+  if (found && found->userId == userId) {
+    const ExerciseSubmission &submission = *found;
+    if (submission.status == "pending") {
+      return R"({"messageType":"GET_FEEDBACK_RESPONSE","messageId":")" +
+             messageId + R"(","timestamp":)" +
+             std::to_string(getCurrentTimestamp()) +
+             R"(,"payload":{"status":"success","data":{"status":"pending","message":"Your submission is still being reviewed"}}})";
+    }
 
-        std::string teacherName = "Unknown";
-        {
-          std::lock_guard<std::mutex> userLock(usersMutex);
-          auto it = userById.find(submission.teacherId);
-          if (it != userById.end()) {
-            teacherName = it->second->fullname;
-          }
-        }
+    std::string teacherName =
+        fullNamesOf({submission.teacherId}, "Unknown").front();
 
-        return R"({"messageType":"GET_FEEDBACK_RESPONSE","messageId":")" +
-               messageId + R"(","timestamp":)" +
-               std::to_string(getCurrentTimestamp()) +
-               R"(,"payload":{"status":"success","data":{"submissionId":")" +
-               submission.submissionId + R"(","exerciseId":")" +
-               submission.exerciseId +
-               R"(","status":"reviewed","teacherName":")" +
-               escapeJson(teacherName) + R"(","feedback":")" +
-               escapeJson(submission.teacherFeedback) + R"(","score":)" +
-               std::to_string(submission.teacherScore) + R"(,"reviewedAt":)" +
-               std::to_string(submission.reviewedAt) + R"(}}})";
-      }
-    }
+    return R"({"messageType":"GET_FEEDBACK_RESPONSE","messageId":")" +
+           messageId + R"(","timestamp":)" +
+           std::to_string(getCurrentTimestamp()) +
+           R"(,"payload":{"status":"success","data":{"submissionId":")" +
+           submission.submissionId + R"(","exerciseId":")" +
+           submission.exerciseId +
+           R"(","status":"reviewed","teacherName":")" +
+           escapeJson(teacherName) + R"(","feedback":")" +
+           escapeJson(submission.teacherFeedback) + R"(","score":)" +
+           std::to_string(submission.teacherScore) + R"(,"reviewedAt":)" +
+           std::to_string(submission.reviewedAt) + R"(}}})";
   }
 
   return R"({"messageType":"GET_FEEDBACK_RESPONSE","messageId":")" + messageId +
@@ -2992,65 +3093,50 @@ std::string handleGetFeedback(const std::string &json) {
 
 // Xử lý GET_USER_SUBMISSIONS_REQUEST (Student views all their submissions with
 // feedback)
-std::string handleGetUserSubmissions(const std::string &json) {
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
+std::string handleGetUserSubmissions(const JsonDocument &request) {
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
-    return R"({"messageType":"GET_USER_SUBMISSIONS_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
+    return errorResponse("GET_USER_SUBMISSIONS_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
-  std::string submissionsJson = "[";
-  bool first = true;
-
-  {
-    std::lock_guard<std::mutex> lock(exercisesMutex);
-    for (const auto &submission : exerciseSubmissions) {
-      if (submission.userId == userId) {
-        if (!first)
-          submissionsJson += ",";
-        first = false;
-
-        // Get exercise title
-        std::string exerciseTitle = "Unknown Exercise";
-        auto exIt = exercises.find(submission.exerciseId);
-        if (exIt != exercises.end()) {
-          exerciseTitle = exIt->second.title;
-        }
+  // Chỉ các bài của user này (posting list), tên tra theo lô
+  std::vector<ExerciseSubmission> submissions =
+      exerciseSubmissions.findByUser(userId);
+  std::vector<std::string> exerciseTitles = exerciseTitlesOf(submissions);
+  std::vector<std::string> teacherIds;
+  teacherIds.reserve(submissions.size());
+  for (const auto &submission : submissions)
+    teacherIds.push_back(submission.status == "reviewed" ? submission.teacherId
+                                                         : "");
+  std::vector<std::string> teacherNames = fullNamesOf(teacherIds, "");
 
-        // Get teacher name if reviewed
-        std::string teacherName = "";
-        if (submission.status == "reviewed" && !submission.teacherId.empty()) {
-          std::lock_guard<std::mutex> userLock(usersMutex);
-          auto it = userById.find(submission.teacherId);
-          if (it != userById.end()) {
-            teacherName = it->second->fullname;
-          }
-        }
+  std::string submissionsJson = "[";
+  for (size_t i = 0; i < submissions.size(); i++) {
+    const ExerciseSubmission &submission = submissions[i];
+    if (i > 0)
+      submissionsJson += ",";
 
-        submissionsJson += R"({"submissionId":")" + submission.submissionId +
-                           R"(","exerciseId":")" + submission.exerciseId +
-                           R"(","exerciseTitle":")" +
-                           escapeJson(exerciseTitle) + R"(","exerciseType":")" +
-                           submission.exerciseType + R"(","status":")" +
-                           submission.status + R"(","submittedAt":)" +
-                           std::to_string(submission.submittedAt);
-
-        if (submission.status == "reviewed") {
-          submissionsJson +=
-              R"(,"teacherId":")" + submission.teacherId +
-              R"(","teacherName":")" + escapeJson(teacherName) +
-              R"(","feedback":")" + escapeJson(submission.teacherFeedback) +
-              R"(","score":)" + std::to_string(submission.teacherScore) +
-              R"(,"reviewedAt":)" + std::to_string(submission.reviewedAt);
-        }
-        submissionsJson += "}";
-      }
+    submissionsJson += R"({"submissionId":")" + submission.submissionId +
+                       R"(","exerciseId":")" + submission.exerciseId +
+                       R"(","exerciseTitle":")" +
+                       escapeJson(exerciseTitles[i]) + R"(","exerciseType":")" +
+                       submission.exerciseType + R"(","status":")" +
+                       submission.status + R"(","submittedAt":)" +
+                       std::to_string(submission.submittedAt);
+
+    if (submission.status == "reviewed") {
+      submissionsJson +=
+          R"(,"teacherId":")" + submission.teacherId + R"(","teacherName":")" +
+          escapeJson(teacherNames[i]) + R"(","feedback":")" +
+          escapeJson(submission.teacherFeedback) + R"(","score":)" +
+          std::to_string(submission.teacherScore) + R"(,"reviewedAt":)" +
+          std::to_string(submission.reviewedAt);
     }
+    submissionsJson += "}";
   }
   submissionsJson += "]";
 
@@ -3062,57 +3148,39 @@ std::string handleGetUserSubmissions(const std::string &json) {
 }
 
 // Xử lý GET_PENDING_REVIEWS_REQUEST (Teacher views submissions pending review)
-std::string handleGetPendingReviews(const std::string &json) {
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
+std::string handleGetPendingReviews(const JsonDocument &request) {
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty() || !isTeacher(userId)) {
-    return R"({"messageType":"GET_PENDING_REVIEWS_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Unauthorized: Teacher access required"}})";
+    return errorResponse("GET_PENDING_REVIEWS_RESPONSE", messageId,
+                         "Unauthorized: Teacher access required");
   }
 
-  std::string submissionsJson = "[";
-  bool first = true;
-
-  {
-    std::lock_guard<std::mutex> lock(exercisesMutex);
-    for (const auto &submission : exerciseSubmissions) {
-      if (submission.status == "pending") {
-        if (!first)
-          submissionsJson += ",";
-        first = false;
-
-        // Get exercise title
-        std::string exerciseTitle = "Unknown Exercise";
-        auto exIt = exercises.find(submission.exerciseId);
-        if (exIt != exercises.end()) {
-          exerciseTitle = exIt->second.title;
-        }
-
-        // Get student name
-        std::string studentName = "Unknown";
-        {
-          std::lock_guard<std::mutex> userLock(usersMutex);
-          auto it = userById.find(submission.userId);
-          if (it != userById.end()) {
-            studentName = it->second->fullname;
-          }
-        }
+  // Hàng chờ chấm, cũ nhất trước; tên tra theo lô
+  std::vector<ExerciseSubmission> pending = exerciseSubmissions.findPending();
+  std::vector<std::string> exerciseTitles = exerciseTitlesOf(pending);
+  std::vector<std::string> studentIds;
+  studentIds.reserve(pending.size());
+  for (const auto &submission : pending)
+    studentIds.push_back(submission.userId);
+  std::vector<std::string> studentNames = fullNamesOf(studentIds, "Unknown");
 
-        submissionsJson +=
-            R"({"submissionId":")" + submission.submissionId +
-            R"(","exerciseId":")" + submission.exerciseId +
-            R"(","exerciseTitle":")" + escapeJson(exerciseTitle) +
-            R"(","exerciseType":")" + submission.exerciseType +
-            R"(","studentId":")" + submission.userId + R"(","studentName":")" +
-            escapeJson(studentName) + R"(","content":")" +
-            escapeJson(submission.content) + R"(","submittedAt":)" +
-            std::to_string(submission.submittedAt) + "}";
-      }
-    }
+  std::string submissionsJson = "[";
+  for (size_t i = 0; i < pending.size(); i++) {
+    const ExerciseSubmission &submission = pending[i];
+    if (i > 0)
+      submissionsJson += ",";
+    submissionsJson +=
+        R"({"submissionId":")" + submission.submissionId +
+        R"(","exerciseId":")" + submission.exerciseId +
+        R"(","exerciseTitle":")" + escapeJson(exerciseTitles[i]) +
+        R"(","exerciseType":")" + submission.exerciseType +
+        R"(","studentId":")" + submission.userId + R"(","studentName":")" +
+        escapeJson(studentNames[i]) + R"(","content":")" +
+        escapeJson(submission.content) + R"(","submittedAt":)" +
+        std::to_string(submission.submittedAt) + "}";
   }
   submissionsJson += "]";
 
@@ -3124,11 +3192,11 @@ std::string handleGetPendingReviews(const std::string &json) {
 }
 
 // Xử lý SET_LEVEL_REQUEST
-std::string handleSetLevel(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string level = getJsonValue(payload, "level");
+std::string handleSetLevel(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string level = payload["level"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
@@ -3145,9 +3213,8 @@ std::string handleSetLevel(const std::string &json) {
 
   {
     std::lock_guard<std::mutex> lock(usersMutex);
-    auto it = userById.find(userId);
-    if (it != userById.end()) {
-      it->second->level = level;
+    if (User *user = userById.find(userId)) {
+      user->level = level;
     }
   }
 
@@ -3161,36 +3228,73 @@ std::string handleSetLevel(const std::string &json) {
 // VOICE CALL HANDLERS
 // ============================================================================
 
-// Helper: Send push notification to a user's socket
-void sendPushToUser(const std::string &userId, const std::string &message) {
-  std::lock_guard<std::mutex> userLock(usersMutex);
-  auto it = userById.find(userId);
-  if (it != userById.end() && it->second->online &&
-      it->second->clientSocket >= 0) {
-    int socket = it->second->clientSocket;
-    uint32_t len = htonl(message.length());
-    send(socket, &len, sizeof(len), 0);
-    send(socket, message.c_str(), message.length(), 0);
+// Helper: xếp push trạng thái cuộc gọi cho user. Cùng callId dùng chung
+// coalesce key, nên client chậm chỉ nhận trạng thái mới nhất. Trạng thái
+// cuộc gọi hết giá trị khi offline nên không spool.
+void sendPushToUser(const std::string &userId, const std::string &callId,
+                    std::string message) {
+  notifications->notify(userId, std::move(message), "call:" + callId);
+}
+
+// Helper: lỗi trả về khi accept/reject/end không thành công
+std::string callChangeError(CallChange change, const std::string &action) {
+  switch (change) {
+  case CallChange::NotReceiver:
+    return "Only the receiver can " + action + " the call";
+  case CallChange::NotParticipant:
+    return "You are not a participant of this call";
+  case CallChange::NotPending:
+    return "Call is not pending";
+  case CallChange::AlreadyEnded:
+    return "Call has already ended";
+  case CallChange::ReceiverBusy:
+    return "You are already in a call";
+  case CallChange::CallerBusy:
+    return "Caller is already in a call";
+  default:
+    return "Call not found";
+  }
+}
+
+// Cuộc gọi đổ chuông quá VOICE_CALL_RING_TIMEOUT_MS thành missed, báo
+// VOICE_CALL_ENDED (reason "missed") cho cả hai bên. Timer wheel chỉ duyệt
+// các tick đã qua nên mỗi lần quét rẻ dù có bao nhiêu cuộc gọi.
+void expireVoiceCalls() {
+  for (const auto &call : voiceCalls.expire(getCurrentTimestamp())) {
+    std::string missedNotification =
+        R"({"messageType":"VOICE_CALL_ENDED","timestamp":)" +
+        std::to_string(getCurrentTimestamp()) + R"(,"payload":{"callId":")" +
+        call.callId + R"(","reason":"missed","duration":0}})";
+    sendPushToUser(call.callerId, call.callId, missedNotification);
+    sendPushToUser(call.receiverId, call.callId,
+                   std::move(missedNotification));
+  }
+}
+
+// Thread dọn dẹp mỗi giây: cuộc gọi đổ chuông quá lâu, game session bỏ dở
+void sweepExpired() {
+  while (running) {
+    std::this_thread::sleep_for(std::chrono::seconds(1));
+    expireVoiceCalls();
+    gameSessions.expire(getCurrentTimestamp());
   }
 }
 
 // Handle VOICE_CALL_INITIATE_REQUEST
-std::string handleVoiceCallInitiate(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string receiverId = getJsonValue(payload, "receiverId");
-  std::string udpPort = getJsonValue(payload, "udpPort"); // Added extraction
-  std::string audioSource = getJsonValue(payload, "audioSource");
+std::string handleVoiceCallInitiate(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string receiverId = payload["receiverId"].str();
+  std::string udpPort = payload["udpPort"].str(); // Added extraction
+  std::string audioSource = payload["audioSource"].str();
   if (audioSource.empty())
     audioSource = "microphone";
 
   std::string callerId = validateSession(sessionToken);
   if (callerId.empty()) {
-    return R"({"messageType":"VOICE_CALL_INITIATE_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
+    return errorResponse("VOICE_CALL_INITIATE_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
   // Check if receiver exists and is online
@@ -3198,62 +3302,34 @@ std::string handleVoiceCallInitiate(const std::string &json) {
   std::string callerName;
   {
     std::lock_guard<std::mutex> lock(usersMutex);
-    auto it = userById.find(receiverId);
-    if (it != userById.end()) {
-      receiver = it->second;
-    }
-    auto callerIt = userById.find(callerId);
-    if (callerIt != userById.end()) {
-      callerName = callerIt->second->fullname;
+    receiver = userById.find(receiverId);
+    if (User *caller = userById.find(callerId)) {
+      callerName = caller->fullname;
     }
   }
 
   if (!receiver) {
-    return R"({"messageType":"VOICE_CALL_INITIATE_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Receiver not found"}})";
+    return errorResponse("VOICE_CALL_INITIATE_RESPONSE", messageId,
+                         "Receiver not found");
   }
 
   if (!receiver->online) {
-    return R"({"messageType":"VOICE_CALL_INITIATE_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Receiver is offline"}})";
+    return errorResponse("VOICE_CALL_INITIATE_RESPONSE", messageId,
+                         "Receiver is offline");
   }
 
-  // Check for existing active/pending calls
-  {
-    std::lock_guard<std::mutex> lock(voiceCallMutex);
-    for (const auto &p : voiceCalls) {
-      if (p.second.involvesUser(callerId) &&
-          (p.second.isActive() || p.second.isPending())) {
-        return R"({"messageType":"VOICE_CALL_INITIATE_RESPONSE","messageId":")" +
-               messageId + R"(","timestamp":)" +
-               std::to_string(getCurrentTimestamp()) +
-               R"(,"payload":{"status":"error","message":"You are already in a call"}})";
-      }
-      if (p.second.involvesUser(receiverId) && p.second.isActive()) {
-        return R"({"messageType":"VOICE_CALL_INITIATE_RESPONSE","messageId":")" +
-               messageId + R"(","timestamp":)" +
-               std::to_string(getCurrentTimestamp()) +
-               R"(,"payload":{"status":"error","message":"Receiver is already in a call"}})";
-      }
-    }
-  }
-
-  // Create call session
-  VoiceCallSession call;
-  call.callId = generateId("call");
-  call.callerId = callerId;
-  call.receiverId = receiverId;
-  call.status = english_learning::core::VoiceCallStatus::Pending;
+  // Create call session; registry kiểm tra slot bận của hai bên
+  VoiceCallSession call(generateId("call"), callerId, receiverId,
+                        getCurrentTimestamp());
   call.audioSource = audioSource;
-  call.startTime = getCurrentTimestamp();
-
-  {
-    std::lock_guard<std::mutex> lock(voiceCallMutex);
-    voiceCalls[call.callId] = call;
+  CallChange started = voiceCalls.start(call);
+  if (started == CallChange::CallerBusy) {
+    return errorResponse("VOICE_CALL_INITIATE_RESPONSE", messageId,
+                         "You are already in a call");
+  }
+  if (started == CallChange::ReceiverBusy) {
+    return errorResponse("VOICE_CALL_INITIATE_RESPONSE", messageId,
+                         "Receiver is already in a call");
   }
 
   // Send push notification to receiver
@@ -3265,7 +3341,7 @@ std::string handleVoiceCallInitiate(const std::string &json) {
       R"(,"callerIp":")" +
       "detect_on_accept_if_needed" + // Ideally detecting IP from socket
       R"(","audioSource":")" + audioSource + R"("}})";
-  sendPushToUser(receiverId, incomingNotification);
+  sendPushToUser(receiverId, call.callId, std::move(incomingNotification));
 
   return R"({"messageType":"VOICE_CALL_INITIATE_RESPONSE","messageId":")" +
          messageId + R"(","timestamp":)" +
@@ -3276,67 +3352,36 @@ std::string handleVoiceCallInitiate(const std::string &json) {
 }
 
 // Handle VOICE_CALL_ACCEPT_REQUEST
-std::string handleVoiceCallAccept(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string callId = getJsonValue(payload, "callId");
-  std::string udpPort = getJsonValue(payload, "udpPort"); // Added
+std::string handleVoiceCallAccept(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string callId = payload["callId"].str();
+  std::string udpPort = payload["udpPort"].str(); // Added
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
-    return R"({"messageType":"VOICE_CALL_ACCEPT_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
-  }
-
-  VoiceCallSession *call = nullptr;
-  std::string callerName, receiverName;
-  {
-    std::lock_guard<std::mutex> lock(voiceCallMutex);
-    auto it = voiceCalls.find(callId);
-    if (it != voiceCalls.end()) {
-      call = &it->second;
-    }
-  }
-
-  if (!call) {
-    return R"({"messageType":"VOICE_CALL_ACCEPT_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Call not found"}})";
-  }
-
-  if (call->receiverId != userId) {
-    return R"({"messageType":"VOICE_CALL_ACCEPT_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Only the receiver can accept the call"}})";
-  }
-
-  if (!call->isPending()) {
-    return R"({"messageType":"VOICE_CALL_ACCEPT_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Call is not pending"}})";
+    return errorResponse("VOICE_CALL_ACCEPT_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
   // Accept the call
-  {
-    std::lock_guard<std::mutex> lock(voiceCallMutex);
-    call->accept(getCurrentTimestamp());
+  VoiceCallSession call;
+  CallChange accepted =
+      voiceCalls.accept(callId, userId, getCurrentTimestamp(), &call);
+  if (accepted != CallChange::Done) {
+    return errorResponse("VOICE_CALL_ACCEPT_RESPONSE", messageId,
+                         callChangeError(accepted, "accept"));
   }
 
   // Get names
+  std::string callerName, receiverName;
   {
     std::lock_guard<std::mutex> lock(usersMutex);
-    auto callerIt = userById.find(call->callerId);
-    if (callerIt != userById.end())
-      callerName = callerIt->second->fullname;
-    auto receiverIt = userById.find(call->receiverId);
-    if (receiverIt != userById.end())
-      receiverName = receiverIt->second->fullname;
+    if (User *caller = userById.find(call.callerId))
+      callerName = caller->fullname;
+    if (User *receiver = userById.find(call.receiverId))
+      receiverName = receiver->fullname;
   }
 
   // Notify caller
@@ -3345,74 +3390,36 @@ std::string handleVoiceCallAccept(const std::string &json) {
       std::to_string(getCurrentTimestamp()) + R"(,"payload":{"callId":")" +
       callId + R"(","receiverId":")" + userId + R"(","receiverName":")" +
       escapeJson(receiverName) + R"(","udpPort":)" + udpPort + R"("}})";
-  sendPushToUser(call->callerId, acceptNotification);
+  sendPushToUser(call.callerId, callId, std::move(acceptNotification));
 
   return R"({"messageType":"VOICE_CALL_ACCEPT_RESPONSE","messageId":")" +
          messageId + R"(","timestamp":)" +
          std::to_string(getCurrentTimestamp()) +
          R"(,"payload":{"status":"success","data":{"callId":")" + callId +
-         R"(","callStatus":"active","callerId":")" + call->callerId +
+         R"(","callStatus":"active","callerId":")" + call.callerId +
          R"(","callerName":")" + escapeJson(callerName) + R"("}}})";
 }
 
 // Handle VOICE_CALL_REJECT_REQUEST
-std::string handleVoiceCallReject(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string callId = getJsonValue(payload, "callId");
+std::string handleVoiceCallReject(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string callId = payload["callId"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
-    return R"({"messageType":"VOICE_CALL_REJECT_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
-  }
-
-  VoiceCallSession *call = nullptr;
-  std::string callerName;
-  {
-    std::lock_guard<std::mutex> lock(voiceCallMutex);
-    auto it = voiceCalls.find(callId);
-    if (it != voiceCalls.end()) {
-      call = &it->second;
-    }
+    return errorResponse("VOICE_CALL_REJECT_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
-  if (!call) {
-    return R"({"messageType":"VOICE_CALL_REJECT_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Call not found"}})";
-  }
-
-  if (call->receiverId != userId) {
-    return R"({"messageType":"VOICE_CALL_REJECT_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Only the receiver can reject the call"}})";
-  }
-
-  if (!call->isPending()) {
-    return R"({"messageType":"VOICE_CALL_REJECT_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Call is not pending"}})";
-  }
-
-  // Reject the call
-  {
-    std::lock_guard<std::mutex> lock(voiceCallMutex);
-    call->reject(getCurrentTimestamp());
-  }
-
-  // Get caller name
-  {
-    std::lock_guard<std::mutex> lock(usersMutex);
-    auto callerIt = userById.find(call->callerId);
-    if (callerIt != userById.end())
-      callerName = callerIt->second->fullname;
+  // Reject the call; registry chuyển nó sang lịch sử
+  VoiceCallSession call;
+  CallChange rejected =
+      voiceCalls.reject(callId, userId, getCurrentTimestamp(), &call);
+  if (rejected != CallChange::Done) {
+    return errorResponse("VOICE_CALL_REJECT_RESPONSE", messageId,
+                         callChangeError(rejected, "reject"));
   }
 
   // Notify caller
@@ -3420,7 +3427,7 @@ std::string handleVoiceCallReject(const std::string &json) {
       R"({"messageType":"VOICE_CALL_REJECTED","timestamp":)" +
       std::to_string(getCurrentTimestamp()) + R"(,"payload":{"callId":")" +
       callId + R"(","receiverId":")" + userId + R"("}})";
-  sendPushToUser(call->callerId, rejectNotification);
+  sendPushToUser(call.callerId, callId, std::move(rejectNotification));
 
   return R"({"messageType":"VOICE_CALL_REJECT_RESPONSE","messageId":")" +
          messageId + R"(","timestamp":)" +
@@ -3430,60 +3437,30 @@ std::string handleVoiceCallReject(const std::string &json) {
 }
 
 // Handle VOICE_CALL_END_REQUEST
-std::string handleVoiceCallEnd(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string callId = getJsonValue(payload, "callId");
+std::string handleVoiceCallEnd(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string callId = payload["callId"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
-    return R"({"messageType":"VOICE_CALL_END_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
-  }
-
-  VoiceCallSession *call = nullptr;
-  {
-    std::lock_guard<std::mutex> lock(voiceCallMutex);
-    auto it = voiceCalls.find(callId);
-    if (it != voiceCalls.end()) {
-      call = &it->second;
-    }
-  }
-
-  if (!call) {
-    return R"({"messageType":"VOICE_CALL_END_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Call not found"}})";
+    return errorResponse("VOICE_CALL_END_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
-  if (!call->involvesUser(userId)) {
-    return R"({"messageType":"VOICE_CALL_END_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"You are not a participant of this call"}})";
-  }
-
-  if (call->hasEnded()) {
-    return R"({"messageType":"VOICE_CALL_END_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Call has already ended"}})";
+  // End the call; registry chuyển nó sang lịch sử
+  VoiceCallSession call;
+  CallChange ended =
+      voiceCalls.end(callId, userId, getCurrentTimestamp(), &call);
+  if (ended != CallChange::Done) {
+    return errorResponse("VOICE_CALL_END_RESPONSE", messageId,
+                         callChangeError(ended, "end"));
   }
 
   std::string otherUserId =
-      (call->callerId == userId) ? call->receiverId : call->callerId;
-  int64_t duration = 0;
-
-  // End the call
-  {
-    std::lock_guard<std::mutex> lock(voiceCallMutex);
-    call->end(getCurrentTimestamp());
-    duration = call->getDurationSeconds();
-  }
+      (call.callerId == userId) ? call.receiverId : call.callerId;
+  int64_t duration = call.getDurationSeconds();
 
   // Notify other participant
   std::string endNotification =
@@ -3491,7 +3468,7 @@ std::string handleVoiceCallEnd(const std::string &json) {
       std::to_string(getCurrentTimestamp()) + R"(,"payload":{"callId":")" +
       callId + R"(","endedBy":")" + userId + R"(","duration":)" +
       std::to_string(duration) + R"(}})";
-  sendPushToUser(otherUserId, endNotification);
+  sendPushToUser(otherUserId, callId, std::move(endNotification));
 
   return R"({"messageType":"VOICE_CALL_END_RESPONSE","messageId":")" +
          messageId + R"(","timestamp":)" +
@@ -3502,47 +3479,33 @@ std::string handleVoiceCallEnd(const std::string &json) {
 }
 
 // Handle VOICE_CALL_GET_STATUS_REQUEST
-std::string handleVoiceCallGetStatus(const std::string &json) {
-  std::string payload = getJsonObject(json, "payload");
-  std::string messageId = getJsonValue(json, "messageId");
-  std::string sessionToken = getJsonValue(json, "sessionToken");
-  std::string callId = getJsonValue(payload, "callId");
+std::string handleVoiceCallGetStatus(const JsonDocument &request) {
+  JsonValue payload = request["payload"];
+  std::string messageId = request["messageId"].str();
+  std::string sessionToken = request["sessionToken"].str();
+  std::string callId = payload["callId"].str();
 
   std::string userId = validateSession(sessionToken);
   if (userId.empty()) {
-    return R"({"messageType":"VOICE_CALL_GET_STATUS_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Invalid or expired session"}})";
-  }
-
-  VoiceCallSession call;
-  bool found = false;
-  {
-    std::lock_guard<std::mutex> lock(voiceCallMutex);
-    auto it = voiceCalls.find(callId);
-    if (it != voiceCalls.end()) {
-      call = it->second;
-      found = true;
-    }
+    return errorResponse("VOICE_CALL_GET_STATUS_RESPONSE", messageId,
+                         "Invalid or expired session");
   }
 
+  // Cuộc gọi đã kết thúc vẫn tra được trong lịch sử
+  auto found = voiceCalls.findById(callId);
   if (!found) {
-    return R"({"messageType":"VOICE_CALL_GET_STATUS_RESPONSE","messageId":")" +
-           messageId + R"(","timestamp":)" +
-           std::to_string(getCurrentTimestamp()) +
-           R"(,"payload":{"status":"error","message":"Call not found"}})";
+    return errorResponse("VOICE_CALL_GET_STATUS_RESPONSE", messageId,
+                         "Call not found");
   }
+  const VoiceCallSession &call = *found;
 
   std::string callerName, receiverName;
   {
     std::lock_guard<std::mutex> lock(usersMutex);
-    auto callerIt = userById.find(call.callerId);
-    if (callerIt != userById.end())
-      callerName = callerIt->second->fullname;
-    auto receiverIt = userById.find(call.receiverId);
-    if (receiverIt != userById.end())
-      receiverName = receiverIt->second->fullname;
+    if (User *caller = userById.find(call.callerId))
+      callerName = caller->fullname;
+    if (User *receiver = userById.find(call.receiverId))
+      receiverName = receiver->fullname;
   }
 
   std::string statusStr =
@@ -3566,6 +3529,162 @@ std::string handleVoiceCallGetStatus(const std::string &json) {
 // XỬ LÝ CLIENT
 // ============================================================================
 
+// Mọi handler được gọi qua cùng một chữ ký; handler không cần socket bỏ qua
+// tham số thứ hai.
+using RequestHandler = std::string (*)(const JsonDocument &, int);
+using english_learning::protocol::MessageDispatchTable;
+namespace MessageType = english_learning::protocol::MessageType;
+
+template <std::string (*Handler)(const JsonDocument &)>
+std::string withoutSocket(const JsonDocument &request, int) {
+  return Handler(request);
+}
+
+// Bảng route được dựng lúc biên dịch (perfect hash): tra messageType chỉ tốn
+// một lần hash và một lần so sánh chuỗi. Mỗi route khai báo request có cần
+// đăng nhập không và các field payload bắt buộc; dispatchMessage kiểm tra
+// trước khi gọi handler.
+constexpr MessageDispatchTable<RequestHandler, 30> REQUEST_ROUTES({{
+    {MessageType::REGISTER_REQUEST, MessageType::REGISTER_RESPONSE, false,
+     withoutSocket<handleRegister>, {"email", "password"}},
+    // handleLogin tự gửi response và trả về chuỗi rỗng
+    {MessageType::LOGIN_REQUEST, MessageType::LOGIN_RESPONSE, false,
+     handleLogin, {"email", "password"}},
+    {MessageType::GET_LESSONS_REQUEST, MessageType::GET_LESSONS_RESPONSE, true,
+     withoutSocket<handleGetLessons>, {}},
+    {MessageType::GET_LESSON_DETAIL_REQUEST,
+     MessageType::GET_LESSON_DETAIL_RESPONSE, true,
+     withoutSocket<handleGetLessonDetail>, {"lessonId"}},
+    {MessageType::GET_TEST_REQUEST, MessageType::GET_TEST_RESPONSE, true,
+     withoutSocket<handleGetTest>, {}},
+    {MessageType::SUBMIT_TEST_REQUEST, MessageType::SUBMIT_TEST_RESPONSE, true,
+     withoutSocket<handleSubmitTest>, {"testId"}},
+    {MessageType::BULK_GRADE_REQUEST, MessageType::BULK_GRADE_RESPONSE, true,
+     withoutSocket<handleBulkGrade>, {"testId"}},
+    {MessageType::GET_EXERCISE_REQUEST, MessageType::GET_EXERCISE_RESPONSE,
+     true, withoutSocket<handleGetExercise>, {}},
+    {MessageType::SUBMIT_EXERCISE_REQUEST,
+     MessageType::SUBMIT_EXERCISE_RESPONSE, true,
+     withoutSocket<handleSubmitExercise>, {"exerciseId"}},
+    {MessageType::GET_USER_SUBMISSIONS_REQUEST,
+     MessageType::GET_USER_SUBMISSIONS_RESPONSE, true,
+     withoutSocket<handleGetUserSubmissions>, {}},
+    {MessageType::GET_FEEDBACK_REQUEST, MessageType::GET_FEEDBACK_RESPONSE,
+     true, withoutSocket<handleGetFeedback>, {"submissionId"}},
+    {MessageType::GET_PENDING_REVIEWS_REQUEST,
+     MessageType::GET_PENDING_REVIEWS_RESPONSE, true,
+     withoutSocket<handleGetPendingReviews>, {}},
+    {MessageType::REVIEW_EXERCISE_REQUEST,
+     MessageType::REVIEW_EXERCISE_RESPONSE, true,
+     withoutSocket<handleReviewExercise>, {"submissionId"}},
+    {MessageType::GET_GAME_LIST_REQUEST, MessageType::GET_GAME_LIST_RESPONSE,
+     true, withoutSocket<handleGetGameList>, {}},
+    {MessageType::START_GAME_REQUEST, MessageType::START_GAME_RESPONSE, true,
+     withoutSocket<handleStartGame>, {"gameId"}},
+    {MessageType::SUBMIT_GAME_RESULT_REQUEST,
+     MessageType::SUBMIT_GAME_RESULT_RESPONSE, true,
+     withoutSocket<handleSubmitGameResult>, {"gameId"}},
+    {MessageType::GET_CONTACT_LIST_REQUEST,
+     MessageType::GET_CONTACT_LIST_RESPONSE, true,
+     withoutSocket<handleGetContactList>, {}},
+    {MessageType::SEND_MESSAGE_REQUEST, MessageType::SEND_MESSAGE_RESPONSE,
+     true, handleSendMessage, {"recipientId"}},
+    {MessageType::GET_CHAT_HISTORY_REQUEST,
+     MessageType::GET_CHAT_HISTORY_RESPONSE, true,
+     withoutSocket<handleGetChatHistory>, {"recipientId"}},
+    {MessageType::SET_LEVEL_REQUEST, MessageType::SET_LEVEL_RESPONSE, true,
+     withoutSocket<handleSetLevel>, {"level"}},
+    {MessageType::ADD_GAME_REQUEST, MessageType::ADD_GAME_RESPONSE, true,
+     withoutSocket<handleAddGame>, {"gameType", "title"}},
+    {MessageType::UPDATE_GAME_REQUEST, MessageType::UPDATE_GAME_RESPONSE, true,
+     withoutSocket<handleUpdateGame>, {"gameId"}},
+    {MessageType::DELETE_GAME_REQUEST, MessageType::DELETE_GAME_RESPONSE, true,
+     withoutSocket<handleDeleteGame>, {"gameId"}},
+    {MessageType::GET_ADMIN_GAMES_REQUEST,
+     MessageType::GET_ADMIN_GAMES_RESPONSE, true,
+     withoutSocket<handleGetAdminGames>, {}},
+    {MessageType::MARK_MESSAGES_READ_REQUEST,
+     MessageType::MARK_MESSAGES_READ_RESPONSE, true,
+     withoutSocket<handleMarkMessagesRead>, {"senderId"}},
+    // Voice Call handlers
+    {MessageType::VOICE_CALL_INITIATE_REQUEST,
+     MessageType::VOICE_CALL_INITIATE_RESPONSE, true,
+     withoutSocket<handleVoiceCallInitiate>, {"receiverId"}},
+    {MessageType::VOICE_CALL_ACCEPT_REQUEST,
+     MessageType::VOICE_CALL_ACCEPT_RESPONSE, true,
+     withoutSocket<handleVoiceCallAccept>, {"callId"}},
+    {MessageType::VOICE_CALL_REJECT_REQUEST,
+     MessageType::VOICE_CALL_REJECT_RESPONSE, true,
+     withoutSocket<handleVoiceCallReject>, {"callId"}},
+    {MessageType::VOICE_CALL_END_REQUEST, MessageType::VOICE_CALL_END_RESPONSE,
+     true, withoutSocket<handleVoiceCallEnd>, {"callId"}},
+    {MessageType::VOICE_CALL_GET_STATUS_REQUEST,
+     MessageType::VOICE_CALL_GET_STATUS_RESPONSE, true,
+     withoutSocket<handleVoiceCallGetStatus>, {"callId"}},
+}});
+
+// Field thiếu, null hoặc chuỗi rỗng đều coi như không có
+bool isMissing(const JsonValue &value) {
+  JsonType type = value.type();
+  return type == JsonType::Missing || type == JsonType::Null ||
+         value.raw().empty();
+}
+
+// Chọn handler theo messageType. Trả về chuỗi rỗng nếu handler đã tự gửi
+// response (LOGIN_REQUEST).
+std::string dispatchMessage(const std::string &message, int clientSocket) {
+  // Tokenize một lần; handler tra cứu trên bảng offset, không quét lại
+  JsonDocument request(message);
+  std::string_view messageId = request["messageId"].raw();
+
+  const auto *route = REQUEST_ROUTES.find(request["messageType"].raw());
+  if (route == nullptr) {
+    return errorResponse(MessageType::ERROR_RESPONSE, messageId,
+                         "Unknown message type");
+  }
+
+  // Chỉ kiểm tra token có mặt; handler vẫn tự validateSession để lấy userId
+  if (route->authRequired && isMissing(request["sessionToken"])) {
+    return errorResponse(route->responseType, messageId,
+                         "Invalid or expired session");
+  }
+
+  JsonValue payload = request["payload"];
+  for (std::string_view field : route->requiredFields) {
+    if (field.empty()) {
+      break;
+    }
+    if (isMissing(payload[field])) {
+      return errorResponse(route->responseType, messageId,
+                           "Missing required field: " + std::string(field));
+    }
+  }
+
+  return route->handler(request, clientSocket);
+}
+
+// Dọn dẹp session/trạng thái online khi connection đóng
+void releaseClient(int clientSocket) {
+  // Chờ dispatcher ghi xong frame đang gửi dở (nếu có) trước khi fd bị đóng
+  notifications->detach(clientSocket);
+
+  std::lock_guard<std::mutex> lock(sessionsMutex);
+  auto it = clientSessions.find(clientSocket);
+  if (it != clientSessions.end()) {
+    std::string token = it->second;
+    auto sessionIt = sessions.find(token);
+    if (sessionIt != sessions.end()) {
+      std::lock_guard<std::mutex> userLock(usersMutex);
+      if (User *user = userById.find(sessionIt->second.userHandle)) {
+        user->online = false;
+        user->clientSocket = -1;
+      }
+    }
+    clientSessions.erase(it);
+  }
+}
+
+// Chế độ thread-per-connection (--io=threads)
 void handleClient(int clientSocket, struct sockaddr_in clientAddr) {
   char clientIP[INET_ADDRSTRLEN];
   inet_ntop(AF_INET, &clientAddr.sin_addr, clientIP, INET_ADDRSTRLEN);
@@ -3574,9 +3693,48 @@ void handleClient(int clientSocket, struct sockaddr_in clientAddr) {
 
   std::cout << "[INFO] New connection from " << clientInfo << std::endl;
 
+  auto writer = std::make_shared<ConnectionWriter>();
+  {
+    std::lock_guard<std::mutex> lock(connectionWritersMutex);
+    connectionWriters[clientSocket] = writer;
+  }
+
   char buffer[BUFFER_SIZE];
 
   while (running) {
+    // Chờ request, hoặc socket ghi được khi còn push ghi dở
+    struct pollfd fds[2] = {{clientSocket, POLLIN, 0},
+                            {writer->wakeFd, POLLIN, 0}};
+    {
+      std::lock_guard<std::mutex> lock(writer->mutex);
+      if (!writer->frames.empty()) {
+        fds[0].events |= POLLOUT;
+      }
+    }
+    if (poll(fds, 2, -1) < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    if (fds[1].revents & POLLIN) {
+      uint64_t wakes;
+      ssize_t ignored = read(writer->wakeFd, &wakes, sizeof(wakes));
+      (void)ignored;
+    }
+    if (fds[0].revents & POLLOUT) {
+      std::lock_guard<std::mutex> lock(writer->mutex);
+      if (writer->frames.flush(clientSocket) ==
+          english_learning::network::FrameQueue::FlushResult::Error) {
+        std::cout << "[INFO] Client " << clientInfo << " disconnected"
+                  << std::endl;
+        break;
+      }
+    }
+    if (!(fds[0].revents & (POLLIN | POLLHUP | POLLERR))) {
+      continue;
+    }
+
     uint32_t msgLen = 0;
     ssize_t bytesRead =
         recv(clientSocket, &msgLen, sizeof(msgLen), MSG_WAITALL);
@@ -3605,133 +3763,217 @@ void handleClient(int clientSocket, struct sockaddr_in clientAddr) {
     std::string message(buffer, bytesRead);
     logMessage("RECV", clientInfo, message);
 
-    std::string messageType = getJsonValue(message, "messageType");
-    std::string response;
-
-    if (messageType == "REGISTER_REQUEST") {
-      response = handleRegister(message);
-    } else if (messageType == "LOGIN_REQUEST") {
-      response = handleLogin(message, clientSocket);
-      // handleLogin đã tự gửi response nên không cần gửi lại
-      if (response.empty()) {
-        continue;
-      }
-    } else if (messageType == "GET_LESSONS_REQUEST") {
-      response = handleGetLessons(message);
-    } else if (messageType == "GET_LESSON_DETAIL_REQUEST") {
-      response = handleGetLessonDetail(message);
-    } else if (messageType == "GET_TEST_REQUEST") {
-      response = handleGetTest(message);
-    } else if (messageType == "SUBMIT_TEST_REQUEST") {
-      response = handleSubmitTest(message);
-    } else if (messageType == "GET_EXERCISE_REQUEST") {
-      response = handleGetExercise(message);
-    } else if (messageType == "SUBMIT_EXERCISE_REQUEST") {
-      response = handleSubmitExercise(message);
-    } else if (messageType == "GET_USER_SUBMISSIONS_REQUEST") {
-      response = handleGetUserSubmissions(message);
-    } else if (messageType == "GET_FEEDBACK_REQUEST") {
-      response = handleGetFeedback(message);
-    } else if (messageType == "GET_PENDING_REVIEWS_REQUEST") {
-      response = handleGetPendingReviews(message);
-    } else if (messageType == "REVIEW_EXERCISE_REQUEST") {
-      response = handleReviewExercise(message);
-    } else if (messageType == "GET_GAME_LIST_REQUEST") {
-      response = handleGetGameList(message);
-    } else if (messageType == "START_GAME_REQUEST") {
-      response = handleStartGame(message);
-    } else if (messageType == "SUBMIT_GAME_RESULT_REQUEST") {
-      response = handleSubmitGameResult(message);
-    } else if (messageType == "GET_CONTACT_LIST_REQUEST") {
-      response = handleGetContactList(message);
-    } else if (messageType == "SEND_MESSAGE_REQUEST") {
-      response = handleSendMessage(message, clientSocket);
-    } else if (messageType == "GET_CHAT_HISTORY_REQUEST") {
-      response = handleGetChatHistory(message);
-    } else if (messageType == "SET_LEVEL_REQUEST") {
-      response = handleSetLevel(message);
-    } else if (messageType == "ADD_GAME_REQUEST") {
-      response = handleAddGame(message);
-    } else if (messageType == "UPDATE_GAME_REQUEST") {
-      response = handleUpdateGame(message);
-    } else if (messageType == "DELETE_GAME_REQUEST") {
-      response = handleDeleteGame(message);
-    } else if (messageType == "GET_ADMIN_GAMES_REQUEST") {
-      response = handleGetAdminGames(message);
-    } else if (messageType == "MARK_MESSAGES_READ_REQUEST") {
-      response = handleMarkMessagesRead(message);
-    }
-    // Voice Call handlers
-    else if (messageType == "VOICE_CALL_INITIATE_REQUEST") {
-      response = handleVoiceCallInitiate(message);
-    } else if (messageType == "VOICE_CALL_ACCEPT_REQUEST") {
-      response = handleVoiceCallAccept(message);
-    } else if (messageType == "VOICE_CALL_REJECT_REQUEST") {
-      response = handleVoiceCallReject(message);
-    } else if (messageType == "VOICE_CALL_END_REQUEST") {
-      response = handleVoiceCallEnd(message);
-    } else if (messageType == "VOICE_CALL_GET_STATUS_REQUEST") {
-      response = handleVoiceCallGetStatus(message);
-    } else {
-      response =
-          R"({"messageType":"ERROR_RESPONSE","timestamp":)" +
-          std::to_string(getCurrentTimestamp()) +
-          R"(,"payload":{"status":"error","message":"Unknown message type"}})";
+    std::string response = dispatchMessage(message, clientSocket);
+    if (response.empty()) {
+      continue;
     }
 
-    uint32_t respLen = htonl(response.length());
-    send(clientSocket, &respLen, sizeof(respLen), 0);
-    send(clientSocket, response.c_str(), response.length(), 0);
-
+    sendFrame(clientSocket, response);
     logMessage("SEND", clientInfo, response);
+    JsonWriter::releaseBuffer(std::move(response));
   }
 
-  // Cleanup
+  releaseClient(clientSocket);
   {
-    std::lock_guard<std::mutex> lock(sessionsMutex);
-    auto it = clientSessions.find(clientSocket);
-    if (it != clientSessions.end()) {
-      std::string token = it->second;
-      auto sessionIt = sessions.find(token);
-      if (sessionIt != sessions.end()) {
-        std::string uid = sessionIt->second.userId;
-        std::lock_guard<std::mutex> userLock(usersMutex);
-        auto userIt = userById.find(uid);
-        if (userIt != userById.end()) {
-          userIt->second->online = false;
-          userIt->second->clientSocket = -1;
-        }
-      }
-      clientSessions.erase(it);
+    std::lock_guard<std::mutex> lock(connectionWritersMutex);
+    connectionWriters.erase(clientSocket);
+  }
+  close(clientSocket);
+}
+
+// Chế độ reactor (--io=epoll): event loop chỉ đọc/ghi socket, còn handler
+// chạy trên worker pool. Client có thể gửi nhiều request liên tiếp mà không
+// chờ (pipelining): chúng được xếp hàng và xử lý tuần tự theo thứ tự nhận,
+// mỗi response mang messageId của request tương ứng.
+void onReactorMessage(int clientSocket, const std::string &clientInfo,
+                      std::string message) {
+  logMessage("RECV", clientInfo, message);
+  std::string messageId = getJsonValue(message, "messageId");
+
+  auto task = [clientSocket, clientInfo, message = std::move(message)]() {
+    std::string response = dispatchMessage(message, clientSocket);
+    if (response.empty()) {
+      return;
     }
+
+    sendFrame(clientSocket, response);
+    logMessage("SEND", clientInfo, response);
+    // Trả buffer lại cho thread để response sau dùng lại capacity
+    JsonWriter::releaseBuffer(std::move(response));
+  };
+
+  if (!workerPool->submit(clientSocket, std::move(task))) {
+    std::string response = errorResponse("ERROR_RESPONSE", messageId,
+                                         "Server busy, please retry");
+    sendFrame(clientSocket, response);
+    logMessage("SEND", clientInfo, response);
+    JsonWriter::releaseBuffer(std::move(response));
   }
+}
 
-  close(clientSocket);
+// Dọn dẹp sau các request còn đang chờ của connection rồi mới đóng fd, để số
+// fd không bị tái sử dụng khi vẫn còn response chưa xử lý xong
+void onReactorClose(int clientSocket, const std::string &clientInfo) {
+  (void)clientInfo;
+  workerPool->submit(
+      clientSocket,
+      [clientSocket]() {
+        releaseClient(clientSocket);
+        close(clientSocket);
+      },
+      true);
+}
+
+// In thống kê worker pool định kỳ (--stats=SECONDS)
+void reportPoolStats(int intervalSeconds) {
+  while (running) {
+    std::this_thread::sleep_for(std::chrono::seconds(intervalSeconds));
+    auto stats = workerPool->stats();
+    size_t connections = 0;
+    for (auto &loop : eventLoops) {
+      connections += loop->connectionCount();
+    }
+    std::cout << "[STATS] workers=" << stats.workers
+              << " queueDepth=" << stats.queueDepth
+              << " submitted=" << stats.submitted
+              << " completed=" << stats.completed
+              << " rejected=" << stats.rejected << " steals=" << stats.steals
+              << " shards=" << eventLoops.size()
+              << " connections=" << connections;
+    if (serverLog) {
+      auto logStats = serverLog->stats();
+      std::cout << " logged=" << logStats.logged
+                << " logDropped=" << logStats.dropped;
+    }
+    auto pushStats = notifications->stats();
+    std::cout << " pushQueued=" << pushStats.queued
+              << " pushDelivered=" << pushStats.delivered
+              << " pushSpooled=" << pushStats.spooled
+              << " pushDropped=" << pushStats.dropped
+              << " pushCoalesced=" << pushStats.coalesced
+              << " pushDisconnects=" << pushStats.disconnects;
+    std::cout << std::endl;
+  }
 }
 
 // ============================================================================
 // SIGNAL HANDLER & MAIN
 // ============================================================================
 
+// Chỉ làm việc async-signal-safe: tắt cờ running và đánh thức các vòng lặp
+// (eventfd của event loop, accept() của chế độ threads). main() dọn dẹp và
+// ghi nốt log sau khi các vòng lặp đã trả về.
 void signalHandler(int signal) {
-  std::cout << "\n[INFO] Shutting down server..." << std::endl;
   running = false;
+  for (auto &loop : eventLoops) {
+    loop->stop();
+  }
   if (serverSocket >= 0) {
-    close(serverSocket);
+    shutdown(serverSocket, SHUT_RDWR);
   }
-  exit(0);
 }
 
+// Sau khi vòng lặp chính trả về: dừng dispatcher rồi ghi nốt log
+void finishShutdown() {
+  std::cout << "\n[INFO] Shutting down server..." << std::endl;
+  notifications->stop();
+  serverLog->stop();
+}
+
+void printBanner(int port, const std::string &ioMode) {
+  std::cout << "============================================" << std::endl;
+  std::cout << "   ENGLISH LEARNING APP - SERVER" << std::endl;
+  std::cout << "============================================" << std::endl;
+  std::cout << "[INFO] Server started on port " << port << std::endl;
+  std::cout << "[INFO] I/O mode: " << ioMode << std::endl;
+  std::cout << "[INFO] Press Ctrl+C to stop" << std::endl;
+  std::cout << "--------------------------------------------" << std::endl;
+  std::cout << "Sample accounts:" << std::endl;
+  std::cout << "  - student@example.com / student123" << std::endl;
+  std::cout << "  - student2@example.com / student123" << std::endl;
+  std::cout << "  - sarah@example.com / teacher123" << std::endl;
+  std::cout << "--------------------------------------------" << std::endl;
+  std::cout << "Lessons: " << lessons.size() << " | Tests: " << tests.size()
+            << std::endl;
+  std::cout << "--------------------------------------------" << std::endl;
+}
+
+// Usage: ./server [port] [--io=epoll|threads] [--shards=N] [--workers=N]
+//                 [--queue=N] [--stats=SECONDS]
+//                 [--log-level=debug|info|warn|error|off] [--log-flush-ms=N]
+//                 [--log-body=BYTES] [--log-rotate-mb=N] [--log-files=N]
+//                 [--log-ring=N] [--push-queue=N]
+//                 [--push-policy=drop|coalesce|disconnect] [--push-spool=N]
 int main(int argc, char *argv[]) {
   int port = DEFAULT_PORT;
-  if (argc > 1) {
-    port = std::stoi(argv[1]);
+  std::string ioMode = "epoll";
+  size_t workerCount = std::max(1u, std::thread::hardware_concurrency());
+  size_t queueCapacity = 1024;
+  int statsInterval = 0;
+  size_t shardCount = 1;
+  english_learning::logging::AsyncLogger::Options logOptions;
+  english_learning::network::NotificationDispatcher::Options pushOptions;
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg.rfind("--io=", 0) == 0) {
+      ioMode = arg.substr(5);
+    } else if (arg.rfind("--shards=", 0) == 0) {
+      shardCount = std::max<size_t>(1, std::stoul(arg.substr(9)));
+    } else if (arg.rfind("--workers=", 0) == 0) {
+      workerCount = std::stoul(arg.substr(10));
+    } else if (arg.rfind("--queue=", 0) == 0) {
+      queueCapacity = std::stoul(arg.substr(8));
+    } else if (arg.rfind("--stats=", 0) == 0) {
+      statsInterval = std::stoi(arg.substr(8));
+    } else if (arg.rfind("--log-level=", 0) == 0) {
+      if (!english_learning::logging::parseLogLevel(arg.substr(12),
+                                                    logOptions.level)) {
+        std::cerr << "[ERROR] Unknown log level '" << arg.substr(12) << "'"
+                  << std::endl;
+        return 1;
+      }
+    } else if (arg.rfind("--log-flush-ms=", 0) == 0) {
+      logOptions.flushInterval =
+          std::chrono::milliseconds(std::max(1, std::stoi(arg.substr(15))));
+    } else if (arg.rfind("--log-body=", 0) == 0) {
+      logOptions.maxBodyBytes = std::stoul(arg.substr(11));
+    } else if (arg.rfind("--log-rotate-mb=", 0) == 0) {
+      logOptions.rotateBytes = std::stoul(arg.substr(16)) * 1024 * 1024;
+    } else if (arg.rfind("--log-files=", 0) == 0) {
+      logOptions.maxFiles = std::stoul(arg.substr(12));
+    } else if (arg.rfind("--log-ring=", 0) == 0) {
+      logOptions.ringCapacity = std::stoul(arg.substr(11));
+    } else if (arg.rfind("--push-queue=", 0) == 0) {
+      pushOptions.queueCapacity = std::stoul(arg.substr(13));
+    } else if (arg.rfind("--push-policy=", 0) == 0) {
+      if (!english_learning::network::parseSlowConsumerPolicy(
+              arg.substr(14), pushOptions.policy)) {
+        std::cerr << "[ERROR] Unknown push policy '" << arg.substr(14) << "'"
+                  << std::endl;
+        return 1;
+      }
+    } else if (arg.rfind("--push-spool=", 0) == 0) {
+      pushOptions.spoolCapacity = std::stoul(arg.substr(13));
+    } else {
+      port = std::stoi(arg);
+    }
+  }
+  if (ioMode != "epoll" && ioMode != "threads") {
+    std::cerr << "[ERROR] Unknown I/O mode '" << ioMode
+              << "' (expected epoll or threads)" << std::endl;
+    return 1;
   }
 
   signal(SIGINT, signalHandler);
   signal(SIGTERM, signalHandler);
   signal(SIGPIPE, SIG_IGN);
 
+  serverLog =
+      std::make_unique<english_learning::logging::AsyncLogger>(logOptions);
+  notifications =
+      std::make_unique<english_learning::network::NotificationDispatcher>(
+          deliverNotification, outboundBacklog, disconnectClient, pushOptions);
+
   initSampleData();
 
   // ========================================================================
@@ -3740,24 +3982,63 @@ int main(int argc, char *argv[]) {
   // Create bridge repositories that wrap the global data structures
   static bridge::BridgeUserRepository userRepo(users, userById, usersMutex);
   static bridge::BridgeSessionRepository sessionRepo(sessions, clientSessions,
-                                                     sessionsMutex);
-  static bridge::BridgeLessonRepository lessonRepo(lessons);
-  static bridge::BridgeTestRepository testRepo(tests);
-  static bridge::BridgeChatRepository chatRepo(chatMessages, chatMutex);
+                                                     userHandles, sessionsMutex);
+  static bridge::BridgeLessonRepository lessonRepo(lessons, lessonIndex);
+  static bridge::BridgeTestRepository testRepo(tests, testIndex);
+  static bridge::BridgeChatRepository chatRepo(chatStore);
   static bridge::BridgeExerciseRepository exerciseRepo(
       exercises, exerciseSubmissions, exercisesMutex);
-  static bridge::BridgeGameRepository gameRepo(games, gameSessions, gamesMutex);
-  static bridge::BridgeVoiceCallRepository voiceCallRepo(voiceCalls,
-                                                         voiceCallMutex);
+  static bridge::BridgeGameRepository gameRepo(games, gameIndex, gameSessions);
+  static bridge::BridgeVoiceCallRepository voiceCallRepo(voiceCalls);
 
   // Create service container with dependency injection
   serviceContainer = std::make_unique<service::ServiceContainer>(
       userRepo, sessionRepo, lessonRepo, testRepo, chatRepo, exerciseRepo,
-      gameRepo, voiceCallRepo);
+      gameRepo, voiceCallRepo, &answerKeys, &matchKeys);
 
   std::cout << "[INFO] Service layer initialized" << std::endl;
   // ========================================================================
 
+  std::thread(sweepExpired).detach();
+
+  if (ioMode == "epoll") {
+    english_learning::network::EventLoop::Options options;
+    options.maxMessageSize = BUFFER_SIZE - 1;
+    options.backlog = MAX_CLIENTS;
+    options.reusePort = shardCount > 1;
+    for (size_t i = 0; i < shardCount; i++) {
+      eventLoops.push_back(std::make_unique<english_learning::network::EventLoop>(
+          onReactorMessage, onReactorClose, options));
+      if (!eventLoops.back()->listen(port)) {
+        return 1;
+      }
+    }
+    workerPool = std::make_unique<english_learning::network::WorkerPool>(
+        workerCount, queueCapacity);
+
+    printBanner(port, ioMode);
+    std::cout << "[INFO] Reactor shards: " << shardCount << " | Worker pool: "
+              << workerCount << " threads, queue " << queueCapacity
+              << std::endl;
+    if (statsInterval > 0) {
+      std::thread(reportPoolStats, statsInterval).detach();
+    }
+
+    // Shard 0 chạy trên main thread, các shard còn lại mỗi shard một thread
+    std::vector<std::thread> shardThreads;
+    for (size_t i = 1; i < eventLoops.size(); i++) {
+      shardThreads.emplace_back(
+          &english_learning::network::EventLoop::run, eventLoops[i].get());
+    }
+    eventLoops[0]->run();
+    for (auto &thread : shardThreads) {
+      thread.join();
+    }
+    workerPool->shutdown();
+    finishShutdown();
+    return 0;
+  }
+
   serverSocket = socket(AF_INET, SOCK_STREAM, 0);
   if (serverSocket < 0) {
     std::cerr << "[ERROR] Cannot create socket" << std::endl;
@@ -3786,20 +4067,7 @@ int main(int argc, char *argv[]) {
     return 1;
   }
 
-  std::cout << "============================================" << std::endl;
-  std::cout << "   ENGLISH LEARNING APP - SERVER" << std::endl;
-  std::cout << "============================================" << std::endl;
-  std::cout << "[INFO] Server started on port " << port << std::endl;
-  std::cout << "[INFO] Press Ctrl+C to stop" << std::endl;
-  std::cout << "--------------------------------------------" << std::endl;
-  std::cout << "Sample accounts:" << std::endl;
-  std::cout << "  - student@example.com / student123" << std::endl;
-  std::cout << "  - student2@example.com / student123" << std::endl;
-  std::cout << "  - sarah@example.com / teacher123" << std::endl;
-  std::cout << "--------------------------------------------" << std::endl;
-  std::cout << "Lessons: " << lessons.size() << " | Tests: " << tests.size()
-            << std::endl;
-  std::cout << "--------------------------------------------" << std::endl;
+  printBanner(port, ioMode);
 
   while (running) {
     struct sockaddr_in clientAddr;
@@ -3819,5 +4087,6 @@ int main(int argc, char *argv[]) {
   }
 
   close(serverSocket);
+  finishShutdown();
   return 0;
 }
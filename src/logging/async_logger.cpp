@@ -0,0 +1,323 @@
+#include "src/logging/async_logger.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace english_learning {
+namespace logging {
+
+namespace {
+
+// A batch is written early once it grows past this, bounding writer memory
+constexpr size_t MAX_BATCH_BYTES = 1024 * 1024;
+
+size_t roundUpToPowerOfTwo(size_t value) {
+    size_t result = 2;
+    while (result < value) result <<= 1;
+    return result;
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::write(fd, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace
+
+bool parseLogLevel(std::string_view name, LogLevel& level) {
+    if (name == "debug") {
+        level = LogLevel::Debug;
+    } else if (name == "info") {
+        level = LogLevel::Info;
+    } else if (name == "warn") {
+        level = LogLevel::Warn;
+    } else if (name == "error") {
+        level = LogLevel::Error;
+    } else if (name == "off") {
+        level = LogLevel::Off;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+AsyncLogger::AsyncLogger(Options options)
+    : options_(std::move(options)),
+      level_(options_.level),
+      mask_(roundUpToPowerOfTwo(options_.ringCapacity) - 1),
+      slots_(new Slot[mask_ + 1]) {
+    // Producers copy only as much of the body as the longer output shows
+    if (options_.maxBodyBytes == 0 || (options_.console && options_.consoleBodyBytes == 0)) {
+        copyLimit_ = 0;
+    } else if (options_.console) {
+        copyLimit_ = std::max(options_.maxBodyBytes, options_.consoleBodyBytes + 1);
+    } else {
+        copyLimit_ = options_.maxBodyBytes;
+    }
+
+    for (size_t i = 0; i <= mask_; i++) {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    openFile();
+    writer_ = std::thread(&AsyncLogger::writerLoop, this);
+}
+
+AsyncLogger::~AsyncLogger() {
+    stop();
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool AsyncLogger::log(LogLevel level, std::string_view tag, std::string_view source,
+                      std::string_view body) {
+    if (!enabled(level) || stopped_.load(std::memory_order_relaxed)) return false;
+
+    // Claim a slot (bounded MPMC ring, Vyukov style): a slot is free for
+    // position pos when its sequence equals pos
+    uint64_t pos = enqueuePos_.load(std::memory_order_relaxed);
+    Slot* slot;
+    for (;;) {
+        slot = &slots_[pos & mask_];
+        uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+        int64_t diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(pos);
+        if (diff == 0) {
+            if (enqueuePos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            // The writer has not released this slot yet: the ring is full
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            pos = enqueuePos_.load(std::memory_order_relaxed);
+        }
+    }
+
+    Record& record = slot->record;
+    record.time = std::chrono::system_clock::now();
+    record.tag.assign(tag.data(), tag.size());
+    record.source.assign(source.data(), source.size());
+    record.bodySize = body.size();
+    size_t copy = copyLimit_ == 0 ? body.size() : std::min(body.size(), copyLimit_);
+    record.body.assign(body.data(), copy);
+    slot->sequence.store(pos + 1, std::memory_order_release);
+
+    // Nudge the writer each time another half of the ring fills up
+    if (((pos + 1) & (mask_ >> 1)) == 0) {
+        wakeRequested_.store(true, std::memory_order_relaxed);
+        wake_.notify_one();
+    }
+    return true;
+}
+
+void AsyncLogger::flush() {
+    uint64_t target = enqueuePos_.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    while (dequeuePos_.load(std::memory_order_acquire) < target && !stopping_) {
+        wakeRequested_.store(true, std::memory_order_relaxed);
+        wake_.notify_one();
+        drained_.wait_for(lock, options_.flushInterval);
+    }
+}
+
+void AsyncLogger::stop() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex_);
+        if (stopping_) return;
+        stopping_ = true;
+        stopped_.store(true, std::memory_order_relaxed);
+    }
+    wake_.notify_one();
+    if (writer_.joinable()) writer_.join();
+}
+
+AsyncLogger::Stats AsyncLogger::stats() const {
+    Stats s;
+    s.logged = enqueuePos_.load(std::memory_order_relaxed);
+    s.dropped = dropped_.load(std::memory_order_relaxed);
+    s.written = written_.load(std::memory_order_relaxed);
+    s.bytes = bytes_.load(std::memory_order_relaxed);
+    s.rotations = rotations_.load(std::memory_order_relaxed);
+    return s;
+}
+
+void AsyncLogger::writerLoop() {
+    std::unique_lock<std::mutex> lock(wakeMutex_);
+    for (;;) {
+        wake_.wait_for(lock, options_.flushInterval, [this] {
+            return stopping_ || wakeRequested_.load(std::memory_order_relaxed);
+        });
+        wakeRequested_.store(false, std::memory_order_relaxed);
+        bool stopping = stopping_;
+        lock.unlock();
+
+        drain();
+
+        lock.lock();
+        drained_.notify_all();
+        if (stopping) break;
+    }
+}
+
+size_t AsyncLogger::drain() {
+    uint64_t pos = dequeuePos_.load(std::memory_order_relaxed);
+    size_t count = 0;
+    for (;;) {
+        Slot& slot = slots_[pos & mask_];
+        if (slot.sequence.load(std::memory_order_acquire) != pos + 1) break;
+
+        format(slot.record);
+        // Hand the slot back to producers for the next lap of the ring
+        slot.sequence.store(pos + mask_ + 1, std::memory_order_release);
+        pos++;
+        count++;
+
+        if (fileBatch_.size() >= MAX_BATCH_BYTES || consoleBatch_.size() >= MAX_BATCH_BYTES) {
+            writeBatch();
+        }
+    }
+
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != droppedReported_) {
+        Record notice;
+        notice.time = std::chrono::system_clock::now();
+        notice.tag = "WARN";
+        notice.source = "logger";
+        notice.body = "dropped " + std::to_string(dropped - droppedReported_) +
+                      " records (ring full)";
+        notice.bodySize = notice.body.size();
+        format(notice);
+        droppedReported_ = dropped;
+    }
+
+    writeBatch();
+    written_.fetch_add(count, std::memory_order_relaxed);
+    dequeuePos_.store(pos, std::memory_order_release);
+    return count;
+}
+
+void AsyncLogger::format(const Record& record) {
+    if (fd_ >= 0) {
+        std::string& out = fileBatch_;
+        out += '[';
+        appendTime(out, record.time);
+        out += "] ";
+        out += record.tag;
+        out += ' ';
+        out += record.source;
+        out += ": ";
+        size_t shown = record.bodySize;
+        if (options_.maxBodyBytes != 0 && shown > options_.maxBodyBytes) {
+            shown = options_.maxBodyBytes;
+        }
+        out.append(record.body, 0, shown);
+        if (shown < record.bodySize) {
+            out += "... [";
+            out += std::to_string(record.bodySize);
+            out += " bytes]";
+        }
+        out += '\n';
+    }
+
+    if (options_.console) {
+        std::string& out = consoleBatch_;
+        out += '[';
+        appendTime(out, record.time);
+        out += "] ";
+        out += record.tag;
+        out += ' ';
+        out += record.source;
+        out += ": ";
+        size_t limit = options_.consoleBodyBytes;
+        if (limit != 0 && record.bodySize > limit) {
+            out.append(record.body, 0, limit);
+            out += "...";
+        } else {
+            out += record.body;
+        }
+        out += '\n';
+    }
+}
+
+void AsyncLogger::appendTime(std::string& out, std::chrono::system_clock::time_point time) {
+    // Same layout as ctime(), reformatted only when the second changes
+    std::time_t seconds = std::chrono::system_clock::to_time_t(time);
+    if (seconds != cachedSecond_) {
+        std::tm local;
+        localtime_r(&seconds, &local);
+        char buffer[32];
+        size_t length = std::strftime(buffer, sizeof(buffer), "%a %b %e %H:%M:%S %Y", &local);
+        cachedTime_.assign(buffer, length);
+        cachedSecond_ = seconds;
+    }
+    out += cachedTime_;
+}
+
+void AsyncLogger::writeBatch() {
+    if (!fileBatch_.empty()) {
+        if (options_.rotateBytes != 0 && fileSize_ > 0 &&
+            fileSize_ + fileBatch_.size() > options_.rotateBytes) {
+            rotate();
+        }
+        if (fd_ >= 0 && writeAll(fd_, fileBatch_.data(), fileBatch_.size())) {
+            fileSize_ += fileBatch_.size();
+            bytes_.fetch_add(fileBatch_.size(), std::memory_order_relaxed);
+        }
+        fileBatch_.clear();
+    }
+
+    if (!consoleBatch_.empty()) {
+        std::fwrite(consoleBatch_.data(), 1, consoleBatch_.size(), stdout);
+        std::fflush(stdout);
+        consoleBatch_.clear();
+    }
+}
+
+bool AsyncLogger::openFile() {
+    fd_ = ::open(options_.path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        std::fprintf(stderr, "[ERROR] Cannot open log file %s: %s\n", options_.path.c_str(),
+                     std::strerror(errno));
+        return false;
+    }
+    struct stat info;
+    fileSize_ = fstat(fd_, &info) == 0 ? static_cast<size_t>(info.st_size) : 0;
+    return true;
+}
+
+void AsyncLogger::rotate() {
+    if (fd_ >= 0) ::close(fd_);
+
+    // path.N-1 -> path.N, ..., path -> path.1; the oldest is overwritten
+    const std::string& path = options_.path;
+    if (options_.maxFiles == 0) {
+        ::unlink(path.c_str());
+    } else {
+        for (size_t i = options_.maxFiles - 1; i >= 1; i--) {
+            std::string from = path + "." + std::to_string(i);
+            std::string to = path + "." + std::to_string(i + 1);
+            ::rename(from.c_str(), to.c_str());
+        }
+        ::rename(path.c_str(), (path + ".1").c_str());
+    }
+
+    rotations_.fetch_add(1, std::memory_order_relaxed);
+    openFile();
+}
+
+} // namespace logging
+} // namespace english_learning
@@ -0,0 +1,144 @@
+#ifndef ENGLISH_LEARNING_LOGGING_ASYNC_LOGGER_H
+#define ENGLISH_LEARNING_LOGGING_ASYNC_LOGGER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace english_learning {
+namespace logging {
+
+enum class LogLevel : uint8_t { Debug, Info, Warn, Error, Off };
+
+/** Parse "debug", "info", "warn", "error" or "off"; false if unknown. */
+bool parseLogLevel(std::string_view name, LogLevel& level);
+
+/**
+ * Logger whose producers never block on I/O.
+ *
+ * log() claims a slot in a bounded lock-free ring (multi-producer, single
+ * consumer), copies the record into it and returns. One background thread
+ * drains the ring, formats the records and appends them to the log file
+ * with a single write() per batch, waking every flush interval or sooner
+ * when the ring is filling up. When the ring is full the record is dropped
+ * and counted instead of stalling the request thread; the writer notes
+ * each run of drops in the log itself.
+ *
+ * Slots keep their string capacity between uses, so once the ring has
+ * warmed up, logging a message costs one copy of the (truncated) body.
+ */
+class AsyncLogger {
+public:
+    struct Options {
+        std::string path = "server.log";
+        size_t ringCapacity = 8192;       ///< Records; rounded up to a power of two
+        std::chrono::milliseconds flushInterval{100};
+        LogLevel level = LogLevel::Info;  ///< Records below this are discarded
+        size_t maxBodyBytes = 0;          ///< File body limit, 0 = unlimited
+        bool console = true;              ///< Echo records to stdout
+        size_t consoleBodyBytes = 200;    ///< Stdout body limit, 0 = unlimited
+        size_t rotateBytes = 16 * 1024 * 1024;  ///< Rotate past this size, 0 = never
+        size_t maxFiles = 3;              ///< Rotated files kept: path.1 .. path.N
+    };
+
+    struct Stats {
+        uint64_t logged = 0;     ///< Records accepted into the ring
+        uint64_t dropped = 0;    ///< Records lost because the ring was full
+        uint64_t written = 0;    ///< Records written out by the background thread
+        uint64_t bytes = 0;      ///< Bytes appended to the log file
+        uint64_t rotations = 0;
+    };
+
+    explicit AsyncLogger(Options options);
+    AsyncLogger() : AsyncLogger(Options()) {}
+    ~AsyncLogger();
+
+    AsyncLogger(const AsyncLogger&) = delete;
+    AsyncLogger& operator=(const AsyncLogger&) = delete;
+
+    bool enabled(LogLevel level) const {
+        return level >= level_.load(std::memory_order_relaxed);
+    }
+
+    void setLevel(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+
+    /**
+     * Queue "[time] tag source: body". Safe from any thread; never blocks.
+     * @return false if the record was filtered out or dropped
+     */
+    bool log(LogLevel level, std::string_view tag, std::string_view source,
+             std::string_view body);
+
+    /** Block until every record queued before the call has been written. */
+    void flush();
+
+    /** Write out what is queued and stop the background thread. */
+    void stop();
+
+    Stats stats() const;
+
+private:
+    struct Record {
+        std::chrono::system_clock::time_point time;
+        std::string tag;
+        std::string source;
+        std::string body;     ///< Possibly truncated copy
+        size_t bodySize = 0;  ///< Length before truncation
+    };
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        Record record;
+    };
+
+    void writerLoop();
+    size_t drain();
+    void format(const Record& record);
+    void appendTime(std::string& out, std::chrono::system_clock::time_point time);
+    void writeBatch();
+    bool openFile();
+    void rotate();
+
+    Options options_;
+    std::atomic<LogLevel> level_;
+    size_t mask_;
+    size_t copyLimit_;  ///< Body bytes a producer copies, 0 = all
+    std::unique_ptr<Slot[]> slots_;
+
+    alignas(64) std::atomic<uint64_t> enqueuePos_{0};
+    alignas(64) std::atomic<uint64_t> dequeuePos_{0};  ///< Written by the writer only
+
+    std::atomic<uint64_t> dropped_{0};
+    std::atomic<uint64_t> written_{0};
+    std::atomic<uint64_t> bytes_{0};
+    std::atomic<uint64_t> rotations_{0};
+    uint64_t droppedReported_ = 0;
+
+    // Writer thread state
+    int fd_ = -1;
+    size_t fileSize_ = 0;
+    std::string fileBatch_;
+    std::string consoleBatch_;
+    int64_t cachedSecond_ = -1;
+    std::string cachedTime_;
+
+    std::mutex wakeMutex_;
+    std::condition_variable wake_;     ///< Writer waits here between batches
+    std::condition_variable drained_;  ///< flush() waits here
+    std::atomic<bool> wakeRequested_{false};
+    bool stopping_ = false;
+    std::atomic<bool> stopped_{false};  ///< Producers stop queueing
+    std::thread writer_;
+};
+
+} // namespace logging
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_LOGGING_ASYNC_LOGGER_H
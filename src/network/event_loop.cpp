@@ -0,0 +1,344 @@
+#include "src/network/event_loop.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace english_learning {
+namespace network {
+
+namespace {
+
+constexpr int MAX_EVENTS = 256;
+constexpr size_t READ_CHUNK = 65536;
+constexpr size_t FRAME_HEADER = sizeof(uint32_t);
+
+std::string peerName(const struct sockaddr_in& addr) {
+    char ip[INET_ADDRSTRLEN];
+    inet_ntop(AF_INET, &addr.sin_addr, ip, INET_ADDRSTRLEN);
+    return std::string(ip) + ":" + std::to_string(ntohs(addr.sin_port));
+}
+
+} // namespace
+
+EventLoop::EventLoop(MessageCallback onMessage, CloseCallback onClose, Options options)
+    : onMessage_(std::move(onMessage)),
+      onClose_(std::move(onClose)),
+      options_(options) {}
+
+EventLoop::~EventLoop() {
+    std::vector<int> fds;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        for (const auto& pair : connections_) {
+            fds.push_back(pair.first);
+        }
+        connections_.clear();
+    }
+    for (int fd : fds) {
+        close(fd);
+    }
+    if (listenFd_ >= 0) close(listenFd_);
+    if (wakeFd_ >= 0) close(wakeFd_);
+    if (epollFd_ >= 0) close(epollFd_);
+}
+
+bool EventLoop::listen(int port) {
+    epollFd_ = epoll_create1(EPOLL_CLOEXEC);
+    if (epollFd_ < 0) {
+        std::cerr << "[ERROR] epoll_create1 failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    wakeFd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wakeFd_ < 0) {
+        std::cerr << "[ERROR] eventfd failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    listenFd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd_ < 0) {
+        std::cerr << "[ERROR] Cannot create socket" << std::endl;
+        return false;
+    }
+
+    int opt = 1;
+    setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    if (options_.reusePort &&
+        setsockopt(listenFd_, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt)) < 0) {
+        std::cerr << "[ERROR] SO_REUSEPORT failed: " << strerror(errno) << std::endl;
+        return false;
+    }
+
+    struct sockaddr_in addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = INADDR_ANY;
+    addr.sin_port = htons(port);
+
+    if (bind(listenFd_, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        std::cerr << "[ERROR] Cannot bind to port " << port << std::endl;
+        return false;
+    }
+    if (::listen(listenFd_, options_.backlog) < 0) {
+        std::cerr << "[ERROR] Listen failed" << std::endl;
+        return false;
+    }
+
+    struct epoll_event ev;
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN | EPOLLET;
+    ev.data.fd = listenFd_;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, listenFd_, &ev);
+
+    ev.events = EPOLLIN;
+    ev.data.fd = wakeFd_;
+    epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+    return true;
+}
+
+void EventLoop::run() {
+    running_ = true;
+    struct epoll_event events[MAX_EVENTS];
+
+    while (running_) {
+        int n = epoll_wait(epollFd_, events, MAX_EVENTS, -1);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "[ERROR] epoll_wait failed: " << strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < n; i++) {
+            int fd = events[i].data.fd;
+            uint32_t mask = events[i].events;
+
+            if (fd == listenFd_) {
+                acceptAll();
+                continue;
+            }
+            if (fd == wakeFd_) {
+                uint64_t value;
+                while (read(wakeFd_, &value, sizeof(value)) > 0) {}
+                continue;
+            }
+
+            auto conn = find(fd);
+            if (!conn) continue;
+
+            if (mask & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR)) {
+                handleReadable(conn);
+            }
+            if (mask & EPOLLOUT) {
+                std::lock_guard<std::mutex> lock(conn->outMutex);
+                flush(*conn);
+            }
+
+            bool broken;
+            {
+                std::lock_guard<std::mutex> lock(conn->outMutex);
+                broken = conn->broken;
+            }
+            if (broken) {
+                closeConnection(fd);
+            }
+        }
+    }
+}
+
+void EventLoop::stop() {
+    running_ = false;
+    if (wakeFd_ >= 0) {
+        uint64_t one = 1;
+        ssize_t ignored = write(wakeFd_, &one, sizeof(one));
+        (void)ignored;
+    }
+}
+
+bool EventLoop::send(int fd, std::string_view payload) {
+    auto conn = find(fd);
+    if (!conn) return false;
+
+    std::lock_guard<std::mutex> lock(conn->outMutex);
+    if (conn->broken) return true;
+
+    // On WouldBlock the tail stays queued until EPOLLOUT
+    if (conn->outQueue.send(fd, payload) == FrameQueue::FlushResult::Error) {
+        conn->broken = true;
+        // Let the loop thread notice the failure and run the close path
+        shutdown(fd, SHUT_RDWR);
+    }
+    return true;
+}
+
+void EventLoop::disconnect(int fd) {
+    auto conn = find(fd);
+    if (!conn) return;
+    std::lock_guard<std::mutex> lock(conn->outMutex);
+    conn->broken = true;
+    shutdown(fd, SHUT_RDWR);
+}
+
+size_t EventLoop::pendingBytes(int fd) const {
+    auto conn = find(fd);
+    if (!conn) return 0;
+    std::lock_guard<std::mutex> lock(conn->outMutex);
+    return conn->outQueue.pendingBytes();
+}
+
+size_t EventLoop::connectionCount() const {
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    return connections_.size();
+}
+
+void EventLoop::acceptAll() {
+    while (true) {
+        struct sockaddr_in addr;
+        socklen_t len = sizeof(addr);
+        int fd = accept4(listenFd_, (struct sockaddr*)&addr, &len,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                std::cerr << "[ERROR] Accept failed: " << strerror(errno) << std::endl;
+            }
+            return;
+        }
+
+        // Frames are already coalesced by FrameQueue; don't let Nagle hold
+        // back the tail of a response waiting for a delayed ACK
+        int nodelay = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+
+        auto conn = std::make_shared<Connection>();
+        conn->fd = fd;
+        conn->peer = peerName(addr);
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex_);
+            connections_[fd] = conn;
+        }
+
+        struct epoll_event ev;
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        ev.data.fd = fd;
+        if (epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev) < 0) {
+            std::cerr << "[ERROR] epoll_ctl failed: " << strerror(errno) << std::endl;
+            std::lock_guard<std::mutex> lock(connectionsMutex_);
+            connections_.erase(fd);
+            close(fd);
+            continue;
+        }
+
+        std::cout << "[INFO] New connection from " << conn->peer << std::endl;
+    }
+}
+
+void EventLoop::handleReadable(const std::shared_ptr<Connection>& conn) {
+    char chunk[READ_CHUNK];
+    bool peerClosed = false;
+
+    // Edge-triggered: drain the socket completely before returning
+    while (true) {
+        ssize_t n = recv(conn->fd, chunk, sizeof(chunk), 0);
+        if (n > 0) {
+            size_t offset = 0;
+            if (conn->discardRemaining > 0) {
+                offset = std::min(conn->discardRemaining, static_cast<size_t>(n));
+                conn->discardRemaining -= offset;
+            }
+            conn->inBuffer.append(chunk + offset, n - offset);
+            continue;
+        }
+        if (n == 0) {
+            peerClosed = true;
+            break;
+        }
+        if (errno == EINTR) continue;
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            peerClosed = true;
+        }
+        break;
+    }
+
+    // Split the buffered bytes into frames
+    std::string& buf = conn->inBuffer;
+    size_t pos = 0;
+    while (buf.size() - pos >= FRAME_HEADER) {
+        uint32_t len;
+        memcpy(&len, buf.data() + pos, FRAME_HEADER);
+        len = ntohl(len);
+
+        if (len > options_.maxMessageSize) {
+            std::cout << "[ERROR] Message too long from " << conn->peer << std::endl;
+            size_t available = buf.size() - pos - FRAME_HEADER;
+            if (available >= len) {
+                pos += FRAME_HEADER + len;
+            } else {
+                conn->discardRemaining = len - available;
+                pos = buf.size();
+            }
+            continue;
+        }
+        if (buf.size() - pos - FRAME_HEADER < len) break;
+
+        std::string message(buf, pos + FRAME_HEADER, len);
+        pos += FRAME_HEADER + len;
+        onMessage_(conn->fd, conn->peer, std::move(message));
+    }
+    buf.erase(0, pos);
+
+    if (peerClosed) {
+        std::cout << "[INFO] Client " << conn->peer << " disconnected" << std::endl;
+        std::lock_guard<std::mutex> lock(conn->outMutex);
+        conn->broken = true;
+    }
+}
+
+bool EventLoop::flush(Connection& conn) {
+    // On WouldBlock, EPOLLOUT fires again once the peer drains its window
+    if (conn.outQueue.flush(conn.fd) == FrameQueue::FlushResult::Error) {
+        conn.broken = true;
+        return false;
+    }
+    return true;
+}
+
+void EventLoop::closeConnection(int fd) {
+    std::shared_ptr<Connection> conn;
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex_);
+        auto it = connections_.find(fd);
+        if (it == connections_.end()) return;
+        conn = it->second;
+        connections_.erase(it);
+    }
+
+    epoll_ctl(epollFd_, EPOLL_CTL_DEL, fd, nullptr);
+    if (onClose_) {
+        onClose_(fd, conn->peer);
+    } else {
+        close(fd);
+    }
+}
+
+std::shared_ptr<EventLoop::Connection> EventLoop::find(int fd) const {
+    std::lock_guard<std::mutex> lock(connectionsMutex_);
+    auto it = connections_.find(fd);
+    if (it == connections_.end()) return nullptr;
+    return it->second;
+}
+
+} // namespace network
+} // namespace english_learning
@@ -0,0 +1,125 @@
+#ifndef ENGLISH_LEARNING_NETWORK_EVENT_LOOP_H
+#define ENGLISH_LEARNING_NETWORK_EVENT_LOOP_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "src/network/frame_queue.h"
+
+namespace english_learning {
+namespace network {
+
+/**
+ * Edge-triggered epoll reactor serving length-prefixed frames.
+ *
+ * One thread calls run() and owns the listening socket, every accepted
+ * (non-blocking) connection and their read buffers. Complete frames are
+ * handed to the message callback; responses and pushes go back through
+ * send(), which may be called from any thread and never blocks.
+ *
+ * Several loops can serve the same port when Options::reusePort is set:
+ * the kernel then balances incoming connections across their listening
+ * sockets and each loop keeps its own connection table.
+ */
+class EventLoop {
+public:
+    /** Called on the loop thread for every complete inbound frame. */
+    using MessageCallback =
+        std::function<void(int fd, const std::string& peer, std::string message)>;
+
+    /**
+     * Called on the loop thread once a connection is gone. The callback
+     * takes ownership of fd and must close() it, which lets the owner keep
+     * the descriptor number reserved until in-flight work for it is done.
+     * Without a callback the loop closes fd itself.
+     */
+    using CloseCallback = std::function<void(int fd, const std::string& peer)>;
+
+    struct Options {
+        size_t maxMessageSize = 65535;  ///< Larger frames are skipped
+        int backlog = 100;              ///< listen() backlog
+        bool reusePort = false;         ///< SO_REUSEPORT, for sharded listeners
+    };
+
+    EventLoop(MessageCallback onMessage, CloseCallback onClose, Options options);
+    EventLoop(MessageCallback onMessage, CloseCallback onClose)
+        : EventLoop(std::move(onMessage), std::move(onClose), Options()) {}
+    ~EventLoop();
+
+    EventLoop(const EventLoop&) = delete;
+    EventLoop& operator=(const EventLoop&) = delete;
+
+    /**
+     * Create the epoll instance and bind a non-blocking listening socket.
+     * @return false (with a message on stderr) if any step fails
+     */
+    bool listen(int port);
+
+    /** Run the reactor until stop() is called. */
+    void run();
+
+    /** Ask run() to return. Safe to call from any thread. */
+    void stop();
+
+    /**
+     * Send one frame (length prefix + payload) on the connection. When
+     * nothing is queued the frame is written directly from payload and
+     * only an unsent tail is copied. Frames queued while the socket is
+     * full go out together in one sendmsg() on EPOLLOUT.
+     * @return false if fd is not a connection owned by this loop
+     */
+    bool send(int fd, std::string_view payload);
+
+    /** True if fd is a live connection of this loop. */
+    bool owns(int fd) const { return find(fd) != nullptr; }
+
+    /** Force-close a connection; the close callback still runs. */
+    void disconnect(int fd);
+
+    /** Bytes queued on fd that the socket has not accepted yet (0 if unknown). */
+    size_t pendingBytes(int fd) const;
+
+    size_t connectionCount() const;
+
+private:
+    struct Connection {
+        int fd = -1;
+        std::string peer;
+        std::string inBuffer;
+        size_t discardRemaining = 0;  ///< Bytes left of an oversized frame
+
+        std::mutex outMutex;
+        FrameQueue outQueue;
+        bool broken = false;
+    };
+
+    void acceptAll();
+    void handleReadable(const std::shared_ptr<Connection>& conn);
+    bool flush(Connection& conn);
+    void closeConnection(int fd);
+    std::shared_ptr<Connection> find(int fd) const;
+
+    MessageCallback onMessage_;
+    CloseCallback onClose_;
+    Options options_;
+
+    int epollFd_ = -1;
+    int listenFd_ = -1;
+    int wakeFd_ = -1;
+    std::atomic<bool> running_{false};
+
+    mutable std::mutex connectionsMutex_;
+    std::unordered_map<int, std::shared_ptr<Connection>> connections_;
+};
+
+} // namespace network
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_NETWORK_EVENT_LOOP_H
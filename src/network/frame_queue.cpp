@@ -0,0 +1,155 @@
+#include "src/network/frame_queue.h"
+
+#include <cerrno>
+#include <climits>
+#include <cstring>
+
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+namespace english_learning {
+namespace network {
+
+namespace {
+
+constexpr size_t FRAME_HEADER = sizeof(uint32_t);
+
+// Two iovecs (prefix + body) per frame
+constexpr size_t MAX_IOV = IOV_MAX < 128 ? IOV_MAX : 128;
+
+ssize_t sendVector(int fd, struct iovec* iov, size_t count, int flags) {
+    struct msghdr msg;
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = iov;
+    msg.msg_iovlen = count;
+    return sendmsg(fd, &msg, flags | MSG_NOSIGNAL);
+}
+
+} // namespace
+
+void FrameQueue::push(std::string payload) {
+    Frame frame;
+    frame.header = htonl(static_cast<uint32_t>(payload.size()));
+    frame.payload = std::move(payload);
+    pendingBytes_ += FRAME_HEADER + frame.payload.size();
+    frames_.push_back(std::move(frame));
+}
+
+FrameQueue::FlushResult FrameQueue::send(int fd, std::string_view payload) {
+    if (!frames_.empty()) {
+        push(std::string(payload));
+        return flush(fd);
+    }
+
+    uint32_t header = htonl(static_cast<uint32_t>(payload.size()));
+    struct iovec iov[2];
+    iov[0].iov_base = &header;
+    iov[0].iov_len = FRAME_HEADER;
+    iov[1].iov_base = const_cast<char*>(payload.data());
+    iov[1].iov_len = payload.size();
+
+    ssize_t n;
+    do {
+        n = sendVector(fd, iov, 2, MSG_DONTWAIT);
+        syscalls_++;
+    } while (n < 0 && errno == EINTR);
+
+    size_t written = 0;
+    if (n < 0) {
+        if (errno != EAGAIN && errno != EWOULDBLOCK) return FlushResult::Error;
+    } else {
+        written = static_cast<size_t>(n);
+    }
+    if (written == FRAME_HEADER + payload.size()) return FlushResult::Done;
+
+    // Keep the unsent tail; EPOLLOUT resumes it from headOffset_
+    push(std::string(payload));
+    headOffset_ = written;
+    pendingBytes_ -= written;
+    return FlushResult::WouldBlock;
+}
+
+FrameQueue::FlushResult FrameQueue::flush(int fd) {
+    struct iovec iov[MAX_IOV];
+
+    while (!frames_.empty()) {
+        // Gather as many frames as fit, skipping what the last call wrote
+        size_t count = 0;
+        size_t skip = headOffset_;
+        for (auto it = frames_.begin(); it != frames_.end() && count + 2 <= MAX_IOV; ++it) {
+            const char* header = reinterpret_cast<const char*>(&it->header);
+            if (skip < FRAME_HEADER) {
+                iov[count].iov_base = const_cast<char*>(header + skip);
+                iov[count].iov_len = FRAME_HEADER - skip;
+                count++;
+                skip = 0;
+            } else {
+                skip -= FRAME_HEADER;
+            }
+            if (it->payload.size() > skip) {
+                iov[count].iov_base = const_cast<char*>(it->payload.data() + skip);
+                iov[count].iov_len = it->payload.size() - skip;
+                count++;
+            }
+            skip = 0;
+        }
+
+        ssize_t n = sendVector(fd, iov, count, MSG_DONTWAIT);
+        syscalls_++;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return FlushResult::WouldBlock;
+            return FlushResult::Error;
+        }
+
+        // Retire fully written frames and remember the partial offset
+        size_t written = static_cast<size_t>(n);
+        pendingBytes_ -= written;
+        while (written > 0) {
+            size_t frameSize = FRAME_HEADER + frames_.front().payload.size();
+            size_t remaining = frameSize - headOffset_;
+            if (written < remaining) {
+                headOffset_ += written;
+                break;
+            }
+            written -= remaining;
+            headOffset_ = 0;
+            frames_.pop_front();
+        }
+    }
+    return FlushResult::Done;
+}
+
+bool FrameQueue::writeFrame(int fd, std::string_view payload) {
+    uint32_t header = htonl(static_cast<uint32_t>(payload.size()));
+    size_t total = FRAME_HEADER + payload.size();
+    size_t offset = 0;
+
+    while (offset < total) {
+        struct iovec iov[2];
+        size_t count = 0;
+        if (offset < FRAME_HEADER) {
+            iov[count].iov_base = reinterpret_cast<char*>(&header) + offset;
+            iov[count].iov_len = FRAME_HEADER - offset;
+            count++;
+        }
+        size_t bodyOffset = offset > FRAME_HEADER ? offset - FRAME_HEADER : 0;
+        if (payload.size() > bodyOffset) {
+            iov[count].iov_base = const_cast<char*>(payload.data() + bodyOffset);
+            iov[count].iov_len = payload.size() - bodyOffset;
+            count++;
+        }
+
+        ssize_t n = sendVector(fd, iov, count, 0);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        offset += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // namespace network
+} // namespace english_learning
@@ -0,0 +1,73 @@
+#ifndef ENGLISH_LEARNING_NETWORK_FRAME_QUEUE_H
+#define ENGLISH_LEARNING_NETWORK_FRAME_QUEUE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+
+namespace english_learning {
+namespace network {
+
+/**
+ * Outbound frames of one connection, written with vectored I/O.
+ *
+ * Each frame is a 4-byte big-endian length prefix followed by the payload.
+ * flush() gathers the prefix and body of as many queued frames as fit in
+ * one iovec array and hands them to a single sendmsg() call, resuming
+ * exactly where a partial write stopped.
+ *
+ * Not thread-safe; the owner serialises access.
+ */
+class FrameQueue {
+public:
+    enum class FlushResult {
+        Done,        ///< Everything queued has been written
+        WouldBlock,  ///< Socket buffer full; retry when writable
+        Error        ///< Connection is broken
+    };
+
+    void push(std::string payload);
+
+    /**
+     * Write a frame straight from the caller's buffer when nothing is
+     * queued ahead of it; only the part the socket did not take is copied
+     * into the queue. With frames already pending it behaves like push()
+     * followed by flush().
+     */
+    FlushResult send(int fd, std::string_view payload);
+
+    /** Write without blocking (MSG_DONTWAIT) until drained or EAGAIN. */
+    FlushResult flush(int fd);
+
+    bool empty() const { return frames_.empty(); }
+    size_t pendingFrames() const { return frames_.size(); }
+    size_t pendingBytes() const { return pendingBytes_; }
+
+    /** Number of sendmsg() calls issued so far. */
+    uint64_t syscalls() const { return syscalls_; }
+
+    /**
+     * Write a single frame to a blocking socket with one sendmsg() per
+     * attempt, looping over partial writes.
+     * @return false if the connection failed
+     */
+    static bool writeFrame(int fd, std::string_view payload);
+
+private:
+    struct Frame {
+        uint32_t header;      ///< Length prefix in network byte order
+        std::string payload;
+    };
+
+    std::deque<Frame> frames_;
+    size_t headOffset_ = 0;   ///< Bytes of frames_.front() already written
+    size_t pendingBytes_ = 0;
+    uint64_t syscalls_ = 0;
+};
+
+} // namespace network
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_NETWORK_FRAME_QUEUE_H
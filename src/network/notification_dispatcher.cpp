@@ -0,0 +1,331 @@
+#include "src/network/notification_dispatcher.h"
+
+#include <unordered_set>
+#include <utility>
+
+namespace english_learning {
+namespace network {
+
+namespace {
+
+// Frames delivered to one user before moving on to the next, for fairness
+constexpr size_t DELIVERY_BUDGET = 64;
+
+} // namespace
+
+bool parseSlowConsumerPolicy(std::string_view name, SlowConsumerPolicy& policy) {
+    if (name == "drop") {
+        policy = SlowConsumerPolicy::Drop;
+    } else if (name == "coalesce") {
+        policy = SlowConsumerPolicy::Coalesce;
+    } else if (name == "disconnect") {
+        policy = SlowConsumerPolicy::Disconnect;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+NotificationDispatcher::NotificationDispatcher(SendFn send, BacklogFn backlog,
+                                               DisconnectFn disconnect, Options options)
+    : send_(std::move(send)),
+      backlog_(std::move(backlog)),
+      disconnect_(std::move(disconnect)),
+      options_(options) {
+    if (options_.queueCapacity == 0) options_.queueCapacity = 1;
+    thread_ = std::thread(&NotificationDispatcher::deliverLoop, this);
+}
+
+NotificationDispatcher::~NotificationDispatcher() {
+    stop();
+}
+
+NotificationDispatcher::Result NotificationDispatcher::notify(const std::string& userId,
+                                                              std::string payload,
+                                                              std::string coalesceKey,
+                                                              bool spool) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_.notified++;
+
+    auto it = recipients_.find(userId);
+    bool online = it != recipients_.end() && it->second.fd >= 0 && !it->second.disconnecting;
+    Item item{std::move(payload), std::move(coalesceKey), spool};
+    if (online) {
+        enqueueLocked(userId, it->second, std::move(item));
+        return Result::Queued;
+    }
+    if (!spool || options_.spoolCapacity == 0) {
+        return Result::Offline;
+    }
+    if (it == recipients_.end()) {
+        it = recipients_.emplace(userId, Recipient()).first;
+    }
+    spoolLocked(it->second, std::move(item));
+    return Result::Spooled;
+}
+
+void NotificationDispatcher::enqueueLocked(const std::string& userId, Recipient& recipient,
+                                           Item item) {
+    if (recipient.queue.size() >= options_.queueCapacity) {
+        switch (options_.policy) {
+        case SlowConsumerPolicy::Drop:
+            recipient.queue.pop_front();
+            stats_.dropped++;
+            break;
+        case SlowConsumerPolicy::Coalesce:
+            recipient.queue.push_back(std::move(item));
+            coalesceLocked(recipient.queue);
+            while (recipient.queue.size() > options_.queueCapacity) {
+                recipient.queue.pop_front();
+                stats_.dropped++;
+            }
+            scheduleLocked(userId, recipient);
+            return;
+        case SlowConsumerPolicy::Disconnect:
+            // What can wait for the next login goes to the spool; the
+            // delivery thread closes the connection
+            recipient.queue.push_back(std::move(item));
+            recipient.disconnecting = true;
+            for (auto& queued : recipient.queue) {
+                if (queued.spool) {
+                    spoolLocked(recipient, std::move(queued));
+                } else {
+                    stats_.dropped++;
+                }
+            }
+            recipient.queue.clear();
+            scheduleLocked(userId, recipient);
+            return;
+        }
+    }
+    recipient.queue.push_back(std::move(item));
+    scheduleLocked(userId, recipient);
+}
+
+void NotificationDispatcher::spoolLocked(Recipient& recipient, Item item) {
+    if (options_.spoolCapacity == 0) {
+        stats_.dropped++;
+        return;
+    }
+    // Only the latest state of a keyed notification is worth replaying
+    if (!item.coalesceKey.empty()) {
+        for (auto it = recipient.spool.begin(); it != recipient.spool.end(); ++it) {
+            if (it->coalesceKey == item.coalesceKey) {
+                recipient.spool.erase(it);
+                stats_.coalesced++;
+                break;
+            }
+        }
+    }
+    if (recipient.spool.size() >= options_.spoolCapacity) {
+        recipient.spool.pop_front();
+        stats_.dropped++;
+    }
+    recipient.spool.push_back(std::move(item));
+    stats_.spooled++;
+}
+
+void NotificationDispatcher::coalesceLocked(std::deque<Item>& queue) {
+    // Keep the newest notification of each key, preserving queue order
+    std::unordered_set<std::string> seen;
+    std::deque<Item> kept;
+    size_t removed = 0;
+    for (auto it = queue.rbegin(); it != queue.rend(); ++it) {
+        if (!it->coalesceKey.empty() && !seen.insert(it->coalesceKey).second) {
+            removed++;
+            continue;
+        }
+        kept.push_front(std::move(*it));
+    }
+    queue.swap(kept);
+    stats_.coalesced += removed;
+}
+
+void NotificationDispatcher::scheduleLocked(const std::string& userId, Recipient& recipient) {
+    if (recipient.scheduled) return;
+    recipient.scheduled = true;
+    ready_.push_back(userId);
+    wake_.notify_one();
+}
+
+void NotificationDispatcher::goOfflineLocked(Recipient& recipient) {
+    recipient.fd = -1;
+    recipient.disconnecting = false;
+    for (auto& item : recipient.queue) {
+        if (item.spool) {
+            spoolLocked(recipient, std::move(item));
+        } else {
+            stats_.dropped++;
+        }
+    }
+    recipient.queue.clear();
+}
+
+void NotificationDispatcher::attach(const std::string& userId, int fd) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // fd was reused without a detach: its previous user is offline now
+    auto previous = userByFd_.find(fd);
+    if (previous != userByFd_.end() && previous->second != userId) {
+        auto old = recipients_.find(previous->second);
+        if (old != recipients_.end() && old->second.fd == fd) goOfflineLocked(old->second);
+    }
+
+    Recipient& recipient = recipients_[userId];
+    if (recipient.fd >= 0 && recipient.fd != fd) {
+        // Logged in again from another connection: only the newest one gets pushes
+        userByFd_.erase(recipient.fd);
+    }
+    recipient.fd = fd;
+    recipient.disconnecting = false;
+    userByFd_[fd] = userId;
+
+    // Spooled notifications are older than anything queued since
+    while (!recipient.spool.empty()) {
+        recipient.queue.push_front(std::move(recipient.spool.back()));
+        recipient.spool.pop_back();
+    }
+    if (!recipient.queue.empty()) scheduleLocked(userId, recipient);
+}
+
+void NotificationDispatcher::detach(int fd) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    idle_.wait(lock, [this, fd] { return sendingFd_ != fd; });
+
+    auto it = userByFd_.find(fd);
+    if (it == userByFd_.end()) return;
+    std::string userId = std::move(it->second);
+    userByFd_.erase(it);
+
+    auto recipient = recipients_.find(userId);
+    if (recipient == recipients_.end() || recipient->second.fd != fd) return;
+    goOfflineLocked(recipient->second);
+    if (recipient->second.spool.empty() && !recipient->second.scheduled) {
+        recipients_.erase(recipient);
+    }
+}
+
+void NotificationDispatcher::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (stopping_) return;
+        stopping_ = true;
+    }
+    wake_.notify_one();
+    if (thread_.joinable()) thread_.join();
+}
+
+NotificationDispatcher::Stats NotificationDispatcher::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats s = stats_;
+    s.queued = 0;
+    for (const auto& pair : recipients_) s.queued += pair.second.queue.size();
+    return s;
+}
+
+void NotificationDispatcher::deliverLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto lastRetry = std::chrono::steady_clock::now();
+    for (;;) {
+        auto hasWork = [this] { return stopping_ || !ready_.empty(); };
+        if (paused_.empty()) {
+            wake_.wait(lock, hasWork);
+        } else {
+            wake_.wait_until(lock, lastRetry + options_.retryInterval, hasWork);
+        }
+        if (stopping_) break;
+
+        // Backed-up connections get another chance once per retry interval
+        auto now = std::chrono::steady_clock::now();
+        if (!paused_.empty() && now - lastRetry >= options_.retryInterval) {
+            ready_.insert(ready_.end(), paused_.begin(), paused_.end());
+            paused_.clear();
+            lastRetry = now;
+        }
+
+        std::vector<std::string> batch;
+        batch.swap(ready_);
+        for (const auto& userId : batch) {
+            if (stopping_) break;
+            deliverLocked(lock, userId);
+
+            auto it = recipients_.find(userId);
+            if (it != recipients_.end() && it->second.fd < 0 && it->second.queue.empty() &&
+                it->second.spool.empty() && !it->second.scheduled) {
+                recipients_.erase(it);
+            }
+        }
+    }
+}
+
+void NotificationDispatcher::deliverLocked(std::unique_lock<std::mutex>& lock,
+                                           const std::string& userId) {
+    auto it = recipients_.find(userId);
+    if (it == recipients_.end()) return;
+    it->second.scheduled = false;
+    const int fd = it->second.fd;
+    if (fd < 0) return;
+
+    if (it->second.disconnecting) {
+        sendingFd_ = fd;
+        lock.unlock();
+        disconnect_(fd);
+        lock.lock();
+        sendingFd_ = -1;
+        idle_.notify_all();
+        stats_.disconnects++;
+        return;  // detach() follows once the connection has closed
+    }
+
+    for (size_t sent = 0; sent < DELIVERY_BUDGET; sent++) {
+        // Look the user up again after every write: while unlocked they may
+        // have gone offline or moved to another connection
+        it = recipients_.find(userId);
+        if (it == recipients_.end()) return;
+        Recipient& recipient = it->second;
+        if (recipient.fd != fd || recipient.disconnecting || recipient.queue.empty()) return;
+
+        Item item = std::move(recipient.queue.front());
+        recipient.queue.pop_front();
+
+        sendingFd_ = fd;
+        lock.unlock();
+        bool backedUp = backlog_(fd) >= options_.maxBacklogBytes;
+        bool delivered = !backedUp && send_(fd, item.payload);
+        lock.lock();
+        sendingFd_ = -1;
+        idle_.notify_all();
+
+        if (delivered) {
+            stats_.delivered++;
+            continue;
+        }
+
+        it = recipients_.find(userId);
+        if (it == recipients_.end()) return;
+        Recipient& latest = it->second;
+        if (latest.fd >= 0) {
+            latest.queue.push_front(std::move(item));
+        } else if (item.spool) {
+            spoolLocked(latest, std::move(item));
+        } else {
+            stats_.dropped++;
+        }
+        // Not delivered and not backed up: the connection is closing and
+        // detach() will spool what is left
+        if (backedUp && latest.fd == fd && !latest.scheduled) {
+            latest.scheduled = true;
+            paused_.push_back(userId);
+        }
+        return;
+    }
+
+    // Budget used up: let other users go first
+    it = recipients_.find(userId);
+    if (it != recipients_.end() && it->second.fd >= 0 && !it->second.queue.empty()) {
+        scheduleLocked(userId, it->second);
+    }
+}
+
+} // namespace network
+} // namespace english_learning
@@ -0,0 +1,157 @@
+#ifndef ENGLISH_LEARNING_NETWORK_NOTIFICATION_DISPATCHER_H
+#define ENGLISH_LEARNING_NETWORK_NOTIFICATION_DISPATCHER_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace english_learning {
+namespace network {
+
+/** What to do when an online recipient's queue is full. */
+enum class SlowConsumerPolicy : uint8_t {
+    Drop,        ///< Drop the oldest queued notification
+    Coalesce,    ///< Keep only the newest queued notification per key, then drop the oldest
+    Disconnect   ///< Close the connection; spoolable notifications wait for the next login
+};
+
+/** Parse "drop", "coalesce" or "disconnect"; false if unknown. */
+bool parseSlowConsumerPolicy(std::string_view name, SlowConsumerPolicy& policy);
+
+/**
+ * Server-initiated messages (pushes) to users, decoupled from the handlers
+ * that produce them.
+ *
+ * notify() only appends to the recipient's bounded queue under the
+ * dispatcher's own lock, so a handler never touches another user's socket.
+ * A single delivery thread hands queued frames to each connection's
+ * outbound writer and stops feeding a connection whose writer already
+ * holds more than maxBacklogBytes, retrying it every retryInterval; the
+ * queue then fills up and the slow-consumer policy decides what gives.
+ *
+ * Users are online between attach() and detach(). Notifications marked
+ * spoolable that arrive while a user is offline, or are still queued
+ * when the connection goes away, are kept (up to spoolCapacity per user)
+ * and delivered right after the next attach().
+ */
+class NotificationDispatcher {
+public:
+    /** Hand one frame to the connection's writer; false if it is gone. */
+    using SendFn = std::function<bool(int fd, std::string_view payload)>;
+    /** Bytes the connection's writer holds that are not on the wire yet. */
+    using BacklogFn = std::function<size_t(int fd)>;
+    using DisconnectFn = std::function<void(int fd)>;
+
+    struct Options {
+        size_t queueCapacity = 256;            ///< Notifications queued per online user
+        size_t maxBacklogBytes = 256 * 1024;   ///< Per-connection writer backlog before pausing
+        SlowConsumerPolicy policy = SlowConsumerPolicy::Coalesce;
+        size_t spoolCapacity = 100;            ///< Kept per offline user, 0 = no spool
+        std::chrono::milliseconds retryInterval{50};  ///< Recheck of paused connections
+    };
+
+    enum class Result {
+        Queued,   ///< Recipient online; will be delivered
+        Spooled,  ///< Recipient offline; delivered on next login
+        Offline   ///< Recipient offline and the notification is not spoolable
+    };
+
+    struct Stats {
+        uint64_t notified = 0;     ///< notify() calls
+        uint64_t delivered = 0;    ///< Frames handed to a connection
+        uint64_t spooled = 0;      ///< Notifications put in an offline spool
+        uint64_t dropped = 0;      ///< Lost to a full queue or spool
+        uint64_t coalesced = 0;    ///< Superseded by a newer notification
+        uint64_t disconnects = 0;  ///< Connections closed by the Disconnect policy
+        size_t queued = 0;         ///< Waiting in online queues right now
+    };
+
+    NotificationDispatcher(SendFn send, BacklogFn backlog, DisconnectFn disconnect,
+                           Options options);
+    NotificationDispatcher(SendFn send, BacklogFn backlog, DisconnectFn disconnect)
+        : NotificationDispatcher(std::move(send), std::move(backlog), std::move(disconnect),
+                                 Options()) {}
+    ~NotificationDispatcher();
+
+    NotificationDispatcher(const NotificationDispatcher&) = delete;
+    NotificationDispatcher& operator=(const NotificationDispatcher&) = delete;
+
+    /**
+     * Queue a frame for userId. Never blocks on I/O.
+     * @param coalesceKey notifications sharing a non-empty key describe the
+     *        same thing (e.g. one call's state); a newer one may replace
+     *        older ones that are still queued
+     * @param spool keep it for the next login if the user is offline
+     */
+    Result notify(const std::string& userId, std::string payload,
+                  std::string coalesceKey = std::string(), bool spool = false);
+
+    /** userId is now reachable on fd; its spool is delivered first. */
+    void attach(const std::string& userId, int fd);
+
+    /**
+     * fd is closing: its user goes offline. Returns once no frame is being
+     * written to fd, so the caller may close() it afterwards.
+     */
+    void detach(int fd);
+
+    /** Stop the delivery thread; queued notifications are discarded. */
+    void stop();
+
+    Stats stats() const;
+
+private:
+    struct Item {
+        std::string payload;
+        std::string coalesceKey;
+        bool spool = false;
+    };
+
+    struct Recipient {
+        int fd = -1;
+        std::deque<Item> queue;   ///< Waiting for delivery while online
+        std::deque<Item> spool;   ///< Waiting for the next attach()
+        bool scheduled = false;   ///< Listed in ready_
+        bool disconnecting = false;
+    };
+
+    void enqueueLocked(const std::string& userId, Recipient& recipient, Item item);
+    void spoolLocked(Recipient& recipient, Item item);
+    void coalesceLocked(std::deque<Item>& queue);
+    void scheduleLocked(const std::string& userId, Recipient& recipient);
+    void goOfflineLocked(Recipient& recipient);
+    void deliverLoop();
+    void deliverLocked(std::unique_lock<std::mutex>& lock, const std::string& userId);
+
+    SendFn send_;
+    BacklogFn backlog_;
+    DisconnectFn disconnect_;
+    Options options_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable wake_;     ///< Delivery thread waits here
+    std::condition_variable idle_;     ///< detach() waits here for sendingFd_
+    std::unordered_map<std::string, Recipient> recipients_;
+    std::unordered_map<int, std::string> userByFd_;
+    std::vector<std::string> ready_;   ///< Users with something to deliver
+    std::vector<std::string> paused_;  ///< Users whose connection is backed up
+    int sendingFd_ = -1;               ///< fd the delivery thread is writing to
+    bool stopping_ = false;
+
+    Stats stats_;
+    std::thread thread_;
+};
+
+} // namespace network
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_NETWORK_NOTIFICATION_DISPATCHER_H
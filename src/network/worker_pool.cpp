@@ -0,0 +1,163 @@
+#include "src/network/worker_pool.h"
+
+#include <exception>
+#include <iostream>
+
+namespace english_learning {
+namespace network {
+
+namespace {
+
+// Tasks a drain job runs for one key before yielding to other connections
+constexpr int MAX_BATCH = 16;
+
+} // namespace
+
+WorkerPool::WorkerPool(size_t threads, size_t capacity)
+    : capacity_(capacity) {
+    if (threads == 0) threads = 1;
+    for (size_t i = 0; i < threads; i++) {
+        workers_.push_back(std::make_unique<Worker>());
+    }
+    for (size_t i = 0; i < threads; i++) {
+        threads_.emplace_back(&WorkerPool::workerLoop, this, i);
+    }
+}
+
+WorkerPool::~WorkerPool() {
+    shutdown();
+}
+
+bool WorkerPool::submit(uint64_t key, Task task, bool force) {
+    if (stopping_) return false;
+
+    if (inFlight_.fetch_add(1) >= capacity_ && !force) {
+        inFlight_--;
+        rejected_++;
+        return false;
+    }
+    submitted_++;
+
+    bool schedule = false;
+    {
+        std::lock_guard<std::mutex> lock(strandsMutex_);
+        Strand& strand = strands_[key];
+        strand.pending.push_back(std::move(task));
+        if (!strand.scheduled) {
+            strand.scheduled = true;
+            schedule = true;
+        }
+    }
+
+    if (schedule) {
+        enqueue([this, key] { drain(key); });
+    }
+    return true;
+}
+
+void WorkerPool::shutdown() {
+    stopping_ = true;
+    {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+    }
+    idle_.notify_all();
+    for (auto& thread : threads_) {
+        if (thread.joinable()) thread.join();
+    }
+}
+
+WorkerPool::Stats WorkerPool::stats() const {
+    Stats s;
+    s.workers = workers_.size();
+    s.queueDepth = inFlight_.load();
+    s.submitted = submitted_.load();
+    s.completed = completed_.load();
+    s.rejected = rejected_.load();
+    s.steals = steals_.load();
+    return s;
+}
+
+void WorkerPool::enqueue(Task job) {
+    size_t index = nextWorker_++ % workers_.size();
+    queuedJobs_++;
+    {
+        std::lock_guard<std::mutex> lock(workers_[index]->mutex);
+        workers_[index]->jobs.push_back(std::move(job));
+    }
+    {
+        std::lock_guard<std::mutex> lock(idleMutex_);
+    }
+    idle_.notify_one();
+}
+
+bool WorkerPool::tryTake(size_t self, Task& job) {
+    {
+        Worker& own = *workers_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.jobs.empty()) {
+            job = std::move(own.jobs.front());
+            own.jobs.pop_front();
+            queuedJobs_--;
+            return true;
+        }
+    }
+
+    for (size_t i = 1; i < workers_.size(); i++) {
+        Worker& victim = *workers_[(self + i) % workers_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.jobs.empty()) {
+            job = std::move(victim.jobs.back());
+            victim.jobs.pop_back();
+            queuedJobs_--;
+            steals_++;
+            return true;
+        }
+    }
+    return false;
+}
+
+void WorkerPool::drain(uint64_t key) {
+    for (int i = 0; i < MAX_BATCH; i++) {
+        Task task;
+        {
+            std::lock_guard<std::mutex> lock(strandsMutex_);
+            auto it = strands_.find(key);
+            if (it->second.pending.empty()) {
+                strands_.erase(it);
+                return;
+            }
+            task = std::move(it->second.pending.front());
+            it->second.pending.pop_front();
+        }
+
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "[ERROR] Unhandled exception in worker: " << e.what() << std::endl;
+        }
+        completed_++;
+        inFlight_--;
+    }
+
+    // Still busy: requeue so other connections get a turn
+    enqueue([this, key] { drain(key); });
+}
+
+void WorkerPool::workerLoop(size_t self) {
+    while (true) {
+        Task job;
+        if (tryTake(self, job)) {
+            job();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(idleMutex_);
+        idle_.wait(lock, [this] { return queuedJobs_ > 0 || stopping_; });
+        if (stopping_ && queuedJobs_ == 0) {
+            return;
+        }
+    }
+}
+
+} // namespace network
+} // namespace english_learning
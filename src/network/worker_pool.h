@@ -0,0 +1,99 @@
+#ifndef ENGLISH_LEARNING_NETWORK_WORKER_POOL_H
+#define ENGLISH_LEARNING_NETWORK_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace english_learning {
+namespace network {
+
+/**
+ * Fixed-size work-stealing executor for request handlers.
+ *
+ * Every worker owns a deque; submissions are spread round-robin and an idle
+ * worker steals from the back of its siblings. Tasks submitted with the
+ * same key (the connection fd) run one at a time in submission order.
+ * The number of accepted-but-unfinished tasks is capped so a flood of
+ * requests cannot queue unbounded work.
+ */
+class WorkerPool {
+public:
+    using Task = std::function<void()>;
+
+    struct Stats {
+        size_t workers = 0;
+        size_t queueDepth = 0;    ///< Accepted tasks not yet finished
+        uint64_t submitted = 0;
+        uint64_t completed = 0;
+        uint64_t rejected = 0;    ///< Refused because the pool was full
+        uint64_t steals = 0;      ///< Jobs taken from another worker's deque
+    };
+
+    WorkerPool(size_t threads, size_t capacity);
+    ~WorkerPool();
+
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    /**
+     * Run task after every earlier task submitted with the same key.
+     * @param force accept even when the pool is at capacity (cleanup work)
+     * @return false if the pool is full or shutting down
+     */
+    bool submit(uint64_t key, Task task, bool force = false);
+
+    /** Stop accepting work, drain what is queued and join the workers. */
+    void shutdown();
+
+    Stats stats() const;
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<Task> jobs;
+    };
+
+    /** Tasks waiting for their turn on one key. */
+    struct Strand {
+        std::deque<Task> pending;
+        bool scheduled = false;
+    };
+
+    void enqueue(Task job);
+    bool tryTake(size_t self, Task& job);
+    void drain(uint64_t key);
+    void workerLoop(size_t self);
+
+    size_t capacity_;
+    std::vector<std::unique_ptr<Worker>> workers_;
+    std::vector<std::thread> threads_;
+
+    std::mutex strandsMutex_;
+    std::unordered_map<uint64_t, Strand> strands_;
+
+    std::mutex idleMutex_;
+    std::condition_variable idle_;
+    std::atomic<size_t> queuedJobs_{0};
+    std::atomic<bool> stopping_{false};
+    std::atomic<size_t> nextWorker_{0};
+
+    std::atomic<size_t> inFlight_{0};
+    std::atomic<uint64_t> submitted_{0};
+    std::atomic<uint64_t> completed_{0};
+    std::atomic<uint64_t> rejected_{0};
+    std::atomic<uint64_t> steals_{0};
+};
+
+} // namespace network
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_NETWORK_WORKER_POOL_H
@@ -0,0 +1,247 @@
+#include "include/protocol/json_document.h"
+
+#include <algorithm>
+#include <charconv>
+
+#include "include/protocol/json_parser.h"
+#include "include/protocol/json_scanner.h"
+
+namespace english_learning {
+namespace protocol {
+
+namespace {
+
+// Deeper nesting than any protocol message is treated as malformed
+constexpr int MAX_DEPTH = 64;
+
+inline bool isWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+} // namespace
+
+// ============================================================================
+// JsonValue
+// ============================================================================
+
+JsonType JsonValue::type() const {
+    if (!doc_) return JsonType::Missing;
+    return doc_->tokens_[index_].type;
+}
+
+std::string_view JsonValue::raw() const {
+    if (!doc_) return std::string_view();
+    const auto& token = doc_->tokens_[index_];
+    return doc_->json_.substr(token.start, token.length);
+}
+
+std::string JsonValue::unescaped() const {
+    return JsonParser::unescape(str());
+}
+
+int JsonValue::asInt(int defaultValue) const {
+    std::string_view text = raw();
+    if (text.empty()) return defaultValue;
+    int value = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+    if (result.ec != std::errc()) return defaultValue;
+    return value;
+}
+
+bool JsonValue::asBool(bool defaultValue) const {
+    std::string_view text = raw();
+    if (text == "true") return true;
+    if (text == "false") return false;
+    return defaultValue;
+}
+
+JsonValue JsonValue::operator[](std::string_view key) const {
+    if (type() != JsonType::Object) return JsonValue();
+
+    const auto& tokens = doc_->tokens_;
+    uint32_t i = index_ + 1;
+    for (uint32_t member = 0; member < tokens[index_].count; member++) {
+        uint32_t valueIndex = i + 1;
+        if (valueIndex >= tokens.size()) break;
+        const auto& keyToken = tokens[i];
+        if (doc_->json_.substr(keyToken.start, keyToken.length) == key) {
+            return JsonValue(doc_, valueIndex);
+        }
+        i = tokens[valueIndex].next;
+    }
+    return JsonValue();
+}
+
+JsonValue JsonValue::at(size_t index) const {
+    if (type() != JsonType::Array || index >= doc_->tokens_[index_].count) {
+        return JsonValue();
+    }
+    uint32_t i = index_ + 1;
+    for (size_t n = 0; n < index; n++) {
+        i = doc_->tokens_[i].next;
+    }
+    return JsonValue(doc_, i);
+}
+
+size_t JsonValue::size() const {
+    JsonType t = type();
+    if (t != JsonType::Object && t != JsonType::Array) return 0;
+    return doc_->tokens_[index_].count;
+}
+
+JsonValue::Iterator& JsonValue::Iterator::operator++() {
+    index_ = doc_->tokens_[index_].next;
+    remaining_--;
+    return *this;
+}
+
+JsonValue::Iterator JsonValue::begin() const {
+    if (type() != JsonType::Array) return end();
+    return Iterator(doc_, index_ + 1, doc_->tokens_[index_].count);
+}
+
+// ============================================================================
+// JsonDocument
+// ============================================================================
+
+JsonDocument::JsonDocument(std::string_view json) : json_(json) {
+    // Rough upper bound: messages average well over 8 bytes per token
+    tokens_.reserve(json.size() / 8 + 4);
+
+    JsonScanner scanner(json_);
+    size_t pos = 0;
+    skipWhitespace(pos);
+    if (pos >= json_.size()) return;
+
+    valid_ = parseValue(scanner, pos, 0);
+    if (valid_) {
+        skipWhitespace(pos);
+        valid_ = pos == json_.size() && scanner.next() == JsonScanner::npos;
+    }
+}
+
+JsonValue JsonDocument::root() const {
+    if (tokens_.empty()) return JsonValue();
+    return JsonValue(this, 0);
+}
+
+JsonValue JsonDocument::find(std::string_view key) const {
+    for (uint32_t i = 0; i + 1 < tokens_.size(); i++) {
+        const auto& token = tokens_[i];
+        if (token.type == JsonType::Key && json_.substr(token.start, token.length) == key) {
+            return JsonValue(this, i + 1);
+        }
+    }
+    return JsonValue();
+}
+
+void JsonDocument::skipWhitespace(size_t& pos) const {
+    while (pos < json_.size() && isWhitespace(json_[pos])) pos++;
+}
+
+bool JsonDocument::onlyWhitespace(size_t from, size_t to) const {
+    for (size_t i = from; i < to; i++) {
+        if (!isWhitespace(json_[i])) return false;
+    }
+    return true;
+}
+
+bool JsonDocument::parseValue(JsonScanner& scanner, size_t& pos, int depth) {
+    skipWhitespace(pos);
+    if (pos >= json_.size()) return false;
+
+    char c = json_[pos];
+    if (c == '{' || c == '[') {
+        if (scanner.next() != pos) return false;
+        return parseContainer(scanner, pos, depth, c == '{');
+    }
+    if (c == '"') return parseString(scanner, pos, JsonType::String);
+
+    // Number, true, false or null: everything up to the next structural
+    // character, which the caller consumes
+    size_t end = std::min(scanner.peek(), json_.size());
+    size_t start = pos;
+    while (end > start && isWhitespace(json_[end - 1])) end--;
+    if (end == start) return false;
+
+    JsonType type = JsonType::Number;
+    if (c == 't' || c == 'f') type = JsonType::Bool;
+    else if (c == 'n') type = JsonType::Null;
+
+    uint32_t index = static_cast<uint32_t>(tokens_.size());
+    tokens_.push_back({type, static_cast<uint32_t>(start),
+                       static_cast<uint32_t>(end - start), index + 1, 0});
+    pos = end;
+    return true;
+}
+
+bool JsonDocument::parseString(JsonScanner& scanner, size_t& pos, JsonType type) {
+    // Inside a string the scanner reports nothing but the closing quote
+    if (scanner.next() != pos) return false;
+    size_t end = scanner.next();
+    if (end == JsonScanner::npos) return false;
+
+    size_t start = pos + 1;
+    uint32_t index = static_cast<uint32_t>(tokens_.size());
+    tokens_.push_back({type, static_cast<uint32_t>(start),
+                       static_cast<uint32_t>(end - start), index + 1, 0});
+    pos = end + 1;
+    return true;
+}
+
+bool JsonDocument::parseContainer(JsonScanner& scanner, size_t& pos, int depth, bool isObject) {
+    if (depth >= MAX_DEPTH) return false;
+
+    uint32_t index = static_cast<uint32_t>(tokens_.size());
+    size_t start = pos;
+    tokens_.push_back({isObject ? JsonType::Object : JsonType::Array,
+                       static_cast<uint32_t>(start), 0, 0, 0});
+    char close = isObject ? '}' : ']';
+    pos++;
+
+    // On error, close the container where parsing stopped so that what
+    // was read so far stays reachable
+    auto finish = [&](bool ok) {
+        size_t end = ok ? pos : json_.size();
+        tokens_[index].length = static_cast<uint32_t>(end - start);
+        tokens_[index].next = static_cast<uint32_t>(tokens_.size());
+        return ok;
+    };
+
+    size_t first = scanner.peek();
+    if (first != JsonScanner::npos && json_[first] == close && onlyWhitespace(pos, first)) {
+        scanner.next();
+        pos = first + 1;
+        return finish(true);
+    }
+
+    while (true) {
+        if (isObject) {
+            skipWhitespace(pos);
+            if (pos >= json_.size() || json_[pos] != '"') return finish(false);
+            if (!parseString(scanner, pos, JsonType::Key)) return finish(false);
+            size_t colon = scanner.next();
+            if (colon == JsonScanner::npos || json_[colon] != ':' ||
+                !onlyWhitespace(pos, colon)) {
+                return finish(false);
+            }
+            pos = colon + 1;
+        }
+
+        size_t before = tokens_.size();
+        bool ok = parseValue(scanner, pos, depth + 1);
+        if (tokens_.size() > before) tokens_[index].count++;
+        if (!ok) return finish(false);
+
+        size_t separator = scanner.next();
+        if (separator == JsonScanner::npos || !onlyWhitespace(pos, separator)) {
+            return finish(false);
+        }
+        pos = separator + 1;
+        if (json_[separator] == ',') continue;
+        return finish(json_[separator] == close);
+    }
+}
+
+} // namespace protocol
+} // namespace english_learning
@@ -1,33 +1,94 @@
 #include "include/protocol/json_parser.h"
 
+#include <cctype>
+
+#include "include/protocol/json_scanner.h"
+#include "include/protocol/json_writer.h"
+
 namespace english_learning {
 namespace protocol {
 
-std::string JsonParser::getValue(const std::string& json, const std::string& key) {
-    std::string searchKey = "\"" + key + "\"";
-    size_t keyPos = json.find(searchKey);
-    if (keyPos == std::string::npos) return "";
+namespace {
+
+inline bool isWhitespace(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+bool onlyWhitespace(const std::string& json, size_t from, size_t to) {
+    for (size_t i = from; i < to; i++) {
+        if (!isWhitespace(json[i])) return false;
+    }
+    return true;
+}
+
+/**
+ * Advance the scanner past the first member named key (at any depth, in
+ * text order) and return the position just after its ':', or npos.
+ * Strings that are values rather than member names never match.
+ */
+size_t findMember(const std::string& json, const std::string& key, JsonScanner& scanner) {
+    for (size_t pos = scanner.next(); pos != JsonScanner::npos; pos = scanner.next()) {
+        if (json[pos] != '"') continue;
+
+        size_t close = scanner.next();
+        if (close == JsonScanner::npos) return JsonScanner::npos;
+        if (close - pos - 1 != key.size() || json.compare(pos + 1, key.size(), key) != 0) {
+            continue;
+        }
+
+        size_t colon = scanner.peek();
+        if (colon != JsonScanner::npos && json[colon] == ':' &&
+            onlyWhitespace(json, close + 1, colon)) {
+            scanner.next();
+            return colon + 1;
+        }
+    }
+    return JsonScanner::npos;
+}
+
+/**
+ * Text of the first open..close container after the scanner's position,
+ * matched on structural characters only, or "" if there is none.
+ */
+std::string extractContainer(const std::string& json, JsonScanner& scanner,
+                             char open, char close) {
+    size_t start = scanner.next();
+    while (start != JsonScanner::npos && json[start] != open) {
+        start = scanner.next();
+    }
+    if (start == JsonScanner::npos) return "";
+
+    int depth = 1;
+    size_t end = json.size();
+    for (size_t pos = scanner.next(); pos != JsonScanner::npos; pos = scanner.next()) {
+        if (json[pos] == open) {
+            depth++;
+        } else if (json[pos] == close && --depth == 0) {
+            end = pos + 1;
+            break;
+        }
+    }
+    return json.substr(start, end - start);
+}
 
-    size_t colonPos = json.find(':', keyPos);
-    if (colonPos == std::string::npos) return "";
+} // namespace
 
-    size_t valueStart = colonPos + 1;
-    while (valueStart < json.length() &&
-           (json[valueStart] == ' ' || json[valueStart] == '\t' || json[valueStart] == '\n')) {
+std::string JsonParser::getValue(const std::string& json, const std::string& key) {
+    JsonScanner scanner(json);
+    size_t valueStart = findMember(json, key, scanner);
+    if (valueStart == JsonScanner::npos) return "";
+
+    while (valueStart < json.length() && isWhitespace(json[valueStart])) {
         valueStart++;
     }
 
     if (valueStart >= json.length()) return "";
 
     if (json[valueStart] == '"') {
-        size_t valueEnd = valueStart + 1;
-        while (valueEnd < json.length()) {
-            if (json[valueEnd] == '"' && json[valueEnd - 1] != '\\') {
-                break;
-            }
-            valueEnd++;
-        }
-        if (valueEnd < json.length()) {
+        // The opening quote is the next structural position, then the close
+        if (scanner.next() != valueStart) return "";
+        size_t valueEnd = scanner.next();
+        if (valueEnd != JsonScanner::npos) {
             return json.substr(valueStart + 1, valueEnd - valueStart - 1);
         }
     } else {
@@ -46,109 +107,59 @@ std::string JsonParser::getValue(const std::string& json, const std::string& key
 }
 
 std::string JsonParser::getObject(const std::string& json, const std::string& key) {
-    std::string searchKey = "\"" + key + "\"";
-    size_t keyPos = json.find(searchKey);
-    if (keyPos == std::string::npos) return "";
-
-    size_t colonPos = json.find(':', keyPos);
-    if (colonPos == std::string::npos) return "";
-
-    size_t bracePos = json.find('{', colonPos);
-    if (bracePos == std::string::npos) return "";
-
-    int braceCount = 1;
-    size_t endPos = bracePos + 1;
-    while (endPos < json.length() && braceCount > 0) {
-        if (json[endPos] == '{') braceCount++;
-        else if (json[endPos] == '}') braceCount--;
-        endPos++;
-    }
-
-    return json.substr(bracePos, endPos - bracePos);
+    JsonScanner scanner(json);
+    if (findMember(json, key, scanner) == JsonScanner::npos) return "";
+    return extractContainer(json, scanner, '{', '}');
 }
 
 std::string JsonParser::getArray(const std::string& json, const std::string& key) {
-    std::string searchKey = "\"" + key + "\"";
-    size_t keyPos = json.find(searchKey);
-    if (keyPos == std::string::npos) return "";
-
-    size_t colonPos = json.find(':', keyPos);
-    if (colonPos == std::string::npos) return "";
-
-    size_t bracketPos = json.find('[', colonPos);
-    if (bracketPos == std::string::npos) return "";
-
-    int bracketCount = 1;
-    size_t endPos = bracketPos + 1;
-    while (endPos < json.length() && bracketCount > 0) {
-        if (json[endPos] == '[') bracketCount++;
-        else if (json[endPos] == ']') bracketCount--;
-        endPos++;
-    }
-
-    return json.substr(bracketPos, endPos - bracketPos);
+    JsonScanner scanner(json);
+    if (findMember(json, key, scanner) == JsonScanner::npos) return "";
+    return extractContainer(json, scanner, '[', ']');
 }
 
 std::vector<std::string> JsonParser::parseArray(const std::string& arrayStr) {
     std::vector<std::string> result;
     if (arrayStr.empty() || arrayStr[0] != '[') return result;
 
-    size_t pos = 1;
-    while (pos < arrayStr.length()) {
-        // Skip whitespace and commas
-        while (pos < arrayStr.length() &&
-               (arrayStr[pos] == ' ' || arrayStr[pos] == '\n' ||
-                arrayStr[pos] == '\t' || arrayStr[pos] == ',')) {
-            pos++;
-        }
-
-        if (pos >= arrayStr.length() || arrayStr[pos] == ']') break;
-
-        if (arrayStr[pos] == '{') {
-            int braceCount = 1;
-            size_t start = pos;
-            pos++;
-            while (pos < arrayStr.length() && braceCount > 0) {
-                if (arrayStr[pos] == '{') braceCount++;
-                else if (arrayStr[pos] == '}') braceCount--;
-                pos++;
-            }
-            result.push_back(arrayStr.substr(start, pos - start));
-        } else if (arrayStr[pos] == '"') {
-            // Handle string array elements
-            size_t start = pos + 1;
-            pos++;
-            while (pos < arrayStr.length() &&
-                   !(arrayStr[pos] == '"' && arrayStr[pos - 1] != '\\')) {
-                pos++;
+    JsonScanner scanner(arrayStr);
+    scanner.next();  // the opening '['
+
+    // Objects and strings directly inside the array become elements;
+    // nested arrays and primitives are skipped
+    int depth = 1;
+    size_t elementStart = 0;
+    for (size_t pos = scanner.next(); pos != JsonScanner::npos; pos = scanner.next()) {
+        char c = arrayStr[pos];
+        if (c == '"') {
+            size_t close = scanner.next();
+            if (close == JsonScanner::npos) break;
+            if (depth == 1) {
+                result.push_back(arrayStr.substr(pos + 1, close - pos - 1));
             }
-            if (pos < arrayStr.length()) {
-                result.push_back(arrayStr.substr(start, pos - start));
-                pos++;
+        } else if (c == '{' || c == '[') {
+            if (depth == 1) elementStart = pos;
+            depth++;
+        } else if (c == '}' || c == ']') {
+            depth--;
+            if (depth == 0) break;
+            if (depth == 1 && c == '}' && arrayStr[elementStart] == '{') {
+                result.push_back(arrayStr.substr(elementStart, pos + 1 - elementStart));
             }
-        } else {
-            pos++;
         }
     }
+
+    // An unterminated trailing object is kept, as before
+    if (depth > 1 && arrayStr[elementStart] == '{') {
+        result.push_back(arrayStr.substr(elementStart));
+    }
     return result;
 }
 
 std::string JsonParser::escape(const std::string& str) {
     std::string result;
     result.reserve(str.size() + 10);  // Pre-allocate for efficiency
-
-    for (char c : str) {
-        switch (c) {
-            case '"':  result += "\\\""; break;
-            case '\\': result += "\\\\"; break;
-            case '\n': result += "\\n"; break;
-            case '\r': result += "\\r"; break;
-            case '\t': result += "\\t"; break;
-            case '\b': result += "\\b"; break;
-            case '\f': result += "\\f"; break;
-            default:   result += c; break;
-        }
-    }
+    JsonWriter::appendEscaped(result, str);
     return result;
 }
 
@@ -166,6 +177,17 @@ std::string JsonParser::unescape(const std::string& str) {
                 case '\\': result += '\\'; i++; break;
                 case 'b':  result += '\b'; i++; break;
                 case 'f':  result += '\f'; i++; break;
+                case 'u':
+                    // \u00XX as written by escape() for other control bytes
+                    if (i + 5 < str.length() && str.compare(i + 2, 2, "00") == 0 &&
+                        std::isxdigit(static_cast<unsigned char>(str[i + 4])) &&
+                        std::isxdigit(static_cast<unsigned char>(str[i + 5]))) {
+                        result += static_cast<char>(std::stoi(str.substr(i + 4, 2), nullptr, 16));
+                        i += 5;
+                    } else {
+                        result += str[i];
+                    }
+                    break;
                 default:   result += str[i]; break;
             }
         } else {
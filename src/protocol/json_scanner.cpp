@@ -0,0 +1,206 @@
+#include "include/protocol/json_scanner.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define JSON_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace english_learning {
+namespace protocol {
+
+namespace {
+
+constexpr size_t BLOCK_SIZE = 64;
+
+struct BlockMasks {
+    uint64_t quote = 0;
+    uint64_t backslash = 0;
+    uint64_t structural = 0;
+};
+
+BlockMasks classifyScalar(const char* block) {
+    BlockMasks masks;
+    for (size_t i = 0; i < BLOCK_SIZE; i++) {
+        uint64_t bit = 1ULL << i;
+        switch (block[i]) {
+            case '"':  masks.quote |= bit; break;
+            case '\\': masks.backslash |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',':
+                masks.structural |= bit;
+                break;
+            default: break;
+        }
+    }
+    return masks;
+}
+
+#ifdef JSON_SCANNER_X86
+
+// '[' and '{' (and ']' and '}') differ only in bit 0x20, so OR-ing it in
+// lets one comparison catch both brackets of a kind.
+
+__attribute__((target("sse2")))
+BlockMasks classifySse2(const char* block) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i fold = _mm_set1_epi8(0x20);
+    const __m128i open = _mm_set1_epi8('{');
+    const __m128i close = _mm_set1_epi8('}');
+    const __m128i colon = _mm_set1_epi8(':');
+    const __m128i comma = _mm_set1_epi8(',');
+
+    BlockMasks masks;
+    for (size_t i = 0; i < BLOCK_SIZE; i += 16) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+        __m128i folded = _mm_or_si128(v, fold);
+        __m128i structural = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(folded, open), _mm_cmpeq_epi8(folded, close)),
+            _mm_or_si128(_mm_cmpeq_epi8(v, colon), _mm_cmpeq_epi8(v, comma)));
+
+        masks.quote |= static_cast<uint64_t>(
+            static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, quote)))) << i;
+        masks.backslash |= static_cast<uint64_t>(
+            static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, backslash)))) << i;
+        masks.structural |= static_cast<uint64_t>(
+            static_cast<uint16_t>(_mm_movemask_epi8(structural))) << i;
+    }
+    return masks;
+}
+
+__attribute__((target("avx2")))
+BlockMasks classifyAvx2(const char* block) {
+    const __m256i quote = _mm256_set1_epi8('"');
+    const __m256i backslash = _mm256_set1_epi8('\\');
+    const __m256i fold = _mm256_set1_epi8(0x20);
+    const __m256i open = _mm256_set1_epi8('{');
+    const __m256i close = _mm256_set1_epi8('}');
+    const __m256i colon = _mm256_set1_epi8(':');
+    const __m256i comma = _mm256_set1_epi8(',');
+
+    BlockMasks masks;
+    for (size_t i = 0; i < BLOCK_SIZE; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+        __m256i folded = _mm256_or_si256(v, fold);
+        __m256i structural = _mm256_or_si256(
+            _mm256_or_si256(_mm256_cmpeq_epi8(folded, open), _mm256_cmpeq_epi8(folded, close)),
+            _mm256_or_si256(_mm256_cmpeq_epi8(v, colon), _mm256_cmpeq_epi8(v, comma)));
+
+        masks.quote |= static_cast<uint64_t>(
+            static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, quote)))) << i;
+        masks.backslash |= static_cast<uint64_t>(
+            static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, backslash)))) << i;
+        masks.structural |= static_cast<uint64_t>(
+            static_cast<uint32_t>(_mm256_movemask_epi8(structural))) << i;
+    }
+    return masks;
+}
+
+#endif // JSON_SCANNER_X86
+
+/**
+ * Bytes escaped by a backslash. Backslashes are rare in protocol messages,
+ * so walking them one at a time is cheaper than the branch-free variant.
+ * carry is set when the block ends on a backslash that escapes the first
+ * byte of the next block.
+ */
+uint64_t escapedMask(uint64_t backslash, bool& carry) {
+    if (backslash == 0 && !carry) return 0;
+
+    uint64_t escaped = 0;
+    if (carry) {
+        escaped = 1;
+        backslash &= ~1ULL;
+        carry = false;
+    }
+    while (backslash != 0) {
+        unsigned i = static_cast<unsigned>(__builtin_ctzll(backslash));
+        backslash &= backslash - 1;
+        if (i == 63) {
+            carry = true;
+            break;
+        }
+        uint64_t nextBit = 1ULL << (i + 1);
+        escaped |= nextBit;
+        backslash &= ~nextBit;  // an escaped backslash escapes nothing
+    }
+    return escaped;
+}
+
+/** Bit i set when an odd number of quotes lie at or before position i. */
+inline uint64_t prefixXor(uint64_t bits) {
+    bits ^= bits << 1;
+    bits ^= bits << 2;
+    bits ^= bits << 4;
+    bits ^= bits << 8;
+    bits ^= bits << 16;
+    bits ^= bits << 32;
+    return bits;
+}
+
+} // namespace
+
+JsonScanner::JsonScanner(std::string_view json, Kernel kernel)
+    : json_(json), kernel_(supported(kernel) ? kernel : Kernel::Scalar) {}
+
+void JsonScanner::scanBlock() {
+    const char* block = json_.data() + blockStart_;
+    size_t remaining = json_.size() - blockStart_;
+
+    // Pad the tail with spaces so every kernel always reads a full block
+    char padded[BLOCK_SIZE];
+    if (remaining < BLOCK_SIZE) {
+        memset(padded, ' ', BLOCK_SIZE);
+        memcpy(padded, block, remaining);
+        block = padded;
+    }
+
+    BlockMasks masks;
+    switch (kernel_) {
+#ifdef JSON_SCANNER_X86
+        case Kernel::Avx2: masks = classifyAvx2(block); break;
+        case Kernel::Sse2: masks = classifySse2(block); break;
+#endif
+        default: masks = classifyScalar(block); break;
+    }
+
+    uint64_t quotes = masks.quote & ~escapedMask(masks.backslash, escapeCarry_);
+    uint64_t inside = prefixXor(quotes) ^ inString_;
+    inString_ = static_cast<uint64_t>(static_cast<int64_t>(inside) >> 63);
+
+    // The opening quote is inside the mask and the closing one is not;
+    // both are reported so callers can delimit strings
+    pending_ = (masks.structural & ~inside) | quotes;
+    pendingBase_ = blockStart_;
+    blockStart_ += BLOCK_SIZE;
+}
+
+JsonScanner::Kernel JsonScanner::activeKernel() {
+    static const Kernel kernel = supported(Kernel::Avx2)   ? Kernel::Avx2
+                                 : supported(Kernel::Sse2) ? Kernel::Sse2
+                                                           : Kernel::Scalar;
+    return kernel;
+}
+
+bool JsonScanner::supported(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Scalar: return true;
+#ifdef JSON_SCANNER_X86
+        case Kernel::Sse2: return __builtin_cpu_supports("sse2");
+        case Kernel::Avx2: return __builtin_cpu_supports("avx2");
+#endif
+        default: return false;
+    }
+}
+
+const char* JsonScanner::kernelName(Kernel kernel) {
+    switch (kernel) {
+        case Kernel::Avx2: return "avx2";
+        case Kernel::Sse2: return "sse2";
+        default: return "scalar";
+    }
+}
+
+} // namespace protocol
+} // namespace english_learning
@@ -0,0 +1,169 @@
+#include "include/protocol/json_writer.h"
+
+#include <array>
+#include <cassert>
+#include <charconv>
+
+namespace english_learning {
+namespace protocol {
+
+namespace {
+
+// Buffers that grew past this (huge lesson lists) are not kept per thread
+constexpr size_t MAX_CACHED_BUFFER = 256 * 1024;
+
+/**
+ * For each byte: 0 if it can be copied as is, otherwise the character that
+ * follows the backslash ('u' meaning a \u00XX sequence).
+ */
+constexpr std::array<char, 256> makeEscapeTable() {
+    std::array<char, 256> table{};
+    for (int c = 0; c < 0x20; c++) table[c] = 'u';
+    table['"'] = '"';
+    table['\\'] = '\\';
+    table['\b'] = 'b';
+    table['\f'] = 'f';
+    table['\n'] = 'n';
+    table['\r'] = 'r';
+    table['\t'] = 't';
+    return table;
+}
+
+constexpr std::array<char, 256> ESCAPE = makeEscapeTable();
+
+thread_local std::string cachedBuffer;
+
+} // namespace
+
+JsonWriter& JsonWriter::beginObject() {
+    separate();
+    out_ += '{';
+    assert(depth_ < MAX_DEPTH && "JsonWriter nesting too deep");
+    depth_++;
+    hasItem_ &= ~(1ULL << depth_);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endObject() {
+    assert(depth_ > 0 && "JsonWriter: no open container to close");
+    out_ += '}';
+    depth_--;
+    return *this;
+}
+
+JsonWriter& JsonWriter::beginArray() {
+    separate();
+    out_ += '[';
+    assert(depth_ < MAX_DEPTH && "JsonWriter nesting too deep");
+    depth_++;
+    hasItem_ &= ~(1ULL << depth_);
+    return *this;
+}
+
+JsonWriter& JsonWriter::endArray() {
+    assert(depth_ > 0 && "JsonWriter: no open container to close");
+    out_ += ']';
+    depth_--;
+    return *this;
+}
+
+JsonWriter& JsonWriter::key(std::string_view name) {
+    separate();
+    out_ += '"';
+    appendEscaped(out_, name);
+    out_.append("\":", 2);
+    afterKey_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::string(std::string_view value) {
+    separate();
+    out_ += '"';
+    appendEscaped(out_, value);
+    out_ += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::escapedString(std::string_view value) {
+    separate();
+    out_ += '"';
+    out_.append(value.data(), value.size());
+    out_ += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::integer(long long value) {
+    separate();
+    appendInt(out_, value);
+    return *this;
+}
+
+JsonWriter& JsonWriter::boolean(bool value) {
+    separate();
+    if (value) {
+        out_.append("true", 4);
+    } else {
+        out_.append("false", 5);
+    }
+    return *this;
+}
+
+JsonWriter& JsonWriter::null() {
+    separate();
+    out_.append("null", 4);
+    return *this;
+}
+
+JsonWriter& JsonWriter::raw(std::string_view json) {
+    separate();
+    out_.append(json.data(), json.size());
+    return *this;
+}
+
+void JsonWriter::appendEscaped(std::string& out, std::string_view value) {
+    static const char HEX[] = "0123456789abcdef";
+
+    const char* data = value.data();
+    size_t size = value.size();
+    size_t runStart = 0;
+    for (size_t i = 0; i < size; i++) {
+        char code = ESCAPE[static_cast<unsigned char>(data[i])];
+        if (code == 0) continue;
+
+        // Copy the safe run before this byte in one go
+        out.append(data + runStart, i - runStart);
+        if (code == 'u') {
+            char sequence[6] = {'\\', 'u', '0', '0',
+                                HEX[(data[i] >> 4) & 0xF], HEX[data[i] & 0xF]};
+            out.append(sequence, sizeof(sequence));
+        } else {
+            char sequence[2] = {'\\', code};
+            out.append(sequence, sizeof(sequence));
+        }
+        runStart = i + 1;
+    }
+    out.append(data + runStart, size - runStart);
+}
+
+void JsonWriter::appendInt(std::string& out, long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+std::string JsonWriter::acquireBuffer() {
+    std::string buffer = std::move(cachedBuffer);
+    cachedBuffer = std::string();
+    buffer.clear();
+    return buffer;
+}
+
+void JsonWriter::releaseBuffer(std::string&& buffer) {
+    if (buffer.capacity() > MAX_CACHED_BUFFER || buffer.capacity() <= cachedBuffer.capacity()) {
+        return;
+    }
+    cachedBuffer = std::move(buffer);
+}
+
+} // namespace protocol
+} // namespace english_learning
@@ -8,6 +8,7 @@
  */
 
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <mutex>
 #include <string>
@@ -21,6 +22,8 @@
 #include "include/repository/i_chat_repository.h"
 #include "include/repository/i_exercise_repository.h"
 #include "include/repository/i_game_repository.h"
+#include "src/repository/memory/chat_store.h"
+#include "src/repository/memory/id_interner.h"
 
 namespace english_learning {
 namespace repository {
@@ -33,7 +36,7 @@ class BridgeUserRepository : public IUserRepository {
 public:
     BridgeUserRepository(
         std::map<std::string, core::User>& users,
-        std::map<std::string, core::User*>& userById,
+        memory::HandleIndex<core::User>& userById,
         std::mutex& mutex)
         : users_(users), userById_(userById), mutex_(mutex) {}
 
@@ -43,7 +46,7 @@ public:
             return false;
         }
         users_[user.email] = user;
-        userById_[user.userId] = &users_[user.email];
+        userById_.put(user.userId, &users_[user.email]);
         return true;
     }
 
@@ -58,9 +61,8 @@ public:
 
     std::optional<core::User> findById(const std::string& userId) const override {
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = userById_.find(userId);
-        if (it != userById_.end() && it->second != nullptr) {
-            return *(it->second);
+        if (const core::User* user = userById_.find(userId)) {
+            return *user;
         }
         return std::nullopt;
     }
@@ -103,7 +105,7 @@ public:
 
     bool existsById(const std::string& userId) const override {
         std::lock_guard<std::mutex> lock(mutex_);
-        return userById_.find(userId) != userById_.end();
+        return userById_.find(userId) != nullptr;
     }
 
     bool update(const core::User& user) override {
@@ -118,9 +120,8 @@ public:
 
     bool updateLevel(const std::string& userId, const std::string& level) override {
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = userById_.find(userId);
-        if (it != userById_.end() && it->second != nullptr) {
-            it->second->level = level;
+        if (core::User* user = userById_.find(userId)) {
+            user->level = level;
             return true;
         }
         return false;
@@ -128,10 +129,9 @@ public:
 
     bool setOnlineStatus(const std::string& userId, bool online, int socket = -1) override {
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = userById_.find(userId);
-        if (it != userById_.end() && it->second != nullptr) {
-            it->second->online = online;
-            it->second->clientSocket = socket;
+        if (core::User* user = userById_.find(userId)) {
+            user->online = online;
+            user->clientSocket = socket;
             return true;
         }
         return false;
@@ -139,10 +139,9 @@ public:
 
     bool remove(const std::string& userId) override {
         std::lock_guard<std::mutex> lock(mutex_);
-        auto it = userById_.find(userId);
-        if (it != userById_.end() && it->second != nullptr) {
-            std::string email = it->second->email;
-            userById_.erase(it);
+        if (core::User* user = userById_.find(userId)) {
+            std::string email = user->email;
+            userById_.erase(userId);
             users_.erase(email);
             return true;
         }
@@ -172,24 +171,29 @@ public:
 
 private:
     std::map<std::string, core::User>& users_;
-    std::map<std::string, core::User*>& userById_;
+    memory::HandleIndex<core::User>& userById_;
     std::mutex& mutex_;
 };
 
 /**
- * Bridge session repository wrapping global session maps.
+ * Bridge session repository wrapping global session maps. Sessions added
+ * through it get the handle of their userId from the server's interner.
  */
 class BridgeSessionRepository : public ISessionRepository {
 public:
     BridgeSessionRepository(
-        std::map<std::string, core::Session>& sessions,
+        std::unordered_map<std::string, core::Session>& sessions,
         std::map<int, std::string>& clientSessions,
+        const memory::IdInterner& userIds,
         std::mutex& mutex)
-        : sessions_(sessions), clientSessions_(clientSessions), mutex_(mutex) {}
+        : sessions_(sessions), clientSessions_(clientSessions), userIds_(userIds),
+          mutex_(mutex) {}
 
     bool add(const core::Session& session) override {
         std::lock_guard<std::mutex> lock(mutex_);
-        sessions_[session.sessionToken] = session;
+        core::Session& stored = sessions_[session.sessionToken];
+        stored = session;
+        stored.userHandle = userIds_.find(session.userId);
         return true;
     }
 
@@ -277,130 +281,69 @@ public:
     }
 
 private:
-    std::map<std::string, core::Session>& sessions_;
+    std::unordered_map<std::string, core::Session>& sessions_;
     std::map<int, std::string>& clientSessions_;
+    const memory::IdInterner& userIds_;
     std::mutex& mutex_;
 };
 
 /**
- * Bridge chat repository wrapping global chat messages.
+ * Bridge chat repository wrapping the global chat store.
  */
 class BridgeChatRepository : public IChatRepository {
 public:
-    BridgeChatRepository(
-        std::vector<core::ChatMessage>& messages,
-        std::mutex& mutex)
-        : messages_(messages), mutex_(mutex) {}
+    explicit BridgeChatRepository(memory::ChatStore& store)
+        : store_(store) {}
 
     bool add(const core::ChatMessage& message) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        messages_.push_back(message);
+        store_.add(message);
         return true;
     }
 
     std::optional<core::ChatMessage> findById(const std::string& messageId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (const auto& msg : messages_) {
-            if (msg.messageId == messageId) {
-                return msg;
-            }
-        }
-        return std::nullopt;
+        return store_.findById(messageId);
     }
 
     std::vector<core::ChatMessage> findAll() const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return messages_;
+        return store_.findAll();
     }
 
     std::vector<core::ChatMessage> findByUser(const std::string& userId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::ChatMessage> result;
-        for (const auto& msg : messages_) {
-            if (msg.involvesUser(userId)) {
-                result.push_back(msg);
-            }
-        }
-        return result;
+        return store_.findByUser(userId);
     }
 
     std::vector<core::ChatMessage> findConversation(const std::string& user1,
                                                      const std::string& user2) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::ChatMessage> result;
-        for (const auto& msg : messages_) {
-            if (msg.isBetween(user1, user2)) {
-                result.push_back(msg);
-            }
-        }
-        return result;
+        return store_.findConversation(user1, user2);
     }
 
     std::vector<core::ChatMessage> findUnreadFor(const std::string& userId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::ChatMessage> result;
-        for (const auto& msg : messages_) {
-            if (msg.recipientId == userId && !msg.read) {
-                result.push_back(msg);
-            }
-        }
-        return result;
+        return store_.findUnreadFor(userId);
     }
 
     size_t countUnreadFor(const std::string& userId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        size_t count = 0;
-        for (const auto& msg : messages_) {
-            if (msg.recipientId == userId && !msg.read) {
-                count++;
-            }
-        }
-        return count;
+        return store_.countUnreadFor(userId);
     }
 
     bool markAsRead(const std::string& messageId) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (auto& msg : messages_) {
-            if (msg.messageId == messageId) {
-                msg.read = true;
-                return true;
-            }
-        }
-        return false;
+        return store_.markAsRead(messageId);
     }
 
     size_t markConversationAsRead(const std::string& recipientId,
                                    const std::string& senderId) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        size_t count = 0;
-        for (auto& msg : messages_) {
-            if (msg.senderId == senderId && msg.recipientId == recipientId && !msg.read) {
-                msg.read = true;
-                count++;
-            }
-        }
-        return count;
+        return store_.markConversationAsRead(recipientId, senderId);
     }
 
     bool remove(const std::string& messageId) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (auto it = messages_.begin(); it != messages_.end(); ++it) {
-            if (it->messageId == messageId) {
-                messages_.erase(it);
-                return true;
-            }
-        }
-        return false;
+        return store_.remove(messageId);
     }
 
     size_t count() const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return messages_.size();
+        return store_.count();
     }
 
 private:
-    std::vector<core::ChatMessage>& messages_;
-    std::mutex& mutex_;
+    memory::ChatStore& store_;
 };
 
 } // namespace bridge
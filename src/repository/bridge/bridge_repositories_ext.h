@@ -6,6 +6,12 @@
  */
 
 #include "bridge_repositories.h"
+#include "src/repository/memory/call_registry.h"
+#include "src/repository/memory/catalog.h"
+#include "src/repository/memory/content_index.h"
+#include "src/repository/memory/game_session_store.h"
+#include "src/repository/memory/lesson_index.h"
+#include "src/repository/memory/submission_store.h"
 #include "include/repository/i_voice_call_repository.h"
 
 namespace english_learning {
@@ -13,83 +19,67 @@ namespace repository {
 namespace bridge {
 
 /**
- * Bridge lesson repository wrapping global lessons map.
+ * Bridge lesson repository over the global lesson catalog. Reads work on a
+ * snapshot and never block; writes publish a new catalog version. Level
+ * and topic lookups use the shared lesson index.
  */
 class BridgeLessonRepository : public ILessonRepository {
 public:
-    BridgeLessonRepository(std::map<std::string, core::Lesson>& lessons)
-        : lessons_(lessons) {}
+    BridgeLessonRepository(memory::Catalog<core::Lesson>& lessons,
+                           const memory::LessonIndexCache& index)
+        : lessons_(lessons), index_(index) {}
 
     bool add(const core::Lesson& lesson) override {
-        if (lessons_.find(lesson.lessonId) != lessons_.end()) {
-            return false;
-        }
-        lessons_[lesson.lessonId] = lesson;
-        return true;
+        return lessons_.update([&](auto& items) {
+            return items.emplace(lesson.lessonId, lesson).second;
+        });
     }
 
     std::optional<core::Lesson> findById(const std::string& lessonId) const override {
-        auto it = lessons_.find(lessonId);
-        if (it != lessons_.end()) {
-            return it->second;
+        auto snapshot = lessons_.snapshot();
+        if (const core::Lesson* lesson = snapshot->find(lessonId)) {
+            return *lesson;
         }
         return std::nullopt;
     }
 
     std::vector<core::Lesson> findAll() const override {
+        auto snapshot = lessons_.snapshot();
         std::vector<core::Lesson> result;
-        for (const auto& pair : lessons_) {
+        for (const auto& pair : snapshot->items) {
             result.push_back(pair.second);
         }
         return result;
     }
 
     std::vector<core::Lesson> findByLevel(const std::string& level) const override {
-        std::vector<core::Lesson> result;
-        for (const auto& pair : lessons_) {
-            if (pair.second.level == level) {
-                result.push_back(pair.second);
-            }
-        }
-        return result;
+        return copy(index_.current()->select(level, std::string()));
     }
 
     std::vector<core::Lesson> findByTopic(const std::string& topic) const override {
-        std::vector<core::Lesson> result;
-        for (const auto& pair : lessons_) {
-            if (pair.second.topic == topic) {
-                result.push_back(pair.second);
-            }
-        }
-        return result;
+        return copy(index_.current()->select(std::string(), topic));
     }
 
     std::vector<core::Lesson> findByLevelAndTopic(const std::string& level,
                                                    const std::string& topic) const override {
-        std::vector<core::Lesson> result;
-        for (const auto& pair : lessons_) {
-            if (pair.second.level == level && pair.second.topic == topic) {
-                result.push_back(pair.second);
-            }
-        }
-        return result;
+        return copy(index_.current()->select(level, topic));
     }
 
     bool exists(const std::string& lessonId) const override {
-        return lessons_.find(lessonId) != lessons_.end();
+        return lessons_.snapshot()->find(lessonId) != nullptr;
     }
 
     bool update(const core::Lesson& lesson) override {
-        auto it = lessons_.find(lesson.lessonId);
-        if (it != lessons_.end()) {
+        return lessons_.update([&](auto& items) {
+            auto it = items.find(lesson.lessonId);
+            if (it == items.end()) return false;
             it->second = lesson;
             return true;
-        }
-        return false;
+        });
     }
 
     bool remove(const std::string& lessonId) override {
-        return lessons_.erase(lessonId) > 0;
+        return lessons_.update([&](auto& items) { return items.erase(lessonId) > 0; });
     }
 
     size_t count() const override {
@@ -97,97 +87,84 @@ public:
     }
 
     size_t countByLevel(const std::string& level) const override {
-        size_t cnt = 0;
-        for (const auto& pair : lessons_) {
-            if (pair.second.level == level) {
-                cnt++;
-            }
-        }
-        return cnt;
+        return index_.current()->count(level, std::string());
     }
 
 private:
-    std::map<std::string, core::Lesson>& lessons_;
+    static std::vector<core::Lesson> copy(const std::vector<const core::Lesson*>& lessons) {
+        std::vector<core::Lesson> result;
+        result.reserve(lessons.size());
+        for (const core::Lesson* lesson : lessons) {
+            result.push_back(*lesson);
+        }
+        return result;
+    }
+
+    memory::Catalog<core::Lesson>& lessons_;
+    const memory::LessonIndexCache& index_;
 };
 
 /**
- * Bridge test repository wrapping global tests map.
+ * Bridge test repository over the global test catalog. Level and type
+ * lookups use the shared test index.
  */
 class BridgeTestRepository : public ITestRepository {
 public:
-    BridgeTestRepository(std::map<std::string, core::Test>& tests)
-        : tests_(tests) {}
+    BridgeTestRepository(memory::Catalog<core::Test>& tests,
+                         const memory::TestIndexCache& index)
+        : tests_(tests), index_(index) {}
 
     bool add(const core::Test& test) override {
-        if (tests_.find(test.testId) != tests_.end()) {
-            return false;
-        }
-        tests_[test.testId] = test;
-        return true;
+        return tests_.update([&](auto& items) {
+            return items.emplace(test.testId, test).second;
+        });
     }
 
     std::optional<core::Test> findById(const std::string& testId) const override {
-        auto it = tests_.find(testId);
-        if (it != tests_.end()) {
-            return it->second;
+        auto snapshot = tests_.snapshot();
+        if (const core::Test* test = snapshot->find(testId)) {
+            return *test;
         }
         return std::nullopt;
     }
 
     std::vector<core::Test> findAll() const override {
+        auto snapshot = tests_.snapshot();
         std::vector<core::Test> result;
-        for (const auto& pair : tests_) {
+        for (const auto& pair : snapshot->items) {
             result.push_back(pair.second);
         }
         return result;
     }
 
     std::vector<core::Test> findByLevel(const std::string& level) const override {
-        std::vector<core::Test> result;
-        for (const auto& pair : tests_) {
-            if (pair.second.level == level) {
-                result.push_back(pair.second);
-            }
-        }
-        return result;
+        return copy(index_.current()->select(level, std::string()));
     }
 
     std::vector<core::Test> findByType(const std::string& testType) const override {
-        std::vector<core::Test> result;
-        for (const auto& pair : tests_) {
-            if (pair.second.testType == testType) {
-                result.push_back(pair.second);
-            }
-        }
-        return result;
+        return copy(index_.current()->select(std::string(), testType));
     }
 
     std::vector<core::Test> findByLevelAndType(const std::string& level,
                                                 const std::string& testType) const override {
-        std::vector<core::Test> result;
-        for (const auto& pair : tests_) {
-            if (pair.second.level == level && pair.second.testType == testType) {
-                result.push_back(pair.second);
-            }
-        }
-        return result;
+        return copy(index_.current()->select(level, testType));
     }
 
     bool exists(const std::string& testId) const override {
-        return tests_.find(testId) != tests_.end();
+        return tests_.snapshot()->find(testId) != nullptr;
     }
 
     bool update(const core::Test& test) override {
-        auto it = tests_.find(test.testId);
-        if (it != tests_.end()) {
+        return tests_.update([&](auto& items) {
+            auto it = items.find(test.testId);
+            if (it == items.end()) return false;
             it->second = test;
             return true;
-        }
-        return false;
+        });
     }
 
     bool remove(const std::string& testId) override {
-        return tests_.erase(testId) > 0;
+        return tests_.update([&](auto& items) { return items.erase(testId) > 0; });
     }
 
     size_t count() const override {
@@ -195,17 +172,29 @@ public:
     }
 
 private:
-    std::map<std::string, core::Test>& tests_;
+    static std::vector<core::Test> copy(const std::vector<const core::Test*>& tests) {
+        std::vector<core::Test> result;
+        result.reserve(tests.size());
+        for (const core::Test* test : tests) {
+            result.push_back(*test);
+        }
+        return result;
+    }
+
+    memory::Catalog<core::Test>& tests_;
+    const memory::TestIndexCache& index_;
 };
 
 /**
- * Bridge exercise repository wrapping global exercises map and submissions.
+ * Bridge exercise repository wrapping the global exercises map and the
+ * server's submission store, so service-layer lookups by id, user or
+ * exercise and the review queue use the same indexes as the handlers.
  */
 class BridgeExerciseRepository : public IExerciseRepository {
 public:
     BridgeExerciseRepository(
         std::map<std::string, core::Exercise>& exercises,
-        std::vector<core::ExerciseSubmission>& submissions,
+        memory::SubmissionStore& submissions,
         std::mutex& mutex)
         : exercises_(exercises), submissions_(submissions), mutex_(mutex) {}
 
@@ -279,83 +268,39 @@ public:
     }
 
     bool addSubmission(const core::ExerciseSubmission& submission) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        submissions_.push_back(submission);
-        return true;
+        return submissions_.add(submission);
     }
 
     std::optional<core::ExerciseSubmission> findSubmissionById(
         const std::string& submissionId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (const auto& sub : submissions_) {
-            if (sub.submissionId == submissionId) {
-                return sub;
-            }
-        }
-        return std::nullopt;
+        return submissions_.findById(submissionId);
     }
 
     std::vector<core::ExerciseSubmission> findAllSubmissions() const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return submissions_;
+        return submissions_.findAll();
     }
 
     std::vector<core::ExerciseSubmission> findSubmissionsByUser(
         const std::string& userId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::ExerciseSubmission> result;
-        for (const auto& sub : submissions_) {
-            if (sub.userId == userId) {
-                result.push_back(sub);
-            }
-        }
-        return result;
+        return submissions_.findByUser(userId);
     }
 
     std::vector<core::ExerciseSubmission> findSubmissionsByExercise(
         const std::string& exerciseId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::ExerciseSubmission> result;
-        for (const auto& sub : submissions_) {
-            if (sub.exerciseId == exerciseId) {
-                result.push_back(sub);
-            }
-        }
-        return result;
+        return submissions_.findByExercise(exerciseId);
     }
 
     std::vector<core::ExerciseSubmission> findPendingSubmissions() const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::ExerciseSubmission> result;
-        for (const auto& sub : submissions_) {
-            if (sub.isPending()) {
-                result.push_back(sub);
-            }
-        }
-        return result;
+        return submissions_.findPending();
     }
 
     std::vector<core::ExerciseSubmission> findReviewedSubmissions(
         const std::string& userId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::ExerciseSubmission> result;
-        for (const auto& sub : submissions_) {
-            if (sub.userId == userId && sub.isReviewed()) {
-                result.push_back(sub);
-            }
-        }
-        return result;
+        return submissions_.findReviewedByUser(userId);
     }
 
     bool updateSubmission(const core::ExerciseSubmission& submission) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (auto& sub : submissions_) {
-            if (sub.submissionId == submission.submissionId) {
-                sub = submission;
-                return true;
-            }
-        }
-        return false;
+        return submissions_.update(submission);
     }
 
     bool reviewSubmission(const std::string& submissionId,
@@ -363,14 +308,7 @@ public:
                           const std::string& feedback,
                           int score,
                           int64_t reviewedAt) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (auto& sub : submissions_) {
-            if (sub.submissionId == submissionId) {
-                sub.setReview(teacherId, feedback, score, reviewedAt);
-                return true;
-            }
-        }
-        return false;
+        return submissions_.review(submissionId, teacherId, feedback, score, reviewedAt);
     }
 
     size_t countExercises() const override {
@@ -379,353 +317,220 @@ public:
     }
 
     size_t countSubmissions() const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return submissions_.size();
+        return submissions_.count();
     }
 
     size_t countPendingSubmissions() const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        size_t count = 0;
-        for (const auto& sub : submissions_) {
-            if (sub.isPending()) {
-                count++;
-            }
-        }
-        return count;
+        return submissions_.countPending();
     }
 
 private:
     std::map<std::string, core::Exercise>& exercises_;
-    std::vector<core::ExerciseSubmission>& submissions_;
-    std::mutex& mutex_;
+    memory::SubmissionStore& submissions_;
+    std::mutex& mutex_;  ///< Guards exercises_
 };
 
 /**
- * Bridge game repository wrapping global games map and sessions.
+ * Bridge game repository over the global game catalog and the server's
+ * game session store. Game reads work on a catalog snapshot, level and
+ * type lookups on the shared game index; a new session gets its game's
+ * timeLimit as time to live.
  */
 class BridgeGameRepository : public IGameRepository {
 public:
     BridgeGameRepository(
-        std::map<std::string, core::Game>& games,
-        std::map<std::string, core::GameSession>& gameSessions,
-        std::mutex& mutex)
-        : games_(games), sessions_(gameSessions), mutex_(mutex) {}
+        memory::Catalog<core::Game>& games,
+        const memory::GameIndexCache& index,
+        memory::GameSessionStore& gameSessions)
+        : games_(games), index_(index), sessions_(gameSessions) {}
 
     bool addGame(const core::Game& game) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (games_.find(game.gameId) != games_.end()) {
-            return false;
-        }
-        games_[game.gameId] = game;
-        return true;
+        return games_.update([&](auto& items) {
+            return items.emplace(game.gameId, game).second;
+        });
     }
 
     std::optional<core::Game> findGameById(const std::string& gameId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = games_.find(gameId);
-        if (it != games_.end()) {
-            return it->second;
+        auto snapshot = games_.snapshot();
+        if (const core::Game* game = snapshot->find(gameId)) {
+            return *game;
         }
         return std::nullopt;
     }
 
     std::vector<core::Game> findAllGames() const override {
-        std::lock_guard<std::mutex> lock(mutex_);
+        auto snapshot = games_.snapshot();
         std::vector<core::Game> result;
-        for (const auto& pair : games_) {
+        for (const auto& pair : snapshot->items) {
             result.push_back(pair.second);
         }
         return result;
     }
 
     std::vector<core::Game> findGamesByLevel(const std::string& level) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::Game> result;
-        for (const auto& pair : games_) {
-            if (pair.second.level == level) {
-                result.push_back(pair.second);
-            }
-        }
-        return result;
+        return copy(index_.current()->select(std::string(), level));
     }
 
     std::vector<core::Game> findGamesByType(const std::string& gameType) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::Game> result;
-        for (const auto& pair : games_) {
-            if (pair.second.gameType == gameType) {
-                result.push_back(pair.second);
-            }
-        }
-        return result;
+        return copy(index_.current()->select(gameType, std::string()));
     }
 
     std::vector<core::Game> findGamesByLevelAndType(const std::string& level,
                                                      const std::string& gameType) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::Game> result;
-        for (const auto& pair : games_) {
-            if (pair.second.level == level && pair.second.gameType == gameType) {
-                result.push_back(pair.second);
-            }
-        }
-        return result;
+        return copy(index_.current()->select(gameType, level));
     }
 
     bool gameExists(const std::string& gameId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return games_.find(gameId) != games_.end();
+        return games_.snapshot()->find(gameId) != nullptr;
     }
 
     bool updateGame(const core::Game& game) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = games_.find(game.gameId);
-        if (it != games_.end()) {
+        return games_.update([&](auto& items) {
+            auto it = items.find(game.gameId);
+            if (it == items.end()) return false;
             it->second = game;
             return true;
-        }
-        return false;
+        });
     }
 
     bool removeGame(const std::string& gameId) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return games_.erase(gameId) > 0;
+        return games_.update([&](auto& items) { return items.erase(gameId) > 0; });
     }
 
     bool addSession(const core::GameSession& session) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (sessions_.find(session.sessionId) != sessions_.end()) {
-            return false;
-        }
-        sessions_[session.sessionId] = session;
-        return true;
+        auto catalog = games_.snapshot();
+        const core::Game* game = catalog->find(session.gameId);
+        return sessions_.add(session, game ? game->timeLimit : core::Game().timeLimit);
     }
 
     std::optional<core::GameSession> findSessionById(
         const std::string& sessionId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = sessions_.find(sessionId);
-        if (it != sessions_.end()) {
-            return it->second;
-        }
-        return std::nullopt;
+        return sessions_.findById(sessionId);
     }
 
     std::vector<core::GameSession> findSessionsByUser(
         const std::string& userId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::GameSession> result;
-        for (const auto& pair : sessions_) {
-            if (pair.second.userId == userId) {
-                result.push_back(pair.second);
-            }
-        }
-        return result;
+        return sessions_.findByUser(userId);
     }
 
     std::vector<core::GameSession> findSessionsByGame(
         const std::string& gameId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::GameSession> result;
-        for (const auto& pair : sessions_) {
-            if (pair.second.gameId == gameId) {
-                result.push_back(pair.second);
-            }
-        }
-        return result;
+        return sessions_.findByGame(gameId);
     }
 
     std::vector<core::GameSession> findActiveSessionsByUser(
         const std::string& userId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::GameSession> result;
-        for (const auto& pair : sessions_) {
-            if (pair.second.userId == userId && pair.second.isActive()) {
-                result.push_back(pair.second);
-            }
-        }
-        return result;
+        return sessions_.findActiveByUser(userId);
     }
 
     bool updateSession(const core::GameSession& session) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = sessions_.find(session.sessionId);
-        if (it != sessions_.end()) {
-            it->second = session;
-            return true;
-        }
-        return false;
+        return sessions_.update(session);
     }
 
     bool completeSession(const std::string& sessionId,
                          int score,
                          int64_t endTime) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = sessions_.find(sessionId);
-        if (it != sessions_.end()) {
-            it->second.complete(score, endTime);
-            return true;
-        }
-        return false;
+        return sessions_.complete(sessionId, score, endTime) ==
+               memory::GameSessionStore::Completion::Done;
     }
 
     size_t countGames() const override {
-        std::lock_guard<std::mutex> lock(mutex_);
         return games_.size();
     }
 
     size_t countSessions() const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return sessions_.size();
+        return sessions_.count();
     }
 
 private:
-    std::map<std::string, core::Game>& games_;
-    std::map<std::string, core::GameSession>& sessions_;
-    std::mutex& mutex_;
+    static std::vector<core::Game> copy(const std::vector<const core::Game*>& games) {
+        std::vector<core::Game> result;
+        result.reserve(games.size());
+        for (const core::Game* game : games) {
+            result.push_back(*game);
+        }
+        return result;
+    }
+
+    memory::Catalog<core::Game>& games_;
+    const memory::GameIndexCache& index_;
+    memory::GameSessionStore& sessions_;
 };
 
 /**
- * Bridge voice call repository wrapping global voice calls map.
+ * Bridge voice call repository over the server's call registry, so the
+ * service layer sees the same busy slots, timeouts and history as the
+ * handlers.
  */
 class BridgeVoiceCallRepository : public IVoiceCallRepository {
 public:
-    BridgeVoiceCallRepository(
-        std::map<std::string, core::VoiceCallSession>& calls,
-        std::mutex& mutex)
-        : calls_(calls), mutex_(mutex) {}
+    explicit BridgeVoiceCallRepository(memory::CallRegistry& calls) : calls_(calls) {}
 
     bool add(const core::VoiceCallSession& call) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        if (calls_.find(call.callId) != calls_.end()) {
-            return false;
-        }
-        calls_[call.callId] = call;
-        return true;
+        return calls_.add(call) == memory::CallRegistry::Change::Done;
     }
 
     std::optional<core::VoiceCallSession> findById(const std::string& callId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = calls_.find(callId);
-        if (it != calls_.end()) {
-            return it->second;
-        }
-        return std::nullopt;
+        return calls_.findById(callId);
     }
 
     std::vector<core::VoiceCallSession> findAll() const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::VoiceCallSession> result;
-        for (const auto& pair : calls_) {
-            result.push_back(pair.second);
-        }
-        return result;
+        return calls_.findAll();
     }
 
     std::vector<core::VoiceCallSession> findByUser(const std::string& userId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::VoiceCallSession> result;
-        for (const auto& pair : calls_) {
-            if (pair.second.involvesUser(userId)) {
-                result.push_back(pair.second);
-            }
-        }
-        return result;
+        return calls_.findByUser(userId);
     }
 
     std::vector<core::VoiceCallSession> findActiveByUser(const std::string& userId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
         std::vector<core::VoiceCallSession> result;
-        for (const auto& pair : calls_) {
-            if (pair.second.involvesUser(userId) && pair.second.isActive()) {
-                result.push_back(pair.second);
-            }
-        }
+        if (auto call = calls_.findActiveCall(userId)) result.push_back(std::move(*call));
         return result;
     }
 
     std::vector<core::VoiceCallSession> findPendingForUser(const std::string& userId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        std::vector<core::VoiceCallSession> result;
-        for (const auto& pair : calls_) {
-            if (pair.second.receiverId == userId && pair.second.isPending()) {
-                result.push_back(pair.second);
-            }
-        }
-        return result;
+        return calls_.findLive([&](const core::VoiceCallSession& call) {
+            return call.receiverId == userId && call.isPending();
+        });
     }
 
     std::optional<core::VoiceCallSession> findActiveCall(const std::string& userId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (const auto& pair : calls_) {
-            if (pair.second.involvesUser(userId) && pair.second.isActive()) {
-                return pair.second;
-            }
-        }
-        return std::nullopt;
+        return calls_.findActiveCall(userId);
     }
 
     std::optional<core::VoiceCallSession> findPendingCall(
         const std::string& callerId, const std::string& receiverId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        for (const auto& pair : calls_) {
-            if (pair.second.callerId == callerId &&
-                pair.second.receiverId == receiverId &&
-                pair.second.isPending()) {
-                return pair.second;
-            }
-        }
-        return std::nullopt;
+        auto pending = calls_.findLive([&](const core::VoiceCallSession& call) {
+            return call.callerId == callerId && call.receiverId == receiverId &&
+                   call.isPending();
+        });
+        if (pending.empty()) return std::nullopt;
+        return pending.front();
     }
 
     bool update(const core::VoiceCallSession& call) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = calls_.find(call.callId);
-        if (it != calls_.end()) {
-            it->second = call;
-            return true;
-        }
-        return false;
+        return calls_.update(call);
     }
 
     bool updateStatus(const std::string& callId, core::VoiceCallStatus status,
                       core::Timestamp endTime = 0) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = calls_.find(callId);
-        if (it != calls_.end()) {
-            it->second.status = status;
-            if (endTime > 0) {
-                it->second.endTime = endTime;
-            }
-            return true;
-        }
-        return false;
+        return calls_.setStatus(callId, status, endTime);
     }
 
     bool remove(const std::string& callId) override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return calls_.erase(callId) > 0;
+        return calls_.remove(callId);
     }
 
     size_t count() const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        return calls_.size();
+        return calls_.count();
     }
 
     size_t countActiveForUser(const std::string& userId) const override {
-        std::lock_guard<std::mutex> lock(mutex_);
-        size_t cnt = 0;
-        for (const auto& pair : calls_) {
-            if (pair.second.involvesUser(userId) && pair.second.isActive()) {
-                cnt++;
-            }
-        }
-        return cnt;
+        return calls_.findActiveCall(userId) ? 1 : 0;
     }
 
 private:
-    std::map<std::string, core::VoiceCallSession>& calls_;
-    std::mutex& mutex_;
+    memory::CallRegistry& calls_;
 };
 
 } // namespace bridge
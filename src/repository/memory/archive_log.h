@@ -0,0 +1,79 @@
+#ifndef ENGLISH_LEARNING_REPOSITORY_MEMORY_ARCHIVE_LOG_H
+#define ENGLISH_LEARNING_REPOSITORY_MEMORY_ARCHIVE_LOG_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+/**
+ * Bounded history of compact records of finished items (ended calls,
+ * finished game sessions), oldest dropped first once there are more than
+ * capacity, each looked up in O(1) by the ID in its Id member.
+ *
+ * Records sit in a deque numbered by a sequence that keeps counting as
+ * the oldest are dropped, and the ID index maps to that sequence number.
+ * A record whose ID was forgotten, or appended again later, stays in the
+ * deque until it ages out but is no longer reachable: find() and
+ * forEach() only ever see the latest record of each ID still indexed.
+ *
+ * Not synchronized; the owning store guards it with its own mutex.
+ */
+template <typename Record, const std::string Record::*Id>
+class ArchiveLog {
+public:
+    explicit ArchiveLog(size_t capacity) : capacity_(capacity) {}
+
+    /** Append record, dropping the oldest past capacity. */
+    void append(Record record) {
+        index_[record.*Id] = base_ + records_.size();
+        records_.push_back(std::move(record));
+
+        while (records_.size() > capacity_) {
+            auto oldest = index_.find(records_.front().*Id);
+            if (oldest != index_.end() && oldest->second == base_) index_.erase(oldest);
+            records_.pop_front();
+            base_++;
+        }
+    }
+
+    /** The record with this ID, or nullptr; valid until the next append(). */
+    const Record* find(const std::string& id) const {
+        auto it = index_.find(id);
+        return it == index_.end() ? nullptr : &records_[it->second - base_];
+    }
+
+    bool contains(const std::string& id) const { return index_.count(id) != 0; }
+
+    /** Make id unreachable; false if it was not. */
+    bool forget(const std::string& id) { return index_.erase(id) > 0; }
+
+    /** Call fn(const Record&) for each reachable record, oldest first. */
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (size_t i = 0; i < records_.size(); i++) {
+            auto it = index_.find(records_[i].*Id);
+            if (it != index_.end() && it->second == base_ + i) fn(records_[i]);
+        }
+    }
+
+    /** Reachable records. */
+    size_t size() const { return index_.size(); }
+
+private:
+    const size_t capacity_;
+    std::deque<Record> records_;
+    uint64_t base_ = 0;  ///< Sequence number of records_.front()
+    std::unordered_map<std::string, uint64_t> index_;  ///< ID -> sequence number
+};
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_REPOSITORY_MEMORY_ARCHIVE_LOG_H
@@ -0,0 +1,311 @@
+#include "src/repository/memory/call_registry.h"
+
+#include <algorithm>
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+CallRegistry::CallRegistry(core::Timestamp ringTimeout, size_t historyCapacity)
+    : ringTimeout_(ringTimeout), history_(historyCapacity) {}
+
+void CallRegistry::occupyLocked(const core::VoiceCallSession& call) {
+    for (const std::string* userId : {&call.callerId, &call.receiverId}) {
+        Slot& slot = slots_[*userId];
+        if (call.isPending()) {
+            slot.pending++;
+        } else if (call.isActive()) {
+            slot.active = call.callId;
+        }
+    }
+}
+
+void CallRegistry::vacateLocked(const core::VoiceCallSession& call) {
+    for (const std::string* userId : {&call.callerId, &call.receiverId}) {
+        auto it = slots_.find(*userId);
+        if (it == slots_.end()) continue;
+        Slot& slot = it->second;
+        if (call.isPending() && slot.pending > 0) {
+            slot.pending--;
+        } else if (call.isActive() && slot.active == call.callId) {
+            slot.active.clear();
+        }
+        if (slot.pending == 0 && slot.active.empty()) slots_.erase(it);
+    }
+}
+
+void CallRegistry::scheduleLocked(Live& live) {
+    live.deadline = live.call.startTime + ringTimeout_;
+    // Rounded up, so a tick's calls are all due once the tick has passed
+    int64_t tick = (live.deadline + TICK - 1) / TICK;
+    if (sweptTick_ >= 0) tick = std::max(tick, sweptTick_ + 1);
+    wheel_[static_cast<uint64_t>(tick) % WHEEL_SLOTS].push_back(live.call.callId);
+}
+
+void CallRegistry::archiveLocked(std::unordered_map<std::string, Live>::iterator it) {
+    const core::VoiceCallSession& call = it->second.call;
+    history_.append(Record{call.callId, call.callerId, call.receiverId, call.startTime,
+                           call.acceptTime, call.endTime, call.status});
+    live_.erase(it);
+}
+
+CallRegistry::Change CallRegistry::insertLocked(const core::VoiceCallSession& call) {
+    if (live_.count(call.callId) != 0 || history_.contains(call.callId)) {
+        return Change::Duplicate;
+    }
+    auto it = live_.emplace(call.callId, Live{call, 0}).first;
+    if (call.hasEnded()) {
+        archiveLocked(it);
+        return Change::Done;
+    }
+    occupyLocked(call);
+    if (call.isPending()) scheduleLocked(it->second);
+    return Change::Done;
+}
+
+core::VoiceCallSession CallRegistry::fromRecord(const Record& record) {
+    core::VoiceCallSession call(record.callId, record.callerId, record.receiverId,
+                                record.startTime);
+    call.audioSource.clear();
+    call.status = record.status;
+    call.acceptTime = record.acceptTime;
+    call.endTime = record.endTime;
+    return call;
+}
+
+CallRegistry::Change CallRegistry::start(const core::VoiceCallSession& call) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto caller = slots_.find(call.callerId);
+    if (caller != slots_.end()) return Change::CallerBusy;
+    auto receiver = slots_.find(call.receiverId);
+    if (receiver != slots_.end() && !receiver->second.active.empty()) {
+        return Change::ReceiverBusy;
+    }
+    return insertLocked(call);
+}
+
+CallRegistry::Change CallRegistry::add(const core::VoiceCallSession& call) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return insertLocked(call);
+}
+
+CallRegistry::Change CallRegistry::accept(const std::string& callId,
+                                          const std::string& receiverId, core::Timestamp at,
+                                          core::VoiceCallSession* call) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = live_.find(callId);
+    if (it == live_.end()) {
+        const Record* record = history_.find(callId);
+        if (!record) return Change::NotFound;
+        if (call) *call = fromRecord(*record);
+        return record->receiverId != receiverId ? Change::NotReceiver : Change::NotPending;
+    }
+
+    core::VoiceCallSession& session = it->second.call;
+    Change change = Change::Done;
+    if (session.receiverId != receiverId) {
+        change = Change::NotReceiver;
+    } else if (!session.isPending()) {
+        change = Change::NotPending;
+    } else {
+        auto receiver = slots_.find(session.receiverId);
+        auto caller = slots_.find(session.callerId);
+        if (receiver != slots_.end() && !receiver->second.active.empty()) {
+            change = Change::ReceiverBusy;
+        } else if (caller != slots_.end() && !caller->second.active.empty()) {
+            change = Change::CallerBusy;
+        } else {
+            vacateLocked(session);
+            session.accept(at);
+            occupyLocked(session);
+        }
+    }
+    if (call) *call = session;
+    return change;
+}
+
+CallRegistry::Change CallRegistry::reject(const std::string& callId,
+                                          const std::string& receiverId, core::Timestamp at,
+                                          core::VoiceCallSession* call) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = live_.find(callId);
+    if (it == live_.end()) {
+        const Record* record = history_.find(callId);
+        if (!record) return Change::NotFound;
+        if (call) *call = fromRecord(*record);
+        return record->receiverId != receiverId ? Change::NotReceiver : Change::NotPending;
+    }
+
+    core::VoiceCallSession& session = it->second.call;
+    if (session.receiverId != receiverId || !session.isPending()) {
+        if (call) *call = session;
+        return session.receiverId != receiverId ? Change::NotReceiver : Change::NotPending;
+    }
+    vacateLocked(session);
+    session.reject(at);
+    if (call) *call = session;
+    archiveLocked(it);
+    return Change::Done;
+}
+
+CallRegistry::Change CallRegistry::end(const std::string& callId, const std::string& userId,
+                                       core::Timestamp at, core::VoiceCallSession* call) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = live_.find(callId);
+    if (it == live_.end()) {
+        const Record* record = history_.find(callId);
+        if (!record) return Change::NotFound;
+        if (call) *call = fromRecord(*record);
+        return record->callerId != userId && record->receiverId != userId
+                   ? Change::NotParticipant
+                   : Change::AlreadyEnded;
+    }
+
+    core::VoiceCallSession& session = it->second.call;
+    if (!session.involvesUser(userId)) {
+        if (call) *call = session;
+        return Change::NotParticipant;
+    }
+    vacateLocked(session);
+    session.end(at);
+    if (call) *call = session;
+    archiveLocked(it);
+    return Change::Done;
+}
+
+void CallRegistry::replaceLocked(std::unordered_map<std::string, Live>::iterator it,
+                                 const core::VoiceCallSession& call) {
+    Live& live = it->second;
+    bool wasPending = live.call.isPending();
+    vacateLocked(live.call);
+    live.call = call;
+    if (call.hasEnded()) {
+        archiveLocked(it);
+        return;
+    }
+    occupyLocked(call);
+    if (call.isPending() && !wasPending) scheduleLocked(live);
+}
+
+bool CallRegistry::update(const core::VoiceCallSession& call) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = live_.find(call.callId);
+    if (it == live_.end()) return false;
+    replaceLocked(it, call);
+    return true;
+}
+
+bool CallRegistry::setStatus(const std::string& callId, core::VoiceCallStatus status,
+                             core::Timestamp endTime) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = live_.find(callId);
+    if (it == live_.end()) return false;
+    core::VoiceCallSession call = it->second.call;
+    call.status = status;
+    if (endTime > 0) call.endTime = endTime;
+    replaceLocked(it, call);
+    return true;
+}
+
+bool CallRegistry::remove(const std::string& callId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = live_.find(callId);
+    if (it != live_.end()) {
+        vacateLocked(it->second.call);
+        live_.erase(it);
+        return true;
+    }
+    return history_.forget(callId);
+}
+
+std::vector<core::VoiceCallSession> CallRegistry::expire(core::Timestamp now) {
+    std::vector<core::VoiceCallSession> missed;
+    std::lock_guard<std::mutex> lock(mutex_);
+    int64_t nowTick = now / TICK;
+    if (nowTick <= sweptTick_) return missed;
+
+    // Each slot once at most, however long since the last sweep
+    int64_t firstTick = std::max(sweptTick_ + 1, nowTick - static_cast<int64_t>(WHEEL_SLOTS) + 1);
+    for (int64_t tick = firstTick; tick <= nowTick; tick++) {
+        std::vector<std::string>& due = wheel_[static_cast<uint64_t>(tick) % WHEEL_SLOTS];
+        size_t kept = 0;
+        for (size_t i = 0; i < due.size(); i++) {
+            auto it = live_.find(due[i]);
+            if (it == live_.end() || !it->second.call.isPending()) continue;
+            if (it->second.deadline > now) {
+                // A later turn of the wheel
+                if (kept != i) due[kept] = std::move(due[i]);
+                kept++;
+                continue;
+            }
+            core::VoiceCallSession& session = it->second.call;
+            vacateLocked(session);
+            session.miss(now);
+            missed.push_back(session);
+            archiveLocked(it);
+        }
+        due.resize(kept);
+    }
+    sweptTick_ = nowTick;
+    return missed;
+}
+
+std::optional<core::VoiceCallSession> CallRegistry::findById(const std::string& callId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = live_.find(callId);
+    if (it != live_.end()) return it->second.call;
+    if (const Record* record = history_.find(callId)) return fromRecord(*record);
+    return std::nullopt;
+}
+
+std::optional<core::VoiceCallSession> CallRegistry::findActiveCall(
+    const std::string& userId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto slot = slots_.find(userId);
+    if (slot == slots_.end() || slot->second.active.empty()) return std::nullopt;
+    auto it = live_.find(slot->second.active);
+    if (it == live_.end()) return std::nullopt;
+    return it->second.call;
+}
+
+bool CallRegistry::isBusy(const std::string& userId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return slots_.count(userId) != 0;
+}
+
+std::vector<core::VoiceCallSession> CallRegistry::findAll() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<core::VoiceCallSession> result;
+    result.reserve(live_.size() + history_.size());
+    for (const auto& pair : live_) result.push_back(pair.second.call);
+    history_.forEach([&](const Record& record) { result.push_back(fromRecord(record)); });
+    return result;
+}
+
+std::vector<core::VoiceCallSession> CallRegistry::findByUser(const std::string& userId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<core::VoiceCallSession> result;
+    for (const auto& pair : live_) {
+        if (pair.second.call.involvesUser(userId)) result.push_back(pair.second.call);
+    }
+    history_.forEach([&](const Record& record) {
+        if (record.callerId == userId || record.receiverId == userId) {
+            result.push_back(fromRecord(record));
+        }
+    });
+    return result;
+}
+
+size_t CallRegistry::count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return live_.size() + history_.size();
+}
+
+size_t CallRegistry::countLive() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return live_.size();
+}
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
@@ -0,0 +1,167 @@
+#ifndef ENGLISH_LEARNING_REPOSITORY_MEMORY_CALL_REGISTRY_H
+#define ENGLISH_LEARNING_REPOSITORY_MEMORY_CALL_REGISTRY_H
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "include/core/voice_call.h"
+#include "src/repository/memory/archive_log.h"
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+/**
+ * Thread-safe registry of voice calls.
+ *
+ * Live (pending or active) calls are hashed by callId, and every user in
+ * one has a slot holding their active call and how many pending calls
+ * they are part of, so checking whether someone is busy is O(1).
+ *
+ * Pending calls ring for at most ringTimeout: their deadlines sit on a
+ * hashed timer wheel of one-second ticks, and expire() turns the ones due
+ * into Missed calls, touching only the ticks that passed since it last
+ * ran. A call that ends, one way or another, leaves the live table for an
+ * ArchiveLog of compact records, where it can still be looked up by callId.
+ */
+class CallRegistry {
+public:
+    static constexpr core::Timestamp DEFAULT_RING_TIMEOUT = 30000;  ///< ms
+    static constexpr size_t DEFAULT_HISTORY_CAPACITY = 10000;
+
+    /** Outcome of a change to a call. */
+    enum class Change {
+        Done,
+        Duplicate,       ///< start/add: the callId is taken
+        NotFound,
+        NotReceiver,     ///< accept/reject by someone else
+        NotParticipant,  ///< end by someone else
+        NotPending,
+        AlreadyEnded,
+        CallerBusy,
+        ReceiverBusy
+    };
+
+    explicit CallRegistry(core::Timestamp ringTimeout = DEFAULT_RING_TIMEOUT,
+                          size_t historyCapacity = DEFAULT_HISTORY_CAPACITY);
+
+    /**
+     * Register a new pending call unless the caller is in a call or
+     * ringing one, or the receiver is in an active call.
+     */
+    Change start(const core::VoiceCallSession& call);
+
+    /** Register a call in any state, without busy checks. */
+    Change add(const core::VoiceCallSession& call);
+
+    /**
+     * Let receiverId answer a pending call; fails with CallerBusy or
+     * ReceiverBusy if either side has gone into another call meanwhile.
+     * The call afterwards (or as found, on failure) goes to call if given.
+     */
+    Change accept(const std::string& callId, const std::string& receiverId,
+                  core::Timestamp at, core::VoiceCallSession* call = nullptr);
+
+    /** Same as accept(), turning the call down. */
+    Change reject(const std::string& callId, const std::string& receiverId,
+                  core::Timestamp at, core::VoiceCallSession* call = nullptr);
+
+    /** Hang up a pending or active call userId is part of. */
+    Change end(const std::string& callId, const std::string& userId, core::Timestamp at,
+               core::VoiceCallSession* call = nullptr);
+
+    /** Replace a live call, e.g. with a new status; false if not live. */
+    bool update(const core::VoiceCallSession& call);
+
+    /** Set a live call's status, and its endTime unless 0. */
+    bool setStatus(const std::string& callId, core::VoiceCallStatus status,
+                   core::Timestamp endTime = 0);
+
+    /** Forget a call, live or archived. */
+    bool remove(const std::string& callId);
+
+    /**
+     * Mark every pending call whose deadline is at or before now as
+     * Missed, archive them and return them.
+     */
+    std::vector<core::VoiceCallSession> expire(core::Timestamp now);
+
+    /** A live call, or an archived one with an empty audioSource. */
+    std::optional<core::VoiceCallSession> findById(const std::string& callId) const;
+
+    /** The active call userId is in, if any. */
+    std::optional<core::VoiceCallSession> findActiveCall(const std::string& userId) const;
+
+    /** Pending or active. */
+    bool isBusy(const std::string& userId) const;
+
+    /** Live calls first, then the history oldest first. */
+    std::vector<core::VoiceCallSession> findAll() const;
+    std::vector<core::VoiceCallSession> findByUser(const std::string& userId) const;
+    /** Live calls matching pred(const core::VoiceCallSession&). */
+    template <typename Pred>
+    std::vector<core::VoiceCallSession> findLive(Pred&& pred) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<core::VoiceCallSession> result;
+        for (const auto& pair : live_) {
+            if (pred(pair.second.call)) result.push_back(pair.second.call);
+        }
+        return result;
+    }
+
+    size_t count() const;
+    size_t countLive() const;
+
+private:
+    static constexpr core::Timestamp TICK = 1000;  ///< ms per wheel slot
+    static constexpr size_t WHEEL_SLOTS = 64;
+
+    struct Live {
+        core::VoiceCallSession call;
+        core::Timestamp deadline = 0;  ///< Ringing until, while pending
+    };
+
+    struct Slot {
+        std::string active;  ///< callId, empty if none
+        uint32_t pending = 0;
+    };
+
+    /** An archived call: no audio source, status in a byte. */
+    struct Record {
+        std::string callId;
+        std::string callerId;
+        std::string receiverId;
+        core::Timestamp startTime;
+        core::Timestamp acceptTime;
+        core::Timestamp endTime;
+        core::VoiceCallStatus status;
+    };
+
+    void occupyLocked(const core::VoiceCallSession& call);
+    void vacateLocked(const core::VoiceCallSession& call);
+    void scheduleLocked(Live& live);
+    /** Move a call that has ended from live_ to the history. */
+    void archiveLocked(std::unordered_map<std::string, Live>::iterator it);
+    Change insertLocked(const core::VoiceCallSession& call);
+    void replaceLocked(std::unordered_map<std::string, Live>::iterator it,
+                       const core::VoiceCallSession& call);
+    static core::VoiceCallSession fromRecord(const Record& record);
+
+    const core::Timestamp ringTimeout_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Live> live_;
+    std::unordered_map<std::string, Slot> slots_;  ///< userId -> live calls of theirs
+    std::vector<std::string> wheel_[WHEEL_SLOTS];  ///< callIds by deadline tick
+    int64_t sweptTick_ = -1;                        ///< Last tick expire() went past
+    ArchiveLog<Record, &Record::callId> history_;
+};
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_REPOSITORY_MEMORY_CALL_REGISTRY_H
@@ -0,0 +1,149 @@
+#ifndef ENGLISH_LEARNING_REPOSITORY_MEMORY_CATALOG_H
+#define ENGLISH_LEARNING_REPOSITORY_MEMORY_CATALOG_H
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+/**
+ * Read-mostly collection (lessons, tests, games) keyed by ID and published
+ * as immutable, versioned snapshots, read-copy-update style.
+ *
+ * snapshot() loads the current version with one atomic shared_ptr load and
+ * never waits for a writer: the reader keeps a consistent view for as long
+ * as it holds the pointer, however many edits are published meanwhile.
+ * Writers serialize among themselves, copy the current map, edit the copy
+ * and publish it with an atomic pointer swap; a superseded version is freed
+ * when its last reader lets go.
+ */
+template <typename T>
+class Catalog {
+public:
+    using Map = std::map<std::string, T>;
+
+    struct Snapshot {
+        uint64_t version = 0;  ///< Incremented on every publish
+        Map items;
+
+        /** Item with this ID, or nullptr; valid while the snapshot is held. */
+        const T* find(const std::string& id) const {
+            auto it = items.find(id);
+            return it == items.end() ? nullptr : &it->second;
+        }
+    };
+
+    using SnapshotPtr = std::shared_ptr<const Snapshot>;
+
+    Catalog() : current_(std::make_shared<const Snapshot>()) {}
+
+    Catalog(const Catalog&) = delete;
+    Catalog& operator=(const Catalog&) = delete;
+
+    /** The current version. */
+    SnapshotPtr snapshot() const {
+        return std::atomic_load_explicit(&current_, std::memory_order_acquire);
+    }
+
+    size_t size() const { return snapshot()->items.size(); }
+
+    /** Replace the whole collection (initial load). */
+    void publish(Map items) {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        auto next = std::make_shared<Snapshot>();
+        next->version = snapshot()->version + 1;
+        next->items = std::move(items);
+        store(std::move(next));
+    }
+
+    /**
+     * Run edit(Map&) on a copy of the current version and publish the copy
+     * if edit returns true. Concurrent update() calls run one at a time, so
+     * an edit always starts from the latest version.
+     * @return what edit returned
+     */
+    template <typename Edit>
+    bool update(Edit&& edit) {
+        std::lock_guard<std::mutex> lock(writeMutex_);
+        SnapshotPtr current = snapshot();
+        auto next = std::make_shared<Snapshot>();
+        next->items = current->items;
+        if (!edit(next->items)) return false;
+        next->version = current->version + 1;
+        store(std::move(next));
+        return true;
+    }
+
+private:
+    void store(std::shared_ptr<Snapshot> next) {
+        std::atomic_store_explicit(&current_, SnapshotPtr(std::move(next)),
+                                   std::memory_order_release);
+    }
+
+    SnapshotPtr current_;    ///< Accessed only through the atomic shared_ptr functions
+    std::mutex writeMutex_;  ///< Serializes writers; readers never take it
+};
+
+/**
+ * Data derived from a catalog (an index, compiled lookup tables) and kept
+ * in step with it. View is constructed from a snapshot's items;
+ * current() costs two atomic loads while the catalog is unchanged, and
+ * the first call after an edit rebuilds the view, once, while other
+ * callers wait for it. The returned view keeps its snapshot alive, so
+ * pointers into the items stay valid as long as the view is held.
+ */
+template <typename T, typename View>
+class CatalogView {
+public:
+    explicit CatalogView(const Catalog<T>& catalog) : catalog_(catalog) {}
+
+    CatalogView(const CatalogView&) = delete;
+    CatalogView& operator=(const CatalogView&) = delete;
+
+    std::shared_ptr<const View> current() const {
+        auto snapshot = catalog_.snapshot();
+        auto built = std::atomic_load_explicit(&built_, std::memory_order_acquire);
+        if (built && built->snapshot->version >= snapshot->version) return alias(built);
+
+        std::lock_guard<std::mutex> lock(rebuildMutex_);
+        // Someone else may have rebuilt it while we waited
+        snapshot = catalog_.snapshot();
+        built = std::atomic_load_explicit(&built_, std::memory_order_acquire);
+        if (built && built->snapshot->version >= snapshot->version) return alias(built);
+
+        built = std::make_shared<const Built>(std::move(snapshot));
+        std::atomic_store_explicit(&built_, built, std::memory_order_release);
+        return alias(built);
+    }
+
+private:
+    using SnapshotPtr = typename Catalog<T>::SnapshotPtr;
+
+    struct Built {
+        SnapshotPtr snapshot;
+        View view;
+
+        explicit Built(SnapshotPtr source)
+            : snapshot(std::move(source)), view(snapshot->items) {}
+    };
+
+    static std::shared_ptr<const View> alias(const std::shared_ptr<const Built>& built) {
+        return std::shared_ptr<const View>(built, &built->view);
+    }
+
+    const Catalog<T>& catalog_;
+    mutable std::shared_ptr<const Built> built_;  ///< Atomic shared_ptr functions only
+    mutable std::mutex rebuildMutex_;
+};
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_REPOSITORY_MEMORY_CATALOG_H
@@ -0,0 +1,297 @@
+#include "src/repository/memory/chat_store.h"
+
+#include <algorithm>
+#include <utility>
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+std::string ChatStore::conversationKey(const std::string& user1, const std::string& user2) {
+    const std::string& low = user1 < user2 ? user1 : user2;
+    const std::string& high = user1 < user2 ? user2 : user1;
+    std::string key;
+    key.reserve(low.size() + high.size() + 1);
+    key += low;
+    key += '\x1f';  // cannot appear in a user ID
+    key += high;
+    return key;
+}
+
+const ChatStore::Conversation* ChatStore::findConversationLocked(
+    const std::string& user1, const std::string& user2) const {
+    auto it = conversations_.find(conversationKey(user1, user2));
+    return it == conversations_.end() ? nullptr : &it->second;
+}
+
+bool ChatStore::pageRange(const Conversation* conversation, const ChatHistoryQuery& query,
+                          size_t& begin, size_t& end, ChatPageInfo& info) const {
+    if (conversation == nullptr) {
+        info.valid = query.beforeId.empty() && query.afterId.empty();
+        return false;
+    }
+
+    const auto& messages = conversation->messages;
+    auto resolve = [&](const std::string& id, size_t& index) {
+        auto it = byId_.find(id);
+        if (it == byId_.end() || it->second.conversation != conversation) return false;
+        index = it->second.index;
+        return true;
+    };
+    // Messages are appended in send order, so timestamps are non-decreasing
+    auto byTime = [](const core::ChatMessage& message, core::Timestamp time) {
+        return message.timestamp < time;
+    };
+    auto timeBefore = [](core::Timestamp time, const core::ChatMessage& message) {
+        return time < message.timestamp;
+    };
+
+    size_t low = 0;
+    size_t high = messages.size();
+    bool forward = false;
+    if (!query.afterId.empty()) {
+        if (!resolve(query.afterId, low)) {
+            info.valid = false;
+            return false;
+        }
+        low++;
+        forward = true;
+    } else if (query.afterTime != 0) {
+        low = std::upper_bound(messages.begin(), messages.end(), query.afterTime, timeBefore) -
+              messages.begin();
+        forward = true;
+    }
+    if (!query.beforeId.empty()) {
+        if (!resolve(query.beforeId, high)) {
+            info.valid = false;
+            return false;
+        }
+    } else if (query.beforeTime != 0) {
+        high = std::lower_bound(messages.begin(), messages.end(), query.beforeTime, byTime) -
+               messages.begin();
+    }
+    if (low > high) low = high;
+
+    begin = low;
+    end = high;
+    if (query.limit != 0 && high - low > query.limit) {
+        if (forward) {
+            end = low + query.limit;
+        } else {
+            begin = high - query.limit;
+        }
+        info.hasMore = true;
+    }
+    return true;
+}
+
+void ChatStore::add(const core::ChatMessage& message) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    auto inserted = conversations_.try_emplace(
+        conversationKey(message.senderId, message.recipientId));
+    Conversation& conversation = inserted.first->second;
+    if (inserted.second) {
+        bool senderFirst = message.senderId <= message.recipientId;
+        conversation.users[0] = senderFirst ? message.senderId : message.recipientId;
+        conversation.users[1] = senderFirst ? message.recipientId : message.senderId;
+        users_[conversation.users[0]].conversations.push_back(&conversation);
+        if (conversation.users[1] != conversation.users[0]) {
+            users_[conversation.users[1]].conversations.push_back(&conversation);
+        }
+    }
+
+    size_t index = conversation.messages.size();
+    conversation.messages.push_back(message);
+    conversation.sequence.push_back(nextSequence_++);
+    byId_[message.messageId] = Location{&conversation, index};
+    count_++;
+
+    if (!message.read) {
+        conversation.unread[conversation.side(message.recipientId)]++;
+        users_[message.recipientId].unread++;
+    }
+}
+
+std::optional<core::ChatMessage> ChatStore::findById(const std::string& messageId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = byId_.find(messageId);
+    if (it == byId_.end()) return std::nullopt;
+    return it->second.conversation->messages[it->second.index];
+}
+
+void ChatStore::collectInOrder(const std::vector<const Conversation*>& conversations,
+                               std::vector<core::ChatMessage>& out) const {
+    std::vector<std::pair<uint64_t, const core::ChatMessage*>> ordered;
+    for (const Conversation* conversation : conversations) {
+        for (size_t i = 0; i < conversation->messages.size(); i++) {
+            ordered.emplace_back(conversation->sequence[i], &conversation->messages[i]);
+        }
+    }
+    std::sort(ordered.begin(), ordered.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    out.reserve(ordered.size());
+    for (const auto& entry : ordered) out.push_back(*entry.second);
+}
+
+std::vector<core::ChatMessage> ChatStore::findAll() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<const Conversation*> all;
+    all.reserve(conversations_.size());
+    for (const auto& pair : conversations_) all.push_back(&pair.second);
+
+    std::vector<core::ChatMessage> result;
+    collectInOrder(all, result);
+    return result;
+}
+
+std::vector<core::ChatMessage> ChatStore::findByUser(const std::string& userId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<core::ChatMessage> result;
+    auto it = users_.find(userId);
+    if (it == users_.end()) return result;
+
+    std::vector<const Conversation*> mine(it->second.conversations.begin(),
+                                          it->second.conversations.end());
+    collectInOrder(mine, result);
+    return result;
+}
+
+std::vector<core::ChatMessage> ChatStore::findConversation(const std::string& user1,
+                                                           const std::string& user2) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Conversation* conversation = findConversationLocked(user1, user2);
+    if (conversation == nullptr) return {};
+    return conversation->messages;
+}
+
+std::vector<const core::ChatMessage*> ChatStore::unreadLocked(const std::string& userId) const {
+    std::vector<const core::ChatMessage*> result;
+    auto it = users_.find(userId);
+    if (it == users_.end() || it->second.unread == 0) return result;
+
+    std::vector<std::pair<uint64_t, const core::ChatMessage*>> ordered;
+    for (const Conversation* conversation : it->second.conversations) {
+        int side = conversation->side(userId);
+        if (conversation->unread[side] == 0) continue;
+        for (size_t i = conversation->firstUnread[side]; i < conversation->messages.size(); i++) {
+            const core::ChatMessage& message = conversation->messages[i];
+            if (message.recipientId == userId && !message.read) {
+                ordered.emplace_back(conversation->sequence[i], &message);
+            }
+        }
+    }
+    std::sort(ordered.begin(), ordered.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    result.reserve(ordered.size());
+    for (const auto& entry : ordered) result.push_back(entry.second);
+    return result;
+}
+
+std::vector<core::ChatMessage> ChatStore::findUnreadFor(const std::string& userId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<core::ChatMessage> result;
+    for (const auto* message : unreadLocked(userId)) result.push_back(*message);
+    return result;
+}
+
+size_t ChatStore::countUnreadFor(const std::string& userId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = users_.find(userId);
+    return it == users_.end() ? 0 : it->second.unread;
+}
+
+size_t ChatStore::countUnreadFrom(const std::string& recipientId,
+                                  const std::string& senderId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Conversation* conversation = findConversationLocked(recipientId, senderId);
+    if (conversation == nullptr) return 0;
+    // In a conversation with oneself both sides are the same user
+    return conversation->unread[conversation->side(recipientId)];
+}
+
+void ChatStore::markReadLocked(Conversation& conversation, size_t index) {
+    core::ChatMessage& message = conversation.messages[index];
+    if (message.read) return;
+    message.read = true;
+
+    int side = conversation.side(message.recipientId);
+    conversation.unread[side]--;
+    users_[message.recipientId].unread--;
+
+    // Skip the lower bound past messages that no longer need scanning
+    size_t& first = conversation.firstUnread[side];
+    while (first < conversation.messages.size() &&
+           (conversation.messages[first].read ||
+            conversation.messages[first].recipientId != message.recipientId)) {
+        first++;
+    }
+}
+
+bool ChatStore::markAsRead(const std::string& messageId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = byId_.find(messageId);
+    if (it == byId_.end()) return false;
+    markReadLocked(*it->second.conversation, it->second.index);
+    return true;
+}
+
+size_t ChatStore::markConversationAsRead(const std::string& recipientId,
+                                         const std::string& senderId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = conversations_.find(conversationKey(recipientId, senderId));
+    if (it == conversations_.end()) return 0;
+
+    Conversation& conversation = it->second;
+    int side = conversation.side(recipientId);
+    size_t marked = 0;
+    for (size_t i = conversation.firstUnread[side];
+         i < conversation.messages.size() && conversation.unread[side] > 0; i++) {
+        const core::ChatMessage& message = conversation.messages[i];
+        if (message.recipientId == recipientId && message.senderId == senderId &&
+            !message.read) {
+            markReadLocked(conversation, i);
+            marked++;
+        }
+    }
+    return marked;
+}
+
+bool ChatStore::remove(const std::string& messageId) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = byId_.find(messageId);
+    if (it == byId_.end()) return false;
+
+    Conversation& conversation = *it->second.conversation;
+    size_t index = it->second.index;
+    byId_.erase(it);
+
+    const core::ChatMessage& message = conversation.messages[index];
+    if (!message.read) {
+        conversation.unread[conversation.side(message.recipientId)]--;
+        users_[message.recipientId].unread--;
+    }
+
+    // Rare operation: close the gap and renumber what followed
+    conversation.messages.erase(conversation.messages.begin() + index);
+    conversation.sequence.erase(conversation.sequence.begin() + index);
+    for (size_t i = index; i < conversation.messages.size(); i++) {
+        byId_[conversation.messages[i].messageId].index = i;
+    }
+    for (size_t& first : conversation.firstUnread) {
+        if (first > index) first--;
+    }
+    count_--;
+    return true;
+}
+
+size_t ChatStore::count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return count_;
+}
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
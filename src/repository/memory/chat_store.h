@@ -0,0 +1,163 @@
+#ifndef ENGLISH_LEARNING_REPOSITORY_MEMORY_CHAT_STORE_H
+#define ENGLISH_LEARNING_REPOSITORY_MEMORY_CHAT_STORE_H
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "include/core/chat_message.h"
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+/**
+ * Window of a conversation for paginated history. Each cursor is a
+ * messageId, or a timestamp when the id is empty (0 = no cursor). Without
+ * an after cursor the page is the newest `limit` messages before `before`;
+ * with one it is the oldest `limit` messages after it, which is how
+ * clients fetch only what arrived since their last sync.
+ */
+struct ChatHistoryQuery {
+    std::string beforeId;
+    core::Timestamp beforeTime = 0;
+    std::string afterId;
+    core::Timestamp afterTime = 0;
+    size_t limit = 0;  ///< 0 = the whole window
+};
+
+struct ChatPageInfo {
+    bool valid = true;     ///< false if a cursor messageId is not in the conversation
+    bool hasMore = false;  ///< More messages lie beyond the page, in its paging direction
+};
+
+/**
+ * Thread-safe chat message store indexed by conversation.
+ *
+ * Messages live in append-only per-conversation segments keyed by the
+ * unordered pair of participants, so reading or marking a conversation
+ * costs its own size rather than the total message volume. Unread counts
+ * are kept per participant and per user and updated on every add and
+ * mark-read, which makes countUnreadFor() O(1) and lets findUnreadFor()
+ * start scanning each conversation at its first unread message.
+ */
+class ChatStore {
+public:
+    void add(const core::ChatMessage& message);
+
+    std::optional<core::ChatMessage> findById(const std::string& messageId) const;
+
+    /** Every message, in the order they were added. */
+    std::vector<core::ChatMessage> findAll() const;
+
+    /** Messages sent or received by userId, in the order they were added. */
+    std::vector<core::ChatMessage> findByUser(const std::string& userId) const;
+
+    /** Messages between two users (either direction), oldest first. */
+    std::vector<core::ChatMessage> findConversation(const std::string& user1,
+                                                     const std::string& user2) const;
+
+    /** Unread messages addressed to userId, in the order they were added. */
+    std::vector<core::ChatMessage> findUnreadFor(const std::string& userId) const;
+
+    size_t countUnreadFor(const std::string& userId) const;
+
+    /** Unread messages from senderId to recipientId. */
+    size_t countUnreadFrom(const std::string& recipientId, const std::string& senderId) const;
+
+    bool markAsRead(const std::string& messageId);
+
+    /** Mark everything senderId sent to recipientId as read; returns how many. */
+    size_t markConversationAsRead(const std::string& recipientId, const std::string& senderId);
+
+    bool remove(const std::string& messageId);
+
+    size_t count() const;
+
+    /**
+     * Call fn(const core::ChatMessage&) for each message between two users,
+     * oldest first, while holding the store's lock. Lets callers serialize
+     * a conversation without copying it; fn must not call back into the
+     * store.
+     */
+    template <typename Fn>
+    void forEachInConversation(const std::string& user1, const std::string& user2,
+                               Fn&& fn) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const Conversation* conversation = findConversationLocked(user1, user2);
+        if (conversation == nullptr) return;
+        for (const auto& message : conversation->messages) fn(message);
+    }
+
+    /**
+     * Like forEachInConversation(), restricted to the page that query
+     * selects; messages are still passed oldest first.
+     */
+    template <typename Fn>
+    ChatPageInfo forEachInConversationPage(const std::string& user1, const std::string& user2,
+                                           const ChatHistoryQuery& query, Fn&& fn) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ChatPageInfo info;
+        size_t begin = 0;
+        size_t end = 0;
+        const Conversation* conversation = findConversationLocked(user1, user2);
+        if (!pageRange(conversation, query, begin, end, info)) return info;
+        for (size_t i = begin; i < end; i++) fn(conversation->messages[i]);
+        return info;
+    }
+
+    /** Same as forEachInConversation() over the unread messages for userId. */
+    template <typename Fn>
+    void forEachUnreadFor(const std::string& userId, Fn&& fn) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto* message : unreadLocked(userId)) fn(*message);
+    }
+
+private:
+    struct Conversation {
+        std::string users[2];              ///< Participants, users[0] <= users[1]
+        std::vector<core::ChatMessage> messages;
+        std::vector<uint64_t> sequence;    ///< Store-wide insertion order of each message
+        size_t unread[2] = {0, 0};         ///< Unread messages addressed to users[i]
+        size_t firstUnread[2] = {0, 0};    ///< No unread message for users[i] before this index
+
+        int side(const std::string& userId) const { return userId == users[0] ? 0 : 1; }
+    };
+
+    struct UserIndex {
+        size_t unread = 0;
+        std::vector<Conversation*> conversations;
+    };
+
+    struct Location {
+        Conversation* conversation;
+        size_t index;
+    };
+
+    static std::string conversationKey(const std::string& user1, const std::string& user2);
+
+    const Conversation* findConversationLocked(const std::string& user1,
+                                               const std::string& user2) const;
+    bool pageRange(const Conversation* conversation, const ChatHistoryQuery& query,
+                   size_t& begin, size_t& end, ChatPageInfo& info) const;
+    std::vector<const core::ChatMessage*> unreadLocked(const std::string& userId) const;
+    void markReadLocked(Conversation& conversation, size_t index);
+    void collectInOrder(const std::vector<const Conversation*>& conversations,
+                        std::vector<core::ChatMessage>& out) const;
+
+    mutable std::mutex mutex_;
+    // Node-based maps: Conversation pointers stay valid as they grow
+    std::unordered_map<std::string, Conversation> conversations_;
+    std::unordered_map<std::string, UserIndex> users_;
+    std::unordered_map<std::string, Location> byId_;
+    uint64_t nextSequence_ = 0;
+    size_t count_ = 0;
+};
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_REPOSITORY_MEMORY_CHAT_STORE_H
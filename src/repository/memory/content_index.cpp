@@ -0,0 +1,135 @@
+#include "src/repository/memory/content_index.h"
+
+#include <utility>
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+namespace {
+
+/// Row code of a name that is not one of the enum's values
+constexpr uint8_t UNKNOWN = 0xFF;
+
+uint8_t gameTypeCode(const std::string& gameType) {
+    core::GameType parsed;
+    return core::parseGameType(gameType, parsed) ? static_cast<uint8_t>(parsed) : UNKNOWN;
+}
+
+uint8_t levelCode(const std::string& level) {
+    core::Level parsed;
+    return core::parseLevel(level, parsed) ? static_cast<uint8_t>(parsed) : UNKNOWN;
+}
+
+// One filter of a listing: empty matches anything, a known name compares
+// row codes, any other name compares the item's string, which only rows
+// coded UNKNOWN can equal
+class Filter {
+public:
+    Filter(const std::string& name, uint8_t code) : name_(name), code_(code) {}
+
+    bool matches(uint8_t rowCode, const std::string& field) const {
+        if (name_.empty()) return true;
+        if (code_ != UNKNOWN) return rowCode == code_;
+        return rowCode == UNKNOWN && field == name_;
+    }
+
+private:
+    const std::string& name_;
+    uint8_t code_;
+};
+
+} // namespace
+
+GameIndex::GameIndex(const Catalog<core::Game>::Map& games) {
+    rows_.reserve(games.size());
+    games_.reserve(games.size());
+    fragments_.reserve(games.size());
+    for (const auto& pair : games) {
+        const core::Game& game = pair.second;
+        rows_.push_back(Row{gameTypeCode(game.gameType), levelCode(game.level)});
+        games_.push_back(&game);
+
+        std::string fragment;
+        protocol::JsonWriter(fragment)
+            .beginObject()
+            .field("gameId", game.gameId)
+            .field("gameType", game.gameType)
+            .field("title", game.title)
+            .field("description", game.description)
+            .field("level", game.level)
+            .field("topic", game.topic)
+            .fieldInt("timeLimit", game.timeLimit)
+            .fieldInt("maxScore", game.maxScore)
+            .endObject();
+        fragments_.push_back(std::move(fragment));
+    }
+}
+
+template <typename Fn>
+void GameIndex::forEachMatch(const std::string& gameType, const std::string& level,
+                             Fn&& fn) const {
+    Filter typeFilter(gameType, gameTypeCode(gameType));
+    Filter levelFilter(level, levelCode(level));
+    for (size_t i = 0; i < rows_.size(); i++) {
+        if (typeFilter.matches(rows_[i].gameType, games_[i]->gameType) &&
+            levelFilter.matches(rows_[i].level, games_[i]->level)) {
+            fn(i);
+        }
+    }
+}
+
+std::vector<const core::Game*> GameIndex::select(const std::string& gameType,
+                                                 const std::string& level) const {
+    std::vector<const core::Game*> result;
+    forEachMatch(gameType, level, [&](size_t i) { result.push_back(games_[i]); });
+    return result;
+}
+
+size_t GameIndex::writeListing(protocol::JsonWriter& writer, const std::string& gameType,
+                               const std::string& level) const {
+    size_t written = 0;
+    forEachMatch(gameType, level, [&](size_t i) {
+        writer.raw(fragments_[i]);
+        written++;
+    });
+    return written;
+}
+
+TestIndex::TestIndex(const Catalog<core::Test>::Map& tests) {
+    levels_.reserve(tests.size());
+    tests_.reserve(tests.size());
+    for (const auto& pair : tests) {
+        const core::Test& test = pair.second;
+        uint8_t level = levelCode(test.level);
+        if (level != UNKNOWN && !firstOfLevel_[level]) firstOfLevel_[level] = &test;
+        levels_.push_back(level);
+        tests_.push_back(&test);
+    }
+}
+
+std::vector<const core::Test*> TestIndex::select(const std::string& level,
+                                                 const std::string& testType) const {
+    Filter levelFilter(level, levelCode(level));
+    std::vector<const core::Test*> result;
+    for (size_t i = 0; i < levels_.size(); i++) {
+        if (levelFilter.matches(levels_[i], tests_[i]->level) &&
+            (testType.empty() || tests_[i]->testType == testType)) {
+            result.push_back(tests_[i]);
+        }
+    }
+    return result;
+}
+
+const core::Test* TestIndex::firstOfLevel(const std::string& level) const {
+    uint8_t code = levelCode(level);
+    if (code != UNKNOWN) return firstOfLevel_[code];
+    for (size_t i = 0; i < levels_.size(); i++) {
+        if (levels_[i] == UNKNOWN && tests_[i]->level == level) return tests_[i];
+    }
+    return nullptr;
+}
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
@@ -0,0 +1,100 @@
+#ifndef ENGLISH_LEARNING_REPOSITORY_MEMORY_CONTENT_INDEX_H
+#define ENGLISH_LEARNING_REPOSITORY_MEMORY_CONTENT_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "include/core/game.h"
+#include "include/core/test.h"
+#include "include/protocol/json_writer.h"
+#include "src/repository/memory/catalog.h"
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+/**
+ * Immutable filter index over one version of the game catalog.
+ *
+ * Each game's (gameType, level) pair is enum-coded into a two-byte row,
+ * and the rows are packed in one array, in gameId order, so a filtered
+ * listing scans a few bytes per game instead of comparing two strings
+ * held in a struct of several hundred bytes. Everything else a listing
+ * needs, the description included, lives apart in a pre-serialized and
+ * escaped listing object per game that is only touched for the games
+ * that match. Games whose type or level is not one of the known names,
+ * and filters that name an unknown one, are matched by comparing strings.
+ *
+ * Kept current by GameIndexCache, whose views hold their catalog
+ * snapshot, so the Game pointers handed out stay valid for as long as
+ * the index is held.
+ */
+class GameIndex {
+public:
+    explicit GameIndex(const Catalog<core::Game>::Map& games);
+
+    /** Games matching both filters (empty = any), in gameId order. */
+    std::vector<const core::Game*> select(const std::string& gameType,
+                                          const std::string& level) const;
+
+    /**
+     * Write the GET_GAME_LIST object of every matching game into the
+     * array the writer is in.
+     * @return how many were written
+     */
+    size_t writeListing(protocol::JsonWriter& writer, const std::string& gameType,
+                        const std::string& level) const;
+
+private:
+    struct Row {
+        uint8_t gameType;  ///< core::GameType, or UNKNOWN
+        uint8_t level;     ///< core::Level, or UNKNOWN
+    };
+
+    template <typename Fn>
+    void forEachMatch(const std::string& gameType, const std::string& level, Fn&& fn) const;
+
+    std::vector<Row> rows_;                 ///< Hot: scanned by every filter
+    std::vector<const core::Game*> games_;  ///< Parallel to rows_
+    std::vector<std::string> fragments_;    ///< Cold: pre-escaped listing objects
+};
+
+/**
+ * Immutable filter index over one version of the test catalog: tests'
+ * levels enum-coded into a packed array in testId order, the first test
+ * of each level resolved up front for GET_TEST. Test types are free-form
+ * and compared as strings.
+ */
+class TestIndex {
+public:
+    explicit TestIndex(const Catalog<core::Test>::Map& tests);
+
+    /** Tests matching both filters (empty = any), in testId order. */
+    std::vector<const core::Test*> select(const std::string& level,
+                                          const std::string& testType) const;
+
+    /** The first test of level in testId order, or nullptr. */
+    const core::Test* firstOfLevel(const std::string& level) const;
+
+    /** The first test in testId order, or nullptr if there are none. */
+    const core::Test* first() const { return tests_.empty() ? nullptr : tests_.front(); }
+
+private:
+    static constexpr size_t LEVELS = 3;  ///< core::Level values
+
+    std::vector<uint8_t> levels_;           ///< core::Level, or UNKNOWN
+    std::vector<const core::Test*> tests_;  ///< Parallel to levels_
+    const core::Test* firstOfLevel_[LEVELS] = {};
+};
+
+/** The GameIndex of the game catalog's current version. */
+using GameIndexCache = CatalogView<core::Game, GameIndex>;
+
+/** The TestIndex of the test catalog's current version. */
+using TestIndexCache = CatalogView<core::Test, TestIndex>;
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_REPOSITORY_MEMORY_CONTENT_INDEX_H
@@ -0,0 +1,147 @@
+#include "src/repository/memory/game_session_store.h"
+
+#include <algorithm>
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+GameSessionStore::GameSessionStore(core::Timestamp grace, size_t historyCapacity)
+    : grace_(grace), history_(historyCapacity) {}
+
+void GameSessionStore::archiveLocked(std::unordered_map<std::string, Live>::iterator it) {
+    const core::GameSession& session = it->second.session;
+    history_.append(Record{session.sessionId, session.gameId, session.userId,
+                           session.startTime, session.endTime, session.score,
+                           session.maxScore, session.completed});
+    live_.erase(it);
+}
+
+core::GameSession GameSessionStore::fromRecord(const Record& record) {
+    core::GameSession session(record.sessionId, record.gameId, record.userId, record.startTime,
+                              record.maxScore);
+    session.endTime = record.endTime;
+    session.score = record.score;
+    session.completed = record.completed;
+    return session;
+}
+
+bool GameSessionStore::add(const core::GameSession& session, int timeLimitSeconds) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (live_.count(session.sessionId) != 0 || history_.contains(session.sessionId)) {
+        return false;
+    }
+    core::Timestamp deadline =
+        session.startTime + static_cast<core::Timestamp>(std::max(timeLimitSeconds, 0)) * 1000 +
+        grace_;
+    auto it = live_.emplace(session.sessionId, Live{session, deadline}).first;
+    if (session.completed) {
+        archiveLocked(it);
+    } else {
+        deadlines_.emplace(deadline, session.sessionId);
+    }
+    return true;
+}
+
+std::optional<core::GameSession> GameSessionStore::findById(const std::string& sessionId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = live_.find(sessionId);
+    if (it != live_.end()) return it->second.session;
+    if (const Record* record = history_.find(sessionId)) return fromRecord(*record);
+    return std::nullopt;
+}
+
+bool GameSessionStore::isExpired(const std::string& sessionId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Record* record = history_.find(sessionId);
+    return record && !record->completed;
+}
+
+std::vector<core::GameSession> GameSessionStore::findByUser(const std::string& userId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<core::GameSession> result;
+    for (const auto& pair : live_) {
+        if (pair.second.session.userId == userId) result.push_back(pair.second.session);
+    }
+    history_.forEach([&](const Record& record) {
+        if (record.userId == userId) result.push_back(fromRecord(record));
+    });
+    return result;
+}
+
+std::vector<core::GameSession> GameSessionStore::findByGame(const std::string& gameId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<core::GameSession> result;
+    for (const auto& pair : live_) {
+        if (pair.second.session.gameId == gameId) result.push_back(pair.second.session);
+    }
+    history_.forEach([&](const Record& record) {
+        if (record.gameId == gameId) result.push_back(fromRecord(record));
+    });
+    return result;
+}
+
+std::vector<core::GameSession> GameSessionStore::findActiveByUser(
+    const std::string& userId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<core::GameSession> result;
+    for (const auto& pair : live_) {
+        if (pair.second.session.userId == userId) result.push_back(pair.second.session);
+    }
+    return result;
+}
+
+bool GameSessionStore::update(const core::GameSession& session) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = live_.find(session.sessionId);
+    if (it == live_.end()) return false;
+    it->second.session = session;
+    if (session.completed) archiveLocked(it);
+    return true;
+}
+
+GameSessionStore::Completion GameSessionStore::complete(const std::string& sessionId, int score,
+                                                        core::Timestamp endTime,
+                                                        core::GameSession* completed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = live_.find(sessionId);
+    if (it == live_.end()) {
+        const Record* record = history_.find(sessionId);
+        if (!record) return Completion::NotFound;
+        if (completed) *completed = fromRecord(*record);
+        return record->completed ? Completion::AlreadyCompleted : Completion::Expired;
+    }
+    it->second.session.complete(score, endTime);
+    if (completed) *completed = it->second.session;
+    archiveLocked(it);
+    return Completion::Done;
+}
+
+size_t GameSessionStore::expire(core::Timestamp now) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    size_t expired = 0;
+    while (!deadlines_.empty() && deadlines_.top().first <= now) {
+        auto it = live_.find(deadlines_.top().second);
+        // Completed meanwhile, or an older session with the same id
+        if (it != live_.end() && it->second.deadline == deadlines_.top().first) {
+            archiveLocked(it);
+            expired++;
+        }
+        deadlines_.pop();
+    }
+    return expired;
+}
+
+size_t GameSessionStore::count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return live_.size() + history_.size();
+}
+
+size_t GameSessionStore::countLive() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return live_.size();
+}
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
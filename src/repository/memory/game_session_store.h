@@ -0,0 +1,115 @@
+#ifndef ENGLISH_LEARNING_REPOSITORY_MEMORY_GAME_SESSION_STORE_H
+#define ENGLISH_LEARNING_REPOSITORY_MEMORY_GAME_SESSION_STORE_H
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <queue>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "include/core/game.h"
+#include "src/repository/memory/archive_log.h"
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+/**
+ * Thread-safe store of game sessions with a time to live.
+ *
+ * A session being played lives in a hash table until it is completed or
+ * its deadline passes: the game's timeLimit after it started, plus a
+ * grace period for slow clients. Deadlines are kept in a min-heap, so
+ * expire() only looks at sessions that are due. Completed and expired
+ * (abandoned) sessions leave the table for an ArchiveLog of records that
+ * keep the score but not the answers.
+ */
+class GameSessionStore {
+public:
+    static constexpr core::Timestamp DEFAULT_GRACE = 60000;  ///< ms
+    static constexpr size_t DEFAULT_HISTORY_CAPACITY = 50000;
+
+    /** Outcome of complete(). */
+    enum class Completion { Done, NotFound, AlreadyCompleted, Expired };
+
+    explicit GameSessionStore(core::Timestamp grace = DEFAULT_GRACE,
+                              size_t historyCapacity = DEFAULT_HISTORY_CAPACITY);
+
+    /**
+     * Track a session that expires timeLimitSeconds (plus the grace
+     * period) after its startTime; false if the sessionId is taken.
+     * A session added already completed goes straight to the history.
+     */
+    bool add(const core::GameSession& session, int timeLimitSeconds);
+
+    /** A live session, or a finished one without its answers. */
+    std::optional<core::GameSession> findById(const std::string& sessionId) const;
+
+    /** Whether sessionId expired before it was completed. */
+    bool isExpired(const std::string& sessionId) const;
+
+    /** Live sessions first, then the history oldest first. */
+    std::vector<core::GameSession> findByUser(const std::string& userId) const;
+    std::vector<core::GameSession> findByGame(const std::string& gameId) const;
+    std::vector<core::GameSession> findActiveByUser(const std::string& userId) const;
+
+    /** Replace a live session; one that is now completed is archived. */
+    bool update(const core::GameSession& session);
+
+    /**
+     * Record a live session's final score and archive it; the completed
+     * session (or the one found, on failure) goes to completed if given.
+     */
+    Completion complete(const std::string& sessionId, int score, core::Timestamp endTime,
+                        core::GameSession* completed = nullptr);
+
+    /**
+     * Archive every live session whose deadline is at or before now as
+     * abandoned.
+     * @return how many were
+     */
+    size_t expire(core::Timestamp now);
+
+    /** Live and archived. */
+    size_t count() const;
+    size_t countLive() const;
+
+private:
+    struct Live {
+        core::GameSession session;
+        core::Timestamp deadline;
+    };
+
+    /** A finished session: no answers. */
+    struct Record {
+        std::string sessionId;
+        std::string gameId;
+        std::string userId;
+        core::Timestamp startTime;
+        core::Timestamp endTime;
+        int32_t score;
+        int32_t maxScore;
+        bool completed;  ///< false: abandoned until it expired
+    };
+
+    using Deadline = std::pair<core::Timestamp, std::string>;
+
+    void archiveLocked(std::unordered_map<std::string, Live>::iterator it);
+    static core::GameSession fromRecord(const Record& record);
+
+    const core::Timestamp grace_;
+
+    mutable std::mutex mutex_;
+    std::unordered_map<std::string, Live> live_;
+    /// Soonest first; entries of sessions no longer live are skipped
+    std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> deadlines_;
+    ArchiveLog<Record, &Record::sessionId> history_;
+};
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_REPOSITORY_MEMORY_GAME_SESSION_STORE_H
@@ -0,0 +1,36 @@
+#include "src/repository/memory/id_interner.h"
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+core::IdHandle IdInterner::intern(std::string_view id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = handles_.find(id);
+    if (it != handles_.end()) return it->second;
+
+    auto handle = static_cast<core::IdHandle>(names_.size());
+    names_.emplace_back(id);
+    handles_.emplace(names_.back(), handle);
+    return handle;
+}
+
+core::IdHandle IdInterner::find(std::string_view id) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = handles_.find(id);
+    return it == handles_.end() ? core::NO_ID_HANDLE : it->second;
+}
+
+std::string IdInterner::name(core::IdHandle handle) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return handle < names_.size() ? names_[handle] : std::string();
+}
+
+size_t IdInterner::size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return names_.size();
+}
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
@@ -0,0 +1,97 @@
+#ifndef ENGLISH_LEARNING_REPOSITORY_MEMORY_ID_INTERNER_H
+#define ENGLISH_LEARNING_REPOSITORY_MEMORY_ID_INTERNER_H
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "include/core/types.h"
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+/**
+ * Thread-safe table of interned string IDs.
+ *
+ * Each distinct ID gets a dense 32-bit handle, in the order they are
+ * first seen, and keeps it for the life of the table: handles are never
+ * reused, even for IDs whose records are gone. The string form is what
+ * crosses the protocol; inside the server a handle can stand for it, so
+ * indexes keyed by it are plain vectors and comparing two IDs is one
+ * integer compare.
+ */
+class IdInterner {
+public:
+    /** The handle of id, assigning the next one if it is new. */
+    core::IdHandle intern(std::string_view id);
+
+    /** The handle of id, or NO_ID_HANDLE if it was never interned. */
+    core::IdHandle find(std::string_view id) const;
+
+    /** The ID a handle stands for; empty for NO_ID_HANDLE or unknown handles. */
+    std::string name(core::IdHandle handle) const;
+
+    size_t size() const;
+
+private:
+    mutable std::mutex mutex_;
+    std::deque<std::string> names_;  ///< handle -> ID; a deque keeps them in place
+    std::unordered_map<std::string_view, core::IdHandle> handles_;  ///< Views into names_
+};
+
+/**
+ * Records by interned ID: a vector of pointers indexed by handle, so a
+ * lookup by handle is an array access and one by string is a single
+ * hash probe into the interner. It does not own the records, and like
+ * the std::map it replaces it is not synchronized: the owner's lock
+ * guards it.
+ */
+template <typename T>
+class HandleIndex {
+public:
+    explicit HandleIndex(IdInterner& ids) : ids_(ids) {}
+
+    /** Point id at item, replacing what it pointed at. */
+    core::IdHandle put(std::string_view id, T* item) {
+        core::IdHandle handle = ids_.intern(id);
+        if (handle >= items_.size()) items_.resize(handle + 1, nullptr);
+        if (!items_[handle]) count_++;
+        items_[handle] = item;
+        return handle;
+    }
+
+    T* find(std::string_view id) const { return find(ids_.find(id)); }
+    T* find(core::IdHandle handle) const {
+        return handle < items_.size() ? items_[handle] : nullptr;
+    }
+
+    /** The handle of an ID that has a record, or NO_ID_HANDLE. */
+    core::IdHandle handle(std::string_view id) const {
+        core::IdHandle handle = ids_.find(id);
+        return find(handle) ? handle : core::NO_ID_HANDLE;
+    }
+
+    bool erase(std::string_view id) {
+        core::IdHandle handle = ids_.find(id);
+        if (!find(handle)) return false;
+        items_[handle] = nullptr;
+        count_--;
+        return true;
+    }
+
+    size_t size() const { return count_; }
+
+private:
+    IdInterner& ids_;
+    std::vector<T*> items_;
+    size_t count_ = 0;
+};
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_REPOSITORY_MEMORY_ID_INTERNER_H
@@ -0,0 +1,119 @@
+#include "src/repository/memory/lesson_index.h"
+
+#include <utility>
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+namespace {
+
+// Bucket slot of a filter value: 0 for "any", 1 + the enum value for a
+// known name; false for any other string
+bool levelSlot(const std::string& level, size_t& slot) {
+    core::Level parsed;
+    if (level.empty()) {
+        slot = 0;
+    } else if (core::parseLevel(level, parsed)) {
+        slot = 1 + static_cast<size_t>(parsed);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool topicSlot(const std::string& topic, size_t& slot) {
+    core::Topic parsed;
+    if (topic.empty()) {
+        slot = 0;
+    } else if (core::parseTopic(topic, parsed)) {
+        slot = 1 + static_cast<size_t>(parsed);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+LessonIndex::LessonIndex(const Catalog<core::Lesson>::Map& lessons) {
+    entries_.reserve(lessons.size());
+    for (const auto& pair : lessons) {
+        const core::Lesson& lesson = pair.second;
+        uint32_t position = static_cast<uint32_t>(entries_.size());
+
+        Entry entry{&lesson, std::string()};
+        protocol::JsonWriter(entry.fragment)
+            .beginObject()
+            .field("lessonId", lesson.lessonId)
+            .field("title", lesson.title)
+            .field("description", lesson.description)
+            .field("topic", lesson.topic)
+            .field("level", lesson.level)
+            .fieldInt("duration", lesson.duration)
+            .fieldBool("completionStatus", false)
+            .fieldInt("progress", 0)
+            .endObject();
+        entries_.push_back(std::move(entry));
+
+        size_t level = 0;
+        size_t topic = 0;
+        bool knownLevel = levelSlot(lesson.level, level) && level != 0;
+        bool knownTopic = topicSlot(lesson.topic, topic) && topic != 0;
+        buckets_[0][0].push_back(position);
+        if (knownLevel) buckets_[level][0].push_back(position);
+        if (knownTopic) buckets_[0][topic].push_back(position);
+        if (knownLevel && knownTopic) buckets_[level][topic].push_back(position);
+    }
+}
+
+const std::vector<uint32_t>* LessonIndex::bucket(const std::string& level,
+                                                 const std::string& topic) const {
+    size_t levelKey = 0;
+    size_t topicKey = 0;
+    if (!levelSlot(level, levelKey) || !topicSlot(topic, topicKey)) return nullptr;
+    return &buckets_[levelKey][topicKey];
+}
+
+template <typename Fn>
+void LessonIndex::forEachMatch(const std::string& level, const std::string& topic,
+                               Fn&& fn) const {
+    if (const std::vector<uint32_t>* positions = bucket(level, topic)) {
+        for (uint32_t position : *positions) fn(entries_[position]);
+        return;
+    }
+    for (const Entry& entry : entries_) {
+        if ((level.empty() || entry.lesson->level == level) &&
+            (topic.empty() || entry.lesson->topic == topic)) {
+            fn(entry);
+        }
+    }
+}
+
+std::vector<const core::Lesson*> LessonIndex::select(const std::string& level,
+                                                     const std::string& topic) const {
+    std::vector<const core::Lesson*> result;
+    forEachMatch(level, topic, [&](const Entry& entry) { result.push_back(entry.lesson); });
+    return result;
+}
+
+size_t LessonIndex::count(const std::string& level, const std::string& topic) const {
+    if (const std::vector<uint32_t>* positions = bucket(level, topic)) return positions->size();
+    size_t matches = 0;
+    forEachMatch(level, topic, [&](const Entry&) { matches++; });
+    return matches;
+}
+
+size_t LessonIndex::writeListing(protocol::JsonWriter& writer, const std::string& level,
+                                 const std::string& topic) const {
+    size_t written = 0;
+    forEachMatch(level, topic, [&](const Entry& entry) {
+        writer.raw(entry.fragment);
+        written++;
+    });
+    return written;
+}
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
@@ -0,0 +1,81 @@
+#ifndef ENGLISH_LEARNING_REPOSITORY_MEMORY_LESSON_INDEX_H
+#define ENGLISH_LEARNING_REPOSITORY_MEMORY_LESSON_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "include/core/lesson.h"
+#include "include/protocol/json_writer.h"
+#include "src/repository/memory/catalog.h"
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+/**
+ * Immutable (Level, Topic) index over one version of the lesson catalog.
+ *
+ * Each lesson's GET_LESSONS listing object is serialized and escaped once,
+ * when the index is built, and every (level, topic) filter combination,
+ * either side possibly "any", maps to the positions of its lessons in
+ * lessonId order. A filtered listing is then a concatenation of cached
+ * fragments. Lessons whose level or topic is not one of the known names
+ * are kept out of the buckets and found by comparing strings, as are
+ * filters that name an unknown level or topic.
+ *
+ * Kept current by LessonIndexCache, whose views hold their catalog
+ * snapshot, so the Lesson pointers handed out stay valid for as long as
+ * the index is held.
+ */
+class LessonIndex {
+public:
+    explicit LessonIndex(const Catalog<core::Lesson>::Map& lessons);
+
+    /**
+     * Lessons matching both filters (empty = any), in lessonId order.
+     */
+    std::vector<const core::Lesson*> select(const std::string& level,
+                                            const std::string& topic) const;
+
+    /** Number of lessons select() would return. */
+    size_t count(const std::string& level, const std::string& topic) const;
+
+    /**
+     * Write the listing object of every matching lesson into the array
+     * the writer is in.
+     * @return how many were written
+     */
+    size_t writeListing(protocol::JsonWriter& writer, const std::string& level,
+                        const std::string& topic) const;
+
+private:
+    static constexpr size_t LEVELS = 3;  ///< core::Level values
+    static constexpr size_t TOPICS = 6;  ///< core::Topic values
+
+    struct Entry {
+        const core::Lesson* lesson;
+        std::string fragment;  ///< Pre-escaped listing object
+    };
+
+    /**
+     * Bucket for a filter pair, slot 0 meaning "any"; nullptr if either
+     * filter is not a known name and the entries have to be scanned.
+     */
+    const std::vector<uint32_t>* bucket(const std::string& level,
+                                        const std::string& topic) const;
+
+    template <typename Fn>
+    void forEachMatch(const std::string& level, const std::string& topic, Fn&& fn) const;
+
+    std::vector<Entry> entries_;                             ///< lessonId order
+    std::vector<uint32_t> buckets_[LEVELS + 1][TOPICS + 1];  ///< Positions in entries_
+};
+
+/** The LessonIndex of the lesson catalog's current version. */
+using LessonIndexCache = CatalogView<core::Lesson, LessonIndex>;
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_REPOSITORY_MEMORY_LESSON_INDEX_H
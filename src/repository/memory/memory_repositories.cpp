@@ -8,83 +8,73 @@ namespace memory {
 // MemoryLessonRepository
 // ============================================================================
 
+namespace {
+
+std::vector<core::Lesson> copyLessons(const std::vector<const core::Lesson*>& lessons) {
+    std::vector<core::Lesson> result;
+    result.reserve(lessons.size());
+    for (const core::Lesson* lesson : lessons) result.push_back(*lesson);
+    return result;
+}
+
+} // namespace
+
 bool MemoryLessonRepository::add(const core::Lesson& lesson) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (lessons_.find(lesson.lessonId) != lessons_.end()) return false;
-    lessons_[lesson.lessonId] = lesson;
-    return true;
+    return lessons_.update([&](auto& items) {
+        return items.emplace(lesson.lessonId, lesson).second;
+    });
 }
 
 std::optional<core::Lesson> MemoryLessonRepository::findById(const std::string& lessonId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = lessons_.find(lessonId);
-    return (it != lessons_.end()) ? std::optional(it->second) : std::nullopt;
+    auto snapshot = lessons_.snapshot();
+    const core::Lesson* lesson = snapshot->find(lessonId);
+    return lesson ? std::optional(*lesson) : std::nullopt;
 }
 
 std::vector<core::Lesson> MemoryLessonRepository::findAll() const {
-    std::lock_guard<std::mutex> lock(mutex_);
+    auto snapshot = lessons_.snapshot();
     std::vector<core::Lesson> result;
-    for (const auto& p : lessons_) result.push_back(p.second);
+    result.reserve(snapshot->items.size());
+    for (const auto& p : snapshot->items) result.push_back(p.second);
     return result;
 }
 
 std::vector<core::Lesson> MemoryLessonRepository::findByLevel(const std::string& level) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::Lesson> result;
-    for (const auto& p : lessons_) {
-        if (p.second.level == level) result.push_back(p.second);
-    }
-    return result;
+    return copyLessons(index_.current()->select(level, std::string()));
 }
 
 std::vector<core::Lesson> MemoryLessonRepository::findByTopic(const std::string& topic) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::Lesson> result;
-    for (const auto& p : lessons_) {
-        if (p.second.topic == topic) result.push_back(p.second);
-    }
-    return result;
+    return copyLessons(index_.current()->select(std::string(), topic));
 }
 
 std::vector<core::Lesson> MemoryLessonRepository::findByLevelAndTopic(
     const std::string& level, const std::string& topic) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::Lesson> result;
-    for (const auto& p : lessons_) {
-        if (p.second.level == level && (topic.empty() || p.second.topic == topic)) {
-            result.push_back(p.second);
-        }
-    }
-    return result;
+    return copyLessons(index_.current()->select(level, topic));
 }
 
 bool MemoryLessonRepository::exists(const std::string& lessonId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return lessons_.find(lessonId) != lessons_.end();
+    return lessons_.snapshot()->find(lessonId) != nullptr;
 }
 
 bool MemoryLessonRepository::update(const core::Lesson& lesson) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = lessons_.find(lesson.lessonId);
-    if (it != lessons_.end()) { it->second = lesson; return true; }
-    return false;
+    return lessons_.update([&](auto& items) {
+        auto it = items.find(lesson.lessonId);
+        if (it == items.end()) return false;
+        it->second = lesson;
+        return true;
+    });
 }
 
 bool MemoryLessonRepository::remove(const std::string& lessonId) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return lessons_.erase(lessonId) > 0;
+    return lessons_.update([&](auto& items) { return items.erase(lessonId) > 0; });
 }
 
 size_t MemoryLessonRepository::count() const {
-    std::lock_guard<std::mutex> lock(mutex_);
     return lessons_.size();
 }
 
 size_t MemoryLessonRepository::countByLevel(const std::string& level) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    size_t c = 0;
-    for (const auto& p : lessons_) if (p.second.level == level) ++c;
-    return c;
+    return index_.current()->count(level, std::string());
 }
 
 // ============================================================================
@@ -167,100 +157,53 @@ size_t MemoryTestRepository::count() const {
 // MemoryChatRepository
 // ============================================================================
 
+// Backed by ChatStore, which indexes messages per conversation
+
 bool MemoryChatRepository::add(const core::ChatMessage& message) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    messages_.push_back(message);
+    store_.add(message);
     return true;
 }
 
 std::optional<core::ChatMessage> MemoryChatRepository::findById(const std::string& messageId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (const auto& m : messages_) {
-        if (m.messageId == messageId) return m;
-    }
-    return std::nullopt;
+    return store_.findById(messageId);
 }
 
 std::vector<core::ChatMessage> MemoryChatRepository::findAll() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return messages_;
+    return store_.findAll();
 }
 
 std::vector<core::ChatMessage> MemoryChatRepository::findByUser(const std::string& userId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::ChatMessage> result;
-    for (const auto& m : messages_) {
-        if (m.senderId == userId || m.recipientId == userId) {
-            result.push_back(m);
-        }
-    }
-    return result;
+    return store_.findByUser(userId);
 }
 
 std::vector<core::ChatMessage> MemoryChatRepository::findConversation(
     const std::string& user1, const std::string& user2) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::ChatMessage> result;
-    for (const auto& m : messages_) {
-        if ((m.senderId == user1 && m.recipientId == user2) ||
-            (m.senderId == user2 && m.recipientId == user1)) {
-            result.push_back(m);
-        }
-    }
-    return result;
+    return store_.findConversation(user1, user2);
 }
 
 std::vector<core::ChatMessage> MemoryChatRepository::findUnreadFor(const std::string& userId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::ChatMessage> result;
-    for (const auto& m : messages_) {
-        if (m.recipientId == userId && !m.read) {
-            result.push_back(m);
-        }
-    }
-    return result;
+    return store_.findUnreadFor(userId);
 }
 
 size_t MemoryChatRepository::countUnreadFor(const std::string& userId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    size_t c = 0;
-    for (const auto& m : messages_) {
-        if (m.recipientId == userId && !m.read) ++c;
-    }
-    return c;
+    return store_.countUnreadFor(userId);
 }
 
 bool MemoryChatRepository::markAsRead(const std::string& messageId) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& m : messages_) {
-        if (m.messageId == messageId) { m.read = true; return true; }
-    }
-    return false;
+    return store_.markAsRead(messageId);
 }
 
 size_t MemoryChatRepository::markConversationAsRead(
     const std::string& recipientId, const std::string& senderId) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    size_t c = 0;
-    for (auto& m : messages_) {
-        if (m.recipientId == recipientId && m.senderId == senderId && !m.read) {
-            m.read = true; ++c;
-        }
-    }
-    return c;
+    return store_.markConversationAsRead(recipientId, senderId);
 }
 
 bool MemoryChatRepository::remove(const std::string& messageId) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (auto it = messages_.begin(); it != messages_.end(); ++it) {
-        if (it->messageId == messageId) { messages_.erase(it); return true; }
-    }
-    return false;
+    return store_.remove(messageId);
 }
 
 size_t MemoryChatRepository::count() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return messages_.size();
+    return store_.count();
 }
 
 // ============================================================================
@@ -325,88 +268,48 @@ bool MemoryExerciseRepository::removeExercise(const std::string& exerciseId) {
     return exercises_.erase(exerciseId) > 0;
 }
 
+// Submissions are kept in SubmissionStore, indexed by id, user and exercise
+
 bool MemoryExerciseRepository::addSubmission(const core::ExerciseSubmission& submission) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    submissions_.push_back(submission);
-    return true;
+    return submissions_.add(submission);
 }
 
 std::optional<core::ExerciseSubmission> MemoryExerciseRepository::findSubmissionById(
     const std::string& submissionId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (const auto& s : submissions_) {
-        if (s.submissionId == submissionId) return s;
-    }
-    return std::nullopt;
+    return submissions_.findById(submissionId);
 }
 
 std::vector<core::ExerciseSubmission> MemoryExerciseRepository::findAllSubmissions() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return submissions_;
+    return submissions_.findAll();
 }
 
 std::vector<core::ExerciseSubmission> MemoryExerciseRepository::findSubmissionsByUser(
     const std::string& userId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::ExerciseSubmission> result;
-    for (const auto& s : submissions_) {
-        if (s.userId == userId) result.push_back(s);
-    }
-    return result;
+    return submissions_.findByUser(userId);
 }
 
 std::vector<core::ExerciseSubmission> MemoryExerciseRepository::findSubmissionsByExercise(
     const std::string& exerciseId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::ExerciseSubmission> result;
-    for (const auto& s : submissions_) {
-        if (s.exerciseId == exerciseId) result.push_back(s);
-    }
-    return result;
+    return submissions_.findByExercise(exerciseId);
 }
 
 std::vector<core::ExerciseSubmission> MemoryExerciseRepository::findPendingSubmissions() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::ExerciseSubmission> result;
-    for (const auto& s : submissions_) {
-        if (s.status == "pending") result.push_back(s);
-    }
-    return result;
+    return submissions_.findPending();
 }
 
 std::vector<core::ExerciseSubmission> MemoryExerciseRepository::findReviewedSubmissions(
     const std::string& userId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::ExerciseSubmission> result;
-    for (const auto& s : submissions_) {
-        if (s.userId == userId && s.status == "reviewed") result.push_back(s);
-    }
-    return result;
+    return submissions_.findReviewedByUser(userId);
 }
 
 bool MemoryExerciseRepository::updateSubmission(const core::ExerciseSubmission& submission) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& s : submissions_) {
-        if (s.submissionId == submission.submissionId) { s = submission; return true; }
-    }
-    return false;
+    return submissions_.update(submission);
 }
 
 bool MemoryExerciseRepository::reviewSubmission(
     const std::string& submissionId, const std::string& teacherId,
     const std::string& feedback, int score, int64_t reviewedAt) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (auto& s : submissions_) {
-        if (s.submissionId == submissionId) {
-            s.status = "reviewed";
-            s.teacherId = teacherId;
-            s.teacherFeedback = feedback;
-            s.teacherScore = score;
-            s.reviewedAt = reviewedAt;
-            return true;
-        }
-    }
-    return false;
+    return submissions_.review(submissionId, teacherId, feedback, score, reviewedAt);
 }
 
 size_t MemoryExerciseRepository::countExercises() const {
@@ -415,15 +318,11 @@ size_t MemoryExerciseRepository::countExercises() const {
 }
 
 size_t MemoryExerciseRepository::countSubmissions() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return submissions_.size();
+    return submissions_.count();
 }
 
 size_t MemoryExerciseRepository::countPendingSubmissions() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    size_t c = 0;
-    for (const auto& s : submissions_) if (s.status == "pending") ++c;
-    return c;
+    return submissions_.countPending();
 }
 
 // ============================================================================
@@ -498,69 +397,44 @@ bool MemoryGameRepository::removeGame(const std::string& gameId) {
 }
 
 bool MemoryGameRepository::addSession(const core::GameSession& session) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (sessions_.find(session.sessionId) != sessions_.end()) return false;
-    sessions_[session.sessionId] = session;
-    return true;
+    int timeLimit = core::Game().timeLimit;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = games_.find(session.gameId);
+        if (it != games_.end()) timeLimit = it->second.timeLimit;
+    }
+    // No sweeper thread here: starting a session evicts the stale ones
+    sessions_.expire(session.startTime);
+    return sessions_.add(session, timeLimit);
 }
 
 std::optional<core::GameSession> MemoryGameRepository::findSessionById(
     const std::string& sessionId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = sessions_.find(sessionId);
-    return (it != sessions_.end()) ? std::optional(it->second) : std::nullopt;
+    return sessions_.findById(sessionId);
 }
 
 std::vector<core::GameSession> MemoryGameRepository::findSessionsByUser(
     const std::string& userId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::GameSession> result;
-    for (const auto& p : sessions_) {
-        if (p.second.userId == userId) result.push_back(p.second);
-    }
-    return result;
+    return sessions_.findByUser(userId);
 }
 
 std::vector<core::GameSession> MemoryGameRepository::findSessionsByGame(
     const std::string& gameId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::GameSession> result;
-    for (const auto& p : sessions_) {
-        if (p.second.gameId == gameId) result.push_back(p.second);
-    }
-    return result;
+    return sessions_.findByGame(gameId);
 }
 
 std::vector<core::GameSession> MemoryGameRepository::findActiveSessionsByUser(
     const std::string& userId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::GameSession> result;
-    for (const auto& p : sessions_) {
-        if (p.second.userId == userId && !p.second.completed) {
-            result.push_back(p.second);
-        }
-    }
-    return result;
+    return sessions_.findActiveByUser(userId);
 }
 
 bool MemoryGameRepository::updateSession(const core::GameSession& session) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = sessions_.find(session.sessionId);
-    if (it != sessions_.end()) { it->second = session; return true; }
-    return false;
+    return sessions_.update(session);
 }
 
 bool MemoryGameRepository::completeSession(
     const std::string& sessionId, int score, int64_t endTime) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = sessions_.find(sessionId);
-    if (it != sessions_.end()) {
-        it->second.score = score;
-        it->second.endTime = endTime;
-        it->second.completed = true;
-        return true;
-    }
-    return false;
+    return sessions_.complete(sessionId, score, endTime) == GameSessionStore::Completion::Done;
 }
 
 size_t MemoryGameRepository::countGames() const {
@@ -569,8 +443,7 @@ size_t MemoryGameRepository::countGames() const {
 }
 
 size_t MemoryGameRepository::countSessions() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return sessions_.size();
+    return sessions_.count();
 }
 
 // ============================================================================
@@ -578,125 +451,71 @@ size_t MemoryGameRepository::countSessions() const {
 // ============================================================================
 
 bool MemoryVoiceCallRepository::add(const core::VoiceCallSession& call) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    if (calls_.find(call.callId) != calls_.end()) return false;
-    calls_[call.callId] = call;
-    return true;
+    return calls_.add(call) == CallRegistry::Change::Done;
 }
 
 std::optional<core::VoiceCallSession> MemoryVoiceCallRepository::findById(
     const std::string& callId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = calls_.find(callId);
-    return (it != calls_.end()) ? std::optional(it->second) : std::nullopt;
+    return calls_.findById(callId);
 }
 
 std::vector<core::VoiceCallSession> MemoryVoiceCallRepository::findAll() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::VoiceCallSession> result;
-    for (const auto& p : calls_) result.push_back(p.second);
-    return result;
+    return calls_.findAll();
 }
 
 std::vector<core::VoiceCallSession> MemoryVoiceCallRepository::findByUser(
     const std::string& userId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::VoiceCallSession> result;
-    for (const auto& p : calls_) {
-        if (p.second.involvesUser(userId)) result.push_back(p.second);
-    }
-    return result;
+    return calls_.findByUser(userId);
 }
 
 std::vector<core::VoiceCallSession> MemoryVoiceCallRepository::findActiveByUser(
     const std::string& userId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
     std::vector<core::VoiceCallSession> result;
-    for (const auto& p : calls_) {
-        if (p.second.involvesUser(userId) && p.second.isActive()) {
-            result.push_back(p.second);
-        }
-    }
+    if (auto call = calls_.findActiveCall(userId)) result.push_back(std::move(*call));
     return result;
 }
 
 std::vector<core::VoiceCallSession> MemoryVoiceCallRepository::findPendingForUser(
     const std::string& userId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    std::vector<core::VoiceCallSession> result;
-    for (const auto& p : calls_) {
-        if (p.second.receiverId == userId && p.second.isPending()) {
-            result.push_back(p.second);
-        }
-    }
-    return result;
+    return calls_.findLive([&](const core::VoiceCallSession& call) {
+        return call.receiverId == userId && call.isPending();
+    });
 }
 
 std::optional<core::VoiceCallSession> MemoryVoiceCallRepository::findActiveCall(
     const std::string& userId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (const auto& p : calls_) {
-        if (p.second.involvesUser(userId) && p.second.isActive()) {
-            return p.second;
-        }
-    }
-    return std::nullopt;
+    return calls_.findActiveCall(userId);
 }
 
 std::optional<core::VoiceCallSession> MemoryVoiceCallRepository::findPendingCall(
     const std::string& callerId, const std::string& receiverId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    for (const auto& p : calls_) {
-        if (p.second.callerId == callerId && p.second.receiverId == receiverId &&
-            p.second.isPending()) {
-            return p.second;
-        }
-    }
-    return std::nullopt;
+    auto pending = calls_.findLive([&](const core::VoiceCallSession& call) {
+        return call.callerId == callerId && call.receiverId == receiverId && call.isPending();
+    });
+    if (pending.empty()) return std::nullopt;
+    return pending.front();
 }
 
 bool MemoryVoiceCallRepository::update(const core::VoiceCallSession& call) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = calls_.find(call.callId);
-    if (it != calls_.end()) {
-        it->second = call;
-        return true;
-    }
-    return false;
+    return calls_.update(call);
 }
 
 bool MemoryVoiceCallRepository::updateStatus(const std::string& callId,
                                               core::VoiceCallStatus status,
                                               core::Timestamp endTime) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    auto it = calls_.find(callId);
-    if (it != calls_.end()) {
-        it->second.status = status;
-        if (endTime > 0) {
-            it->second.endTime = endTime;
-        }
-        return true;
-    }
-    return false;
+    return calls_.setStatus(callId, status, endTime);
 }
 
 bool MemoryVoiceCallRepository::remove(const std::string& callId) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return calls_.erase(callId) > 0;
+    return calls_.remove(callId);
 }
 
 size_t MemoryVoiceCallRepository::count() const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    return calls_.size();
+    return calls_.count();
 }
 
 size_t MemoryVoiceCallRepository::countActiveForUser(const std::string& userId) const {
-    std::lock_guard<std::mutex> lock(mutex_);
-    size_t c = 0;
-    for (const auto& p : calls_) {
-        if (p.second.involvesUser(userId) && p.second.isActive()) ++c;
-    }
-    return c;
+    return calls_.findActiveCall(userId) ? 1 : 0;
 }
 
 } // namespace memory
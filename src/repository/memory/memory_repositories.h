@@ -10,13 +10,21 @@
 #include "include/repository/i_exercise_repository.h"
 #include "include/repository/i_game_repository.h"
 #include "include/repository/i_voice_call_repository.h"
+#include "src/repository/memory/call_registry.h"
+#include "src/repository/memory/catalog.h"
+#include "src/repository/memory/chat_store.h"
+#include "src/repository/memory/game_session_store.h"
+#include "src/repository/memory/lesson_index.h"
+#include "src/repository/memory/submission_store.h"
 
 namespace english_learning {
 namespace repository {
 namespace memory {
 
 /**
- * In-memory implementation of ILessonRepository.
+ * In-memory implementation of ILessonRepository. Lessons are kept in a
+ * Catalog, so reads never block; level and topic lookups go through a
+ * LessonIndex that is rebuilt after each change.
  */
 class MemoryLessonRepository : public ILessonRepository {
 public:
@@ -34,8 +42,8 @@ public:
     size_t countByLevel(const std::string& level) const override;
 
 private:
-    mutable std::mutex mutex_;
-    std::map<std::string, core::Lesson> lessons_;
+    Catalog<core::Lesson> lessons_;
+    LessonIndexCache index_{lessons_};
 };
 
 /**
@@ -61,7 +69,8 @@ private:
 };
 
 /**
- * In-memory implementation of IChatRepository.
+ * In-memory implementation of IChatRepository, indexed per conversation
+ * (see ChatStore).
  */
 class MemoryChatRepository : public IChatRepository {
 public:
@@ -80,8 +89,7 @@ public:
     size_t count() const override;
 
 private:
-    mutable std::mutex mutex_;
-    std::vector<core::ChatMessage> messages_;
+    ChatStore store_;
 };
 
 /**
@@ -123,9 +131,9 @@ public:
     size_t countPendingSubmissions() const override;
 
 private:
-    mutable std::mutex mutex_;
+    mutable std::mutex mutex_;  ///< Guards exercises_
     std::map<std::string, core::Exercise> exercises_;
-    std::vector<core::ExerciseSubmission> submissions_;
+    SubmissionStore submissions_;
 };
 
 /**
@@ -158,13 +166,14 @@ public:
     size_t countSessions() const override;
 
 private:
-    mutable std::mutex mutex_;
+    mutable std::mutex mutex_;  ///< games_; sessions_ has its own
     std::map<std::string, core::Game> games_;
-    std::map<std::string, core::GameSession> sessions_;
+    GameSessionStore sessions_;
 };
 
 /**
- * In-memory implementation of IVoiceCallRepository.
+ * In-memory implementation of IVoiceCallRepository, backed by a
+ * CallRegistry.
  */
 class MemoryVoiceCallRepository : public IVoiceCallRepository {
 public:
@@ -185,8 +194,7 @@ public:
     size_t countActiveForUser(const std::string& userId) const override;
 
 private:
-    mutable std::mutex mutex_;
-    std::map<std::string, core::VoiceCallSession> calls_;
+    CallRegistry calls_;
 };
 
 } // namespace memory
@@ -0,0 +1,177 @@
+#include "src/repository/memory/submission_store.h"
+
+#include <algorithm>
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+const SubmissionStore::Node* SubmissionStore::findLocked(const std::string& submissionId) const {
+    auto it = byId_.find(submissionId);
+    return it == byId_.end() ? nullptr : &nodes_[it->second];
+}
+
+std::vector<core::ExerciseSubmission> SubmissionStore::collectLocked(
+    const PostingLists& lists, const std::string& key) const {
+    std::vector<core::ExerciseSubmission> result;
+    auto it = lists.find(key);
+    if (it == lists.end()) return result;
+    result.reserve(it->second.size());
+    for (uint32_t i : it->second) result.push_back(nodes_[i].submission);
+    return result;
+}
+
+void SubmissionStore::unpost(PostingLists& lists, const std::string& key, uint32_t index) {
+    auto it = lists.find(key);
+    if (it == lists.end()) return;
+    auto& positions = it->second;
+    positions.erase(std::lower_bound(positions.begin(), positions.end(), index));
+    if (positions.empty()) lists.erase(it);
+}
+
+void SubmissionStore::enqueueLocked(uint32_t index) {
+    Node& node = nodes_[index];
+    if (node.queued) return;
+    node.queued = true;
+    node.prevPending = pendingTail_;
+    node.nextPending = NONE;
+    if (pendingTail_ != NONE) {
+        nodes_[pendingTail_].nextPending = index;
+    } else {
+        pendingHead_ = index;
+    }
+    pendingTail_ = index;
+    pendingCount_++;
+}
+
+void SubmissionStore::dequeueLocked(uint32_t index) {
+    Node& node = nodes_[index];
+    if (!node.queued) return;
+    if (node.prevPending != NONE) {
+        nodes_[node.prevPending].nextPending = node.nextPending;
+    } else {
+        pendingHead_ = node.nextPending;
+    }
+    if (node.nextPending != NONE) {
+        nodes_[node.nextPending].prevPending = node.prevPending;
+    } else {
+        pendingTail_ = node.prevPending;
+    }
+    node.prevPending = node.nextPending = NONE;
+    node.queued = false;
+    pendingCount_--;
+}
+
+bool SubmissionStore::add(const core::ExerciseSubmission& submission) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    uint32_t index = static_cast<uint32_t>(nodes_.size());
+    if (!byId_.emplace(submission.submissionId, index).second) return false;
+
+    nodes_.push_back(Node{submission});
+    byUser_[submission.userId].push_back(index);
+    byExercise_[submission.exerciseId].push_back(index);
+    if (submission.isPending()) enqueueLocked(index);
+    return true;
+}
+
+std::optional<core::ExerciseSubmission> SubmissionStore::findById(
+    const std::string& submissionId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const Node* node = findLocked(submissionId);
+    if (node == nullptr) return std::nullopt;
+    return node->submission;
+}
+
+std::vector<core::ExerciseSubmission> SubmissionStore::findAll() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<core::ExerciseSubmission> result;
+    result.reserve(nodes_.size());
+    for (const Node& node : nodes_) result.push_back(node.submission);
+    return result;
+}
+
+std::vector<core::ExerciseSubmission> SubmissionStore::findByUser(const std::string& userId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return collectLocked(byUser_, userId);
+}
+
+std::vector<core::ExerciseSubmission> SubmissionStore::findByExercise(
+    const std::string& exerciseId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return collectLocked(byExercise_, exerciseId);
+}
+
+std::vector<core::ExerciseSubmission> SubmissionStore::findReviewedByUser(
+    const std::string& userId) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<core::ExerciseSubmission> result;
+    auto it = byUser_.find(userId);
+    if (it == byUser_.end()) return result;
+    for (uint32_t i : it->second) {
+        if (nodes_[i].submission.isReviewed()) result.push_back(nodes_[i].submission);
+    }
+    return result;
+}
+
+std::vector<core::ExerciseSubmission> SubmissionStore::findPending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<core::ExerciseSubmission> result;
+    result.reserve(pendingCount_);
+    for (uint32_t i = pendingHead_; i != NONE; i = nodes_[i].nextPending) {
+        result.push_back(nodes_[i].submission);
+    }
+    return result;
+}
+
+bool SubmissionStore::update(const core::ExerciseSubmission& submission) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = byId_.find(submission.submissionId);
+    if (it == byId_.end()) return false;
+    uint32_t index = it->second;
+    Node& node = nodes_[index];
+
+    // Posting lists stay sorted by position: re-insert in place
+    auto repost = [&](PostingLists& lists, const std::string& from, const std::string& to) {
+        if (from == to) return;
+        unpost(lists, from, index);
+        auto& positions = lists[to];
+        positions.insert(std::lower_bound(positions.begin(), positions.end(), index), index);
+    };
+    repost(byUser_, node.submission.userId, submission.userId);
+    repost(byExercise_, node.submission.exerciseId, submission.exerciseId);
+
+    node.submission = submission;
+    if (submission.isPending()) {
+        enqueueLocked(index);
+    } else {
+        dequeueLocked(index);
+    }
+    return true;
+}
+
+bool SubmissionStore::review(const std::string& submissionId, const std::string& teacherId,
+                             const std::string& feedback, int score,
+                             core::Timestamp reviewedAt, core::ExerciseSubmission* reviewed) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = byId_.find(submissionId);
+    if (it == byId_.end()) return false;
+    Node& node = nodes_[it->second];
+    node.submission.setReview(teacherId, feedback, score, reviewedAt);
+    dequeueLocked(it->second);
+    if (reviewed != nullptr) *reviewed = node.submission;
+    return true;
+}
+
+size_t SubmissionStore::count() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return nodes_.size();
+}
+
+size_t SubmissionStore::countPending() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return pendingCount_;
+}
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
@@ -0,0 +1,95 @@
+#ifndef ENGLISH_LEARNING_REPOSITORY_MEMORY_SUBMISSION_STORE_H
+#define ENGLISH_LEARNING_REPOSITORY_MEMORY_SUBMISSION_STORE_H
+
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "include/core/exercise.h"
+
+namespace english_learning {
+namespace repository {
+namespace memory {
+
+/**
+ * Thread-safe exercise submission store.
+ *
+ * Submissions are kept in insertion order and indexed three ways: a hash
+ * index by submissionId, and posting lists of positions per user and per
+ * exercise. Pending submissions are also threaded on an intrusive doubly
+ * linked FIFO, oldest first, that reviewing unlinks from in O(1). Finding
+ * a submission is O(1), and a user's submissions or the review queue cost
+ * the size of the result rather than the number of submissions stored.
+ */
+class SubmissionStore {
+public:
+    /** false if a submission with the same submissionId is stored. */
+    bool add(const core::ExerciseSubmission& submission);
+
+    std::optional<core::ExerciseSubmission> findById(const std::string& submissionId) const;
+
+    /** Every submission, in the order they were added. */
+    std::vector<core::ExerciseSubmission> findAll() const;
+
+    /** In the order they were added, as are the lookups below. */
+    std::vector<core::ExerciseSubmission> findByUser(const std::string& userId) const;
+    std::vector<core::ExerciseSubmission> findByExercise(const std::string& exerciseId) const;
+    std::vector<core::ExerciseSubmission> findReviewedByUser(const std::string& userId) const;
+
+    /** The review queue, oldest first. */
+    std::vector<core::ExerciseSubmission> findPending() const;
+
+    /**
+     * Replace the submission with the same submissionId. One that becomes
+     * pending again goes to the back of the review queue.
+     */
+    bool update(const core::ExerciseSubmission& submission);
+
+    /**
+     * Record a teacher's review and take the submission off the review
+     * queue; if reviewed is given, it receives the updated submission.
+     */
+    bool review(const std::string& submissionId, const std::string& teacherId,
+                const std::string& feedback, int score, core::Timestamp reviewedAt,
+                core::ExerciseSubmission* reviewed = nullptr);
+
+    size_t count() const;
+    size_t countPending() const;
+
+private:
+    static constexpr uint32_t NONE = UINT32_MAX;
+
+    struct Node {
+        core::ExerciseSubmission submission;
+        uint32_t prevPending = NONE;  ///< Review queue links, NONE at either end
+        uint32_t nextPending = NONE;
+        bool queued = false;
+    };
+
+    using PostingLists = std::unordered_map<std::string, std::vector<uint32_t>>;
+
+    const Node* findLocked(const std::string& submissionId) const;
+    std::vector<core::ExerciseSubmission> collectLocked(const PostingLists& lists,
+                                                        const std::string& key) const;
+    static void unpost(PostingLists& lists, const std::string& key, uint32_t index);
+    void enqueueLocked(uint32_t index);
+    void dequeueLocked(uint32_t index);
+
+    mutable std::mutex mutex_;
+    std::deque<Node> nodes_;  ///< Insertion order; a deque never moves its elements
+    std::unordered_map<std::string, uint32_t> byId_;
+    PostingLists byUser_;
+    PostingLists byExercise_;
+    uint32_t pendingHead_ = NONE;
+    uint32_t pendingTail_ = NONE;
+    size_t pendingCount_ = 0;
+};
+
+} // namespace memory
+} // namespace repository
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_REPOSITORY_MEMORY_SUBMISSION_STORE_H
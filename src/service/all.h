@@ -8,9 +8,12 @@
 #include "auth_service.h"
 #include "lesson_service.h"
 #include "test_service.h"
+#include "answer_key.h"
+#include "fuzzy_match.h"
 #include "chat_service.h"
 #include "exercise_service.h"
 #include "game_service.h"
+#include "match_key.h"
 #include "voice_call_service.h"
 #include "service_container.h"
 
@@ -0,0 +1,427 @@
+#include "src/service/answer_key.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "src/service/fuzzy_match.h"
+
+namespace english_learning {
+namespace service {
+
+namespace {
+
+// ASCII only, like the C-locale tolower/isalnum the grader always used
+char lowerAscii(char c) {
+    return (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+}
+
+bool isAlnumLower(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9');
+}
+
+// Below this many submissions per shard, handing the shard to another
+// thread costs more than it saves
+constexpr size_t MIN_SHARD_SIZE = 256;
+
+// Per-question outcome counters of one shard, laid out question by question
+enum Outcome : size_t { CORRECT, WRONG, UNANSWERED, OUTCOMES };
+
+// Call fn(begin, end) for each word of a Sentence-normalized answer
+template <typename Fn>
+void forEachWord(std::string_view sentence, Fn&& fn) {
+    size_t begin = 0;
+    while (begin < sentence.size()) {
+        size_t end = sentence.find(' ', begin);
+        if (end == std::string_view::npos) end = sentence.size();
+        fn(begin, end);
+        begin = end + 1;
+    }
+}
+
+} // namespace
+
+AnswerMatch answerMatchFor(const std::string& questionType) {
+    core::QuestionType type;
+    if (!core::parseQuestionType(questionType, type)) return AnswerMatch::Trimmed;
+    switch (type) {
+    case core::QuestionType::MultipleChoice: return AnswerMatch::Exact;
+    case core::QuestionType::SentenceOrder: return AnswerMatch::Sentence;
+    case core::QuestionType::FillBlank: break;
+    }
+    return AnswerMatch::Trimmed;
+}
+
+void normalizeAnswer(AnswerMatch match, std::string_view answer, std::string& out) {
+    out.clear();
+    switch (match) {
+    case AnswerMatch::Exact:
+        out.assign(answer.data(), answer.size());
+        return;
+
+    case AnswerMatch::Trimmed: {
+        size_t begin = answer.find_first_not_of(" \t");
+        if (begin == std::string_view::npos) return;
+        size_t end = answer.find_last_not_of(" \t") + 1;
+        out.reserve(end - begin);
+        for (size_t i = begin; i < end; i++) out += lowerAscii(answer[i]);
+        return;
+    }
+
+    case AnswerMatch::Sentence: {
+        // Words of letters and digits, separated by single spaces
+        bool space = false;
+        for (char c : answer) {
+            char lower = lowerAscii(c);
+            if (lower == ' ') {
+                space = !out.empty();
+            } else if (isAlnumLower(lower)) {
+                if (space) out += ' ';
+                space = false;
+                out += lower;
+            }
+        }
+        return;
+    }
+    }
+}
+
+const char* letterGrade(int percentage) {
+    if (percentage >= 90) return "A";
+    if (percentage >= 80) return "B";
+    if (percentage >= 70) return "C";
+    if (percentage >= 60) return "D";
+    return "F";
+}
+
+AnswerKey::AnswerKey(const core::Test& test) {
+    size_t count = test.questions.size();
+    matches_.reserve(count);
+    tolerance_.reserve(count);
+    points_.reserve(count);
+    normalizedEnd_.reserve(count);
+    wordsEnd_.reserve(count);
+    ids_.reserve(count);
+    correctAnswers_.reserve(count);
+
+    std::string normalized;
+    for (const auto& q : test.questions) {
+        AnswerMatch match = answerMatchFor(q.type);
+        normalizeAnswer(match, q.correctAnswer, normalized);
+        uint32_t offset = static_cast<uint32_t>(normalized_.size());
+        normalized_ += normalized;
+        normalizedEnd_.push_back(static_cast<uint32_t>(normalized_.size()));
+        matches_.push_back(match);
+
+        // Answers too long for one machine word are graded exactly
+        uint8_t tolerance = 0;
+        size_t firstWord = words_.size();
+        if (match == AnswerMatch::Trimmed && q.maxTypos > 0 &&
+            normalized.size() <= MAX_FUZZY_PATTERN) {
+            tolerance = static_cast<uint8_t>(std::min(q.maxTypos, 255));
+        } else if (match == AnswerMatch::Sentence && q.partialCredit) {
+            size_t wordCount = 0;
+            forEachWord(normalized, [&](size_t begin, size_t end) {
+                std::string_view word(normalized.data() + begin, end - begin);
+                if (wordCount < MAX_FUZZY_PATTERN) {
+                    size_t hash = std::hash<std::string_view>()(word);
+                    auto it = std::find_if(words_.begin() + firstWord, words_.end(),
+                                           [&](const Word& known) {
+                                               return known.hash == hash &&
+                                                      normalized.compare(known.begin - offset,
+                                                                         known.end - known.begin,
+                                                                         word) == 0;
+                                           });
+                    if (it == words_.end()) {
+                        it = words_.insert(words_.end(),
+                                           Word{hash, 0, static_cast<uint32_t>(offset + begin),
+                                                static_cast<uint32_t>(offset + end)});
+                    }
+                    it->positions |= uint64_t(1) << wordCount;
+                }
+                wordCount++;
+            });
+            if (wordCount <= MAX_FUZZY_PATTERN) {
+                tolerance = static_cast<uint8_t>(wordCount);
+            } else {
+                words_.resize(firstWord);
+            }
+        }
+        tolerance_.push_back(tolerance);
+        wordsEnd_.push_back(static_cast<uint32_t>(words_.size()));
+        points_.push_back(q.points);
+        totalPoints_ += q.points;
+        ids_.push_back(q.questionId);
+        correctAnswers_.push_back(q.correctAnswer);
+    }
+    // After ids_ is final: the keys point into its strings.
+    // A repeated questionId resolves to its first question.
+    positions_.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        positions_.emplace(ids_[i], static_cast<uint32_t>(i));
+    }
+}
+
+size_t AnswerKey::position(std::string_view questionId) const {
+    auto it = positions_.find(questionId);
+    return it == positions_.end() ? npos : it->second;
+}
+
+AnswerKey::Mark AnswerKey::mark(size_t position, std::string_view answer,
+                                Scratch& scratch) const {
+    const int full = points_[position];
+    AnswerMatch match = matches_[position];
+    if (match == AnswerMatch::Exact) {
+        return answer == normalized(position) ? Mark{true, full} : Mark{};
+    }
+    normalizeAnswer(match, answer, scratch.answer);
+    std::string_view correct = normalized(position);
+    if (scratch.answer == correct) return Mark{true, full};
+
+    int tolerance = tolerance_[position];
+    if (tolerance == 0) return Mark{};
+    if (match == AnswerMatch::Sentence) return markPartial(position, scratch);
+
+    // Never so many edits that nothing of the correct answer is left
+    int edits = boundedEditDistance(correct, scratch.answer, tolerance, scratch.charMasks);
+    return edits <= tolerance && static_cast<size_t>(edits) < correct.size() ? Mark{true, full}
+                                                                             : Mark{};
+}
+
+AnswerKey::Mark AnswerKey::markPartial(size_t position, Scratch& scratch) const {
+    const Word* first = words_.data() + (position == 0 ? 0 : wordsEnd_[position - 1]);
+    const Word* last = words_.data() + wordsEnd_[position];
+
+    scratch.wordMasks.clear();
+    std::string_view answer = scratch.answer;
+    forEachWord(answer, [&](size_t begin, size_t end) {
+        std::string_view word = answer.substr(begin, end - begin);
+        size_t hash = std::hash<std::string_view>()(word);
+        uint64_t mask = 0;
+        for (const Word* known = first; known != last; known++) {
+            if (known->hash == hash &&
+                std::string_view(normalized_).substr(known->begin, known->end - known->begin) ==
+                    word) {
+                mask = known->positions;
+                break;
+            }
+        }
+        scratch.wordMasks.push_back(mask);
+    });
+
+    size_t correctWords = tolerance_[position];
+    size_t answerWords = scratch.wordMasks.size();
+    int inOrder = longestCommonSubsequence(correctWords, scratch.wordMasks.data(), answerWords);
+    return Mark{false,
+                points_[position] * inOrder / static_cast<int>(std::max(correctWords, answerWords))};
+}
+
+AnswerKey::Result AnswerKey::grade(const std::vector<std::string>& answers) const {
+    Result result;
+    result.totalPoints = totalPoints_;
+    result.correct.resize(size());
+    result.earned.resize(size());
+
+    Scratch scratch;
+    for (size_t i = 0; i < size(); i++) {
+        std::string_view answer = i < answers.size() ? std::string_view(answers[i]) : "";
+        Mark marked = mark(i, answer, scratch);
+        result.earned[i] = marked.points;
+        result.earnedPoints += marked.points;
+        if (marked.correct) {
+            result.correct[i] = 1;
+            result.correctCount++;
+        } else {
+            result.wrongCount++;
+        }
+    }
+    return result;
+}
+
+namespace {
+
+// Grade submissions [begin, end) into scores, adding up outcomes in counts
+void gradeShard(const AnswerKey& key, const std::vector<SubmissionAnswers>& submissions,
+                size_t begin, size_t end, std::vector<SubmissionScore>& scores,
+                std::vector<uint32_t>& counts) {
+    const size_t questions = key.size();
+    std::vector<std::string_view> answers(questions);
+    std::vector<uint8_t> answered(questions);
+    AnswerKey::Scratch scratch;
+
+    for (size_t s = begin; s < end; s++) {
+        const SubmissionAnswers& submission = submissions[s];
+        std::fill(answered.begin(), answered.end(), 0);
+        for (const auto& answer : submission.answers) {
+            size_t position = key.position(answer.first);
+            if (position == AnswerKey::npos || answered[position]) continue;
+            answered[position] = 1;
+            answers[position] = answer.second;
+        }
+
+        SubmissionScore& score = scores[s];
+        score.submissionId = submission.submissionId;
+        for (size_t i = 0; i < questions; i++) {
+            std::string_view answer = answered[i] ? answers[i] : std::string_view();
+            uint32_t* outcome = &counts[i * OUTCOMES];
+            AnswerKey::Mark marked = key.mark(i, answer, scratch);
+            score.score += marked.points;
+            if (marked.correct) {
+                score.correctCount++;
+                outcome[CORRECT]++;
+            } else {
+                outcome[answered[i] ? WRONG : UNANSWERED]++;
+            }
+        }
+        score.percentage = key.totalPoints() > 0 ? score.score * 100 / key.totalPoints() : 0;
+    }
+}
+
+// The shards of one gradeBatch() call, claimed one at a time by the
+// caller and by any helper that picks the batch up
+struct ShardBatch {
+    std::function<void(size_t)> grade;
+    size_t shards = 0;
+    std::atomic<size_t> next{0};
+
+    std::mutex mutex;
+    std::condition_variable finished;
+    size_t done = 0;  // Guarded by mutex
+
+    // Grade shards until none is left unclaimed
+    void work() {
+        for (size_t shard; (shard = next.fetch_add(1)) < shards;) {
+            grade(shard);
+            std::lock_guard<std::mutex> lock(mutex);
+            if (++done == shards) finished.notify_all();
+        }
+    }
+
+    void waitFinished() {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this] { return done == shards; });
+    }
+};
+
+// Helper threads shared by every gradeBatch() call, one per core besides
+// the caller's. Concurrent bulk grades queue for them instead of each
+// starting threads of its own; a caller never waits for a helper to
+// start, since it grades whatever shards are still unclaimed itself.
+class ShardHelpers {
+public:
+    static ShardHelpers& instance() {
+        static ShardHelpers helpers;
+        return helpers;
+    }
+
+    size_t size() const { return threads_.size(); }
+
+    void post(std::shared_ptr<ShardBatch> batch) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queue_.push_back(std::move(batch));
+        }
+        ready_.notify_one();
+    }
+
+    ~ShardHelpers() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        ready_.notify_all();
+        for (auto& thread : threads_) thread.join();
+    }
+
+private:
+    ShardHelpers() {
+        unsigned helpers = std::max(1u, std::thread::hardware_concurrency()) - 1;
+        for (unsigned i = 0; i < helpers; i++) threads_.emplace_back(&ShardHelpers::run, this);
+    }
+
+    void run() {
+        for (;;) {
+            std::shared_ptr<ShardBatch> batch;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                ready_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+                if (queue_.empty()) return;
+                batch = std::move(queue_.front());
+                queue_.pop_front();
+            }
+            // Finds nothing left if the caller got through the shards first
+            batch->work();
+        }
+    }
+
+    std::mutex mutex_;
+    std::condition_variable ready_;
+    std::deque<std::shared_ptr<ShardBatch>> queue_;
+    bool stopping_ = false;
+    std::vector<std::thread> threads_;
+};
+
+} // namespace
+
+BulkGradeResult gradeBatch(const AnswerKey& key, const std::vector<SubmissionAnswers>& submissions,
+                           unsigned threads) {
+    BulkGradeResult result;
+    result.totalPoints = key.totalPoints();
+    result.scores.resize(submissions.size());
+
+    size_t shards = threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    shards = std::min(shards, std::max<size_t>(1, submissions.size() / MIN_SHARD_SIZE));
+    result.shards = static_cast<unsigned>(shards);
+
+    std::vector<std::vector<uint32_t>> counts(shards,
+                                              std::vector<uint32_t>(key.size() * OUTCOMES));
+    auto shardBegin = [&](size_t shard) { return submissions.size() * shard / shards; };
+
+    auto batch = std::make_shared<ShardBatch>();
+    batch->shards = shards;
+    batch->grade = [&](size_t shard) {
+        gradeShard(key, submissions, shardBegin(shard), shardBegin(shard + 1), result.scores,
+                   counts[shard]);
+    };
+    ShardHelpers& helpers = ShardHelpers::instance();
+    for (size_t i = 0; i < std::min(shards - 1, helpers.size()); i++) helpers.post(batch);
+    batch->work();
+    batch->waitFinished();
+
+    result.questions.resize(key.size());
+    for (size_t i = 0; i < key.size(); i++) {
+        QuestionStats& stats = result.questions[i];
+        stats.questionId = key.questionId(i);
+        for (const auto& shard : counts) {
+            stats.correct += shard[i * OUTCOMES + CORRECT];
+            stats.wrong += shard[i * OUTCOMES + WRONG];
+            stats.unanswered += shard[i * OUTCOMES + UNANSWERED];
+        }
+    }
+
+    long long percentages = 0;
+    for (const auto& score : result.scores) percentages += score.percentage;
+    if (!result.scores.empty()) {
+        result.averagePercentage = static_cast<double>(percentages) / result.scores.size();
+    }
+    return result;
+}
+
+AnswerKeyBook::AnswerKeyBook(const std::map<std::string, core::Test>& tests) {
+    keys_.reserve(tests.size());
+    for (const auto& pair : tests) {
+        keys_.emplace(pair.first, AnswerKey(pair.second));
+    }
+}
+
+const AnswerKey* AnswerKeyBook::find(const std::string& testId) const {
+    auto it = keys_.find(testId);
+    return it == keys_.end() ? nullptr : &it->second;
+}
+
+} // namespace service
+} // namespace english_learning
@@ -0,0 +1,162 @@
+#ifndef ENGLISH_LEARNING_SERVICE_ANSWER_KEY_H
+#define ENGLISH_LEARNING_SERVICE_ANSWER_KEY_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "include/core/test.h"
+#include "include/service/i_test_service.h"
+#include "src/repository/memory/catalog.h"
+
+namespace english_learning {
+namespace service {
+
+/** How a submitted answer is compared with the correct one. */
+enum class AnswerMatch : uint8_t {
+    Exact,     ///< multiple_choice: the option id as sent
+    Trimmed,   ///< fill_blank: case-insensitive, surrounding blanks ignored
+    Sentence   ///< sentence_order: also ignores punctuation and repeated spaces
+};
+
+/** The comparison for a question type; unknown types compare like fill_blank. */
+AnswerMatch answerMatchFor(const std::string& questionType);
+
+/** Replace out with answer normalized the way match compares it. */
+void normalizeAnswer(AnswerMatch match, std::string_view answer, std::string& out);
+
+/** Letter grade for a percentage score (A >= 90 ... F < 60). */
+const char* letterGrade(int percentage);
+
+/**
+ * A test's answer key, compiled once per Test: correct answers are
+ * normalized up front and question IDs are hashed to their position, so
+ * grading a submission is linear in the number of questions and only
+ * ever normalizes the submitted side.
+ *
+ * Questions can opt into tolerance: a fill_blank answer within maxTypos
+ * edits of the correct one still counts as correct, and a sentence_order
+ * answer with partialCredit earns points for its longest run of words in
+ * the right order (not necessarily adjacent), scaled by the longer of the
+ * two sentences. Both use the bit-parallel algorithms of fuzzy_match.h and
+ * only run when the normalized answer is not already an exact match.
+ *
+ * What grading reads for every answer (match mode, tolerance, points,
+ * normalized answer) is stored column-wise, with all normalized answers
+ * back to back in one buffer; IDs and authored answers, needed only for
+ * lookups and feedback, are kept apart.
+ */
+class AnswerKey {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    struct Result {
+        int totalPoints = 0;
+        int earnedPoints = 0;
+        int correctCount = 0;
+        int wrongCount = 0;             ///< Including partially correct answers
+        std::vector<uint8_t> correct;  ///< Per question position
+        std::vector<int> earned;        ///< Points per question position
+    };
+
+    /** Grading of one answer. */
+    struct Mark {
+        bool correct = false;
+        int points = 0;  ///< Full points if correct, maybe some with partial credit
+    };
+
+    /** Work space reused across mark() calls; one per thread. */
+    struct Scratch {
+        std::string answer;               ///< Normalized submitted answer
+        std::vector<uint64_t> wordMasks;  ///< Per submitted word
+        uint64_t charMasks[256] = {};     ///< For boundedEditDistance()
+    };
+
+    explicit AnswerKey(const core::Test& test);
+
+    // positions_ holds views into ids_
+    AnswerKey(const AnswerKey&) = delete;
+    AnswerKey& operator=(const AnswerKey&) = delete;
+    AnswerKey(AnswerKey&&) = default;
+    AnswerKey& operator=(AnswerKey&&) = default;
+
+    size_t size() const { return ids_.size(); }
+    int totalPoints() const { return totalPoints_; }
+    const std::string& questionId(size_t position) const { return ids_[position]; }
+    /** As authored, for feedback. */
+    const std::string& correctAnswer(size_t position) const { return correctAnswers_[position]; }
+    int points(size_t position) const { return points_[position]; }
+
+    /** Position of questionId in the test, or npos. */
+    size_t position(std::string_view questionId) const;
+
+    /** Grade answer to the question at position. */
+    Mark mark(size_t position, std::string_view answer, Scratch& scratch) const;
+
+    /** Grade answers given by question position; missing ones are empty. */
+    Result grade(const std::vector<std::string>& answers) const;
+
+private:
+    std::string_view normalized(size_t position) const {
+        uint32_t begin = position == 0 ? 0 : normalizedEnd_[position - 1];
+        return std::string_view(normalized_).substr(begin, normalizedEnd_[position] - begin);
+    }
+
+    /** A distinct word of a partial-credit sentence. */
+    struct Word {
+        size_t hash;
+        uint64_t positions;   ///< Bit i: the sentence's i-th word
+        uint32_t begin, end;  ///< In normalized_
+    };
+
+    Mark markPartial(size_t position, Scratch& scratch) const;
+
+    // Hot: read for every graded answer
+    std::vector<AnswerMatch> matches_;
+    /// Trimmed: edits accepted; Sentence: its words if partial credit is on.
+    /// 0 = exact match only.
+    std::vector<uint8_t> tolerance_;
+    std::vector<int> points_;
+    std::string normalized_;               ///< Normalized correct answers, concatenated
+    std::vector<uint32_t> normalizedEnd_;  ///< End of each answer in normalized_
+    std::vector<Word> words_;              ///< Of partial-credit sentences, by question
+    std::vector<uint32_t> wordsEnd_;       ///< End of each question's words in words_
+    int totalPoints_ = 0;
+
+    // Cold: lookups and feedback
+    std::vector<std::string> ids_;
+    std::vector<std::string> correctAnswers_;
+    std::unordered_map<std::string_view, uint32_t> positions_;
+};
+
+/**
+ * Grade many submissions of one test, split into contiguous shards
+ * (threads = 0: one per core; small batches use fewer). The caller grades
+ * shards along with a fixed set of helper threads shared by all calls, so
+ * concurrent batches share the cores rather than each starting threads.
+ * Each shard counts per-question outcomes on its own and the counts are
+ * summed at the end.
+ */
+BulkGradeResult gradeBatch(const AnswerKey& key, const std::vector<SubmissionAnswers>& submissions,
+                           unsigned threads = 0);
+
+/** Answer keys for every test of one catalog version, by testId. */
+class AnswerKeyBook {
+public:
+    explicit AnswerKeyBook(const std::map<std::string, core::Test>& tests);
+
+    const AnswerKey* find(const std::string& testId) const;
+
+private:
+    std::unordered_map<std::string, AnswerKey> keys_;
+};
+
+/** The AnswerKeyBook of the test catalog's current version. */
+using AnswerKeyCache = repository::memory::CatalogView<core::Test, AnswerKeyBook>;
+
+} // namespace service
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_SERVICE_ANSWER_KEY_H
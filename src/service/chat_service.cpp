@@ -54,12 +54,7 @@ ServiceResult<ChatHistoryResult> ChatService::getChatHistory(
 
     auto messages = chatRepo_.findConversation(userId1, userId2);
 
-    // Apply limit if specified
-    if (limit > 0 && messages.size() > limit) {
-        messages.resize(limit);
-    }
-
-    // Count unread for userId1
+    // Count unread for userId1 over the whole conversation, not just the page
     size_t unreadCount = 0;
     for (const auto& msg : messages) {
         if (msg.recipientId == userId1 && !msg.read) {
@@ -67,6 +62,11 @@ ServiceResult<ChatHistoryResult> ChatService::getChatHistory(
         }
     }
 
+    // Apply limit if specified, keeping the newest messages
+    if (limit > 0 && messages.size() > limit) {
+        messages.erase(messages.begin(), messages.end() - static_cast<std::ptrdiff_t>(limit));
+    }
+
     ChatHistoryResult result;
     result.messages = messages;
     result.total = messages.size();
@@ -0,0 +1,65 @@
+#include "src/service/fuzzy_match.h"
+
+namespace english_learning {
+namespace service {
+
+int boundedEditDistance(std::string_view pattern, std::string_view text, int bound,
+                        uint64_t charMasks[256]) {
+    const int m = static_cast<int>(pattern.size());
+    const int n = static_cast<int>(text.size());
+    if (m - n > bound || n - m > bound) return bound + 1;
+    if (m == 0) return n;
+
+    for (int i = 0; i < m; i++) {
+        charMasks[static_cast<unsigned char>(pattern[i])] |= uint64_t(1) << i;
+    }
+
+    // Vertical deltas of the current column, as +1 (Pv) and -1 (Mv) bits;
+    // score tracks the last row, D[m][j]
+    const uint64_t last = uint64_t(1) << (m - 1);
+    uint64_t pv = ~uint64_t(0);
+    uint64_t mv = 0;
+    int score = m;
+    for (int j = 0; j < n; j++) {
+        uint64_t eq = charMasks[static_cast<unsigned char>(text[j])];
+        uint64_t xv = eq | mv;
+        uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+        uint64_t ph = mv | ~(xh | pv);
+        uint64_t mh = pv & xh;
+        if (ph & last) {
+            score++;
+        } else if (mh & last) {
+            score--;
+        }
+        // Row 0 is D[0][j] = j: every column adds 1 there
+        ph = (ph << 1) | 1;
+        mh <<= 1;
+        pv = mh | ~(xv | ph);
+        mv = ph & xv;
+
+        // Each remaining column can lower the score by at most one
+        if (score - (n - 1 - j) > bound) {
+            score = bound + 1;
+            break;
+        }
+    }
+
+    for (int i = 0; i < m; i++) charMasks[static_cast<unsigned char>(pattern[i])] = 0;
+    return score > bound ? bound + 1 : score;
+}
+
+int longestCommonSubsequence(size_t patternLength, const uint64_t* textMasks, size_t textLength) {
+    if (patternLength == 0) return 0;
+    // Zero bits of v mark pattern positions that end a common subsequence
+    const uint64_t used = patternLength == 64 ? ~uint64_t(0)
+                                              : (uint64_t(1) << patternLength) - 1;
+    uint64_t v = ~uint64_t(0);
+    for (size_t j = 0; j < textLength; j++) {
+        uint64_t u = v & textMasks[j];
+        v = (v + u) | (v - u);
+    }
+    return __builtin_popcountll(~v & used);
+}
+
+} // namespace service
+} // namespace english_learning
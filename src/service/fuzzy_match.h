@@ -0,0 +1,40 @@
+#ifndef ENGLISH_LEARNING_SERVICE_FUZZY_MATCH_H
+#define ENGLISH_LEARNING_SERVICE_FUZZY_MATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace english_learning {
+namespace service {
+
+/**
+ * Bit-parallel string distances used for tolerant grading. Both keep one
+ * bit per position of the pattern (the correct answer) in a machine word,
+ * so the pattern is limited to MAX_FUZZY_PATTERN bytes or tokens and each
+ * symbol of the text costs a handful of word operations.
+ */
+constexpr size_t MAX_FUZZY_PATTERN = 64;
+
+/**
+ * Levenshtein distance between pattern and text (Myers' algorithm in
+ * Hyyrö's formulation), or bound + 1 as soon as it is known to exceed
+ * bound.
+ *
+ * charMasks is a work table indexed by byte; it must be all zero on
+ * entry and is all zero again on return.
+ */
+int boundedEditDistance(std::string_view pattern, std::string_view text, int bound,
+                        uint64_t charMasks[256]);
+
+/**
+ * Length of the longest common subsequence of a pattern of patternLength
+ * symbols and a text given as, for each of its symbols in order, the mask
+ * of the pattern positions holding that symbol (0 if none).
+ */
+int longestCommonSubsequence(size_t patternLength, const uint64_t* textMasks, size_t textLength);
+
+} // namespace service
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_SERVICE_FUZZY_MATCH_H
@@ -1,4 +1,5 @@
 #include "game_service.h"
+#include "match_key.h"
 #include "include/protocol/utils.h"
 #include <algorithm>
 
@@ -7,9 +8,11 @@ namespace service {
 
 GameService::GameService(
     repository::IGameRepository& gameRepo,
-    repository::IUserRepository& userRepo)
+    repository::IUserRepository& userRepo,
+    const MatchKeyCache* matchKeys)
     : gameRepo_(gameRepo)
-    , userRepo_(userRepo) {}
+    , userRepo_(userRepo)
+    , matchKeys_(matchKeys) {}
 
 ServiceResult<GameListResult> GameService::getGames(const std::string& level) {
     std::vector<core::Game> games;
@@ -92,25 +95,17 @@ ServiceResult<GameSessionResult> GameService::submitGameMatches(
         return ServiceResult<GameSessionResult>::error("Session already completed");
     }
 
-    auto gameOpt = gameRepo_.findGameById(session.gameId);
-    if (!gameOpt.has_value()) {
+    std::shared_ptr<const MatchKey> key = findMatchKey(session.gameId);
+    if (!key) {
         return ServiceResult<GameSessionResult>::error("Game not found");
     }
 
-    const core::Game& game = gameOpt.value();
-    const auto& correctPairs = game.getActivePairs();
-
     // Calculate score based on correct matches
-    int correctCount = 0;
-    for (const auto& pair : correctPairs) {
-        auto it = matches.find(pair.first);
-        if (it != matches.end() && it->second == pair.second) {
-            correctCount++;
-        }
+    MatchTally tally(*key);
+    for (const auto& match : matches) {
+        tally.add(match.first, match.second);
     }
-
-    int score = correctPairs.empty() ? 0 :
-        (correctCount * game.maxScore) / static_cast<int>(correctPairs.size());
+    int score = tally.score();
 
     long long endTime = protocol::utils::getCurrentTimestamp();
 
@@ -119,8 +114,8 @@ ServiceResult<GameSessionResult> GameService::submitGameMatches(
         return ServiceResult<GameSessionResult>::error("Failed to complete session");
     }
 
-    double percentage = game.maxScore == 0 ? 0.0 :
-        (static_cast<double>(score) / game.maxScore) * 100.0;
+    double percentage = key->maxScore() == 0 ? 0.0 :
+        (static_cast<double>(score) / key->maxScore()) * 100.0;
 
     std::string grade;
     if (percentage >= 90) grade = "Excellent";
@@ -134,7 +129,7 @@ ServiceResult<GameSessionResult> GameService::submitGameMatches(
     result.gameId = session.gameId;
     result.oderId = userId;
     result.score = score;
-    result.maxScore = game.maxScore;
+    result.maxScore = key->maxScore();
     result.percentage = percentage;
     result.grade = grade;
     result.durationSeconds = static_cast<int>((endTime - session.startTime) / 1000);
@@ -142,6 +137,19 @@ ServiceResult<GameSessionResult> GameService::submitGameMatches(
     return ServiceResult<GameSessionResult>::success(result);
 }
 
+std::shared_ptr<const MatchKey> GameService::findMatchKey(const std::string& gameId) const {
+    if (matchKeys_) {
+        std::shared_ptr<const MatchKeyBook> keys = matchKeys_->current();
+        const MatchKey* key = keys->find(gameId);
+        // Shares ownership of the book, which holds the key
+        return key ? std::shared_ptr<const MatchKey>(keys, key) : nullptr;
+    }
+
+    auto gameOpt = gameRepo_.findGameById(gameId);
+    if (!gameOpt.has_value()) return nullptr;
+    return std::make_shared<const MatchKey>(gameOpt.value());
+}
+
 ServiceResult<std::vector<core::GameSession>> GameService::getUserGameHistory(
     const std::string& userId,
     const std::string& gameId) {
@@ -1,21 +1,27 @@
 #ifndef ENGLISH_LEARNING_SERVICE_GAME_SERVICE_H
 #define ENGLISH_LEARNING_SERVICE_GAME_SERVICE_H
 
+#include <memory>
 #include "include/service/i_game_service.h"
 #include "include/repository/i_game_repository.h"
 #include "include/repository/i_user_repository.h"
+#include "src/service/match_key.h"
 
 namespace english_learning {
 namespace service {
 
 /**
  * Implementation of game management service.
+ *
+ * Given the match keys the server keeps for the game catalog, scoring
+ * uses those; otherwise each call compiles the game's key afresh.
  */
 class GameService : public IGameService {
 public:
     GameService(
         repository::IGameRepository& gameRepo,
-        repository::IUserRepository& userRepo);
+        repository::IUserRepository& userRepo,
+        const MatchKeyCache* matchKeys = nullptr);
 
     ~GameService() override = default;
 
@@ -50,8 +56,12 @@ public:
         const std::string& gameId) override;
 
 private:
+    /** The game's match key, or nullptr if there is no such game. */
+    std::shared_ptr<const MatchKey> findMatchKey(const std::string& gameId) const;
+
     repository::IGameRepository& gameRepo_;
     repository::IUserRepository& userRepo_;
+    const MatchKeyCache* matchKeys_;
 };
 
 } // namespace service
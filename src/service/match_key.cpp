@@ -0,0 +1,62 @@
+#include "src/service/match_key.h"
+
+#include <functional>
+
+namespace english_learning {
+namespace service {
+
+size_t MatchKey::PairHash::operator()(
+    const std::pair<std::string_view, std::string_view>& pair) const {
+    size_t left = std::hash<std::string_view>()(pair.first);
+    size_t right = std::hash<std::string_view>()(pair.second);
+    return left ^ (right + 0x9e3779b97f4a7c15ULL + (left << 6) + (left >> 2));
+}
+
+MatchKey::MatchKey(const core::Game& game)
+    : maxScore_(game.maxScore), leftField_("left"), rightField_("right") {
+    // Games of an unknown type have no pairs to match
+    core::GameType type;
+    if (core::parseGameType(game.gameType, type)) {
+        switch (type) {
+        case core::GameType::WordMatch:
+            pairs_ = game.pairs;
+            break;
+        case core::GameType::SentenceMatch:
+            pairs_ = game.sentencePairs;
+            break;
+        case core::GameType::PictureMatch:
+            pairs_ = game.picturePairs;
+            leftField_ = "word";
+            rightField_ = "imageUrl";
+            break;
+        }
+    }
+
+    // After pairs_ is final: the keys point into its strings
+    positions_.reserve(pairs_.size());
+    for (size_t i = 0; i < pairs_.size(); i++) {
+        positions_.emplace(std::make_pair(std::string_view(pairs_[i].first),
+                                          std::string_view(pairs_[i].second)),
+                           static_cast<uint32_t>(i));
+    }
+}
+
+size_t MatchKey::find(std::string_view left, std::string_view right) const {
+    auto it = positions_.find(std::make_pair(left, right));
+    return it == positions_.end() ? npos : it->second;
+}
+
+MatchKeyBook::MatchKeyBook(const std::map<std::string, core::Game>& games) {
+    keys_.reserve(games.size());
+    for (const auto& pair : games) {
+        keys_.emplace(pair.first, MatchKey(pair.second));
+    }
+}
+
+const MatchKey* MatchKeyBook::find(const std::string& gameId) const {
+    auto it = keys_.find(gameId);
+    return it == keys_.end() ? nullptr : &it->second;
+}
+
+} // namespace service
+} // namespace english_learning
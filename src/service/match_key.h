@@ -0,0 +1,105 @@
+#ifndef ENGLISH_LEARNING_SERVICE_MATCH_KEY_H
+#define ENGLISH_LEARNING_SERVICE_MATCH_KEY_H
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "include/core/game.h"
+#include "src/repository/memory/catalog.h"
+
+namespace english_learning {
+namespace service {
+
+/**
+ * A game's correct pairs, compiled once per Game: each (left, right)
+ * pair of the game type's pair list is hashed to its position, so
+ * checking a submitted match is one lookup instead of a scan of every
+ * pair. A pair listed twice in the game resolves to its first position.
+ */
+class MatchKey {
+public:
+    static constexpr size_t npos = static_cast<size_t>(-1);
+
+    explicit MatchKey(const core::Game& game);
+
+    // positions_ holds views into pairs_
+    MatchKey(const MatchKey&) = delete;
+    MatchKey& operator=(const MatchKey&) = delete;
+    MatchKey(MatchKey&&) = default;
+    MatchKey& operator=(MatchKey&&) = default;
+
+    /** Pairs in the game, duplicates included (totalPairs). */
+    size_t size() const { return pairs_.size(); }
+    int maxScore() const { return maxScore_; }
+
+    /** Field names of a submitted match: left/right, or word/imageUrl. */
+    const char* leftField() const { return leftField_; }
+    const char* rightField() const { return rightField_; }
+
+    /** Position of the pair (left, right) in the game, or npos. */
+    size_t find(std::string_view left, std::string_view right) const;
+
+private:
+    struct PairHash {
+        size_t operator()(const std::pair<std::string_view, std::string_view>& pair) const;
+    };
+
+    std::vector<std::pair<std::string, std::string>> pairs_;
+    std::unordered_map<std::pair<std::string_view, std::string_view>, uint32_t, PairHash>
+        positions_;
+    int maxScore_;
+    const char* leftField_;
+    const char* rightField_;
+};
+
+/**
+ * Counts the correct matches of one submission, each pair of the game
+ * at most once however many times it is submitted.
+ */
+class MatchTally {
+public:
+    explicit MatchTally(const MatchKey& key) : key_(key), seen_(key.size(), 0) {}
+
+    /** Count (left, right) if it is a pair of the game not counted yet. */
+    void add(std::string_view left, std::string_view right) {
+        size_t position = key_.find(left, right);
+        if (position == MatchKey::npos || seen_[position]) return;
+        seen_[position] = 1;
+        correct_++;
+    }
+
+    int correct() const { return correct_; }
+
+    /** correct() out of the game's pairs, scaled to its maxScore. */
+    int score() const {
+        return key_.size() > 0 ? correct_ * key_.maxScore() / static_cast<int>(key_.size()) : 0;
+    }
+
+private:
+    const MatchKey& key_;
+    std::vector<uint8_t> seen_;
+    int correct_ = 0;
+};
+
+/** Match keys for every game of one catalog version, by gameId. */
+class MatchKeyBook {
+public:
+    explicit MatchKeyBook(const std::map<std::string, core::Game>& games);
+
+    const MatchKey* find(const std::string& gameId) const;
+
+private:
+    std::unordered_map<std::string, MatchKey> keys_;
+};
+
+/** The MatchKeyBook of the game catalog's current version. */
+using MatchKeyCache = repository::memory::CatalogView<core::Game, MatchKeyBook>;
+
+} // namespace service
+} // namespace english_learning
+
+#endif // ENGLISH_LEARNING_SERVICE_MATCH_KEY_H
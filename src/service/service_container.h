@@ -42,7 +42,9 @@ class ServiceContainer {
 public:
     /**
      * Constructor with repository dependencies.
-     * Creates all service instances with proper dependencies.
+     * Creates all service instances with proper dependencies; answerKeys
+     * and matchKeys, if given, are the test and game catalogs' compiled
+     * keys for grading and scoring.
      */
     ServiceContainer(
         repository::IUserRepository& userRepo,
@@ -52,13 +54,15 @@ public:
         repository::IChatRepository& chatRepo,
         repository::IExerciseRepository& exerciseRepo,
         repository::IGameRepository& gameRepo,
-        repository::IVoiceCallRepository& voiceCallRepo)
+        repository::IVoiceCallRepository& voiceCallRepo,
+        const AnswerKeyCache* answerKeys = nullptr,
+        const MatchKeyCache* matchKeys = nullptr)
         : authService_(std::make_unique<AuthService>(userRepo, sessionRepo, chatRepo))
         , lessonService_(std::make_unique<LessonService>(lessonRepo, userRepo))
-        , testService_(std::make_unique<TestService>(testRepo, userRepo))
+        , testService_(std::make_unique<TestService>(testRepo, userRepo, answerKeys))
         , chatService_(std::make_unique<ChatService>(chatRepo, userRepo))
         , exerciseService_(std::make_unique<ExerciseService>(exerciseRepo, userRepo))
-        , gameService_(std::make_unique<GameService>(gameRepo, userRepo))
+        , gameService_(std::make_unique<GameService>(gameRepo, userRepo, matchKeys))
         , voiceCallService_(std::make_unique<VoiceCallService>(voiceCallRepo, userRepo))
     {}
 
@@ -1,4 +1,5 @@
 #include "test_service.h"
+#include "answer_key.h"
 #include "include/protocol/utils.h"
 
 namespace english_learning {
@@ -6,9 +7,11 @@ namespace service {
 
 TestService::TestService(
     repository::ITestRepository& testRepo,
-    repository::IUserRepository& userRepo)
+    repository::IUserRepository& userRepo,
+    const AnswerKeyCache* answerKeys)
     : testRepo_(testRepo)
-    , userRepo_(userRepo) {}
+    , userRepo_(userRepo)
+    , answerKeys_(answerKeys) {}
 
 ServiceResult<TestListResult> TestService::getTests(const std::string& level) {
     std::vector<core::Test> tests;
@@ -74,38 +77,25 @@ ServiceResult<TestSubmissionResult> TestService::submitTest(
     const std::string& testId,
     const std::vector<std::string>& answers) {
 
-    auto testOpt = testRepo_.findById(testId);
-    if (!testOpt.has_value()) {
+    std::shared_ptr<const AnswerKey> key = findAnswerKey(testId);
+    if (!key) {
         return ServiceResult<TestSubmissionResult>::error("Test not found");
     }
 
-    const core::Test& test = testOpt.value();
-
-    if (answers.size() != test.questions.size()) {
+    if (answers.size() != key->size()) {
         return ServiceResult<TestSubmissionResult>::error("Number of answers doesn't match questions");
     }
 
-    int score = 0;
-    std::vector<bool> questionResults;
+    // Same grading as SUBMIT_TEST, including per-question tolerance
+    AnswerKey::Result graded = key->grade(answers);
+    int score = graded.earnedPoints;
+    std::vector<bool> questionResults(graded.correct.begin(), graded.correct.end());
 
-    for (size_t i = 0; i < test.questions.size(); i++) {
-        bool correct = test.questions[i].checkAnswer(answers[i]);
-        questionResults.push_back(correct);
-        if (correct) {
-            score += test.questions[i].points;
-        }
-    }
-
-    int totalPoints = test.getTotalPoints();
+    int totalPoints = graded.totalPoints;
     double percentage = totalPoints == 0 ? 0.0 :
         (static_cast<double>(score) / totalPoints) * 100.0;
 
-    std::string grade;
-    if (percentage >= 90) grade = "A";
-    else if (percentage >= 80) grade = "B";
-    else if (percentage >= 70) grade = "C";
-    else if (percentage >= 60) grade = "D";
-    else grade = "F";
+    std::string grade = letterGrade(static_cast<int>(percentage));
 
     TestSubmissionResult result;
     result.testId = testId;
@@ -118,6 +108,39 @@ ServiceResult<TestSubmissionResult> TestService::submitTest(
     return ServiceResult<TestSubmissionResult>::success(result);
 }
 
+ServiceResult<BulkGradeResult> TestService::gradeSubmissions(
+    const std::string& userId,
+    const std::string& testId,
+    const std::vector<SubmissionAnswers>& submissions,
+    unsigned threads) {
+
+    if (!userRepo_.isTeacher(userId)) {
+        return ServiceResult<BulkGradeResult>::error("Only teachers can grade submissions");
+    }
+
+    std::shared_ptr<const AnswerKey> key = findAnswerKey(testId);
+    if (!key) {
+        return ServiceResult<BulkGradeResult>::error("Test not found");
+    }
+
+    BulkGradeResult result = gradeBatch(*key, submissions, threads);
+    result.testId = testId;
+    return ServiceResult<BulkGradeResult>::success(result);
+}
+
+std::shared_ptr<const AnswerKey> TestService::findAnswerKey(const std::string& testId) const {
+    if (answerKeys_) {
+        std::shared_ptr<const AnswerKeyBook> keys = answerKeys_->current();
+        const AnswerKey* key = keys->find(testId);
+        // Shares ownership of the book, which holds the key
+        return key ? std::shared_ptr<const AnswerKey>(keys, key) : nullptr;
+    }
+
+    auto testOpt = testRepo_.findById(testId);
+    if (!testOpt.has_value()) return nullptr;
+    return std::make_shared<const AnswerKey>(testOpt.value());
+}
+
 ServiceResult<core::Test> TestService::updateTest(
     const std::string& userId,
     const std::string& testId,
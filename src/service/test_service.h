@@ -1,21 +1,27 @@
 #ifndef ENGLISH_LEARNING_SERVICE_TEST_SERVICE_H
 #define ENGLISH_LEARNING_SERVICE_TEST_SERVICE_H
 
+#include <memory>
 #include "include/service/i_test_service.h"
 #include "include/repository/i_test_repository.h"
 #include "include/repository/i_user_repository.h"
+#include "src/service/answer_key.h"
 
 namespace english_learning {
 namespace service {
 
 /**
  * Implementation of test management service.
+ *
+ * Given the answer keys the server keeps for the test catalog, grading
+ * uses those; otherwise each call compiles the test's key afresh.
  */
 class TestService : public ITestService {
 public:
     TestService(
         repository::ITestRepository& testRepo,
-        repository::IUserRepository& userRepo);
+        repository::IUserRepository& userRepo,
+        const AnswerKeyCache* answerKeys = nullptr);
 
     ~TestService() override = default;
 
@@ -36,6 +42,12 @@ public:
         const std::string& testId,
         const std::vector<std::string>& answers) override;
 
+    ServiceResult<BulkGradeResult> gradeSubmissions(
+        const std::string& userId,
+        const std::string& testId,
+        const std::vector<SubmissionAnswers>& submissions,
+        unsigned threads = 0) override;
+
     ServiceResult<core::Test> updateTest(
         const std::string& userId,
         const std::string& testId,
@@ -52,8 +64,12 @@ public:
     ServiceResult<size_t> getTestCount() override;
 
 private:
+    /** The test's answer key, or nullptr if there is no such test. */
+    std::shared_ptr<const AnswerKey> findAnswerKey(const std::string& testId) const;
+
     repository::ITestRepository& testRepo_;
     repository::IUserRepository& userRepo_;
+    const AnswerKeyCache* answerKeys_;
 };
 
 } // namespace service